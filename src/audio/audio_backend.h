@@ -28,6 +28,8 @@ namespace Audio
 		virtual b8 OpenStartStream(const BackendStreamParam& param, BackendRenderCallback callback) = 0;
 		virtual b8 StopCloseStream() = 0;
 		virtual b8 IsOpenRunning() const = 0;
+		// NOTE: Number of times the output device ran out of frames to play since the stream was last opened, as far as the backend is able to tell
+		virtual i64 GetUnderrunCount() const = 0;
 	};
 
 	class WASAPIBackend : public IAudioBackend
@@ -40,9 +42,34 @@ namespace Audio
 		b8 OpenStartStream(const BackendStreamParam& param, BackendRenderCallback callback) override;
 		b8 StopCloseStream() override;
 		b8 IsOpenRunning() const override;
+		i64 GetUnderrunCount() const override;
 
 	private:
 		struct Impl;
 		std::unique_ptr<Impl> impl;
 	};
+
+	// NOTE: Device-less backend without a render thread of its own, the render callback is instead driven explicitly
+	//		 by whoever owns the stream clock so that audio can be rendered deterministically and as fast as the CPU allows
+	class OfflineRenderBackend : public IAudioBackend
+	{
+	public:
+		OfflineRenderBackend() = default;
+		~OfflineRenderBackend() = default;
+
+	public:
+		b8 OpenStartStream(const BackendStreamParam& param, BackendRenderCallback callback) override;
+		b8 StopCloseStream() override;
+		b8 IsOpenRunning() const override;
+		// NOTE: Frames are only rendered on demand so there is no device to ever run out of them
+		i64 GetUnderrunCount() const override;
+
+		// NOTE: Synchronously invokes the render callback on the calling thread in chunks of at most DesiredFrameCount frames
+		b8 RenderFrames(i16* outInterleavedSamples, i64 frameCount);
+
+	private:
+		BackendStreamParam streamParam = {};
+		BackendRenderCallback renderCallback = nullptr;
+		b8 isOpenRunning = false;
+	};
 }
@@ -0,0 +1,57 @@
+#include "audio_backend.h"
+#include "audio_common.h"
+
+namespace Audio
+{
+	b8 OfflineRenderBackend::OpenStartStream(const BackendStreamParam& param, BackendRenderCallback callback)
+	{
+		if (isOpenRunning)
+			return false;
+
+		if (param.ChannelCount == 0 || param.DesiredFrameCount == 0 || callback == nullptr)
+			return false;
+
+		streamParam = param;
+		renderCallback = std::move(callback);
+		isOpenRunning = true;
+		return true;
+	}
+
+	b8 OfflineRenderBackend::StopCloseStream()
+	{
+		if (!isOpenRunning)
+			return false;
+
+		isOpenRunning = false;
+		renderCallback = nullptr;
+		return true;
+	}
+
+	b8 OfflineRenderBackend::IsOpenRunning() const
+	{
+		return isOpenRunning;
+	}
+
+	i64 OfflineRenderBackend::GetUnderrunCount() const
+	{
+		return 0;
+	}
+
+	b8 OfflineRenderBackend::RenderFrames(i16* outInterleavedSamples, i64 frameCount)
+	{
+		if (!isOpenRunning || outInterleavedSamples == nullptr || frameCount < 0)
+			return false;
+
+		i64 framesRemaining = frameCount;
+		while (framesRemaining > 0)
+		{
+			const u32 chunkFrameCount = static_cast<u32>(Min<i64>(framesRemaining, streamParam.DesiredFrameCount));
+			renderCallback(outInterleavedSamples, chunkFrameCount, streamParam.ChannelCount);
+
+			outInterleavedSamples += (static_cast<size_t>(chunkFrameCount) * streamParam.ChannelCount);
+			framesRemaining -= chunkFrameCount;
+		}
+
+		return true;
+	}
+}
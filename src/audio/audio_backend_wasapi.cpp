@@ -55,6 +55,7 @@ namespace Audio
 
 			streamParam = param;
 			renderCallback = std::move(callback);
+			underrunCount = 0;
 
 			HRESULT error = S_OK;
 			error = Win32ThreadLocalCoInitializeOnce();
@@ -213,6 +214,11 @@ namespace Audio
 			return isOpenRunning;
 		}
 
+		i64 GetUnderrunCount() const
+		{
+			return underrunCount;
+		}
+
 	public:
 		u32 RenderThreadEntryPoint()
 		{
@@ -275,10 +281,16 @@ namespace Audio
 				UINT32 remainingFrameCount = bufferFrameCount;
 				if (streamParam.ShareMode == StreamShareMode::Shared)
 				{
+					// NOTE: Nothing being left queued up means the device has already run dry (or is just about to) by the time this buffer is submitted.
+					//		 Exclusive mode streams always refill the entire buffer at once without any way of telling, so underruns are only detected in shared mode
 					UINT32 paddingFrameCount;
 					error = audioClient->GetCurrentPadding(&paddingFrameCount);
 					if (!FAILED(error))
+					{
+						if (paddingFrameCount == 0)
+							underrunCount++;
 						remainingFrameCount -= paddingFrameCount;
+					}
 				}
 
 				error = renderClient->GetBuffer(remainingFrameCount, &tempOutputBuffer);
@@ -325,6 +337,7 @@ namespace Audio
 
 		std::atomic<b8> isOpenRunning = false;
 		std::atomic<b8> renderThreadStopRequested = false;
+		std::atomic<i64> underrunCount = 0;
 
 		b8 applySharedSessionVolume = true;
 
@@ -350,4 +363,5 @@ namespace Audio
 	b8 WASAPIBackend::OpenStartStream(const BackendStreamParam& param, BackendRenderCallback callback) { return impl->OpenStartStream(param, std::move(callback)); }
 	b8 WASAPIBackend::StopCloseStream() { return impl->StopCloseStream(); }
 	b8 WASAPIBackend::IsOpenRunning() const { return impl->IsOpenRunning(); }
+	i64 WASAPIBackend::GetUnderrunCount() const { return impl->GetUnderrunCount(); }
 }
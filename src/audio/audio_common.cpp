@@ -1,15 +1,222 @@
 #include "audio_common.h"
 
+#if defined(_M_X64) || defined(__SSE2__)
+#define PEEPO_AUDIO_SSE2_MIX_BUS 1
+#include <emmintrin.h>
+#else
+#define PEEPO_AUDIO_SSE2_MIX_BUS 0
+#endif
+
+#if PEEPO_AUDIO_AVX2
+#include <immintrin.h>
+#endif
+
 namespace Audio
 {
+#if PEEPO_AUDIO_AVX2
+	static b8 QueryCPUSupportsAVX2()
+	{
+#if defined(_MSC_VER)
+		int info[4] = {};
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// NOTE: OSXSAVE and AVX, plus the OS actually saving the upper halves of the YMM registers
+		__cpuid(info, 1);
+		constexpr int requiredECX = (1 << 27) | (1 << 28);
+		if ((info[2] & requiredECX) != requiredECX || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	b8 CPUSupportsAVX2()
+	{
+		static const b8 supported = QueryCPUSupportsAVX2();
+		return supported;
+	}
+#endif
+
+#if PEEPO_AUDIO_SSE2_MIX_BUS
+	// NOTE: Sign extend 8 i16 samples to two vectors of 4 f32 each, by moving each sample into the upper half of an i32 and then shifting it back down
+	static inline void ConvertEightSamplesI16ToF32(__m128i samples, __m128& outLow, __m128& outHigh)
+	{
+		outLow = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+		outHigh = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+	}
+#endif
+
+	static void MixSamplesI16IntoBusF32ScalarOrSSE2(f32* inOutBus, const i16* inSamples, size_t sampleCount, f32 volume)
+	{
+		size_t i = 0;
+#if PEEPO_AUDIO_SSE2_MIX_BUS
+		const __m128 volumeVector = _mm_set1_ps(volume);
+		for (; (i + 8) <= sampleCount; i += 8)
+		{
+			__m128 low, high;
+			ConvertEightSamplesI16ToF32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(inSamples + i)), low, high);
+			_mm_storeu_ps(inOutBus + i + 0, _mm_add_ps(_mm_loadu_ps(inOutBus + i + 0), _mm_mul_ps(low, volumeVector)));
+			_mm_storeu_ps(inOutBus + i + 4, _mm_add_ps(_mm_loadu_ps(inOutBus + i + 4), _mm_mul_ps(high, volumeVector)));
+		}
+#endif
+		for (; i < sampleCount; i++)
+			inOutBus[i] += (static_cast<f32>(inSamples[i]) * volume);
+	}
+
+	static void MixStereoSamplesI16IntoBusF32ScalarOrSSE2(f32* inOutBus, const i16* inSamples, const f32* inFrameVolumes, size_t frameCount)
+	{
+		size_t f = 0;
+#if PEEPO_AUDIO_SSE2_MIX_BUS
+		for (; (f + 4) <= frameCount; f += 4)
+		{
+			// NOTE: 4 frames = 8 interleaved samples, with each frame volume then duplicated for both of its channels
+			const __m128 frameVolumes = _mm_loadu_ps(inFrameVolumes + f);
+			const __m128 volumesLow = _mm_unpacklo_ps(frameVolumes, frameVolumes);
+			const __m128 volumesHigh = _mm_unpackhi_ps(frameVolumes, frameVolumes);
+
+			__m128 low, high;
+			f32* bus = inOutBus + (f * 2);
+			ConvertEightSamplesI16ToF32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(inSamples + (f * 2))), low, high);
+			_mm_storeu_ps(bus + 0, _mm_add_ps(_mm_loadu_ps(bus + 0), _mm_mul_ps(low, volumesLow)));
+			_mm_storeu_ps(bus + 4, _mm_add_ps(_mm_loadu_ps(bus + 4), _mm_mul_ps(high, volumesHigh)));
+		}
+#endif
+		for (; f < frameCount; f++)
+		{
+			inOutBus[(f * 2) + 0] += (static_cast<f32>(inSamples[(f * 2) + 0]) * inFrameVolumes[f]);
+			inOutBus[(f * 2) + 1] += (static_cast<f32>(inSamples[(f * 2) + 1]) * inFrameVolumes[f]);
+		}
+	}
+
+	// NOTE: Same range as ClampSampleI16() with the conversion truncating towards zero just like a static_cast
+	static constexpr f32 BusMinSample = static_cast<f32>(I16Min + 1), BusMaxSample = static_cast<f32>(I16Max - 1);
+
+	static void ConvertBusF32ToSamplesI16ClampedScalarOrSSE2(const f32* inBus, i16* outSamples, size_t sampleCount, f32 volume)
+	{
+		constexpr f32 minSample = BusMinSample, maxSample = BusMaxSample;
+
+		size_t i = 0;
+#if PEEPO_AUDIO_SSE2_MIX_BUS
+		const __m128 volumeVector = _mm_set1_ps(volume);
+		const __m128 minVector = _mm_set1_ps(minSample), maxVector = _mm_set1_ps(maxSample);
+		for (; (i + 8) <= sampleCount; i += 8)
+		{
+			const __m128 low = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(inBus + i + 0), volumeVector), minVector), maxVector);
+			const __m128 high = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(inBus + i + 4), volumeVector), minVector), maxVector);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(outSamples + i), _mm_packs_epi32(_mm_cvttps_epi32(low), _mm_cvttps_epi32(high)));
+		}
+#endif
+		for (; i < sampleCount; i++)
+			outSamples[i] = static_cast<i16>(Clamp(inBus[i] * volume, minSample, maxSample));
+	}
+
+#if PEEPO_AUDIO_AVX2
+	// NOTE: Same operations (separate multiply and add, no FMA) in the same order as the SSE2 and scalar versions, so that all of them produce bit identical results
+	PEEPO_AUDIO_TARGET_AVX2 static inline __m256 ConvertEightSamplesI16ToF32AVX2(const i16* samples)
+	{
+		return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples))));
+	}
+
+	PEEPO_AUDIO_TARGET_AVX2 static void MixSamplesI16IntoBusF32AVX2(f32* inOutBus, const i16* inSamples, size_t sampleCount, f32 volume)
+	{
+		size_t i = 0;
+		const __m256 volumeVector = _mm256_set1_ps(volume);
+		for (; (i + 16) <= sampleCount; i += 16)
+		{
+			_mm256_storeu_ps(inOutBus + i + 0, _mm256_add_ps(_mm256_loadu_ps(inOutBus + i + 0), _mm256_mul_ps(ConvertEightSamplesI16ToF32AVX2(inSamples + i + 0), volumeVector)));
+			_mm256_storeu_ps(inOutBus + i + 8, _mm256_add_ps(_mm256_loadu_ps(inOutBus + i + 8), _mm256_mul_ps(ConvertEightSamplesI16ToF32AVX2(inSamples + i + 8), volumeVector)));
+		}
+		if (i < sampleCount)
+			MixSamplesI16IntoBusF32ScalarOrSSE2(inOutBus + i, inSamples + i, (sampleCount - i), volume);
+	}
+
+	PEEPO_AUDIO_TARGET_AVX2 static void MixStereoSamplesI16IntoBusF32AVX2(f32* inOutBus, const i16* inSamples, const f32* inFrameVolumes, size_t frameCount)
+	{
+		size_t f = 0;
+		const __m256i lowFrameIndices = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+		const __m256i highFrameIndices = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+		for (; (f + 8) <= frameCount; f += 8)
+		{
+			// NOTE: 8 frames = 16 interleaved samples, with each frame volume then duplicated for both of its channels
+			const __m256 frameVolumes = _mm256_loadu_ps(inFrameVolumes + f);
+			const __m256 volumesLow = _mm256_permutevar8x32_ps(frameVolumes, lowFrameIndices);
+			const __m256 volumesHigh = _mm256_permutevar8x32_ps(frameVolumes, highFrameIndices);
+
+			f32* bus = inOutBus + (f * 2);
+			_mm256_storeu_ps(bus + 0, _mm256_add_ps(_mm256_loadu_ps(bus + 0), _mm256_mul_ps(ConvertEightSamplesI16ToF32AVX2(inSamples + (f * 2) + 0), volumesLow)));
+			_mm256_storeu_ps(bus + 8, _mm256_add_ps(_mm256_loadu_ps(bus + 8), _mm256_mul_ps(ConvertEightSamplesI16ToF32AVX2(inSamples + (f * 2) + 8), volumesHigh)));
+		}
+		if (f < frameCount)
+			MixStereoSamplesI16IntoBusF32ScalarOrSSE2(inOutBus + (f * 2), inSamples + (f * 2), inFrameVolumes + f, (frameCount - f));
+	}
+
+	PEEPO_AUDIO_TARGET_AVX2 static void ConvertBusF32ToSamplesI16ClampedAVX2(const f32* inBus, i16* outSamples, size_t sampleCount, f32 volume)
+	{
+		size_t i = 0;
+		const __m256 volumeVector = _mm256_set1_ps(volume);
+		const __m256 minVector = _mm256_set1_ps(BusMinSample), maxVector = _mm256_set1_ps(BusMaxSample);
+		for (; (i + 16) <= sampleCount; i += 16)
+		{
+			const __m256 low = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(inBus + i + 0), volumeVector), minVector), maxVector);
+			const __m256 high = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(inBus + i + 8), volumeVector), minVector), maxVector);
+
+			// NOTE: Packing works within each 128-bit lane, resulting in a [low0 high0 low1 high1] qword order that then has to be put back in sequence
+			const __m256i packed = _mm256_packs_epi32(_mm256_cvttps_epi32(low), _mm256_cvttps_epi32(high));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(outSamples + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+		if (i < sampleCount)
+			ConvertBusF32ToSamplesI16ClampedScalarOrSSE2(inBus + i, outSamples + i, (sampleCount - i), volume);
+	}
+#endif
+
+	using MixSamplesI16IntoBusF32Func = void(*)(f32* inOutBus, const i16* inSamples, size_t sampleCount, f32 volume);
+	using MixStereoSamplesI16IntoBusF32Func = void(*)(f32* inOutBus, const i16* inSamples, const f32* inFrameVolumes, size_t frameCount);
+	using ConvertBusF32ToSamplesI16ClampedFunc = void(*)(const f32* inBus, i16* outSamples, size_t sampleCount, f32 volume);
+
+	void MixSamplesI16IntoBusF32(f32* inOutBus, const i16* inSamples, size_t sampleCount, f32 volume)
+	{
+#if PEEPO_AUDIO_AVX2
+		static const MixSamplesI16IntoBusF32Func func = CPUSupportsAVX2() ? MixSamplesI16IntoBusF32AVX2 : MixSamplesI16IntoBusF32ScalarOrSSE2;
+		func(inOutBus, inSamples, sampleCount, volume);
+#else
+		MixSamplesI16IntoBusF32ScalarOrSSE2(inOutBus, inSamples, sampleCount, volume);
+#endif
+	}
+
+	void MixStereoSamplesI16IntoBusF32(f32* inOutBus, const i16* inSamples, const f32* inFrameVolumes, size_t frameCount)
+	{
+#if PEEPO_AUDIO_AVX2
+		static const MixStereoSamplesI16IntoBusF32Func func = CPUSupportsAVX2() ? MixStereoSamplesI16IntoBusF32AVX2 : MixStereoSamplesI16IntoBusF32ScalarOrSSE2;
+		func(inOutBus, inSamples, inFrameVolumes, frameCount);
+#else
+		MixStereoSamplesI16IntoBusF32ScalarOrSSE2(inOutBus, inSamples, inFrameVolumes, frameCount);
+#endif
+	}
+
+	void ConvertBusF32ToSamplesI16Clamped(const f32* inBus, i16* outSamples, size_t sampleCount, f32 volume)
+	{
+#if PEEPO_AUDIO_AVX2
+		static const ConvertBusF32ToSamplesI16ClampedFunc func = CPUSupportsAVX2() ? ConvertBusF32ToSamplesI16ClampedAVX2 : ConvertBusF32ToSamplesI16ClampedScalarOrSSE2;
+		func(inBus, outSamples, sampleCount, volume);
+#else
+		ConvertBusF32ToSamplesI16ClampedScalarOrSSE2(inBus, outSamples, sampleCount, volume);
+#endif
+	}
+
 	i64 PCMSampleBuffer::ReadAtOrFillSilence(i64 inFrameOffset, i64 inFrameCount, i16 outSamples[]) const
 	{
 		// TODO: Handle channel count mismatch (?) 
 		// assert(ChannelCount == 2);
 
+		// NOTE: Frames that haven't been decoded yet are treated as silence
 		const i64 sourceChannelCount = ChannelCount;
-		const i64 sourceFrameCount = FrameCount;
-		const i64 sourceSampleCount = SampleCount();
+		const i64 sourceFrameCount = GetAvailableFrameCount();
+		const i64 sourceSampleCount = (sourceFrameCount * sourceChannelCount);
 
 		std::fill(outSamples, outSamples + (inFrameCount * sourceChannelCount), 0);
 
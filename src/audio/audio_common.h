@@ -2,9 +2,27 @@
 #include "core_types.h"
 #include <memory>
 #include <vector>
+#include <atomic>
+
+// NOTE: AVX2 code paths are compiled for all x64 targets but only ever selected at runtime (if supported by the CPU), everything else only assumes SSE2
+#if defined(_M_X64) || defined(__x86_64__)
+#define PEEPO_AUDIO_AVX2 1
+#if defined(_MSC_VER)
+#define PEEPO_AUDIO_TARGET_AVX2
+#else
+#define PEEPO_AUDIO_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define PEEPO_AUDIO_AVX2 0
+#endif
 
 namespace Audio
 {
+#if PEEPO_AUDIO_AVX2
+	// NOTE: Queried only once with the result then being cached
+	b8 CPUSupportsAVX2();
+#endif
+
 	constexpr f32 ConvertSampleI16ToF32(i16 v) { return static_cast<f32>(v) / static_cast<f32>(I16Max); }
 	constexpr i16 ConvertSampleF32ToI16(f32 v) { return static_cast<i16>(v * static_cast<f32>(I16Max)); }
 
@@ -27,15 +45,25 @@ namespace Audio
 	constexpr i32 ScaleSampleI16Linear_AsI32(i32 v, f32 linear) { return static_cast<i32>(static_cast<f32>(v) * linear); }
 	constexpr i16 ScaleSampleI16Linear_Clamped(i32 v, f32 linear) { return ClampSampleI16(ScaleSampleI16Linear_AsI32(v, linear)); }
 
+	// NOTE: The renderer accumulates all voices into a float mix bus (kept in i16 sample range) and then clamps and converts it back to i16 only once at the very end,
+	//		 instead of clipping and converting between float and int after every single voice. Vectorized using SSE2, or AVX2 if supported by the CPU
+	void MixSamplesI16IntoBusF32(f32* inOutBus, const i16* inSamples, size_t sampleCount, f32 volume);
+	void MixStereoSamplesI16IntoBusF32(f32* inOutBus, const i16* inSamples, const f32* inFrameVolumes, size_t frameCount);
+	void ConvertBusF32ToSamplesI16Clamped(const f32* inBus, i16* outSamples, size_t sampleCount, f32 volume);
+
 	struct PCMSampleBuffer
 	{
 		u32 ChannelCount;
 		u32 SampleRate;
 		i64 FrameCount;
 		std::unique_ptr<i16[]> InterleavedSamples;
+		// NOTE: Only set for buffers being filled in by a StreamingDecoder (on another thread), with all samples past this frame count not having been decoded yet
+		std::shared_ptr<const std::atomic<i64>> StreamingDecodedFrameCount;
 
 		constexpr size_t SampleCount() const { return (FrameCount * ChannelCount); }
 		constexpr size_t ByteSize() const { return (FrameCount * ChannelCount * sizeof(i16)); }
+		inline i64 GetAvailableFrameCount() const { return (StreamingDecodedFrameCount != nullptr) ? Min(StreamingDecodedFrameCount->load(std::memory_order_acquire), FrameCount) : FrameCount; }
+		inline b8 IsFullyAvailable() const { return (GetAvailableFrameCount() >= FrameCount); }
 		i64 ReadAtOrFillSilence(i64 inFrameOffset, i64 inFrameCount, i16 outSamples[]) const;
 	};
 
@@ -151,6 +179,20 @@ namespace Audio
 		return (sampleIndex < sampleCount) ? sampels[sampleIndex] : static_cast<SampleType>(0);
 	}
 
+	template <typename SampleType>
+	constexpr SampleType LinearSampleInbetween(SampleType startValue, SampleType endValue, f64 inbetween)
+	{
+		constexpr f64 maxSampleValueF64 = static_cast<f64>(std::numeric_limits<SampleType>::max());
+		const f64 normalizedStart = static_cast<f64>(startValue / maxSampleValueF64);
+		const f64 normalizedEnd = static_cast<f64>(endValue / maxSampleValueF64);
+
+		const f64 normalizedResult = LerpF64(normalizedStart, normalizedEnd, inbetween);
+		const f64 clampedResult = Clamp(normalizedResult, -1.0, 1.0);
+
+		const SampleType sampleTypeResult = static_cast<SampleType>(clampedResult * maxSampleValueF64);
+		return sampleTypeResult;
+	}
+
 	// TODO: Switch to f32 instead (?)
 	template <typename SampleType>
 	constexpr SampleType LinearSampleAtTimeOrZero(f64 atSecond, u32 atChannel, const SampleType* samples, size_t sampleCount, f64 sampleRate, u32 channelCount)
@@ -163,18 +205,10 @@ namespace Audio
 		const SampleType endValue = SampleAtFrameIndexOrZero<SampleType>(endFrame, atChannel, samples, sampleCount, channelCount);
 		const f64 inbetween = (frameFaction - static_cast<f64>(startFrame));
 
-		static constexpr f64 maxSampleValueF64 = static_cast<f64>(std::numeric_limits<SampleType>::max());
-		const f64 normalizedStart = static_cast<f64>(startValue / maxSampleValueF64);
-		const f64 normalizedEnd = static_cast<f64>(endValue / maxSampleValueF64);
-
-		const f64 normalizedResult = LerpF64(normalizedStart, normalizedEnd, inbetween);
-		const f64 clampedResult = Clamp(normalizedResult, -1.0, 1.0);
-
-		const SampleType sampleTypeResult = static_cast<SampleType>(clampedResult * maxSampleValueF64);
-		return sampleTypeResult;
+		return LinearSampleInbetween<SampleType>(startValue, endValue, inbetween);
 	}
 
-	// NOTE: Low quallity linear resampling lacking a low pass filter, should however still be better than having sped up audio for now
+	// NOTE: Low quallity linear resampling lacking a low pass filter, only still around as a cheap reference point. Use the band limited ResampleBuffer() instead
 	template <typename SampleType>
 	void LinearlyResampleBuffer(std::unique_ptr<SampleType[]>& inOutSamples, size_t& inOutFrameCount, u32& inOutSampleRate, const u32 inChannelCount, const u32 targetSampleRate)
 	{
@@ -1,24 +1,46 @@
 #include "audio_engine.h"
 #include "audio_file_formats.h"
 #include "audio_backend.h"
+#include "audio_time_stretch.h"
+#include "audio_telemetry.h"
 #include "core_io.h"
 #include <mutex>
+#include <thread>
 
 namespace Audio
 {
-	constexpr HandleBaseType VoiceHandleToIndex(VoiceHandle handle) { return static_cast<HandleBaseType>(handle); }
-	constexpr VoiceHandle IndexToVoiceHandle(HandleBaseType index) { return static_cast<VoiceHandle>(index); }
+	using SlotGeneration = u16;
+	constexpr u32 HandleIndexBitCount = 16;
+	constexpr HandleBaseType HandleIndexMask = ((1u << HandleIndexBitCount) - 1);
+	static_assert(AudioEngine::MaxPoolSlotCount == HandleIndexMask, "The index of the invalid handle must always be out of bounds");
 
-	constexpr HandleBaseType SourceHandleToIndex(SourceHandle handle) { return static_cast<HandleBaseType>(handle); }
-	constexpr SourceHandle IndexToSourceHandle(HandleBaseType index) { return static_cast<SourceHandle>(index); }
+	constexpr HandleBaseType PackHandle(HandleBaseType index, SlotGeneration generation) { return (static_cast<HandleBaseType>(generation) << HandleIndexBitCount) | (index & HandleIndexMask); }
+	constexpr HandleBaseType HandleToIndex(HandleBaseType handle) { return (handle & HandleIndexMask); }
+	constexpr SlotGeneration HandleToGeneration(HandleBaseType handle) { return static_cast<SlotGeneration>(handle >> HandleIndexBitCount); }
+
+	constexpr HandleBaseType VoiceHandleToIndex(VoiceHandle handle) { return HandleToIndex(static_cast<HandleBaseType>(handle)); }
+	constexpr SlotGeneration VoiceHandleToGeneration(VoiceHandle handle) { return HandleToGeneration(static_cast<HandleBaseType>(handle)); }
+	constexpr VoiceHandle ToVoiceHandle(HandleBaseType index, SlotGeneration generation) { return static_cast<VoiceHandle>(PackHandle(index, generation)); }
+
+	constexpr HandleBaseType SourceHandleToIndex(SourceHandle handle) { return HandleToIndex(static_cast<HandleBaseType>(handle)); }
+	constexpr SlotGeneration SourceHandleToGeneration(SourceHandle handle) { return HandleToGeneration(static_cast<HandleBaseType>(handle)); }
+	constexpr SourceHandle ToSourceHandle(HandleBaseType index, SlotGeneration generation) { return static_cast<SourceHandle>(PackHandle(index, generation)); }
 
 	static std::unique_ptr<IAudioBackend> CreateBackendInterface(Backend backend)
 	{
 		switch (backend)
 		{
+#if PEEPO_WIN32
 		case Backend::WASAPI_Shared:
 		case Backend::WASAPI_Exclusive:
 			return std::make_unique<WASAPIBackend>();
+#else
+		case Backend::WASAPI_Shared:
+		case Backend::WASAPI_Exclusive:
+			return nullptr;
+#endif
+		case Backend::Offline:
+			return std::make_unique<OfflineRenderBackend>();
 		}
 
 		assert(false);
@@ -36,13 +58,21 @@ namespace Audio
 		VoiceFlags_RemoveOnEnd = 1 << 4,
 		VoiceFlags_PauseOnEnd = 1 << 5,
 		VoiceFlags_VariablePlaybackSpeed = 1 << 6,
+		// NOTE: RemoveVoice() has been called, the render thread then kills the voice once it gets to the command
+		VoiceFlags_PendingRemove = 1 << 7,
+		// NOTE: Time stretch instead of resample at variable playback speeds (for stereo sources, as long as there is a free TimeStretchSlot)
+		VoiceFlags_PreservePitch = 1 << 8,
 	};
 
-	// NOTE: Indexed into by VoiceHandle, slot valid if Flags != VoiceFlags_Dead
+	// NOTE: Indexed into by VoiceHandle, slot valid if Flags != VoiceFlags_Dead and the generation of the handle matches
 	struct VoiceData
 	{
-		// NOTE: Automatically resets to SourceHandle::Invalid when the source is unloaded
+		std::atomic<SlotGeneration> Generation;
+		// NOTE: Position within the dense ActiveVoiceIndices list, only ever accessed by whoever is currently executing commands
+		u32 ActiveVoiceListIndex;
+
 		std::atomic<VoiceFlags> Flags;
+		// NOTE: Automatically resets to SourceHandle::Invalid when the source is unloaded
 		std::atomic<SourceHandle> Source;
 		std::atomic<f32> Volume;
 		std::atomic<i64> FramePosition;
@@ -67,45 +97,189 @@ namespace Audio
 			std::atomic<f32> StartVolume, EndVolume;
 		} VolumeMap;
 
+		// NOTE: Render thread time spent on this voice since it was added, only written to by the render thread
+		struct AtomicVoiceRenderCost
+		{
+			std::atomic<i64> CallbackCount;
+			std::atomic<i64> TotalNS, MaxNS, LastNS;
+		} RenderCost;
+
 		char Name[64];
 	};
 
-	// NOTE: Indexed into by SourceHandle, slot valid if SlotUsed
+	// NOTE: Free -> Reserved (loading thread) -> Used -> PendingUnload (unloading thread) -> Retired (render thread) -> Free (FreeRetiredSourceBuffers() thread)
+	enum class SourceSlotState : u8
+	{
+		Free,
+		Reserved,
+		Used,
+		PendingUnload,
+		Retired,
+	};
+
+	// NOTE: Indexed into by SourceHandle, slot valid if State == SourceSlotState::Used and the generation of the handle matches
 	struct SourceData
 	{
-		std::atomic<bool> SlotUsed;
+		std::atomic<SourceSlotState> State = SourceSlotState::Free;
+		std::atomic<SlotGeneration> Generation = 0;
 		PCMSampleBuffer Buffer;
 		std::atomic<f32> BaseVolume = 0.0f;
 		char Name[256];
 	};
 
+	// NOTE: Fixed capacity wait-free single-producer single-consumer ring buffer for passing data to and from the render thread without ever locking on it.
+	//		 Popped items are moved out of their slot, which is important for owning types so that pushing into a previously used slot never has to free anything
+	template <typename T>
+	struct SPSCRingBuffer
+	{
+		std::unique_ptr<T[]> Items;
+		size_t Capacity = 0;
+		alignas(64) std::atomic<size_t> WriteIndex = 0;
+		alignas(64) std::atomic<size_t> ReadIndex = 0;
+
+		// NOTE: Must be called once before first use, with the capacity then being rounded up to the next power of two
+		void Initialize(size_t minCapacity)
+		{
+			Capacity = RoundUpToPowerOfTwo(static_cast<u32>(ClampBot<size_t>(minCapacity, 1)));
+			Items = std::make_unique<T[]>(Capacity);
+		}
+
+		b8 TryPush(T&& item)
+		{
+			const size_t writeIndex = WriteIndex.load(std::memory_order_relaxed);
+			if ((writeIndex - ReadIndex.load(std::memory_order_acquire)) >= Capacity)
+				return false;
+
+			Items[writeIndex & (Capacity - 1)] = std::move(item);
+			WriteIndex.store(writeIndex + 1, std::memory_order_release);
+			return true;
+		}
+
+		b8 TryPop(T& outItem)
+		{
+			const size_t readIndex = ReadIndex.load(std::memory_order_relaxed);
+			if (readIndex == WriteIndex.load(std::memory_order_acquire))
+				return false;
+
+			outItem = std::move(Items[readIndex & (Capacity - 1)]);
+			ReadIndex.store(readIndex + 1, std::memory_order_release);
+			return true;
+		}
+	};
+
+	// NOTE: Mutations that could otherwise conflict with a voice or source currently being rendered, executed by the render thread at the start of each buffer
+	enum class EngineCommandType : u8
+	{
+		AddVoice,
+		RemoveVoice,
+		UnloadSource,
+		ScheduleVoiceStart,
+		CancelScheduledVoiceStarts,
+	};
+
+	struct EngineCommand
+	{
+		EngineCommandType Type;
+		HandleBaseType Index;
+		// NOTE: Only used by ScheduleVoiceStart
+		i64 StreamFrame;
+		i64 VoiceFramePosition;
+	};
+
+	struct ScheduledVoiceStart
+	{
+		i64 StreamFrame;
+		i64 VoiceFramePosition;
+		HandleBaseType VoiceIndex;
+	};
+
+	struct RetiredSourceBuffer
+	{
+		HandleBaseType Index;
+		PCMSampleBuffer Buffer;
+	};
+
+	// NOTE: Only ever accessed by whoever is currently rendering, assigned to pitch preserving voices on demand and released again once they are killed
+	struct TimeStretchSlot
+	{
+		HandleBaseType VoiceIndex = static_cast<HandleBaseType>(VoiceHandle::Invalid);
+		TimeStretcher Stretcher;
+	};
+
 	struct AudioEngine::Impl
 	{
+	public:
+		explicit Impl(const EngineStartupParam& param)
+			: VoicePool(Clamp<size_t>(param.MaxSimultaneousVoices, 1, MaxPoolSlotCount)), LoadedSources(Clamp<size_t>(param.MaxLoadedSources, 1, MaxPoolSlotCount))
+		{
+			// NOTE: In reverse so that the lowest indices are handed out first
+			FreeVoiceIndices.reserve(VoicePool.size());
+			for (size_t i = VoicePool.size(); i-- > 0;)
+				FreeVoiceIndices.push_back(static_cast<HandleBaseType>(i));
+
+			FreeSourceIndices.reserve(LoadedSources.size());
+			for (size_t i = LoadedSources.size(); i-- > 0;)
+				FreeSourceIndices.push_back(static_cast<HandleBaseType>(i));
+
+			ActiveVoiceIndices.reserve(VoicePool.size());
+			CommandRing.Initialize(CommandRingCapacity);
+			RetiredVoiceIndexRing.Initialize(VoicePool.size());
+			RetiredSourceBufferRing.Initialize(LoadedSources.size());
+		}
+
 	public:
 		b8 IsStreamOpenRunning = false;
 		std::atomic<f32> MasterVolume = AudioEngine::MaxVolume;
 
 	public:
-		ChannelMixer ChannelMixer = {};
+		ChannelMixer Mixer = {};
 
 		Backend CurrentBackendType = {};
 		std::unique_ptr<IAudioBackend> CurrentBackend = nullptr;
 
 	public:
-		std::mutex VoiceRenderMutex;
-
-		// NOTE: Slot maps indexed into via handles
-		std::array<VoiceData, MaxSimultaneousVoices> VoicePool;
-		std::array<SourceData, MaxLoadedSources> LoadedSources;
+		// NOTE: Slot maps indexed into via handles, sized once on startup
+		std::vector<VoiceData> VoicePool;
+		std::vector<SourceData> LoadedSources;
+
+		// NOTE: Only ever locked by non-render threads to serialize pushing commands (and popping retired slots) between themselves, the render callback never locks.
+		//		 While no stream is running there is no render thread to drain the command ring, so commands are then executed immediately by the pushing thread instead
+		std::mutex CommandProducerMutex;
+		b8 IsRenderThreadExecutingCommands = false;
+		static constexpr size_t CommandRingCapacity = 512;
+		SPSCRingBuffer<EngineCommand> CommandRing;
+		// NOTE: Killed voices and unloaded sample buffers are handed back instead of being freed on the render thread.
+		//		 Every slot can only be retired once at a time (until it is reused) so neither of these can ever overflow
+		SPSCRingBuffer<HandleBaseType> RetiredVoiceIndexRing;
+		SPSCRingBuffer<RetiredSourceBuffer> RetiredSourceBufferRing;
+
+		// NOTE: Stacks of unused slots for constant time allocation, only ever accessed while holding the CommandProducerMutex and reserved upfront so they never reallocate
+		std::vector<HandleBaseType> FreeVoiceIndices;
+		std::vector<HandleBaseType> FreeSourceIndices;
+
+		// NOTE: Dense list of all alive voices for the render callback to iterate instead of the entire pool, only ever accessed by whoever is currently executing commands
+		std::vector<HandleBaseType> ActiveVoiceIndices;
+
+		// NOTE: Sorted by stream frame (in the order they were scheduled for equal frames) and only ever accessed by whoever is currently executing commands
+		std::array<ScheduledVoiceStart, MaxScheduledVoiceStarts> ScheduledVoiceStarts = {};
+		size_t ScheduledVoiceStartCount = 0;
+		std::atomic<i64> LateScheduledVoiceStartCount = {};
+		std::atomic<i64> DroppedScheduledVoiceStartCount = {};
+
+		std::array<TimeStretchSlot, MaxTimeStretchedVoices> TimeStretchSlots = {};
 
 	public:
 		std::array<i16, (MaxBufferFrameCount * OutputChannelCount)> TempOutputBuffer = {};
+		std::array<f32, (MaxBufferFrameCount * OutputChannelCount)> MixBus = {};
+		std::array<f32, MaxBufferFrameCount> TempFrameVolumes = {};
 		u32 CurrentBufferFrameSize = DefaultBufferFrameCount;
 
-		// TODO: Rename "CallbackDuration" to "RenderDuration" (?)
 		// NOTE: For measuring performance
-		size_t CallbackDurationRingIndex = 0;
-		std::array<Time, AudioEngine::CallbackDurationRingBufferSize> CallbackDurationsRingBuffer = {};
+		RenderTelemetry Telemetry = {};
+		std::atomic<b8> TrackVoiceRenderCosts = true;
+		// NOTE: Backends only count underruns since their stream was last opened, so these are accumulated across streams
+		//		 (and offset by however many the running stream had already counted whenever the telemetry is reset)
+		i64 ClosedStreamUnderrunCount = 0;
 
 		// NOTE: For visualizing the current audio output
 		size_t LastPlayedSamplesRingIndex = 0;
@@ -115,7 +289,10 @@ namespace Audio
 		Time CallbackFrequency = {};
 		Time CallbackStreamTime = {}, LastCallbackStreamTime = {};
 
+		// NOTE: The output stream clock. Odd while the render thread is in the middle of updating voice positions, so that a voice position can be read together
+		//		 with the stream frame it corresponds to without the two ever being torn between buffers (see Voice::GetPositionAtStreamFrame())
 		std::atomic<i64> TotalRenderedFrames = {};
+		std::atomic<u32> VoiceUpdateSequence = {};
 
 	public:
 		VoiceData* TryGetVoiceData(VoiceHandle handle)
@@ -125,7 +302,11 @@ namespace Audio
 				return nullptr;
 
 			VoiceData* voiceData = &VoicePool[handleIndex];
-			return (voiceData->Flags & VoiceFlags_Alive) ? voiceData : nullptr;
+			if (voiceData->Generation != VoiceHandleToGeneration(handle))
+				return nullptr;
+
+			const VoiceFlags flags = voiceData->Flags;
+			return ((flags & VoiceFlags_Alive) && !(flags & VoiceFlags_PendingRemove)) ? voiceData : nullptr;
 		}
 
 		enum class GetSourceDataParam : u8 { None, ValidateBuffer };
@@ -136,7 +317,7 @@ namespace Audio
 				return nullptr;
 
 			SourceData* sourceData = &LoadedSources[handleIndex];
-			if (!sourceData->SlotUsed)
+			if (sourceData->State != SourceSlotState::Used || sourceData->Generation != SourceHandleToGeneration(handle))
 				return nullptr;
 
 			if (param == GetSourceDataParam::ValidateBuffer)
@@ -171,9 +352,261 @@ namespace Audio
 				CopyStringViewIntoFixedBuffer(sourceData->Name, newName);
 		}
 
-		void CallbackClearOutPreviousCallBuffer(i16* outputBuffer, const size_t sampleCount)
+		void ExecuteCommand(const EngineCommand& command)
+		{
+			switch (command.Type)
+			{
+			case EngineCommandType::AddVoice:
+			{
+				VoicePool[command.Index].ActiveVoiceListIndex = static_cast<u32>(ActiveVoiceIndices.size());
+				ActiveVoiceIndices.push_back(command.Index);
+				break;
+			}
+			case EngineCommandType::RemoveVoice:
+			{
+				// NOTE: Voices with a pending remove command never remove themselves on end, so the slot can't have been reused in the meantime
+				VoiceData& voiceData = VoicePool[command.Index];
+				if (voiceData.Flags & VoiceFlags_PendingRemove)
+					KillVoice(command.Index);
+				break;
+			}
+			case EngineCommandType::UnloadSource:
+			{
+				for (const HandleBaseType voiceIndex : ActiveVoiceIndices)
+				{
+					VoiceData& voice = VoicePool[voiceIndex];
+					if (SourceHandleToIndex(voice.Source) == command.Index)
+						voice.Source = SourceHandle::Invalid;
+				}
+
+				SourceData& sourceData = LoadedSources[command.Index];
+				assert(sourceData.State == SourceSlotState::PendingUnload);
+				const b8 pushSuccess = RetiredSourceBufferRing.TryPush(RetiredSourceBuffer { command.Index, std::move(sourceData.Buffer) });
+				assert(pushSuccess); (void)pushSuccess;
+				sourceData.State = SourceSlotState::Retired;
+				break;
+			}
+			case EngineCommandType::ScheduleVoiceStart:
+			{
+				if (ScheduledVoiceStartCount >= ScheduledVoiceStarts.size())
+				{
+					DroppedScheduledVoiceStartCount++;
+					break;
+				}
+
+				auto* const begin = ScheduledVoiceStarts.data();
+				auto* const end = begin + ScheduledVoiceStartCount;
+				auto* const insertAt = std::upper_bound(begin, end, command.StreamFrame, [](i64 streamFrame, const ScheduledVoiceStart& it) { return streamFrame < it.StreamFrame; });
+				std::move_backward(insertAt, end, end + 1);
+				*insertAt = ScheduledVoiceStart { command.StreamFrame, command.VoiceFramePosition, command.Index };
+				ScheduledVoiceStartCount++;
+				break;
+			}
+			case EngineCommandType::CancelScheduledVoiceStarts:
+			{
+				RemoveScheduledVoiceStarts(command.Index);
+				break;
+			}
+			}
+		}
+
+		// NOTE: Must only be called by whoever is currently executing commands, with the slot then being handed back to be reused by the next AddVoice()
+		void KillVoice(HandleBaseType voiceIndex)
+		{
+			VoiceData& voiceData = VoicePool[voiceIndex];
+			voiceData.Generation++;
+			voiceData.Flags = VoiceFlags_Dead;
+
+			if (ScheduledVoiceStartCount > 0)
+				RemoveScheduledVoiceStarts(voiceIndex);
+			ReleaseTimeStretchSlot(voiceIndex);
+
+			const u32 listIndex = voiceData.ActiveVoiceListIndex;
+			assert(InBounds(listIndex, ActiveVoiceIndices) && ActiveVoiceIndices[listIndex] == voiceIndex);
+			ActiveVoiceIndices[listIndex] = ActiveVoiceIndices.back();
+			VoicePool[ActiveVoiceIndices[listIndex]].ActiveVoiceListIndex = listIndex;
+			ActiveVoiceIndices.pop_back();
+
+			const b8 pushSuccess = RetiredVoiceIndexRing.TryPush(HandleBaseType { voiceIndex });
+			assert(pushSuccess); (void)pushSuccess;
+		}
+
+		// NOTE: Must only be called while holding the CommandProducerMutex. The slot is then only visible to the render thread once its AddVoice command has been executed
+		VoiceData* TryAllocateVoiceSlot(HandleBaseType& outIndex)
 		{
-			std::fill(outputBuffer, outputBuffer + sampleCount, 0);
+			HandleBaseType retiredIndex;
+			while (RetiredVoiceIndexRing.TryPop(retiredIndex))
+				FreeVoiceIndices.push_back(retiredIndex);
+
+			if (FreeVoiceIndices.empty())
+				return nullptr;
+
+			outIndex = FreeVoiceIndices.back();
+			FreeVoiceIndices.pop_back();
+			return &VoicePool[outIndex];
+		}
+
+		// NOTE: The voice is made visible to other threads all at once by setting its final flags after all of its data has been initialized.
+		//		 Its AddVoice command is pushed while still holding the lock, so that any command for the new voice is guaranteed to only be executed after it
+		VoiceHandle AllocateAndInitializeVoice(SourceHandle source, std::string_view name, f32 volume, VoiceFlags flags)
+		{
+			const auto lock = std::scoped_lock(CommandProducerMutex);
+
+			HandleBaseType voiceIndex = 0;
+			VoiceData* voiceToUpdate = TryAllocateVoiceSlot(voiceIndex);
+			if (voiceToUpdate == nullptr)
+			{
+#if PEEPO_DEBUG
+				assert(!"Consider increasing EngineStartupParam::MaxSimultaneousVoices");
+#endif
+				return VoiceHandle::Invalid;
+			}
+
+			voiceToUpdate->Source = source;
+			voiceToUpdate->Volume = volume;
+			voiceToUpdate->FramePosition = 0;
+			voiceToUpdate->VolumeMap.StartVolume = 0.0f;
+			voiceToUpdate->VolumeMap.EndVolume = 0.0f;
+			voiceToUpdate->RenderCost.CallbackCount = 0;
+			voiceToUpdate->RenderCost.TotalNS = 0;
+			voiceToUpdate->RenderCost.MaxNS = 0;
+			voiceToUpdate->RenderCost.LastNS = 0;
+			CopyStringViewIntoFixedBuffer(voiceToUpdate->Name, name);
+			voiceToUpdate->Flags = flags;
+
+			PushCommandWhileLocked(EngineCommand { EngineCommandType::AddVoice, voiceIndex });
+			return ToVoiceHandle(voiceIndex, voiceToUpdate->Generation);
+		}
+
+		void ReleaseTimeStretchSlot(HandleBaseType voiceIndex)
+		{
+			for (TimeStretchSlot& slot : TimeStretchSlots)
+			{
+				if (slot.VoiceIndex == voiceIndex)
+					slot.VoiceIndex = static_cast<HandleBaseType>(VoiceHandle::Invalid);
+			}
+		}
+
+		// NOTE: Slots of voices that no longer want to be time stretched are only taken back once another voice needs one
+		TimeStretcher* CallbackTryGetVoiceTimeStretcher(HandleBaseType voiceIndex, const VoiceData& voiceData, const SourceData* sourceData)
+		{
+			if (!(voiceData.Flags & VoiceFlags_PreservePitch) || sourceData == nullptr || sourceData->Buffer.ChannelCount != TimeStretcher::ChannelCount)
+				return nullptr;
+
+			TimeStretchSlot* freeSlot = nullptr;
+			for (TimeStretchSlot& slot : TimeStretchSlots)
+			{
+				if (slot.VoiceIndex == voiceIndex)
+					return &slot.Stretcher;
+
+				const b8 isSlotFree = !InBounds(slot.VoiceIndex, VoicePool) ||
+					((VoicePool[slot.VoiceIndex].Flags & (VoiceFlags_Alive | VoiceFlags_VariablePlaybackSpeed | VoiceFlags_PreservePitch)) != (VoiceFlags_Alive | VoiceFlags_VariablePlaybackSpeed | VoiceFlags_PreservePitch));
+				if (isSlotFree && freeSlot == nullptr)
+					freeSlot = &slot;
+			}
+
+			if (freeSlot == nullptr)
+				return nullptr;
+
+			freeSlot->VoiceIndex = voiceIndex;
+			freeSlot->Stretcher.Reset(voiceData.TimePositionSec * static_cast<f64>(sourceData->Buffer.SampleRate));
+			return &freeSlot->Stretcher;
+		}
+
+		void RemoveScheduledVoiceStarts(HandleBaseType voiceIndex)
+		{
+			auto* const begin = ScheduledVoiceStarts.data();
+			auto* const newEnd = std::remove_if(begin, begin + ScheduledVoiceStartCount, [voiceIndex](const ScheduledVoiceStart& it) { return it.VoiceIndex == voiceIndex; });
+			ScheduledVoiceStartCount = static_cast<size_t>(newEnd - begin);
+		}
+
+		void PushCommand(EngineCommand command)
+		{
+			const auto lock = std::scoped_lock(CommandProducerMutex);
+			PushCommandWhileLocked(command);
+		}
+
+		// NOTE: Must only be called while holding the CommandProducerMutex
+		void PushCommandWhileLocked(EngineCommand command)
+		{
+			if (!IsRenderThreadExecutingCommands)
+			{
+				ExecuteCommand(command);
+				return;
+			}
+
+			// NOTE: Only ever waits (on the producer side) in case of the render thread having fallen behind by an entire ring worth of commands
+			while (!CommandRing.TryPush(std::move(command)))
+				std::this_thread::yield();
+		}
+
+		// NOTE: Must only be called while holding the CommandProducerMutex
+		void ExecuteAllPendingCommandsOnNonRenderThread()
+		{
+			EngineCommand command;
+			while (CommandRing.TryPop(command))
+				ExecuteCommand(command);
+		}
+
+		void FreeRetiredSourceBuffers()
+		{
+			const auto lock = std::scoped_lock(CommandProducerMutex);
+			RetiredSourceBuffer retired {};
+			while (RetiredSourceBufferRing.TryPop(retired))
+			{
+				retired.Buffer = {};
+				LoadedSources[retired.Index].Generation++;
+				LoadedSources[retired.Index].State = SourceSlotState::Free;
+				FreeSourceIndices.push_back(retired.Index);
+			}
+		}
+
+		void CallbackExecutePendingCommands()
+		{
+			EngineCommand command;
+			while (CommandRing.TryPop(command))
+				ExecuteCommand(command);
+		}
+
+		void CallbackStartScheduledVoices(const u32 bufferFrameCount)
+		{
+			const i64 bufferStartFrame = TotalRenderedFrames.load(std::memory_order_relaxed);
+			const i64 bufferEndFrame = (bufferStartFrame + bufferFrameCount);
+
+			size_t startedCount = 0;
+			for (; startedCount < ScheduledVoiceStartCount && ScheduledVoiceStarts[startedCount].StreamFrame < bufferEndFrame; startedCount++)
+			{
+				const ScheduledVoiceStart& scheduled = ScheduledVoiceStarts[startedCount];
+				VoiceData& voiceData = VoicePool[scheduled.VoiceIndex];
+				if (!(voiceData.Flags & VoiceFlags_Alive) || (voiceData.Flags & VoiceFlags_PendingRemove))
+					continue;
+
+				// NOTE: Rendering from a negative position fills everything up until the start with silence, so the voice becomes audible at exactly the scheduled frame.
+				//		 Starts that have already been missed are instead skipped ahead by however late they are, to stay in sync with whatever they were scheduled against
+				const i64 bufferFrameOffset = (scheduled.StreamFrame - bufferStartFrame);
+				if (bufferFrameOffset < 0)
+					LateScheduledVoiceStartCount++;
+
+				const SourceData* sourceData = TryGetSourceData(voiceData.Source, GetSourceDataParam::ValidateBuffer);
+				const u32 sampleRate = (sourceData != nullptr) ? sourceData->Buffer.SampleRate : OutputSampleRate;
+				const f64 playbackSpeed = (voiceData.Flags & VoiceFlags_VariablePlaybackSpeed) ? static_cast<f64>(voiceData.PlaybackSpeed) : 1.0;
+
+				voiceData.FramePosition = (scheduled.VoiceFramePosition - bufferFrameOffset);
+				voiceData.TimePositionSec = FramesToTime(scheduled.VoiceFramePosition, sampleRate).ToSec() - (FramesToTime(bufferFrameOffset, OutputSampleRate).ToSec() * playbackSpeed);
+				voiceData.SmoothTime.RequestUpdate = true;
+				voiceData.Flags |= VoiceFlags_Playing;
+			}
+
+			if (startedCount > 0)
+			{
+				std::move(ScheduledVoiceStarts.begin() + startedCount, ScheduledVoiceStarts.begin() + ScheduledVoiceStartCount, ScheduledVoiceStarts.begin());
+				ScheduledVoiceStartCount -= startedCount;
+			}
+		}
+
+		void CallbackClearOutPreviousCallBuffer(f32* mixBus, const size_t sampleCount)
+		{
+			std::fill(mixBus, mixBus + sampleCount, 0.0f);
 		}
 
 		f32 SampleVolumeMapAt(const i64 startFrame, const i64 endFrame, const f32 startVolume, const f32 endVolume, const i64 frame)
@@ -190,22 +623,24 @@ namespace Audio
 			return lerpVolume;
 		}
 
-		void CallbackApplyVoiceVolumeAndMixTempBufferIntoOutput(i16* outputBuffer, const i64 frameCount, const VoiceData& voiceData, const u32 sampleRate)
+		void CallbackApplyVoiceVolumeAndMixTempBufferIntoBus(f32* mixBus, const i64 frameCount, const VoiceData& voiceData, const u32 sampleRate)
 		{
+			static_assert(OutputChannelCount == 2, "The per-frame volume mixing kernel assumes interleaved stereo");
+
 			const f32 voiceVolume = voiceData.Volume * GetSourceBaseVolume(voiceData.Source);
 			const f32 startVolume = voiceData.VolumeMap.StartVolume;
 			const f32 endVolume = voiceData.VolumeMap.EndVolume;
 
 			if (startVolume == endVolume)
 			{
-				for (i64 i = 0; i < (frameCount * OutputChannelCount); i++)
-					outputBuffer[i] = MixSamplesI16_Clamped(outputBuffer[i], ScaleSampleI16Linear_AsI32(TempOutputBuffer[i], voiceVolume));
+				MixSamplesI16IntoBusF32(mixBus, TempOutputBuffer.data(), static_cast<size_t>(frameCount * OutputChannelCount), voiceVolume);
 			}
 			else
 			{
 				const i64 volumeMapStartFrame = voiceData.VolumeMap.StartFrame;
 				const i64 volumeMapEndFrame = voiceData.VolumeMap.EndFrame;
 
+				// NOTE: Only the (cheap) volume ramp itself is evaluated per frame, the samples are then all scaled and mixed together in one go
 				if (voiceData.Flags & VoiceFlags_VariablePlaybackSpeed)
 				{
 					const Time frameDuration = FramesToTime(1, sampleRate) * voiceData.PlaybackSpeed;
@@ -215,41 +650,46 @@ namespace Audio
 					for (i64 f = 0; f < frameCount; f++)
 					{
 						const Time frameTime = Time::FromSec(voiceStartTime.ToSec() + (f * frameDuration.ToSec()));
-						const f32 frameVolume = SampleVolumeMapAt(volumeMapStartFrame, volumeMapEndFrame, startVolume, endVolume, TimeToFrames(frameTime, sampleRate)) * voiceVolume;
-
-						for (u32 c = 0; c < OutputChannelCount; c++)
-						{
-							const i64 sampleIndex = (f * OutputChannelCount) + c;
-							outputBuffer[sampleIndex] = MixSamplesI16_Clamped(outputBuffer[sampleIndex], ScaleSampleI16Linear_AsI32(TempOutputBuffer[sampleIndex], frameVolume));
-						}
+						TempFrameVolumes[f] = SampleVolumeMapAt(volumeMapStartFrame, volumeMapEndFrame, startVolume, endVolume, TimeToFrames(frameTime, sampleRate)) * voiceVolume;
 					}
 				}
 				else
 				{
 					const i64 voiceStartFrame = (voiceData.FramePosition - frameCount);
-
 					for (i64 f = 0; f < frameCount; f++)
-					{
-						const f32 frameVolume = SampleVolumeMapAt(volumeMapStartFrame, volumeMapEndFrame, startVolume, endVolume, voiceStartFrame + f) * voiceVolume;
-						for (u32 c = 0; c < OutputChannelCount; c++)
-						{
-							const i64 sampleIndex = (f * OutputChannelCount) + c;
-							outputBuffer[sampleIndex] = MixSamplesI16_Clamped(outputBuffer[sampleIndex], ScaleSampleI16Linear_AsI32(TempOutputBuffer[sampleIndex], frameVolume));
-						}
-					}
+						TempFrameVolumes[f] = SampleVolumeMapAt(volumeMapStartFrame, volumeMapEndFrame, startVolume, endVolume, voiceStartFrame + f) * voiceVolume;
 				}
+
+				MixStereoSamplesI16IntoBusF32(mixBus, TempOutputBuffer.data(), TempFrameVolumes.data(), static_cast<size_t>(frameCount));
 			}
 		}
 
-		void CallbackProcessVoices(i16* outputBuffer, const u32 bufferFrameCount, const u32 bufferSampleCount)
+		void CallbackAttributeVoiceRenderCost(VoiceData& voiceData, CPUTime& inOutLastTime)
 		{
-			const auto lock = std::scoped_lock(VoiceRenderMutex);
+			// NOTE: A single timestamp in between each voice, so the cost of the loop itself is spread across all of them
+			const CPUTime now = CPUTime::GetNow();
+			const i64 durationNS = static_cast<i64>(CPUTime::DeltaTime(inOutLastTime, now).ToSec() * 1000000000.0);
+			inOutLastTime = now;
+
+			VoiceData::AtomicVoiceRenderCost& cost = voiceData.RenderCost;
+			cost.CallbackCount.store(cost.CallbackCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			cost.TotalNS.store(cost.TotalNS.load(std::memory_order_relaxed) + durationNS, std::memory_order_relaxed);
+			cost.LastNS.store(durationNS, std::memory_order_relaxed);
+			if (durationNS > cost.MaxNS.load(std::memory_order_relaxed))
+				cost.MaxNS.store(durationNS, std::memory_order_relaxed);
+		}
+
+		void CallbackProcessVoices(f32* mixBus, const u32 bufferFrameCount, const u32 bufferSampleCount)
+		{
+			const b8 trackVoiceRenderCosts = TrackVoiceRenderCosts.load(std::memory_order_relaxed);
+			CPUTime lastVoiceTime = trackVoiceRenderCosts ? CPUTime::GetNow() : CPUTime {};
 
-			for (size_t voiceIndex = 0; voiceIndex < VoicePool.size(); voiceIndex++)
+			// NOTE: Iterated in reverse so that killing a voice (moving the last one into its place) never skips over any of the remaining ones
+			for (size_t activeIndex = ActiveVoiceIndices.size(); activeIndex-- > 0;)
 			{
+				const HandleBaseType voiceIndex = ActiveVoiceIndices[activeIndex];
 				VoiceData& voiceData = VoicePool[voiceIndex];
-				if (!(voiceData.Flags & VoiceFlags_Alive))
-					continue;
+				defer { if (trackVoiceRenderCosts) CallbackAttributeVoiceRenderCost(voiceData, lastVoiceTime); };
 
 				// TODO: Handle sample rate mismatch (by always setting variable playback speed?)
 				SourceData* sourceData = TryGetSourceData(voiceData.Source, GetSourceDataParam::ValidateBuffer);
@@ -274,16 +714,24 @@ namespace Audio
 				if (voiceData.Flags & VoiceFlags_Playing)
 				{
 					if (variablePlaybackSpeed)
-						CallbackProcessVariableSpeedVoiceSamples(outputBuffer, bufferFrameCount, playPastEnd, hasReachedEnd, voiceData, sourceData);
+						CallbackProcessVariableSpeedVoiceSamples(mixBus, bufferFrameCount, playPastEnd, hasReachedEnd, voiceData, sourceData, CallbackTryGetVoiceTimeStretcher(voiceIndex, voiceData, sourceData));
 					else
-						CallbackProcessNormalSpeedVoiceSamples(outputBuffer, bufferFrameCount, playPastEnd, hasReachedEnd, voiceData, sourceData);
+						CallbackProcessNormalSpeedVoiceSamples(mixBus, bufferFrameCount, playPastEnd, hasReachedEnd, voiceData, sourceData);
 				}
 
 				if (hasReachedEnd)
 				{
 					if (!playPastEnd && (voiceData.Flags & VoiceFlags_RemoveOnEnd))
 					{
-						voiceData.Flags = VoiceFlags_Dead;
+						// NOTE: Leave voices with a pending remove command alive, so that their slot can't be reused before the command has been executed
+						if (voiceData.Flags & VoiceFlags_PendingRemove)
+						{
+							voiceData.Flags &= ~VoiceFlags_Playing;
+						}
+						else
+						{
+							KillVoice(voiceIndex);
+						}
 						continue;
 					}
 					else if (voiceData.Flags & VoiceFlags_PauseOnEnd)
@@ -297,7 +745,7 @@ namespace Audio
 			TotalRenderedFrames += bufferFrameCount;
 		}
 
-		void CallbackProcessNormalSpeedVoiceSamples(i16* outputBuffer, const u32 bufferFrameCount, const b8 playPastEnd, const b8 hasReachedEnd, VoiceData& voiceData, SourceData* sourceData)
+		void CallbackProcessNormalSpeedVoiceSamples(f32* mixBus, const u32 bufferFrameCount, const b8 playPastEnd, const b8 hasReachedEnd, VoiceData& voiceData, SourceData* sourceData)
 		{
 			if (sourceData == nullptr)
 			{
@@ -307,7 +755,7 @@ namespace Audio
 
 			i64 framesRead = 0;
 			if (sourceData->Buffer.ChannelCount != 0 && sourceData->Buffer.ChannelCount != OutputChannelCount)
-				framesRead = ChannelMixer.MixChannels(sourceData->Buffer, TempOutputBuffer.data(), voiceData.FramePosition, bufferFrameCount);
+				framesRead = Mixer.MixChannels(sourceData->Buffer, TempOutputBuffer.data(), voiceData.FramePosition, bufferFrameCount);
 			else
 				framesRead = sourceData->Buffer.ReadAtOrFillSilence(voiceData.FramePosition, bufferFrameCount, TempOutputBuffer.data());
 
@@ -315,10 +763,10 @@ namespace Audio
 			if (hasReachedEnd && !playPastEnd)
 				voiceData.FramePosition = (voiceData.Flags & VoiceFlags_Looping) ? 0 : sourceData->Buffer.FrameCount;
 
-			CallbackApplyVoiceVolumeAndMixTempBufferIntoOutput(outputBuffer, framesRead, voiceData, sourceData->Buffer.SampleRate);
+			CallbackApplyVoiceVolumeAndMixTempBufferIntoBus(mixBus, framesRead, voiceData, sourceData->Buffer.SampleRate);
 		}
 
-		void CallbackProcessVariableSpeedVoiceSamples(i16* outputBuffer, const u32 bufferFrameCount, const b8 playPastEnd, const b8 hasReachedEnd, VoiceData& voiceData, SourceData* sourceData)
+		void CallbackProcessVariableSpeedVoiceSamples(f32* mixBus, const u32 bufferFrameCount, const b8 playPastEnd, const b8 hasReachedEnd, VoiceData& voiceData, SourceData* sourceData, TimeStretcher* timeStretcher)
 		{
 			const u32 sampleRate = (sourceData != nullptr) ? sourceData->Buffer.SampleRate : OutputSampleRate;
 			const f64 bufferDurationSec = (FramesToTime(bufferFrameCount, sampleRate).ToSec() * voiceData.PlaybackSpeed);
@@ -334,15 +782,24 @@ namespace Audio
 			const f64 sampleDurationSec = (1.0 / static_cast<i64>(sampleRate)) * voiceData.PlaybackSpeed;
 			const i64 framesRead = static_cast<i64>(Round(bufferDurationSec / sampleDurationSec));
 
-			const size_t providerSampleCount = sourceData->Buffer.SampleCount();
+			const size_t providerSampleCount = (sourceData->Buffer.GetAvailableFrameCount() * sourceData->Buffer.ChannelCount);
 			const u32 providerChannelCount = sourceData->Buffer.ChannelCount;
 
 			const f64 sampleRateF64 = static_cast<f64>(sampleRate);
 			const f64 voiceStartTimeSec = voiceData.TimePositionSec;
 
-			if (providerChannelCount != OutputChannelCount)
+			if (timeStretcher != nullptr)
 			{
-				i16* mixBuffer = ChannelMixer.GetMixSampleBufferWithMinSize(framesRead * providerChannelCount);
+				// NOTE: Anything other than the stretcher having rendered up until exactly this point (such as seeking or looping) has to start over from the new position
+				const f64 voiceStartFrame = (voiceStartTimeSec * sampleRateF64);
+				if (Absolute(timeStretcher->GetSourceFramePosition() - voiceStartFrame) > 1.0)
+					timeStretcher->Reset(voiceStartFrame);
+
+				timeStretcher->Render(rawSamples, sourceData->Buffer.GetAvailableFrameCount(), voiceData.PlaybackSpeed, TempOutputBuffer.data(), framesRead);
+			}
+			else if (providerChannelCount != OutputChannelCount)
+			{
+				i16* mixBuffer = Mixer.GetMixSampleBufferWithMinSize(framesRead * providerChannelCount);
 
 				for (i64 f = 0; f < framesRead; f++)
 				{
@@ -351,7 +808,7 @@ namespace Audio
 						mixBuffer[(f * providerChannelCount) + c] = LinearSampleAtTimeOrZero<i16>(frameTimeSec, c, rawSamples, providerSampleCount, sampleRateF64, providerChannelCount);
 				}
 
-				ChannelMixer.MixChannels(providerChannelCount, mixBuffer, framesRead, TempOutputBuffer.data(), 0, framesRead);
+				Mixer.MixChannels(providerChannelCount, mixBuffer, framesRead, TempOutputBuffer.data(), 0, framesRead);
 			}
 			else
 			{
@@ -367,14 +824,13 @@ namespace Audio
 			if (hasReachedEnd && !playPastEnd)
 				voiceData.TimePositionSec = (voiceData.Flags & VoiceFlags_Looping) ? 0.0 : FramesToTime(sourceData->Buffer.FrameCount, sampleRate).ToSec();
 
-			CallbackApplyVoiceVolumeAndMixTempBufferIntoOutput(outputBuffer, framesRead, voiceData, sampleRate);
+			CallbackApplyVoiceVolumeAndMixTempBufferIntoBus(mixBus, framesRead, voiceData, sampleRate);
 		}
 
-		void CallbackAdjustBufferMasterVolume(i16* outputBuffer, const size_t sampleCount)
+		// NOTE: The one and only place where the mixed output gets clipped, with the master volume applied as part of the same pass
+		void CallbackApplyMasterVolumeAndConvertBusToOutput(const f32* mixBus, i16* outputBuffer, const size_t sampleCount)
 		{
-			const f32 masterVolume = MasterVolume.load();
-			for (size_t i = 0; i < sampleCount; i++)
-				outputBuffer[i] = ScaleSampleI16Linear_Clamped(outputBuffer[i], masterVolume);
+			ConvertBusF32ToSamplesI16Clamped(mixBus, outputBuffer, sampleCount, MasterVolume.load());
 		}
 
 		void CallbackUpdateLastPlayedSamplesRingBuffer(i16* outputBuffer, const size_t frameCount)
@@ -389,11 +845,10 @@ namespace Audio
 			}
 		}
 
-		void CallbackUpdateCallbackDurationRingBuffer(const Time duration)
+		i64 GetUnderrunCount() const
 		{
-			CallbackDurationsRingBuffer[CallbackDurationRingIndex] = duration;
-			if (CallbackDurationRingIndex++ >= (CallbackDurationsRingBuffer.size() - 1))
-				CallbackDurationRingIndex = 0;
+			const i64 streamUnderrunCount = (IsStreamOpenRunning && CurrentBackend != nullptr) ? CurrentBackend->GetUnderrunCount() : 0;
+			return ClosedStreamUnderrunCount + streamUnderrunCount;
 		}
 
 		void RequestUpdateSmoothTimeForAllAliveVoices()
@@ -428,11 +883,18 @@ namespace Audio
 			CallbackFrequency = (CallbackStreamTime - LastCallbackStreamTime);
 			LastCallbackStreamTime = CallbackStreamTime;
 
-			CallbackClearOutPreviousCallBuffer(outputBuffer, bufferSampleCount);
-			CallbackProcessVoices(outputBuffer, bufferFrameCount, bufferSampleCount);
-			CallbackAdjustBufferMasterVolume(outputBuffer, bufferSampleCount);
+			CallbackExecutePendingCommands();
+			CallbackClearOutPreviousCallBuffer(MixBus.data(), bufferSampleCount);
+
+			VoiceUpdateSequence.fetch_add(1, std::memory_order_acq_rel);
+			CallbackStartScheduledVoices(bufferFrameCount);
+			CallbackProcessVoices(MixBus.data(), bufferFrameCount, bufferSampleCount);
+			VoiceUpdateSequence.fetch_add(1, std::memory_order_release);
+			CallbackApplyMasterVolumeAndConvertBusToOutput(MixBus.data(), outputBuffer, bufferSampleCount);
 			CallbackUpdateLastPlayedSamplesRingBuffer(outputBuffer, bufferFrameCount);
-			CallbackUpdateCallbackDurationRingBuffer(stopwatch.Stop());
+
+			const i64 durationNS = static_cast<i64>(stopwatch.Stop().ToSec() * 1000000000.0);
+			Telemetry.RecordCallback(durationNS, bufferFrameCount, OutputSampleRate, static_cast<u32>(ActiveVoiceIndices.size()));
 		}
 	};
 
@@ -447,15 +909,15 @@ namespace Audio
 		impl = nullptr;
 	}
 
-	void AudioEngine::ApplicationStartup()
+	void AudioEngine::ApplicationStartup(const EngineStartupParam& param)
 	{
 		assert(impl == nullptr && "ApplicationStartup() has already been called (?)");
-		impl = std::make_unique<Impl>();
+		impl = std::make_unique<Impl>(param);
 
 		SetBackend(Backend::Default);
-		impl->ChannelMixer.TargetChannels = OutputChannelCount;
-		impl->ChannelMixer.MixingBehavior = ChannelMixingBehavior::Combine;
-		impl->ChannelMixer.MixBuffer.reserve(MaxBufferFrameCount * OutputChannelCount);
+		impl->Mixer.TargetChannels = OutputChannelCount;
+		impl->Mixer.MixingBehavior = ChannelMixingBehavior::Combine;
+		impl->Mixer.MixBuffer.reserve(MaxBufferFrameCount * OutputChannelCount);
 	}
 
 	void AudioEngine::ApplicationShutdown()
@@ -484,6 +946,10 @@ namespace Audio
 
 		impl->OnOpenStream();
 
+		// NOTE: Hand command execution over to the render thread before it can possibly start running
+		const auto lock = std::scoped_lock(impl->CommandProducerMutex);
+		impl->IsRenderThreadExecutingCommands = true;
+
 		const b8 openStreamSuccess = impl->CurrentBackend->OpenStartStream(streamParam, [this](i16* outputBuffer, const u32 bufferFrameCount, const u32 bufferChannelCount)
 		{
 			impl->RenderAudioCallback(outputBuffer, bufferFrameCount, bufferChannelCount);
@@ -491,6 +957,8 @@ namespace Audio
 
 		if (openStreamSuccess)
 			impl->StreamTimeStopwatch.Restart();
+		else
+			impl->IsRenderThreadExecutingCommands = false;
 
 		impl->IsStreamOpenRunning = openStreamSuccess;
 	}
@@ -500,8 +968,19 @@ namespace Audio
 		if (!impl->IsStreamOpenRunning)
 			return;
 
-		if (impl->CurrentBackend != nullptr)
-			impl->CurrentBackend->StopCloseStream();
+		{
+			// NOTE: Once the backend has stopped, the render callback is guaranteed to no longer be running so any remaining commands can safely be executed right here
+			const auto lock = std::scoped_lock(impl->CommandProducerMutex);
+			if (impl->CurrentBackend != nullptr)
+			{
+				impl->CurrentBackend->StopCloseStream();
+				impl->ClosedStreamUnderrunCount += impl->CurrentBackend->GetUnderrunCount();
+			}
+
+			impl->IsRenderThreadExecutingCommands = false;
+			impl->ExecuteAllPendingCommandsOnNonRenderThread();
+		}
+		impl->FreeRetiredSourceBuffers();
 
 		impl->OnCloseStream();
 		impl->StreamTimeStopwatch.Stop();
@@ -547,27 +1026,29 @@ namespace Audio
 
 	SourceHandle AudioEngine::LoadSourceFromBufferMove(std::string_view sourceName, PCMSampleBuffer bufferToMove)
 	{
-		const auto lock = std::scoped_lock(impl->VoiceRenderMutex);
-		for (HandleBaseType index = 0; index < static_cast<HandleBaseType>(impl->LoadedSources.size()); index++)
-		{
-			const SourceHandle handleIt = IndexToSourceHandle(index);
-			SourceData& sourceData = impl->LoadedSources[index];
-			if (sourceData.SlotUsed)
-				continue;
-
-			sourceData.SlotUsed = true;
-			sourceData.Buffer = std::move(bufferToMove);
-			sourceData.BaseVolume = 1.0f;
-			CopyStringViewIntoFixedBuffer(sourceData.Name, sourceName);
-
-			return static_cast<SourceHandle>(index);
-		}
+		impl->FreeRetiredSourceBuffers();
 
+		const auto lock = std::scoped_lock(impl->CommandProducerMutex);
+		if (impl->FreeSourceIndices.empty())
+		{
 #if PEEPO_DEBUG
-		assert(!"Consider increasing MaxLoadedSources");
+			assert(!"Consider increasing EngineStartupParam::MaxLoadedSources");
 #endif
+			return SourceHandle::Invalid;
+		}
 
-		return SourceHandle::Invalid;
+		const HandleBaseType index = impl->FreeSourceIndices.back();
+		impl->FreeSourceIndices.pop_back();
+
+		// NOTE: The slot isn't visible to the render thread until its state has been set to used, after all of its data has been written
+		SourceData& sourceData = impl->LoadedSources[index];
+		sourceData.State = SourceSlotState::Reserved;
+		sourceData.Buffer = std::move(bufferToMove);
+		sourceData.BaseVolume = 1.0f;
+		CopyStringViewIntoFixedBuffer(sourceData.Name, sourceName);
+		sourceData.State = SourceSlotState::Used;
+
+		return ToSourceHandle(index, sourceData.Generation);
 	}
 
 	void AudioEngine::UnloadSource(SourceHandle source)
@@ -575,17 +1056,20 @@ namespace Audio
 		if (source == SourceHandle::Invalid)
 			return;
 
-		const auto lock = std::scoped_lock(impl->VoiceRenderMutex);
 		SourceData* sourceData = impl->TryGetSourceData(source, Impl::GetSourceDataParam::None);
 		if (sourceData == nullptr)
 			return;
 
-		sourceData->SlotUsed = false;
-		for (VoiceData& voice : impl->VoicePool)
-		{
-			if ((voice.Flags & VoiceFlags_Alive) && voice.Source == source)
-				voice.Source = SourceHandle::Invalid;
-		}
+		// NOTE: The render thread might still be reading from the buffer, so only detach it from any voices and hand it back to be freed once it gets to the command
+		SourceSlotState expectedState = SourceSlotState::Used;
+		if (sourceData->State.compare_exchange_strong(expectedState, SourceSlotState::PendingUnload))
+			impl->PushCommand(EngineCommand { EngineCommandType::UnloadSource, SourceHandleToIndex(source) });
+		impl->FreeRetiredSourceBuffers();
+	}
+
+	void AudioEngine::FreeRetiredSourceBuffers()
+	{
+		impl->FreeRetiredSourceBuffers();
 	}
 
 	const PCMSampleBuffer* AudioEngine::GetSourceSampleBufferView(SourceHandle source)
@@ -616,46 +1100,45 @@ namespace Audio
 
 	VoiceHandle AudioEngine::AddVoice(SourceHandle source, std::string_view name, b8 playing, f32 volume, b8 playPastEnd)
 	{
-		const auto lock = std::scoped_lock(impl->VoiceRenderMutex);
+		VoiceFlags newFlags = VoiceFlags_Alive;
+		if (playing) newFlags |= VoiceFlags_Playing;
+		if (playPastEnd) newFlags |= VoiceFlags_PlayPastEnd;
+		return impl->AllocateAndInitializeVoice(source, name, volume, newFlags);
+	}
 
-		for (size_t i = 0; i < impl->VoicePool.size(); i++)
-		{
-			VoiceData& voiceToUpdate = impl->VoicePool[i];
-			if (voiceToUpdate.Flags & VoiceFlags_Alive)
-				continue;
+	void AudioEngine::RemoveVoice(VoiceHandle voice)
+	{
+		if (voice == VoiceHandle::Invalid)
+			return;
 
-			voiceToUpdate.Flags = VoiceFlags_Alive;
-			if (playing) voiceToUpdate.Flags |= VoiceFlags_Playing;
-			if (playPastEnd) voiceToUpdate.Flags |= VoiceFlags_PlayPastEnd;
+		// NOTE: Killing the voice directly could allow its slot to be reused by AddVoice() while the render thread is still in the middle of processing it
+		VoiceData* voiceData = impl->TryGetVoiceData(voice);
+		if (voiceData == nullptr)
+			return;
 
-			voiceToUpdate.Source = source;
-			voiceToUpdate.Volume = volume;
-			voiceToUpdate.FramePosition = 0;
-			voiceToUpdate.VolumeMap.StartVolume = 0.0f;
-			voiceToUpdate.VolumeMap.EndVolume = 0.0f;
-			CopyStringViewIntoFixedBuffer(voiceToUpdate.Name, name);
+		if (!(voiceData->Flags.fetch_or(VoiceFlags_PendingRemove) & VoiceFlags_PendingRemove))
+			impl->PushCommand(EngineCommand { EngineCommandType::RemoveVoice, VoiceHandleToIndex(voice) });
+	}
 
-			return static_cast<VoiceHandle>(i);
-		}
+	i64 AudioEngine::GetStreamFramePosition() const
+	{
+		return impl->TotalRenderedFrames.load(std::memory_order_acquire);
+	}
 
-#if PEEPO_DEBUG
-		assert(!"Consider increasing MaxSimultaneousVoices");
-#endif
+	void AudioEngine::ScheduleVoiceStart(VoiceHandle voice, i64 streamFrame, i64 voiceFramePosition)
+	{
+		if (impl->TryGetVoiceData(voice) == nullptr)
+			return;
 
-		return VoiceHandle::Invalid;
+		impl->PushCommand(EngineCommand { EngineCommandType::ScheduleVoiceStart, VoiceHandleToIndex(voice), streamFrame, voiceFramePosition });
 	}
 
-	void AudioEngine::RemoveVoice(VoiceHandle voice)
+	void AudioEngine::CancelScheduledVoiceStarts(VoiceHandle voice)
 	{
-		if (voice == VoiceHandle::Invalid)
+		if (impl->TryGetVoiceData(voice) == nullptr)
 			return;
 
-		// TODO: Think these locks through again
-		const auto lock = std::scoped_lock(impl->VoiceRenderMutex);
-
-		VoiceData* voiceData = impl->TryGetVoiceData(voice);
-		if (voiceData != nullptr)
-			voiceData->Flags = VoiceFlags_Dead;
+		impl->PushCommand(EngineCommand { EngineCommandType::CancelScheduledVoiceStarts, VoiceHandleToIndex(voice) });
 	}
 
 	void AudioEngine::PlayOneShotSound(SourceHandle source, std::string_view name, f32 volume)
@@ -663,22 +1146,7 @@ namespace Audio
 		if (source == SourceHandle::Invalid)
 			return;
 
-		const auto lock = std::scoped_lock(impl->VoiceRenderMutex);
-
-		for (VoiceData& voiceToUpdate : impl->VoicePool)
-		{
-			if (voiceToUpdate.Flags & VoiceFlags_Alive)
-				continue;
-
-			voiceToUpdate.Flags = VoiceFlags_Alive | VoiceFlags_Playing | VoiceFlags_RemoveOnEnd;
-			voiceToUpdate.Source = source;
-			voiceToUpdate.Volume = volume;
-			voiceToUpdate.FramePosition = 0;
-			voiceToUpdate.VolumeMap.StartVolume = 0.0f;
-			voiceToUpdate.VolumeMap.EndVolume = 0.0f;
-			CopyStringViewIntoFixedBuffer(voiceToUpdate.Name, name);
-			return;
-		}
+		impl->AllocateAndInitializeVoice(source, name, volume, static_cast<VoiceFlags>(VoiceFlags_Alive | VoiceFlags_Playing | VoiceFlags_RemoveOnEnd));
 	}
 
 	Backend AudioEngine::GetBackend() const
@@ -716,8 +1184,8 @@ namespace Audio
 
 		for (size_t i = 0; i < impl->VoicePool.size(); i++)
 		{
-			const VoiceData& voice = impl->VoicePool[i];
-			if ((voice.Flags & VoiceFlags_Alive) && (voice.Flags & VoiceFlags_Playing))
+			const VoiceFlags flags = impl->VoicePool[i].Flags;
+			if ((flags & VoiceFlags_Alive) && (flags & VoiceFlags_Playing))
 				return false;
 		}
 
@@ -762,7 +1230,20 @@ namespace Audio
 
 	ChannelMixer& AudioEngine::GetChannelMixer()
 	{
-		return impl->ChannelMixer;
+		return impl->Mixer;
+	}
+
+	b8 AudioEngine::RenderOfflineFrames(i16* outInterleavedSamples, i64 frameCount)
+	{
+		if (impl->CurrentBackendType != Backend::Offline || !impl->IsStreamOpenRunning || impl->CurrentBackend == nullptr)
+			return false;
+
+		// NOTE: The render callback adopts the frame count of each call as the current buffer size, which a shorter last chunk mustn't permanently change
+		const u32 bufferFrameSize = impl->CurrentBufferFrameSize;
+		auto* offlineBackend = static_cast<OfflineRenderBackend*>(impl->CurrentBackend.get());
+		const b8 renderSuccess = offlineBackend->RenderFrames(outInterleavedSamples, frameCount);
+		impl->CurrentBufferFrameSize = bufferFrameSize;
+		return renderSuccess;
 	}
 
 	i64 AudioEngine::DebugGetTotalRenderedFrames() const
@@ -770,26 +1251,37 @@ namespace Audio
 		return impl->TotalRenderedFrames;
 	}
 
-	AudioEngine::DebugVoicesArray AudioEngine::DebugGetAllActiveVoices()
+	i64 AudioEngine::DebugGetLateScheduledVoiceStartCount() const
 	{
-		DebugVoicesArray out = {};
+		return impl->LateScheduledVoiceStartCount;
+	}
+
+	i64 AudioEngine::DebugGetDroppedScheduledVoiceStartCount() const
+	{
+		return impl->DroppedScheduledVoiceStartCount;
+	}
+
+	std::vector<Voice> AudioEngine::DebugGetAllActiveVoices()
+	{
+		std::vector<Voice> out;
 		for (size_t i = 0; i < impl->VoicePool.size(); i++)
 		{
 			const VoiceData& voice = impl->VoicePool[i];
-			if (voice.Flags & VoiceFlags_Alive)
-				out.Slots[out.Count++] = static_cast<VoiceHandle>(i);
+			const VoiceFlags flags = voice.Flags;
+			if ((flags & VoiceFlags_Alive) && !(flags & VoiceFlags_PendingRemove))
+				out.push_back(ToVoiceHandle(static_cast<HandleBaseType>(i), voice.Generation));
 		}
 		return out;
 	}
 
-	AudioEngine::DebugSourcesArray AudioEngine::DebugGetAllLoadedSources()
+	std::vector<SourceHandle> AudioEngine::DebugGetAllLoadedSources()
 	{
-		DebugSourcesArray out = {};
+		std::vector<SourceHandle> out;
 		for (size_t i = 0; i < impl->LoadedSources.size(); i++)
 		{
 			const SourceData& source = impl->LoadedSources[i];
-			if (source.SlotUsed)
-				out.Slots[out.Count++] = static_cast<SourceHandle>(i);
+			if (source.State == SourceSlotState::Used)
+				out.push_back(ToSourceHandle(static_cast<HandleBaseType>(i), source.Generation));
 		}
 		return out;
 	}
@@ -809,9 +1301,53 @@ namespace Audio
 		return instanceCount;
 	}
 
+	RenderTelemetrySnapshot AudioEngine::GetRenderTelemetrySnapshot() const
+	{
+		RenderTelemetrySnapshot out = {};
+		impl->Telemetry.ReadInto(out, OutputSampleRate);
+		out.UnderrunCount = impl->GetUnderrunCount();
+
+		for (size_t i = 0; i < impl->VoicePool.size(); i++)
+		{
+			const VoiceData& voice = impl->VoicePool[i];
+			const VoiceFlags flags = voice.Flags;
+			if (!(flags & VoiceFlags_Alive) || (flags & VoiceFlags_PendingRemove))
+				continue;
+
+			RenderTelemetryVoiceCost& cost = out.VoiceCosts.emplace_back();
+			cost.Name = std::string(voice.Name);
+			cost.Handle = static_cast<u32>(ToVoiceHandle(static_cast<HandleBaseType>(i), voice.Generation));
+			cost.CallbackCount = voice.RenderCost.CallbackCount.load(std::memory_order_relaxed);
+			cost.TotalDuration = Time::FromSec(static_cast<f64>(voice.RenderCost.TotalNS.load(std::memory_order_relaxed)) / 1000000000.0);
+			cost.MaxDuration = Time::FromSec(static_cast<f64>(voice.RenderCost.MaxNS.load(std::memory_order_relaxed)) / 1000000000.0);
+			cost.LastDuration = Time::FromSec(static_cast<f64>(voice.RenderCost.LastNS.load(std::memory_order_relaxed)) / 1000000000.0);
+		}
+
+		std::stable_sort(out.VoiceCosts.begin(), out.VoiceCosts.end(), [](const RenderTelemetryVoiceCost& a, const RenderTelemetryVoiceCost& b) { return a.TotalDuration > b.TotalDuration; });
+		return out;
+	}
+
+	void AudioEngine::ResetRenderTelemetry()
+	{
+		impl->Telemetry.Reset();
+		impl->ClosedStreamUnderrunCount = -((impl->IsStreamOpenRunning && impl->CurrentBackend != nullptr) ? impl->CurrentBackend->GetUnderrunCount() : 0);
+	}
+
+	b8 AudioEngine::GetTrackVoiceRenderCosts() const
+	{
+		return impl->TrackVoiceRenderCosts;
+	}
+
+	void AudioEngine::SetTrackVoiceRenderCosts(b8 value)
+	{
+		impl->TrackVoiceRenderCosts = value;
+	}
+
 	std::array<Time, AudioEngine::CallbackDurationRingBufferSize> AudioEngine::DebugGetRenderPerformanceHistory()
 	{
-		return impl->CallbackDurationsRingBuffer;
+		std::array<Time, CallbackDurationRingBufferSize> out = {};
+		impl->Telemetry.ReadRecentDurations(out.data(), out.size());
+		return out;
 	}
 
 	std::array<std::array<i16, AudioEngine::LastPlayedSamplesRingBufferFrameCount>, AudioEngine::OutputChannelCount> AudioEngine::DebugGetLastPlayedSamples()
@@ -900,6 +1436,32 @@ namespace Audio
 		return Time::Zero();
 	}
 
+	Time Voice::GetPositionAtStreamFrame(i64& outStreamFrame) const
+	{
+		auto& impl = Engine.impl;
+
+		// NOTE: Seqlock style retry loop, the render thread only ever holds the sequence odd for the short duration of updating all voices
+		while (true)
+		{
+			const u32 sequenceBefore = impl->VoiceUpdateSequence.load(std::memory_order_acquire);
+			if (sequenceBefore & 1)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			const i64 streamFrame = impl->TotalRenderedFrames.load(std::memory_order_acquire);
+			const Time position = GetPosition();
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (impl->VoiceUpdateSequence.load(std::memory_order_relaxed) == sequenceBefore)
+			{
+				outStreamFrame = streamFrame;
+				return position;
+			}
+		}
+	}
+
 	Time Voice::GetPositionSmooth() const
 	{
 		auto& impl = Engine.impl;
@@ -977,12 +1539,7 @@ namespace Audio
 
 	void Voice::SetIsPlaying(b8 value)
 	{
-		// TODO: Allow manual render thread locking from outside code to then be used for playback sounds
-		//		 This should then become lockfree again!
-
-		// HACK: Prevent randomly "stacking" playback button sounds... need to find a better solution, definitely don't want any locks like this
-		const auto lock = std::scoped_lock(Engine.impl->VoiceRenderMutex);
-
+		// NOTE: Atomically set so that it is visible to the render thread (and any subsequent GetIsPlaying() calls) immediately, without having to lock
 		SetInternalFlag(VoiceFlags_Playing, value);
 	}
 
@@ -1026,6 +1583,16 @@ namespace Audio
 		SetInternalFlag(VoiceFlags_PauseOnEnd, value);
 	}
 
+	b8 Voice::GetPreservePitch() const
+	{
+		return GetInternalFlag(VoiceFlags_PreservePitch);
+	}
+
+	void Voice::SetPreservePitch(b8 value)
+	{
+		SetInternalFlag(VoiceFlags_PreservePitch, value);
+	}
+
 	std::string_view Voice::GetName() const
 	{
 		auto& impl = Engine.impl;
@@ -2,9 +2,11 @@
 #include "core_types.h"
 #include "audio_common.h"
 #include "core_string.h"
+#include "audio_telemetry.h"
 #include <functional>
 #include <future>
 #include <array>
+#include <vector>
 
 // TODO: Automatically add VariableRate playback for samplerate mismatched voices (?)
 
@@ -15,11 +17,11 @@
 //		 "Voice"  -> Instance of a source, rendered to the output stream
 namespace Audio
 {
-	// NOTE: Opaque types for referncing data stored in the AudioEngine, internally interpreted as in index.
-	//		 A genertion ID could easily be tagged on for extra safety but so far it hasn't felt necessary
-	using HandleBaseType = u16;
-	enum class VoiceHandle : HandleBaseType { Invalid = 0xFFFF };
-	enum class SourceHandle : HandleBaseType { Invalid = 0xFFFF };
+	// NOTE: Opaque types for referncing data stored in the AudioEngine, internally interpreted as a slot index (lower 16 bits) tagged with a generation ID (upper 16 bits).
+	//		 The generation of a slot is incremented every time it is freed, so that handles to a removed voice or unloaded source are rejected even after their slot has been reused
+	using HandleBaseType = u32;
+	enum class VoiceHandle : HandleBaseType { Invalid = 0xFFFFFFFF };
+	enum class SourceHandle : HandleBaseType { Invalid = 0xFFFFFFFF };
 
 	// NOTE: Lightweight non-owning wrapper around a VoiceHandle providing a convenient OOP interface
 	struct Voice
@@ -44,6 +46,9 @@ namespace Audio
 		Time GetPositionSmooth() const;
 		void SetPosition(Time value);
 
+		// NOTE: Position as of the output stream frame that will be rendered next, read atomically together with said frame
+		Time GetPositionAtStreamFrame(i64& outStreamFrame) const;
+
 		SourceHandle GetSource() const;
 		void SetSource(SourceHandle value);
 
@@ -64,6 +69,11 @@ namespace Audio
 		b8 GetPauseOnEnd() const;
 		void SetPauseOnEnd(b8 value);
 
+		// NOTE: Time stretch instead of resample at variable playback speeds, so that the pitch stays the same. Only supported for stereo sources
+		//		 and (with the time stretch state being preallocated) up to AudioEngine::MaxTimeStretchedVoices at a time, with all others still falling back to resampling
+		b8 GetPreservePitch() const;
+		void SetPreservePitch(b8 value);
+
 		std::string_view GetName() const;
 
 		void ResetVolumeMap();
@@ -78,6 +88,8 @@ namespace Audio
 	{
 		WASAPI_Shared,
 		WASAPI_Exclusive,
+		// NOTE: No output device, frames are only rendered on demand via AudioEngine::RenderOfflineFrames()
+		Offline,
 		Count,
 		// TEMP: Switching to shared during early developement where there isn't actually any charting to do yet
 		// Default = WASAPI_Exclusive,
@@ -88,14 +100,25 @@ namespace Audio
 	{
 		"WASAPI (Shared)",
 		"WASAPI (Exclusive)",
+		"Offline",
+	};
+
+	// NOTE: All slots are allocated upfront and the pools never grow afterwards, so that the render thread never has to wait on a reallocation
+	struct EngineStartupParam
+	{
+		size_t MaxSimultaneousVoices = 128;
+		// NOTE: Batch tools processing many files at once may want to raise this considerably
+		size_t MaxLoadedSources = 256;
 	};
 
 	class AudioEngine : NonCopyable
 	{
 	public:
 		static constexpr f32 MinVolume = 0.0f, MaxVolume = 1.0f;
-		static constexpr size_t MaxSimultaneousVoices = 128;
-		static constexpr size_t MaxLoadedSources = 256;
+		// NOTE: Upper limit for each of the EngineStartupParam pool sizes, as every slot index has to fit into the lower bits of a handle (excluding the invalid handle)
+		static constexpr size_t MaxPoolSlotCount = 0xFFFF;
+		static constexpr size_t MaxScheduledVoiceStarts = 256;
+		static constexpr size_t MaxTimeStretchedVoices = 4;
 
 		static constexpr u32 OutputChannelCount = 2;
 		static constexpr u32 OutputSampleRate = 44100;
@@ -112,7 +135,7 @@ namespace Audio
 		~AudioEngine();
 
 	public:
-		void ApplicationStartup();
+		void ApplicationStartup(const EngineStartupParam& param = {});
 		void ApplicationShutdown();
 
 		void OpenStartStream();
@@ -128,6 +151,9 @@ namespace Audio
 		SourceHandle LoadSourceFromBufferMove(std::string_view sourceName, PCMSampleBuffer bufferToMove);
 		void UnloadSource(SourceHandle source);
 
+		// NOTE: Unloaded sources are only detached on the render thread and their buffers then handed back to be freed here instead, should be called regularly from a non-render thread
+		void FreeRetiredSourceBuffers();
+
 		const PCMSampleBuffer* GetSourceSampleBufferView(SourceHandle source);
 
 		f32 GetSourceBaseVolume(SourceHandle source);
@@ -143,6 +169,14 @@ namespace Audio
 		// NOTE: Add a voice, play it once then discard
 		void PlayOneShotSound(SourceHandle source, std::string_view name, f32 volume = MaxVolume);
 
+		// NOTE: The output stream clock, counting all frames rendered so far, so also the stream frame at the start of the next rendered buffer
+		i64 GetStreamFramePosition() const;
+
+		// NOTE: Start playing the voice from the given (source) frame position once the output stream reaches the given stream frame, sample accurate within the buffer.
+		//		 Starts that are already in the past by the time they are processed play right away, skipped ahead by however many frames they are late
+		void ScheduleVoiceStart(VoiceHandle voice, i64 streamFrame, i64 voiceFramePosition = 0);
+		void CancelScheduledVoiceStarts(VoiceHandle voice);
+
 	public:
 		Backend GetBackend() const;
 		void SetBackend(Backend value);
@@ -159,15 +193,30 @@ namespace Audio
 		Time GetCallbackFrequency() const;
 		ChannelMixer& GetChannelMixer();
 
+	public:
+		// NOTE: Lock-free to read at any time, without ever blocking the render thread
+		RenderTelemetrySnapshot GetRenderTelemetrySnapshot() const;
+		void ResetRenderTelemetry();
+
+		// NOTE: Timing each voice separately adds a timer read per voice and callback, so can be turned off if not needed
+		b8 GetTrackVoiceRenderCosts() const;
+		void SetTrackVoiceRenderCosts(b8 value);
+
+	public:
+		// NOTE: Only valid for Backend::Offline with an open stream, synchronously renders the next interleaved output frames on the calling thread
+		//		 which then also acts as the render thread, so the caller is entirely in control of the stream clock
+		b8 RenderOfflineFrames(i16* outInterleavedSamples, i64 frameCount);
+
 	public:
 		i64 DebugGetTotalRenderedFrames() const;
+		i64 DebugGetLateScheduledVoiceStartCount() const;
+		i64 DebugGetDroppedScheduledVoiceStartCount() const;
 
-		struct DebugVoicesArray { Voice Slots[MaxSimultaneousVoices]; size_t Count; };
-		struct DebugSourcesArray { SourceHandle Slots[MaxLoadedSources]; size_t Count; };
-		DebugVoicesArray DebugGetAllActiveVoices();
-		DebugSourcesArray DebugGetAllLoadedSources();
+		std::vector<Voice> DebugGetAllActiveVoices();
+		std::vector<SourceHandle> DebugGetAllLoadedSources();
 		i32 DebugGetSourceVoiceInstanceCount(SourceHandle source);
 
+		// NOTE: Durations of the most recent callbacks, oldest first
 		std::array<Time, CallbackDurationRingBufferSize> DebugGetRenderPerformanceHistory();
 		std::array<std::array<i16, LastPlayedSamplesRingBufferFrameCount>, OutputChannelCount> DebugGetLastPlayedSamples();
 
@@ -175,7 +224,7 @@ namespace Audio
 		friend Voice;
 
 		struct Impl;
-		std::unique_ptr<Impl> impl = nullptr;
+		std::unique_ptr<Impl> impl;
 	};
 
 	// NOTE: Single global instance
@@ -1,4 +1,5 @@
 #include "audio_file_formats.h"
+#include "audio_resampler.h"
 #include "core_io.h"
 
 #define DR_MP3_IMPLEMENTATION
@@ -17,7 +18,19 @@
 
 // TODO: Forward declare because visual studio is having a stroke parsing the C header (something about the typedef union { ... } Floor; ???)
 //		 even though it was working perfectly fine in a different C++ project before :PeepoShrug:
-extern "C" int stb_vorbis_decode_memory(const unsigned char* mem, int len, int* channels, int* sample_rate, short** output);
+extern "C"
+{
+	struct stb_vorbis;
+	struct stb_vorbis_alloc;
+	struct stb_vorbis_info { unsigned int sample_rate; int channels; unsigned int setup_memory_required, setup_temp_memory_required, temp_memory_required; int max_frame_size; };
+
+	stb_vorbis* stb_vorbis_open_memory(const unsigned char* data, int len, int* error, const stb_vorbis_alloc* alloc_buffer);
+	stb_vorbis_info stb_vorbis_get_info(stb_vorbis* f);
+	unsigned int stb_vorbis_stream_length_in_samples(stb_vorbis* f);
+	int stb_vorbis_get_samples_short_interleaved(stb_vorbis* f, int channels, short* buffer, int num_shorts);
+	int stb_vorbis_seek_start(stb_vorbis* f);
+	void stb_vorbis_close(stb_vorbis* f);
+}
 
 namespace Audio
 {
@@ -31,8 +44,202 @@ namespace Audio
 		return SupportedFileFormat::Count;
 	}
 
-	DecodeFileResult DecodeEntireFile(std::string_view fileNameWithExtension, const void* inFileContent, size_t inFileSize, PCMSampleBuffer& outBuffer)
+	struct StreamingDecoder::Impl
 	{
+		SupportedFileFormat FileFormat = SupportedFileFormat::Count;
+		::drwav Wav = {};
+		::drflac* Flac = nullptr;
+		::drmp3 Mp3 = {};
+		::stb_vorbis* Vorbis = nullptr;
+
+		u32 ChannelCount = 0;
+		u32 SourceSampleRate = 0;
+		u32 TargetSampleRate = 0;
+		i64 SourceFrameCount = 0;
+		i64 TotalFrameCount = 0;
+
+		i16* OutputSamples = nullptr;
+		i64 WrittenFrameCount = 0;
+		b8 IsFinished = false;
+		std::shared_ptr<std::atomic<i64>> PublishedFrameCount;
+		std::atomic<b8> CancelRequested = false;
+
+		// NOTE: Only used when resampling, with the resampler itself holding on to all source frames still needed by the filter taps of the next output frames
+		PolyphaseResampler Resampler;
+		std::vector<i16> ResampleSourceChunk;
+
+		inline b8 IsResampling() const { return (TargetSampleRate != SourceSampleRate); }
+
+		b8 OpenCodec(SupportedFileFormat fileFormat, const void* inFileContent, size_t inFileSize)
+		{
+			FileFormat = fileFormat;
+			switch (fileFormat)
+			{
+			case SupportedFileFormat::OggVorbis:
+			{
+				if (inFileSize > static_cast<size_t>(I32Max))
+					return false;
+				Vorbis = ::stb_vorbis_open_memory(static_cast<const unsigned char*>(inFileContent), static_cast<int>(inFileSize), nullptr, nullptr);
+				if (Vorbis == nullptr)
+					return false;
+				const ::stb_vorbis_info info = ::stb_vorbis_get_info(Vorbis);
+				const u32 lengthInSamples = ::stb_vorbis_stream_length_in_samples(Vorbis);
+				ChannelCount = static_cast<u32>(info.channels);
+				SourceSampleRate = info.sample_rate;
+				SourceFrameCount = (lengthInSamples == U32Max) ? 0 : static_cast<i64>(lengthInSamples);
+
+				// NOTE: The length is unknown for (rare) streams without a valid last page granule position, in which case it can only be found by decoding everything twice
+				if (SourceFrameCount == 0)
+				{
+					std::vector<i16> scratchSamples(static_cast<size_t>(ChunkFrameCount * ChannelCount));
+					while (const i64 framesRead = static_cast<i64>(::stb_vorbis_get_samples_short_interleaved(Vorbis, static_cast<int>(ChannelCount), scratchSamples.data(), static_cast<int>(scratchSamples.size()))))
+						SourceFrameCount += framesRead;
+					if (!::stb_vorbis_seek_start(Vorbis))
+						return false;
+				}
+			} break;
+
+			case SupportedFileFormat::WAV:
+			{
+				if (!::drwav_init_memory(&Wav, inFileContent, inFileSize, nullptr))
+					return false;
+				ChannelCount = Wav.channels;
+				SourceSampleRate = Wav.sampleRate;
+				SourceFrameCount = static_cast<i64>(Wav.totalPCMFrameCount);
+			} break;
+
+			case SupportedFileFormat::FLAC:
+			{
+				Flac = ::drflac_open_memory(inFileContent, inFileSize, nullptr);
+				if (Flac == nullptr)
+					return false;
+				ChannelCount = Flac->channels;
+				SourceSampleRate = Flac->sampleRate;
+				SourceFrameCount = static_cast<i64>(Flac->totalPCMFrameCount);
+
+				// NOTE: The total frame count is optional (but pretty much always present), without it the only option is to decode everything twice
+				if (SourceFrameCount == 0)
+				{
+					std::vector<i16> scratchSamples(static_cast<size_t>(ChunkFrameCount * ChannelCount));
+					while (const i64 framesRead = static_cast<i64>(::drflac_read_pcm_frames_s16(Flac, ChunkFrameCount, scratchSamples.data())))
+						SourceFrameCount += framesRead;
+					if (!::drflac_seek_to_pcm_frame(Flac, 0))
+						return false;
+				}
+			} break;
+
+			case SupportedFileFormat::MP3:
+			{
+				if (!::drmp3_init_memory(&Mp3, inFileContent, inFileSize, nullptr))
+				{
+					Mp3 = {};
+					return false;
+				}
+				// NOTE: Has to scan through all MP3 frame headers, which is still much faster than actually decoding them
+				ChannelCount = Mp3.channels;
+				SourceSampleRate = Mp3.sampleRate;
+				SourceFrameCount = static_cast<i64>(::drmp3_get_pcm_frame_count(&Mp3));
+			} break;
+
+			default:
+			{
+				assert(!"Unhandled file format switch case");
+				return false;
+			} break;
+			}
+
+			return (ChannelCount > 0 && SourceSampleRate > 0);
+		}
+
+		void CloseCodec()
+		{
+			switch (FileFormat)
+			{
+			case SupportedFileFormat::OggVorbis: { if (Vorbis != nullptr) ::stb_vorbis_close(Vorbis); Vorbis = nullptr; } break;
+			case SupportedFileFormat::WAV: { if (Wav.onRead != nullptr) ::drwav_uninit(&Wav); Wav = {}; } break;
+			case SupportedFileFormat::FLAC: { if (Flac != nullptr) ::drflac_close(Flac); Flac = nullptr; } break;
+			case SupportedFileFormat::MP3: { if (Mp3.onRead != nullptr) ::drmp3_uninit(&Mp3); Mp3 = {}; } break;
+			default: break;
+			}
+			FileFormat = SupportedFileFormat::Count;
+		}
+
+		i64 ReadSourceFrames(i16* outSamples, i64 frameCount)
+		{
+			i64 totalFramesRead = 0;
+			while (totalFramesRead < frameCount)
+			{
+				i16* outSamplesAtOffset = (outSamples + (totalFramesRead * ChannelCount));
+				const i64 framesToRead = (frameCount - totalFramesRead);
+
+				i64 framesRead = 0;
+				switch (FileFormat)
+				{
+				case SupportedFileFormat::OggVorbis: { framesRead = ::stb_vorbis_get_samples_short_interleaved(Vorbis, static_cast<int>(ChannelCount), outSamplesAtOffset, static_cast<int>(framesToRead * ChannelCount)); } break;
+				case SupportedFileFormat::WAV: { framesRead = static_cast<i64>(::drwav_read_pcm_frames_s16(&Wav, static_cast<drwav_uint64>(framesToRead), outSamplesAtOffset)); } break;
+				case SupportedFileFormat::FLAC: { framesRead = static_cast<i64>(::drflac_read_pcm_frames_s16(Flac, static_cast<drflac_uint64>(framesToRead), outSamplesAtOffset)); } break;
+				case SupportedFileFormat::MP3: { framesRead = static_cast<i64>(::drmp3_read_pcm_frames_s16(&Mp3, static_cast<drmp3_uint64>(framesToRead), outSamplesAtOffset)); } break;
+				default: break;
+				}
+
+				if (framesRead <= 0)
+					break;
+				totalFramesRead += framesRead;
+			}
+			return totalFramesRead;
+		}
+
+		b8 DecodeAndResampleNextChunk()
+		{
+			ResampleSourceChunk.resize(static_cast<size_t>(ChunkFrameCount * ChannelCount));
+			const i64 framesRead = ReadSourceFrames(ResampleSourceChunk.data(), ChunkFrameCount);
+			const b8 sourceEndReached = (framesRead < ChunkFrameCount);
+
+			i16* outSamples = &OutputSamples[WrittenFrameCount * ChannelCount];
+			WrittenFrameCount += Resampler.Process(ResampleSourceChunk.data(), framesRead, outSamples, (TotalFrameCount - WrittenFrameCount));
+			if (sourceEndReached)
+				WrittenFrameCount += Resampler.ProcessEndOfInput(&OutputSamples[WrittenFrameCount * ChannelCount], (TotalFrameCount - WrittenFrameCount));
+
+			return !sourceEndReached;
+		}
+
+		b8 DecodeNextChunk()
+		{
+			b8 hasMoreFrames;
+			if (IsResampling())
+			{
+				hasMoreFrames = DecodeAndResampleNextChunk();
+			}
+			else
+			{
+				const i64 framesToRead = Min(ChunkFrameCount, (TotalFrameCount - WrittenFrameCount));
+				const i64 framesRead = ReadSourceFrames(&OutputSamples[WrittenFrameCount * ChannelCount], framesToRead);
+				WrittenFrameCount += framesRead;
+				hasMoreFrames = (framesRead == framesToRead);
+			}
+
+			if (!hasMoreFrames || WrittenFrameCount >= TotalFrameCount)
+			{
+				// NOTE: The total frame count taken from the file header can (in theory) be larger than the number of frames actually stored inside the file
+				std::fill(&OutputSamples[WrittenFrameCount * ChannelCount], &OutputSamples[TotalFrameCount * ChannelCount], static_cast<i16>(0));
+				WrittenFrameCount = TotalFrameCount;
+				IsFinished = true;
+				CloseCodec();
+				Resampler = {};
+				ResampleSourceChunk = {};
+			}
+
+			PublishedFrameCount->store(WrittenFrameCount, std::memory_order_release);
+			return !IsFinished;
+		}
+	};
+
+	StreamingDecoder::StreamingDecoder() = default;
+	StreamingDecoder::~StreamingDecoder() { Close(); }
+
+	DecodeFileResult StreamingDecoder::Open(std::string_view fileNameWithExtension, const void* inFileContent, size_t inFileSize, PCMSampleBuffer& outBuffer, u32 targetSampleRate)
+	{
+		Close();
 		outBuffer = {};
 
 		if (inFileContent == nullptr || inFileSize == 0)
@@ -43,106 +250,97 @@ namespace Audio
 		if (fileFormat == SupportedFileFormat::Count)
 			return DecodeFileResult::Sadge;
 
-		switch (fileFormat)
-		{
-		case SupportedFileFormat::OggVorbis:
-		{
-			i32 outChannels = {};
-			i32 outSampleRate = {};
-			i16* outSamplesI16 = {};
-			i32 outFrameCount = ::stb_vorbis_decode_memory(static_cast<const unsigned char*>(inFileContent), static_cast<int>(inFileSize), &outChannels, &outSampleRate, &outSamplesI16);
-			defer { ::free(outSamplesI16); };
-			if (outSamplesI16 == nullptr || outFrameCount < 0)
-				return DecodeFileResult::Sadge;
-
-			const size_t totalSampleCount = static_cast<size_t>(outFrameCount * outChannels);
-			outBuffer.ChannelCount = static_cast<u32>(outChannels);
-			outBuffer.SampleRate = static_cast<u32>(outSampleRate);
-			outBuffer.FrameCount = static_cast<i64>(outFrameCount);
-			// outBuffer.InterleavedSamples = std::make_unique<i16[]>(totalSampleCount);
-			outBuffer.InterleavedSamples = std::unique_ptr<i16[]>(new i16[totalSampleCount]);
-			if (outBuffer.InterleavedSamples == nullptr)
-				return DecodeFileResult::Sadge;
-
-			// TODO: Prevent copy by.. overwriting malloc? or manually read chunks
-			::memcpy(outBuffer.InterleavedSamples.get(), outSamplesI16, totalSampleCount * sizeof(i16));
-		} break;
-
-		case SupportedFileFormat::WAV:
-		{
-			u32 outChannels = {};
-			u32 outSampleRate = {};
-			u64 outFrameCount = {};
-			i16* outSamplesI16 = ::drwav_open_memory_and_read_pcm_frames_s16(inFileContent, inFileSize, &outChannels, &outSampleRate, &outFrameCount, nullptr);
-			defer { ::drwav_free(outSamplesI16, nullptr); };
-			if (outSamplesI16 == nullptr)
-				return DecodeFileResult::Sadge;
-
-			const size_t totalSampleCount = static_cast<size_t>(outFrameCount * outChannels);
-			outBuffer.ChannelCount = static_cast<u32>(outChannels);
-			outBuffer.SampleRate = static_cast<u32>(outSampleRate);
-			outBuffer.FrameCount = static_cast<i64>(outFrameCount);
-			// outBuffer.InterleavedSamples = std::make_unique<i16[]>(totalSampleCount);
-			outBuffer.InterleavedSamples = std::unique_ptr<i16[]>(new i16[totalSampleCount]);
-			if (outBuffer.InterleavedSamples == nullptr)
-				return DecodeFileResult::Sadge;
-
-			// TODO: Prevent copy by passing down custom allocator or manually read chunks
-			::memcpy(outBuffer.InterleavedSamples.get(), outSamplesI16, totalSampleCount * sizeof(i16));
-		} break;
-
-		case SupportedFileFormat::FLAC:
-		{
-			u32 outChannels = {};
-			u32 outSampleRate = {};
-			u64 outFrameCount = {};
-			i16* outSamplesI16 = ::drflac_open_memory_and_read_pcm_frames_s16(inFileContent, inFileSize, &outChannels, &outSampleRate, &outFrameCount, nullptr);
-			defer { ::drflac_free(outSamplesI16, nullptr); };
-			if (outSamplesI16 == nullptr)
-				return DecodeFileResult::Sadge;
-
-			const size_t totalSampleCount = static_cast<size_t>(outFrameCount * outChannels);
-			outBuffer.ChannelCount = static_cast<u32>(outChannels);
-			outBuffer.SampleRate = static_cast<u32>(outSampleRate);
-			outBuffer.FrameCount = static_cast<i64>(outFrameCount);
-			// outBuffer.InterleavedSamples = std::make_unique<i16[]>(totalSampleCount);
-			outBuffer.InterleavedSamples = std::unique_ptr<i16[]>(new i16[totalSampleCount]);
-			if (outBuffer.InterleavedSamples == nullptr)
-				return DecodeFileResult::Sadge;
-
-			// TODO: Prevent copy by passing down custom allocator or manually read chunks
-			::memcpy(outBuffer.InterleavedSamples.get(), outSamplesI16, totalSampleCount * sizeof(i16));
-		} break;
-
-		case SupportedFileFormat::MP3:
+		impl = std::make_unique<Impl>();
+		if (!impl->OpenCodec(fileFormat, inFileContent, inFileSize))
 		{
-			::drmp3_config outConfig = {};
-			::drmp3_uint64 outFrameCount = {};
-			::drmp3d_sample_t* outSamplesI16 = ::drmp3_open_memory_and_read_pcm_frames_s16(inFileContent, inFileSize, &outConfig, &outFrameCount, nullptr);
-			defer { ::drmp3_free(outSamplesI16, nullptr); };
-			if (outSamplesI16 == nullptr)
-				return DecodeFileResult::Sadge;
-
-			const size_t totalSampleCount = static_cast<size_t>(outFrameCount * outConfig.channels);
-			outBuffer.ChannelCount = static_cast<u32>(outConfig.channels);
-			outBuffer.SampleRate = static_cast<u32>(outConfig.sampleRate);
-			outBuffer.FrameCount = static_cast<i64>(outFrameCount);
-			// outBuffer.InterleavedSamples = std::make_unique<i16[]>(totalSampleCount);
-			outBuffer.InterleavedSamples = std::unique_ptr<i16[]>(new i16[totalSampleCount]);
-			if (outBuffer.InterleavedSamples == nullptr)
-				return DecodeFileResult::Sadge;
-
-			// TODO: Prevent copy by passing down custom allocator or manually read chunks
-			::memcpy(outBuffer.InterleavedSamples.get(), outSamplesI16, totalSampleCount * sizeof(i16));
-		} break;
-
-		default:
-		{
-			assert(!"Unhandled file format switch case");
+			Close();
 			return DecodeFileResult::Sadge;
-		} break;
 		}
 
+		impl->TargetSampleRate = (targetSampleRate != 0) ? targetSampleRate : impl->SourceSampleRate;
+		impl->TotalFrameCount = !impl->IsResampling() ? impl->SourceFrameCount : PolyphaseResampler::GetOutputFrameCount(impl->SourceFrameCount, impl->SourceSampleRate, impl->TargetSampleRate);
+		if (impl->IsResampling())
+			impl->Resampler.Initialize(impl->SourceSampleRate, impl->TargetSampleRate, impl->ChannelCount);
+
+		const size_t totalSampleCount = static_cast<size_t>(impl->TotalFrameCount * impl->ChannelCount);
+		outBuffer.InterleavedSamples = std::unique_ptr<i16[]>(new i16[totalSampleCount]);
+
+		impl->OutputSamples = outBuffer.InterleavedSamples.get();
+		impl->PublishedFrameCount = std::make_shared<std::atomic<i64>>(0);
+
+		outBuffer.ChannelCount = impl->ChannelCount;
+		outBuffer.SampleRate = impl->TargetSampleRate;
+		outBuffer.FrameCount = impl->TotalFrameCount;
+		outBuffer.StreamingDecodedFrameCount = impl->PublishedFrameCount;
+		return DecodeFileResult::FeelsGoodMan;
+	}
+
+	void StreamingDecoder::Close()
+	{
+		if (impl != nullptr)
+			impl->CloseCodec();
+		impl = nullptr;
+	}
+
+	b8 StreamingDecoder::DecodeNextChunk()
+	{
+		if (impl == nullptr || impl->IsFinished)
+			return false;
+		return impl->DecodeNextChunk();
+	}
+
+	b8 StreamingDecoder::DecodeAllRemainingChunks()
+	{
+		if (impl == nullptr)
+			return false;
+
+		while (DecodeNextChunk())
+		{
+			if (impl->CancelRequested.load(std::memory_order_relaxed))
+				return false;
+		}
+		return impl->IsFinished;
+	}
+
+	void StreamingDecoder::RequestCancel()
+	{
+		if (impl != nullptr)
+			impl->CancelRequested.store(true, std::memory_order_relaxed);
+	}
+
+	i64 StreamingDecoder::GetDecodedFrameCount() const { return (impl != nullptr) ? impl->WrittenFrameCount : 0; }
+	i64 StreamingDecoder::GetTotalFrameCount() const { return (impl != nullptr) ? impl->TotalFrameCount : 0; }
+	b8 StreamingDecoder::IsFinished() const { return (impl != nullptr) ? impl->IsFinished : false; }
+
+	DecodeFileResult DecodeEntireFile(std::string_view fileNameWithExtension, const void* inFileContent, size_t inFileSize, PCMSampleBuffer& outBuffer, u32 targetSampleRate)
+	{
+		StreamingDecoder decoder {};
+		if (decoder.Open(fileNameWithExtension, inFileContent, inFileSize, outBuffer, targetSampleRate) != DecodeFileResult::FeelsGoodMan)
+			return DecodeFileResult::Sadge;
+
+		decoder.DecodeAllRemainingChunks();
+		assert(decoder.IsFinished());
+
+		// NOTE: Everything has been decoded so there's no need to keep checking the decoded frame count
+		outBuffer.StreamingDecodedFrameCount = nullptr;
 		return DecodeFileResult::FeelsGoodMan;
 	}
+
+	void EncodeWaveFile(const i16* inInterleavedSamples, i64 frameCount, u32 channelCount, u32 sampleRate, std::vector<u8>& outFileContent)
+	{
+		const u32 dataByteSize = static_cast<u32>(frameCount * channelCount * sizeof(i16));
+		const u32 byteRate = (sampleRate * channelCount * sizeof(i16));
+		const u16 blockAlign = static_cast<u16>(channelCount * sizeof(i16)), bitsPerSample = 16, formatPCM = 1, channelCountU16 = static_cast<u16>(channelCount);
+		const u32 riffByteSize = (36 + dataByteSize), fmtByteSize = 16;
+
+		// NOTE: Written member by member, assuming a little endian host just like the rest of the code base
+		auto& out = outFileContent;
+		out.reserve(out.size() + 44 + dataByteSize);
+		auto write = [&out](const void* data, size_t size) { out.insert(out.end(), static_cast<const u8*>(data), static_cast<const u8*>(data) + size); };
+		write("RIFF", 4); write(&riffByteSize, 4); write("WAVE", 4);
+		write("fmt ", 4); write(&fmtByteSize, 4); write(&formatPCM, 2); write(&channelCountU16, 2); write(&sampleRate, 4); write(&byteRate, 4); write(&blockAlign, 2); write(&bitsPerSample, 2);
+		write("data", 4); write(&dataByteSize, 4);
+		if (dataByteSize > 0)
+			write(inInterleavedSamples, dataByteSize);
+	}
 }
@@ -33,8 +33,42 @@ namespace Audio
 
 	SupportedFileFormat TryToDetermineFileFormatFromExtension(std::string_view fileName);
 
-	// TODO: Also expose file streaming API if / when it's needed
-	//		 but for now everything will be stored in one big continuous buffer since it greatly reduces complexity.
-	//		 Instead of constantly reading a streamed file from disk it might also be an option to read the entire file upfront but then only decode chunks on demand (?)
-	DecodeFileResult DecodeEntireFile(std::string_view fileNameWithExtension, const void* inFileContent, size_t inFileSize, PCMSampleBuffer& outBuffer);
+	// NOTE: Decodes an entire in-memory file one chunk at a time, directly into the final (pre-allocated) sample buffer so that no intermediate copy of the entire song is ever needed.
+	//		 Everything is still stored in one big continuous buffer since it greatly reduces complexity, however the number of frames decoded so far is published after each chunk
+	//		 so that other threads can already start playing back (and generating waveforms for) the beginning of the buffer while the rest of the file is still being decoded
+	struct StreamingDecoder : NonCopyable
+	{
+		// NOTE: Small enough for the first chunk to be audible almost immediately, large enough for the per-chunk overhead to not matter
+		static constexpr i64 ChunkFrameCount = 16384;
+
+		StreamingDecoder();
+		~StreamingDecoder();
+
+		// NOTE: Allocates the entire output buffer upfront. The input file content must be kept alive until the decoder is closed (or destroyed)
+		//		 and the output buffer may be moved freely, as long as its sample array isn't freed before the decoder has finished or been cancelled.
+		//		 Resamples to the target sample rate on the fly if it is non-zero and differs from the sample rate of the file itself
+		DecodeFileResult Open(std::string_view fileNameWithExtension, const void* inFileContent, size_t inFileSize, PCMSampleBuffer& outBuffer, u32 targetSampleRate = 0);
+		void Close();
+
+		// NOTE: Returns false once every frame has been published (also in case of a decoding error, after having filled the rest of the buffer with silence)
+		b8 DecodeNextChunk();
+		// NOTE: Returns false if cancelled before reaching the end, in which case the rest of the buffer remains unpublished
+		b8 DecodeAllRemainingChunks();
+
+		// NOTE: Can be called from any thread to make DecodeAllRemainingChunks() return early
+		void RequestCancel();
+
+		i64 GetDecodedFrameCount() const;
+		i64 GetTotalFrameCount() const;
+		b8 IsFinished() const;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> impl;
+	};
+
+	DecodeFileResult DecodeEntireFile(std::string_view fileNameWithExtension, const void* inFileContent, size_t inFileSize, PCMSampleBuffer& outBuffer, u32 targetSampleRate = 0);
+
+	// NOTE: Canonical 44 byte RIFF header followed by the raw interleaved 16-bit PCM data, appended to the end of the output vector
+	void EncodeWaveFile(const i16* inInterleavedSamples, i64 frameCount, u32 channelCount, u32 sampleRate, std::vector<u8>& outFileContent);
 }
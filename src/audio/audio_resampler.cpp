@@ -0,0 +1,366 @@
+#include "audio_resampler.h"
+#include "audio_common.h"
+#include <math.h>
+#include <numeric>
+
+#include <array>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define PEEPO_AUDIO_SSE2_RESAMPLER 1
+#include <emmintrin.h>
+#else
+#define PEEPO_AUDIO_SSE2_RESAMPLER 0
+#endif
+
+#if PEEPO_AUDIO_AVX2
+#define PEEPO_AUDIO_AVX2_RESAMPLER 1
+#include <immintrin.h>
+#else
+#define PEEPO_AUDIO_AVX2_RESAMPLER 0
+#endif
+
+namespace Audio
+{
+	static_assert((PolyphaseResampler::TapCount % 32) == 0);
+	static constexpr f64 PiF64 = 3.14159265358979323846;
+
+	// NOTE: Zeroth order modified bessel function of the first kind, the power series converges quickly enough for all beta values worth using
+	static f64 BesselI0(f64 x)
+	{
+		f64 sum = 1.0, term = 1.0;
+		const f64 halfXSquared = (x * x) * 0.25;
+		for (i32 k = 1; k < 64; k++)
+		{
+			term *= halfXSquared / static_cast<f64>(k * k);
+			sum += term;
+			if (term < (sum * 1e-17))
+				break;
+		}
+		return sum;
+	}
+
+	static f64 NormalizedSinc(f64 x)
+	{
+		if (x == 0.0)
+			return 1.0;
+		const f64 piX = (PiF64 * x);
+		return ::sin(piX) / piX;
+	}
+
+	// NOTE: Coefficients are stored as fixed point numbers so that the products of multiple taps can be summed using a single (16-bit multiply-add) SIMD instruction.
+	//		 With the absolute sum of all taps of a phase reaching a bit above two, this leaves enough headroom for full scale input to never overflow the 32-bit accumulators
+	static constexpr i32 CoefficientFractionBits = 14;
+	static constexpr i32 CoefficientOne = (1 << CoefficientFractionBits);
+	static constexpr i32 CoefficientRoundingBias = (1 << (CoefficientFractionBits - 1));
+
+	// NOTE: Source window offset and coefficient offset of the first tap, for each of the output frames of a batch
+	struct TapPosition
+	{
+		size_t WindowOffset;
+		size_t CoefficientOffset;
+	};
+
+	using ConvolveBatchFunc = void(*)(const i16* window, const i16* coefficients, const TapPosition* positions, size_t count, i16* outSamples, size_t outSampleStride);
+
+	static inline i16 RoundSumToSample(i32 sum)
+	{
+		return static_cast<i16>(Clamp<i32>((sum + CoefficientRoundingBias) >> CoefficientFractionBits, I16Min, I16Max));
+	}
+
+#if PEEPO_AUDIO_SSE2_RESAMPLER
+	// NOTE: Rounds the four 32-bit sums down to samples and writes them out, with the pack instruction already doing all of the clamping
+	static inline void StoreFourSums(__m128i sums, i16* outSamples, size_t outSampleStride)
+	{
+		const __m128i shifted = _mm_srai_epi32(_mm_add_epi32(sums, _mm_set1_epi32(CoefficientRoundingBias)), CoefficientFractionBits);
+		const __m128i packed = _mm_packs_epi32(shifted, shifted);
+		if (outSampleStride == 1)
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(outSamples), packed);
+		}
+		else
+		{
+			outSamples[0 * outSampleStride] = static_cast<i16>(_mm_extract_epi16(packed, 0));
+			outSamples[1 * outSampleStride] = static_cast<i16>(_mm_extract_epi16(packed, 1));
+			outSamples[2 * outSampleStride] = static_cast<i16>(_mm_extract_epi16(packed, 2));
+			outSamples[3 * outSampleStride] = static_cast<i16>(_mm_extract_epi16(packed, 3));
+		}
+	}
+
+	static inline __m128i ConvolveTapsSSE2(const i16* samples, const i16* taps)
+	{
+		__m128i sum0 = _mm_setzero_si128(), sum1 = _mm_setzero_si128();
+		for (i32 tap = 0; tap < PolyphaseResampler::TapCount; tap += 16)
+		{
+			sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + tap + 0)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps + tap + 0))));
+			sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + tap + 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps + tap + 8))));
+		}
+		return _mm_add_epi32(sum0, sum1);
+	}
+#endif
+
+	static void ConvolveBatchScalarOrSSE2(const i16* window, const i16* coefficients, const TapPosition* positions, size_t count, i16* outSamples, size_t outSampleStride)
+	{
+		size_t i = 0;
+#if PEEPO_AUDIO_SSE2_RESAMPLER
+		// NOTE: Four output frames at a time so that their horizontal sums can share the same transposing adds
+		for (; (i + 4) <= count; i += 4)
+		{
+			const __m128i sum0 = ConvolveTapsSSE2(window + positions[i + 0].WindowOffset, coefficients + positions[i + 0].CoefficientOffset);
+			const __m128i sum1 = ConvolveTapsSSE2(window + positions[i + 1].WindowOffset, coefficients + positions[i + 1].CoefficientOffset);
+			const __m128i sum2 = ConvolveTapsSSE2(window + positions[i + 2].WindowOffset, coefficients + positions[i + 2].CoefficientOffset);
+			const __m128i sum3 = ConvolveTapsSSE2(window + positions[i + 3].WindowOffset, coefficients + positions[i + 3].CoefficientOffset);
+
+			const __m128i sum01Low = _mm_unpacklo_epi32(sum0, sum1), sum01High = _mm_unpackhi_epi32(sum0, sum1);
+			const __m128i sum23Low = _mm_unpacklo_epi32(sum2, sum3), sum23High = _mm_unpackhi_epi32(sum2, sum3);
+			const __m128i sums = _mm_add_epi32(
+				_mm_add_epi32(_mm_unpacklo_epi64(sum01Low, sum23Low), _mm_unpackhi_epi64(sum01Low, sum23Low)),
+				_mm_add_epi32(_mm_unpacklo_epi64(sum01High, sum23High), _mm_unpackhi_epi64(sum01High, sum23High)));
+			StoreFourSums(sums, outSamples + (i * outSampleStride), outSampleStride);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			const i16* samples = (window + positions[i].WindowOffset);
+			const i16* taps = (coefficients + positions[i].CoefficientOffset);
+
+			i32 sum = 0;
+			for (i32 tap = 0; tap < PolyphaseResampler::TapCount; tap++)
+				sum += static_cast<i32>(samples[tap]) * static_cast<i32>(taps[tap]);
+			outSamples[i * outSampleStride] = RoundSumToSample(sum);
+		}
+	}
+
+#if PEEPO_AUDIO_AVX2_RESAMPLER
+	PEEPO_AUDIO_TARGET_AVX2 static inline __m128i ConvolveTapsAVX2(const i16* samples, const i16* taps)
+	{
+		__m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+		for (i32 tap = 0; tap < PolyphaseResampler::TapCount; tap += 32)
+		{
+			sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + tap + 0)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(taps + tap + 0))));
+			sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + tap + 16)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(taps + tap + 16))));
+		}
+		const __m256i sum = _mm256_add_epi32(sum0, sum1);
+		return _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	}
+
+	PEEPO_AUDIO_TARGET_AVX2 static void ConvolveBatchAVX2(const i16* window, const i16* coefficients, const TapPosition* positions, size_t count, i16* outSamples, size_t outSampleStride)
+	{
+		size_t i = 0;
+		for (; (i + 4) <= count; i += 4)
+		{
+			const __m128i sum0 = ConvolveTapsAVX2(window + positions[i + 0].WindowOffset, coefficients + positions[i + 0].CoefficientOffset);
+			const __m128i sum1 = ConvolveTapsAVX2(window + positions[i + 1].WindowOffset, coefficients + positions[i + 1].CoefficientOffset);
+			const __m128i sum2 = ConvolveTapsAVX2(window + positions[i + 2].WindowOffset, coefficients + positions[i + 2].CoefficientOffset);
+			const __m128i sum3 = ConvolveTapsAVX2(window + positions[i + 3].WindowOffset, coefficients + positions[i + 3].CoefficientOffset);
+			StoreFourSums(_mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1), _mm_hadd_epi32(sum2, sum3)), outSamples + (i * outSampleStride), outSampleStride);
+		}
+		if (i < count)
+			ConvolveBatchScalarOrSSE2(window, coefficients, positions + i, (count - i), outSamples + (i * outSampleStride), outSampleStride);
+	}
+#endif
+
+	static ConvolveBatchFunc GetConvolveBatchFunc()
+	{
+#if PEEPO_AUDIO_AVX2_RESAMPLER
+		static const ConvolveBatchFunc func = CPUSupportsAVX2() ? ConvolveBatchAVX2 : ConvolveBatchScalarOrSSE2;
+		return func;
+#else
+		return ConvolveBatchScalarOrSSE2;
+#endif
+	}
+
+	void PolyphaseResampler::Initialize(u32 sourceSampleRate, u32 targetSampleRate, u32 inChannelCount)
+	{
+		assert(sourceSampleRate > 0 && targetSampleRate > 0 && inChannelCount > 0);
+		constexpr i32 halfTapCount = (TapCount / 2);
+
+		const u32 commonDivisor = std::gcd(sourceSampleRate, targetSampleRate);
+		channelCount = inChannelCount;
+		upFactor = (targetSampleRate / commonDivisor);
+		downFactor = (sourceSampleRate / commonDivisor);
+		phaseCount = Min(upFactor, MaxPhaseCount);
+		wholeFramesPerStep = (downFactor / upFactor);
+		phasePerStep = (downFactor % upFactor);
+
+		// NOTE: Transition band width of the Kaiser window in cycles per source frame, with the cutoff then placed half of it below the nyquist frequency
+		const f64 stopbandAttenuationDB = (KaiserBeta / 0.1102) + 8.7;
+		const f64 transitionWidth = (stopbandAttenuationDB - 7.95) / (14.36 * static_cast<f64>(TapCount));
+		const f64 nyquist = 0.5 * Min(1.0, static_cast<f64>(upFactor) / static_cast<f64>(downFactor));
+		const f64 cutoff = (nyquist - (transitionWidth * 0.5));
+		const f64 besselI0Beta = BesselI0(KaiserBeta);
+
+		coefficients.resize(static_cast<size_t>(phaseCount) * TapCount);
+		for (u32 phase = 0; phase < phaseCount; phase++)
+		{
+			const f64 phaseFraction = static_cast<f64>(phase) / static_cast<f64>(phaseCount);
+
+			std::array<f64, TapCount> tapValues;
+			f64 tapSum = 0.0;
+			for (i32 tap = 0; tap < TapCount; tap++)
+			{
+				// NOTE: Distance between the output position and the source frame this tap is applied to
+				const f64 distance = phaseFraction + static_cast<f64>(halfTapCount - 1 - tap);
+				const f64 normalizedDistance = (distance / static_cast<f64>(halfTapCount));
+				const f64 window = BesselI0(KaiserBeta * ::sqrt(ClampBot(1.0 - (normalizedDistance * normalizedDistance), 0.0))) / besselI0Beta;
+
+				tapValues[tap] = (2.0 * cutoff) * NormalizedSinc(2.0 * cutoff * distance) * window;
+				tapSum += tapValues[tap];
+			}
+
+			// NOTE: Any rounding error is added onto the largest tap, so that the fixed point DC gain of every phase is still exactly one
+			i16* phaseTaps = &coefficients[static_cast<size_t>(phase) * TapCount];
+			i32 fixedTapSum = 0, fixedAbsoluteTapSum = 0, largestTap = 0;
+			for (i32 tap = 0; tap < TapCount; tap++)
+			{
+				phaseTaps[tap] = static_cast<i16>(::round((tapValues[tap] / tapSum) * static_cast<f64>(CoefficientOne)));
+				fixedTapSum += phaseTaps[tap];
+				fixedAbsoluteTapSum += Absolute(static_cast<i32>(phaseTaps[tap]));
+				if (Absolute(phaseTaps[tap]) > Absolute(phaseTaps[largestTap]))
+					largestTap = tap;
+			}
+			phaseTaps[largestTap] = static_cast<i16>(phaseTaps[largestTap] + (CoefficientOne - fixedTapSum));
+			assert(fixedAbsoluteTapSum <= ((I32Max - CoefficientRoundingBias) / -static_cast<i32>(I16Min)));
+		}
+
+		// NOTE: Silent lead-in so that the very first output frames can be centered on source frame zero just like all others
+		channelWindows.resize(channelCount);
+		for (auto& window : channelWindows)
+			window.assign(static_cast<size_t>(halfTapCount - 1), 0);
+		windowStartFrame = -(halfTapCount - 1);
+
+		nextSourceFrame = 0;
+		nextSourcePhase = 0;
+	}
+
+	i64 PolyphaseResampler::Process(const i16* inInterleavedSamples, i64 inFrameCount, i16* outInterleavedSamples, i64 outMaxFrameCount)
+	{
+		AppendSourceFrames(inInterleavedSamples, inFrameCount);
+		const i64 framesWritten = WriteAvailableOutputFrames(outInterleavedSamples, outMaxFrameCount);
+		DiscardConsumedSourceFrames();
+		return framesWritten;
+	}
+
+	i64 PolyphaseResampler::ProcessEndOfInput(i16* outInterleavedSamples, i64 outMaxFrameCount)
+	{
+		if (outMaxFrameCount <= 0)
+			return 0;
+
+		// NOTE: Enough silence for the taps of every remaining output frame, with a bit of extra room for the phase rounding
+		const i64 windowEndFrame = windowStartFrame + static_cast<i64>(channelWindows.empty() ? 0 : channelWindows[0].size());
+		const i64 lastRequiredSourceFrame = nextSourceFrame + ((outMaxFrameCount * static_cast<i64>(downFactor)) / static_cast<i64>(upFactor)) + TapCount + 2;
+		AppendSilentFrames(ClampBot<i64>(lastRequiredSourceFrame - windowEndFrame, 0));
+
+		const i64 framesWritten = WriteAvailableOutputFrames(outInterleavedSamples, outMaxFrameCount);
+		DiscardConsumedSourceFrames();
+		return framesWritten;
+	}
+
+	i64 PolyphaseResampler::GetOutputFrameCount(i64 sourceFrameCount, u32 sourceSampleRate, u32 targetSampleRate)
+	{
+		return static_cast<i64>(static_cast<f64>(sourceFrameCount) * static_cast<f64>(targetSampleRate) / static_cast<f64>(sourceSampleRate) + 0.5);
+	}
+
+	void PolyphaseResampler::AppendSourceFrames(const i16* inInterleavedSamples, i64 inFrameCount)
+	{
+		for (u32 channel = 0; channel < channelCount; channel++)
+		{
+			std::vector<i16>& window = channelWindows[channel];
+			const size_t previousSize = window.size();
+			window.resize(previousSize + static_cast<size_t>(inFrameCount));
+
+			i16* outSamples = &window[previousSize];
+			const i16* inSamples = (inInterleavedSamples + channel);
+			for (i64 frame = 0; frame < inFrameCount; frame++)
+				outSamples[frame] = inSamples[frame * channelCount];
+		}
+	}
+
+	void PolyphaseResampler::AppendSilentFrames(i64 frameCount)
+	{
+		for (auto& window : channelWindows)
+			window.resize(window.size() + static_cast<size_t>(frameCount), 0);
+	}
+
+	i64 PolyphaseResampler::WriteAvailableOutputFrames(i16* outInterleavedSamples, i64 outMaxFrameCount)
+	{
+		constexpr i32 halfTapCount = (TapCount / 2);
+		if (channelWindows.empty())
+			return 0;
+
+		const i64 windowEndFrame = windowStartFrame + static_cast<i64>(channelWindows[0].size());
+		const b8 hasExactPhases = (phaseCount == upFactor);
+
+		const ConvolveBatchFunc convolveBatch = GetConvolveBatchFunc();
+		std::array<TapPosition, 256> batchPositions;
+
+		i64 framesWritten = 0;
+		while (framesWritten < outMaxFrameCount)
+		{
+			// NOTE: Positions of an entire batch are determined upfront, so that the convolution kernel can be selected once and then loop over all channels uninterrupted
+			size_t batchCount = 0;
+			while (batchCount < batchPositions.size() && (framesWritten + static_cast<i64>(batchCount)) < outMaxFrameCount)
+			{
+				u32 phase = nextSourcePhase;
+				i64 firstTapFrame = nextSourceFrame - (halfTapCount - 1);
+				if (!hasExactPhases)
+				{
+					phase = static_cast<u32>(((static_cast<u64>(nextSourcePhase) * phaseCount) + (upFactor / 2)) / upFactor);
+					if (phase >= phaseCount) { phase = 0; firstTapFrame++; }
+				}
+
+				if ((firstTapFrame + TapCount) > windowEndFrame)
+					break;
+
+				batchPositions[batchCount++] = TapPosition { static_cast<size_t>(firstTapFrame - windowStartFrame), static_cast<size_t>(phase) * TapCount };
+				nextSourceFrame += wholeFramesPerStep;
+				nextSourcePhase += phasePerStep;
+				if (nextSourcePhase >= upFactor) { nextSourcePhase -= upFactor; nextSourceFrame++; }
+			}
+
+			if (batchCount == 0)
+				break;
+
+			for (u32 channel = 0; channel < channelCount; channel++)
+				convolveBatch(channelWindows[channel].data(), coefficients.data(), batchPositions.data(), batchCount, (outInterleavedSamples + (framesWritten * channelCount) + channel), channelCount);
+			framesWritten += static_cast<i64>(batchCount);
+		}
+
+		return framesWritten;
+	}
+
+	void PolyphaseResampler::DiscardConsumedSourceFrames()
+	{
+		constexpr i32 halfTapCount = (TapCount / 2);
+		const i64 firstStillNeededFrame = nextSourceFrame - (halfTapCount - 1);
+		const i64 framesToDiscard = Clamp<i64>(firstStillNeededFrame - windowStartFrame, 0, channelWindows.empty() ? 0 : static_cast<i64>(channelWindows[0].size()));
+
+		for (auto& window : channelWindows)
+			window.erase(window.begin(), window.begin() + static_cast<size_t>(framesToDiscard));
+		windowStartFrame += framesToDiscard;
+	}
+
+	void ResampleBuffer(std::unique_ptr<i16[]>& inOutSamples, i64& inOutFrameCount, u32& inOutSampleRate, const u32 inChannelCount, const u32 targetSampleRate)
+	{
+		if (inOutSampleRate == targetSampleRate) { assert(false); return; }
+		constexpr i64 chunkFrameCount = 16384;
+
+		const i64 outFrameCount = PolyphaseResampler::GetOutputFrameCount(inOutFrameCount, inOutSampleRate, targetSampleRate);
+		auto outSamples = std::unique_ptr<i16[]>(new i16[static_cast<size_t>(outFrameCount * inChannelCount)]);
+
+		PolyphaseResampler resampler {};
+		resampler.Initialize(inOutSampleRate, targetSampleRate, inChannelCount);
+
+		i64 writtenFrameCount = 0;
+		for (i64 readFrameCount = 0; readFrameCount < inOutFrameCount; readFrameCount += chunkFrameCount)
+		{
+			const i64 framesToRead = Min(chunkFrameCount, (inOutFrameCount - readFrameCount));
+			writtenFrameCount += resampler.Process(&inOutSamples[readFrameCount * inChannelCount], framesToRead, &outSamples[writtenFrameCount * inChannelCount], (outFrameCount - writtenFrameCount));
+		}
+		writtenFrameCount += resampler.ProcessEndOfInput(&outSamples[writtenFrameCount * inChannelCount], (outFrameCount - writtenFrameCount));
+		assert(writtenFrameCount == outFrameCount);
+
+		inOutSamples = std::move(outSamples);
+		inOutFrameCount = outFrameCount;
+		inOutSampleRate = targetSampleRate;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "core_types.h"
+#include <vector>
+#include <memory>
+
+namespace Audio
+{
+	// NOTE: Band limited (Kaiser windowed sinc) polyphase resampler between any two sample rates, with output frame N always lining up with source time N / targetSampleRate.
+	//		 The filter is placed so that its stopband starts right at the lower of the two nyquist frequencies, meaning nothing above it can alias back into the audible range.
+	//		 Input may be fed in arbitrarily sized chunks with the output being exactly the same as when resampling an entire buffer at once
+	class PolyphaseResampler
+	{
+	public:
+		// NOTE: Number of source frames each output frame is interpolated from, must be a multiple of the (unrolled) SIMD width
+		static constexpr i32 TapCount = 64;
+		// NOTE: Sample rate ratios requiring more filter phases than this (i.e. not sharing a large enough common divisor) round to the closest of these phases instead
+		static constexpr u32 MaxPhaseCount = 1024;
+		static constexpr f64 KaiserBeta = 8.0;
+
+	public:
+		PolyphaseResampler() = default;
+		~PolyphaseResampler() = default;
+
+	public:
+		void Initialize(u32 sourceSampleRate, u32 targetSampleRate, u32 channelCount);
+
+		// NOTE: Consumes all input frames and writes as many output frames as there are enough source frames for (up to outMaxFrameCount), returning the number written
+		i64 Process(const i16* inInterleavedSamples, i64 inFrameCount, i16* outInterleavedSamples, i64 outMaxFrameCount);
+		// NOTE: Treats everything past the last input frame as silence to write out the remaining (up to outMaxFrameCount) output frames
+		i64 ProcessEndOfInput(i16* outInterleavedSamples, i64 outMaxFrameCount);
+
+		static i64 GetOutputFrameCount(i64 sourceFrameCount, u32 sourceSampleRate, u32 targetSampleRate);
+
+	private:
+		void AppendSourceFrames(const i16* inInterleavedSamples, i64 inFrameCount);
+		void AppendSilentFrames(i64 frameCount);
+		i64 WriteAvailableOutputFrames(i16* outInterleavedSamples, i64 outMaxFrameCount);
+		void DiscardConsumedSourceFrames();
+
+	private:
+		u32 channelCount = 0;
+		u32 upFactor = 1, downFactor = 1, phaseCount = 1;
+		u32 wholeFramesPerStep = 1, phasePerStep = 0;
+
+		// NOTE: [phase][tap] fixed point coefficients, with each phase normalized to a DC gain of exactly one
+		std::vector<i16> coefficients;
+		// NOTE: [channel][frame] deinterleaved source frames starting at windowStartFrame, the first few of which are a silent lead-in for the very first output frames
+		std::vector<std::vector<i16>> channelWindows;
+		i64 windowStartFrame = 0;
+
+		// NOTE: Position of the next output frame in source frames, as an integer frame plus a phase in units of (1 / upFactor)
+		i64 nextSourceFrame = 0;
+		u32 nextSourcePhase = 0;
+	};
+
+	// NOTE: Resamples an entire buffer at once, still internally processed in chunks so that the intermediate float buffers stay small
+	void ResampleBuffer(std::unique_ptr<i16[]>& inOutSamples, i64& inOutFrameCount, u32& inOutSampleRate, const u32 inChannelCount, const u32 targetSampleRate);
+}
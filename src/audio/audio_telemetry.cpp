@@ -0,0 +1,220 @@
+#include "audio_telemetry.h"
+#include <algorithm>
+
+namespace Audio
+{
+	static constexpr u64 PackCallbackHistoryEntry(i64 durationNS, u32 frameCount, u32 activeVoiceCount)
+	{
+		return (static_cast<u64>(Clamp<i64>(durationNS, 0, U32Max)) << 32) | (static_cast<u64>(Min<u32>(frameCount, U16Max)) << 16) | static_cast<u64>(Min<u32>(activeVoiceCount, U16Max));
+	}
+
+	static constexpr size_t GetHistogramBinIndex(i64 durationNS)
+	{
+		size_t bin = 0;
+		for (i64 durationUS = (durationNS / 1000); durationUS > 0 && bin < (RenderTelemetryHistogramBinCount - 1); durationUS >>= 1)
+			bin++;
+		return bin;
+	}
+
+	static constexpr i64 GetBudgetNS(u32 frameCount, u32 sampleRate)
+	{
+		return (sampleRate > 0) ? ((static_cast<i64>(frameCount) * 1000000000) / sampleRate) : 0;
+	}
+
+	static constexpr Time NanosecondsToTime(i64 nanoseconds)
+	{
+		return Time::FromSec(static_cast<f64>(nanoseconds) / 1000000000.0);
+	}
+
+	Time RenderTelemetrySnapshot::EstimateDurationPercentile(f64 percentile) const
+	{
+		i64 totalCount = 0;
+		for (const i64 count : DurationHistogram)
+			totalCount += count;
+
+		if (totalCount <= 0)
+			return Time::Zero();
+
+		const f64 targetCount = (Clamp(percentile, 0.0, 100.0) / 100.0) * static_cast<f64>(totalCount);
+		i64 countSoFar = 0;
+		for (size_t bin = 0; bin < DurationHistogram.size(); bin++)
+		{
+			countSoFar += DurationHistogram[bin];
+			if (countSoFar > 0 && static_cast<f64>(countSoFar) >= targetCount)
+				return Min(GetRenderTelemetryHistogramBinEnd(bin), MaxDuration);
+		}
+		return MaxDuration;
+	}
+
+	void RenderTelemetry::RecordCallback(i64 durationNS, u32 frameCount, u32 sampleRate, u32 activeVoiceCount)
+	{
+		// NOTE: Only ever written to by the render thread, so there is no need for any (more expensive) atomic read-modify-write operations
+		const i64 callbackIndex = CallbackCount.load(std::memory_order_relaxed);
+		CallbackHistory[static_cast<size_t>(callbackIndex) % CallbackHistory.size()].store(PackCallbackHistoryEntry(durationNS, frameCount, activeVoiceCount), std::memory_order_relaxed);
+
+		RenderedFrameCount.store(RenderedFrameCount.load(std::memory_order_relaxed) + frameCount, std::memory_order_relaxed);
+		TotalDurationNS.store(TotalDurationNS.load(std::memory_order_relaxed) + durationNS, std::memory_order_relaxed);
+		if (durationNS > MaxDurationNS.load(std::memory_order_relaxed))
+			MaxDurationNS.store(durationNS, std::memory_order_relaxed);
+		if (durationNS > GetBudgetNS(frameCount, sampleRate))
+			OverBudgetCount.store(OverBudgetCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		std::atomic<i64>& binCount = DurationHistogram[GetHistogramBinIndex(durationNS)];
+		binCount.store(binCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		// NOTE: Published last so that a reader never sees a callback as counted before its history entry has been written
+		CallbackCount.store(callbackIndex + 1, std::memory_order_release);
+	}
+
+	void RenderTelemetry::Reset()
+	{
+		CallbackCount = 0;
+		RenderedFrameCount = 0;
+		OverBudgetCount = 0;
+		TotalDurationNS = 0;
+		MaxDurationNS = 0;
+		for (auto& binCount : DurationHistogram)
+			binCount = 0;
+		for (auto& entry : CallbackHistory)
+			entry = 0;
+	}
+
+	void RenderTelemetry::ReadInto(RenderTelemetrySnapshot& outSnapshot, u32 sampleRate) const
+	{
+		const i64 callbackCount = CallbackCount.load(std::memory_order_acquire);
+		outSnapshot.SampleRate = sampleRate;
+		outSnapshot.CallbackCount = callbackCount;
+		outSnapshot.RenderedFrameCount = RenderedFrameCount.load(std::memory_order_relaxed);
+		outSnapshot.OverBudgetCount = OverBudgetCount.load(std::memory_order_relaxed);
+		outSnapshot.TotalDuration = NanosecondsToTime(TotalDurationNS.load(std::memory_order_relaxed));
+		outSnapshot.MaxDuration = NanosecondsToTime(MaxDurationNS.load(std::memory_order_relaxed));
+		for (size_t bin = 0; bin < DurationHistogram.size(); bin++)
+			outSnapshot.DurationHistogram[bin] = DurationHistogram[bin].load(std::memory_order_relaxed);
+
+		// NOTE: The oldest entries might already be getting overwritten by newer callbacks while being read, which is fine for what this is used for
+		const i64 historyCount = Min<i64>(callbackCount, static_cast<i64>(CallbackHistory.size()));
+		outSnapshot.RecentCallbacks.clear();
+		outSnapshot.RecentCallbacks.reserve(static_cast<size_t>(historyCount));
+		for (i64 callbackIndex = (callbackCount - historyCount); callbackIndex < callbackCount; callbackIndex++)
+		{
+			const u64 entry = CallbackHistory[static_cast<size_t>(callbackIndex) % CallbackHistory.size()].load(std::memory_order_relaxed);
+			RenderTelemetryCallback& out = outSnapshot.RecentCallbacks.emplace_back();
+			out.CallbackIndex = callbackIndex;
+			out.FrameCount = static_cast<u32>((entry >> 16) & U16Max);
+			out.ActiveVoiceCount = static_cast<u32>(entry & U16Max);
+			out.Duration = NanosecondsToTime(static_cast<i64>(entry >> 32));
+			out.Budget = NanosecondsToTime(GetBudgetNS(out.FrameCount, sampleRate));
+		}
+	}
+
+	void RenderTelemetry::ReadRecentDurations(Time* outDurations, size_t count) const
+	{
+		const i64 callbackCount = CallbackCount.load(std::memory_order_acquire);
+		const i64 historyCount = Min<i64>(Min<i64>(callbackCount, static_cast<i64>(CallbackHistory.size())), static_cast<i64>(count));
+		const size_t paddingCount = (count - static_cast<size_t>(historyCount));
+		std::fill(outDurations, outDurations + paddingCount, Time::Zero());
+
+		for (i64 i = 0; i < historyCount; i++)
+		{
+			const i64 callbackIndex = (callbackCount - historyCount + i);
+			const u64 entry = CallbackHistory[static_cast<size_t>(callbackIndex) % CallbackHistory.size()].load(std::memory_order_relaxed);
+			outDurations[paddingCount + static_cast<size_t>(i)] = NanosecondsToTime(static_cast<i64>(entry >> 32));
+		}
+	}
+
+	std::string RenderTelemetrySnapshotToCSV(const RenderTelemetrySnapshot& snapshot)
+	{
+		std::string out;
+		out.reserve(64 + (snapshot.RecentCallbacks.size() * 48));
+		out += "callback_index,frame_count,active_voice_count,duration_us,budget_us,load_percent\n";
+
+		char b[128];
+		for (const RenderTelemetryCallback& callback : snapshot.RecentCallbacks)
+		{
+			const f64 loadPercent = (callback.Budget.ToSec() > 0.0) ? ((callback.Duration.ToSec() / callback.Budget.ToSec()) * 100.0) : 0.0;
+			out += std::string_view(b, sprintf_s(b, "%lld,%u,%u,%.3f,%.3f,%.2f\n",
+				static_cast<long long>(callback.CallbackIndex), callback.FrameCount, callback.ActiveVoiceCount, callback.Duration.ToMS() * 1000.0, callback.Budget.ToMS() * 1000.0, loadPercent));
+		}
+		return out;
+	}
+
+	static void AppendJSONEscapedString(std::string& out, std::string_view value)
+	{
+		out += '"';
+		for (const char c : value)
+		{
+			switch (c)
+			{
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if (static_cast<u8>(c) < 0x20) { char b[8]; out += std::string_view(b, sprintf_s(b, "\\u%04X", static_cast<u32>(c))); }
+				else { out += c; }
+				break;
+			}
+		}
+		out += '"';
+	}
+
+	std::string RenderTelemetrySnapshotToJSON(const RenderTelemetrySnapshot& snapshot)
+	{
+		std::string out;
+		out.reserve(1024 + (snapshot.RecentCallbacks.size() * 96) + (snapshot.VoiceCosts.size() * 160));
+
+		char b[256];
+		out += "{\n";
+		out += std::string_view(b, sprintf_s(b, "\t\"sample_rate\": %u,\n", snapshot.SampleRate));
+		out += std::string_view(b, sprintf_s(b, "\t\"callback_count\": %lld,\n", static_cast<long long>(snapshot.CallbackCount)));
+		out += std::string_view(b, sprintf_s(b, "\t\"rendered_frame_count\": %lld,\n", static_cast<long long>(snapshot.RenderedFrameCount)));
+		out += std::string_view(b, sprintf_s(b, "\t\"over_budget_count\": %lld,\n", static_cast<long long>(snapshot.OverBudgetCount)));
+		out += std::string_view(b, sprintf_s(b, "\t\"underrun_count\": %lld,\n", static_cast<long long>(snapshot.UnderrunCount)));
+		out += std::string_view(b, sprintf_s(b, "\t\"total_duration_ms\": %.3f,\n", snapshot.TotalDuration.ToMS()));
+		out += std::string_view(b, sprintf_s(b, "\t\"max_duration_us\": %.3f,\n", snapshot.MaxDuration.ToMS() * 1000.0));
+
+		static constexpr f64 percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+		out += "\t\"estimated_percentiles_us\": {";
+		for (size_t i = 0; i < ArrayCount(percentiles); i++)
+			out += std::string_view(b, sprintf_s(b, "%s\"p%g\": %.3f", (i > 0) ? ", " : " ", percentiles[i], snapshot.EstimateDurationPercentile(percentiles[i]).ToMS() * 1000.0));
+		out += " },\n";
+
+		out += "\t\"duration_histogram\": [\n";
+		for (size_t bin = 0; bin < snapshot.DurationHistogram.size(); bin++)
+		{
+			// NOTE: The last bin being open ended
+			const b8 isLastBin = ((bin + 1) == snapshot.DurationHistogram.size());
+			char binEnd[32] = "null";
+			if (!isLastBin)
+				sprintf_s(binEnd, "%g", GetRenderTelemetryHistogramBinEnd(bin).ToMS() * 1000.0);
+
+			out += std::string_view(b, sprintf_s(b, "\t\t{ \"start_us\": %g, \"end_us\": %s, \"count\": %lld }%s\n",
+				GetRenderTelemetryHistogramBinStart(bin).ToMS() * 1000.0, binEnd, static_cast<long long>(snapshot.DurationHistogram[bin]), isLastBin ? "" : ","));
+		}
+		out += "\t],\n";
+
+		out += "\t\"voice_costs\": [\n";
+		for (size_t i = 0; i < snapshot.VoiceCosts.size(); i++)
+		{
+			const RenderTelemetryVoiceCost& voice = snapshot.VoiceCosts[i];
+			out += "\t\t{ \"name\": ";
+			AppendJSONEscapedString(out, voice.Name);
+			out += std::string_view(b, sprintf_s(b, ", \"handle\": %u, \"callback_count\": %lld, \"total_us\": %.3f, \"max_us\": %.3f, \"last_us\": %.3f }%s\n",
+				voice.Handle, static_cast<long long>(voice.CallbackCount), voice.TotalDuration.ToMS() * 1000.0, voice.MaxDuration.ToMS() * 1000.0, voice.LastDuration.ToMS() * 1000.0, ((i + 1) < snapshot.VoiceCosts.size()) ? "," : ""));
+		}
+		out += "\t],\n";
+
+		out += "\t\"recent_callbacks\": [\n";
+		for (size_t i = 0; i < snapshot.RecentCallbacks.size(); i++)
+		{
+			const RenderTelemetryCallback& callback = snapshot.RecentCallbacks[i];
+			out += std::string_view(b, sprintf_s(b, "\t\t{ \"index\": %lld, \"frame_count\": %u, \"active_voice_count\": %u, \"duration_us\": %.3f, \"budget_us\": %.3f }%s\n",
+				static_cast<long long>(callback.CallbackIndex), callback.FrameCount, callback.ActiveVoiceCount, callback.Duration.ToMS() * 1000.0, callback.Budget.ToMS() * 1000.0, ((i + 1) < snapshot.RecentCallbacks.size()) ? "," : ""));
+		}
+		out += "\t]\n";
+		out += "}\n";
+
+		return out;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "core_types.h"
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+
+namespace Audio
+{
+	// NOTE: Log2 scale callback duration histogram, with the first bin counting everything below one microsecond, each bin N after that covering [2^(N-1), 2^N) microseconds
+	//		 and the last one also counting everything above (which at ~0.25 seconds is far beyond any buffer duration the engine supports anyway)
+	constexpr size_t RenderTelemetryHistogramBinCount = 20;
+	constexpr size_t RenderTelemetryCallbackHistoryCount = 4096;
+
+	constexpr Time GetRenderTelemetryHistogramBinStart(size_t bin) { return (bin == 0) ? Time::Zero() : Time::FromSec(static_cast<f64>(1ull << (bin - 1)) / 1000000.0); }
+	constexpr Time GetRenderTelemetryHistogramBinEnd(size_t bin) { return Time::FromSec(static_cast<f64>(1ull << bin) / 1000000.0); }
+
+	struct RenderTelemetryCallback
+	{
+		// NOTE: Counting all callbacks since the telemetry was last reset
+		i64 CallbackIndex;
+		u32 FrameCount;
+		u32 ActiveVoiceCount;
+		Time Duration;
+		// NOTE: Duration of the rendered audio itself, so the time by which the next buffer has to be ready
+		Time Budget;
+	};
+
+	struct RenderTelemetryVoiceCost
+	{
+		std::string Name;
+		u32 Handle;
+		i64 CallbackCount;
+		Time TotalDuration;
+		Time MaxDuration;
+		Time LastDuration;
+	};
+
+	struct RenderTelemetrySnapshot
+	{
+		u32 SampleRate;
+		i64 CallbackCount;
+		i64 RenderedFrameCount;
+		// NOTE: Callbacks that took longer than the duration of the audio they rendered, so missed their deadline if they were running in real-time
+		i64 OverBudgetCount;
+		// NOTE: Reported by the backend for when the output device ran out of frames to play (if the backend is able to detect it at all)
+		i64 UnderrunCount;
+		Time TotalDuration;
+		Time MaxDuration;
+		std::array<i64, RenderTelemetryHistogramBinCount> DurationHistogram;
+		// NOTE: Up to RenderTelemetryCallbackHistoryCount of the most recent callbacks, oldest first
+		std::vector<RenderTelemetryCallback> RecentCallbacks;
+		// NOTE: All currently alive voices, most expensive first
+		std::vector<RenderTelemetryVoiceCost> VoiceCosts;
+
+		// NOTE: End of the histogram bin the percentile (in the range [0, 100]) falls into, so only accurate to within a factor of two
+		Time EstimateDurationPercentile(f64 percentile) const;
+	};
+
+	// NOTE: Written exclusively by the render thread and safe to be read from any other thread at any time without ever locking. Every value is a separate
+	//		 relaxed atomic, so a snapshot taken mid-callback might be off by one callback between fields but no individual value can ever be torn
+	struct RenderTelemetry
+	{
+		std::atomic<i64> CallbackCount = 0;
+		std::atomic<i64> RenderedFrameCount = 0;
+		std::atomic<i64> OverBudgetCount = 0;
+		std::atomic<i64> TotalDurationNS = 0;
+		std::atomic<i64> MaxDurationNS = 0;
+		std::array<std::atomic<i64>, RenderTelemetryHistogramBinCount> DurationHistogram = {};
+		// NOTE: Duration in nanoseconds (upper 32 bits), frame count (middle 16 bits) and active voice count (lower 16 bits) of each callback,
+		//		 all packed into a single value so that each entry is always read as a whole. Indexed by callback count
+		std::array<std::atomic<u64>, RenderTelemetryCallbackHistoryCount> CallbackHistory = {};
+
+		void RecordCallback(i64 durationNS, u32 frameCount, u32 sampleRate, u32 activeVoiceCount);
+		// NOTE: Callbacks recorded while resetting might partially survive the reset
+		void Reset();
+		void ReadInto(RenderTelemetrySnapshot& outSnapshot, u32 sampleRate) const;
+		// NOTE: Durations of the most recent (count) callbacks, oldest first and with zero padding in front if there haven't been as many yet
+		void ReadRecentDurations(Time* outDurations, size_t count) const;
+	};
+
+	// NOTE: The CSV only contains the recent callbacks (one row each), the JSON additionally all of the accumulated counters, the histogram and voice costs
+	std::string RenderTelemetrySnapshotToCSV(const RenderTelemetrySnapshot& snapshot);
+	std::string RenderTelemetrySnapshotToJSON(const RenderTelemetrySnapshot& snapshot);
+}
@@ -0,0 +1,190 @@
+#include "audio_time_stretch.h"
+#include "audio_common.h"
+#include <math.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define PEEPO_AUDIO_SSE2_TIME_STRETCH 1
+#include <emmintrin.h>
+#else
+#define PEEPO_AUDIO_SSE2_TIME_STRETCH 0
+#endif
+
+namespace Audio
+{
+	static_assert((TimeStretcher::HopFrameCount % 16) == 0);
+
+	static f32 DotProduct(const f32* a, const f32* b, i32 count)
+	{
+		assert((count % 16) == 0);
+#if PEEPO_AUDIO_SSE2_TIME_STRETCH
+		__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps(), sum2 = _mm_setzero_ps(), sum3 = _mm_setzero_ps();
+		for (i32 i = 0; i < count; i += 16)
+		{
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i + 0), _mm_loadu_ps(b + i + 0)));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+			sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+			sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+		}
+		__m128 sum = _mm_add_ps(_mm_add_ps(sum0, sum1), _mm_add_ps(sum2, sum3));
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+		return _mm_cvtss_f32(sum);
+#else
+		f32 sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+		for (i32 i = 0; i < count; i += 4)
+		{
+			sum0 += a[i + 0] * b[i + 0];
+			sum1 += a[i + 1] * b[i + 1];
+			sum2 += a[i + 2] * b[i + 2];
+			sum3 += a[i + 3] * b[i + 3];
+		}
+		return (sum0 + sum1) + (sum2 + sum3);
+#endif
+	}
+
+	// NOTE: Clips the frame range to the frames actually inside the source, with the output being filled with silence upfront if any part of it lies outside
+	static b8 ClipFrameRangeToSourceAndFillSilence(i64 sourceFrameCount, i64 startFrame, i32 frameCount, f32* outSamples, size_t outSamplesPerFrame, i64& outFirstFrame, i64& outEndFrame)
+	{
+		outFirstFrame = Clamp<i64>(startFrame, 0, sourceFrameCount);
+		outEndFrame = Clamp<i64>(startFrame + frameCount, 0, sourceFrameCount);
+		if ((outEndFrame - outFirstFrame) < frameCount)
+			std::fill(outSamples, outSamples + (static_cast<size_t>(frameCount) * outSamplesPerFrame), 0.0f);
+		return (outEndFrame > outFirstFrame);
+	}
+
+	static void ReadStereoFramesF32(const i16* sourceInterleavedSamples, i64 sourceFrameCount, i64 startFrame, i32 frameCount, f32* outInterleavedSamples)
+	{
+		i64 firstFrame, endFrame;
+		if (!ClipFrameRangeToSourceAndFillSilence(sourceFrameCount, startFrame, frameCount, outInterleavedSamples, TimeStretcher::ChannelCount, firstFrame, endFrame))
+			return;
+
+		const i16* inSamples = &sourceInterleavedSamples[firstFrame * TimeStretcher::ChannelCount];
+		f32* outSamples = &outInterleavedSamples[(firstFrame - startFrame) * TimeStretcher::ChannelCount];
+		for (i64 i = 0; i < ((endFrame - firstFrame) * TimeStretcher::ChannelCount); i++)
+			outSamples[i] = static_cast<f32>(inSamples[i]);
+	}
+
+	static void ReadDownmixedFramesF32(const i16* sourceInterleavedSamples, i64 sourceFrameCount, i64 startFrame, i32 frameCount, f32* outSamples)
+	{
+		i64 firstFrame, endFrame;
+		if (!ClipFrameRangeToSourceAndFillSilence(sourceFrameCount, startFrame, frameCount, outSamples, 1, firstFrame, endFrame))
+			return;
+
+		for (i64 frame = firstFrame; frame < endFrame; frame++)
+			outSamples[frame - startFrame] = static_cast<f32>(static_cast<i32>(sourceInterleavedSamples[(frame * 2) + 0]) + static_cast<i32>(sourceInterleavedSamples[(frame * 2) + 1]));
+	}
+
+	TimeStretcher::TimeStretcher()
+	{
+		// NOTE: Periodic hann window, which for an overlap of exactly half a segment always sums up to a constant gain of one
+		for (i32 i = 0; i < SegmentFrameCount; i++)
+			window[i] = 0.5f - (0.5f * ::cosf((2.0f * PI * static_cast<f32>(i)) / static_cast<f32>(SegmentFrameCount)));
+
+		Reset(0.0);
+	}
+
+	void TimeStretcher::Reset(f64 newSourceFramePosition)
+	{
+		sourceFramePosition = newSourceFramePosition;
+		previousSegmentStart = 0;
+		hasPreviousSegment = false;
+		hopReadFrameIndex = HopFrameCount;
+	}
+
+	void TimeStretcher::Render(const i16* sourceInterleavedSamples, i64 sourceFrameCount, f32 speed, i16* outInterleavedSamples, i64 outFrameCount)
+	{
+		i64 framesRendered = 0;
+		while (framesRendered < outFrameCount)
+		{
+			if (hopReadFrameIndex >= HopFrameCount)
+				SynthesizeNextHop(sourceInterleavedSamples, sourceFrameCount, speed);
+
+			const i64 framesToCopy = Min<i64>(HopFrameCount - hopReadFrameIndex, outFrameCount - framesRendered);
+			const i16* hopBegin = &hopSamples[static_cast<size_t>(hopReadFrameIndex) * ChannelCount];
+			std::copy(hopBegin, hopBegin + (framesToCopy * ChannelCount), outInterleavedSamples + (framesRendered * ChannelCount));
+
+			hopReadFrameIndex += static_cast<i32>(framesToCopy);
+			framesRendered += framesToCopy;
+			sourceFramePosition += (static_cast<f64>(framesToCopy) * speed);
+		}
+	}
+
+	void TimeStretcher::SynthesizeNextHop(const i16* sourceInterleavedSamples, i64 sourceFrameCount, f32 speed)
+	{
+		// NOTE: Fade out of a virtual previous segment continuing from exactly the current position, so that the first hop after a reset neither has to fade in from silence
+		//		 nor start at the wrong position. Its natural continuation then also acts as the similarity target for the first real segment
+		if (!hasPreviousSegment)
+		{
+			previousSegmentStart = static_cast<i64>(Round(sourceFramePosition)) - HopFrameCount;
+			ReadStereoFramesF32(sourceInterleavedSamples, sourceFrameCount, previousSegmentStart + HopFrameCount, HopFrameCount, overlapSamples.data());
+			for (i32 f = 0; f < HopFrameCount; f++)
+			{
+				overlapSamples[(f * ChannelCount) + 0] *= window[HopFrameCount + f];
+				overlapSamples[(f * ChannelCount) + 1] *= window[HopFrameCount + f];
+			}
+			hasPreviousSegment = true;
+		}
+
+		// NOTE: Segments are placed so that the frame halfway through them lines up with where the source position will be at that point,
+		//		 meaning the first half of each segment (which together with the second half of the previous one makes up the next hop) starts slightly ahead or behind
+		const i64 nominalSegmentStart = static_cast<i64>(Round(sourceFramePosition + ((static_cast<f64>(speed) - 1.0) * static_cast<f64>(HopFrameCount))));
+		const i64 segmentStart = FindBestMatchingSegmentStart(sourceInterleavedSamples, sourceFrameCount, nominalSegmentStart);
+
+		ReadStereoFramesF32(sourceInterleavedSamples, sourceFrameCount, segmentStart, SegmentFrameCount, segmentSamples.data());
+		for (i32 f = 0; f < SegmentFrameCount; f++)
+		{
+			segmentSamples[(f * ChannelCount) + 0] *= window[f];
+			segmentSamples[(f * ChannelCount) + 1] *= window[f];
+		}
+
+		constexpr size_t hopSampleCount = (HopFrameCount * ChannelCount);
+		for (size_t i = 0; i < hopSampleCount; i++)
+			segmentSamples[i] += overlapSamples[i];
+
+		ConvertBusF32ToSamplesI16Clamped(segmentSamples.data(), hopSamples.data(), hopSampleCount, 1.0f);
+		std::copy(segmentSamples.begin() + hopSampleCount, segmentSamples.end(), overlapSamples.begin());
+
+		previousSegmentStart = segmentStart;
+		hopReadFrameIndex = 0;
+	}
+
+	i64 TimeStretcher::FindBestMatchingSegmentStart(const i16* sourceInterleavedSamples, i64 sourceFrameCount, i64 nominalSegmentStart)
+	{
+		// NOTE: The target being the waveform the previous segment would have naturally continued with, for the length of the overlap region
+		ReadDownmixedFramesF32(sourceInterleavedSamples, sourceFrameCount, previousSegmentStart + HopFrameCount, HopFrameCount, searchTargetSamples.data());
+		ReadDownmixedFramesF32(sourceInterleavedSamples, sourceFrameCount, nominalSegmentStart - SearchRadiusFrameCount, static_cast<i32>(searchCandidateSamples.size()), searchCandidateSamples.data());
+
+		// NOTE: Normalized by the energy of each candidate (updated incrementally while sliding along) so that louder sections aren't favored just for being louder
+		f64 candidateEnergy = 0.0;
+		for (i32 i = 0; i < HopFrameCount; i++)
+			candidateEnergy += static_cast<f64>(searchCandidateSamples[i]) * static_cast<f64>(searchCandidateSamples[i]);
+
+		constexpr f64 minCandidateEnergy = 1.0;
+		auto similarityAt = [&](i32 offset, f64 energy) -> f64
+		{
+			const f64 correlation = DotProduct(&searchCandidateSamples[offset], searchTargetSamples.data(), HopFrameCount);
+			return (energy > minCandidateEnergy) ? (correlation / ::sqrt(energy)) : 0.0;
+		};
+
+		// NOTE: Ties (such as for silence) are resolved in favor of whichever candidate is closest to the nominal position
+		i32 bestOffset = SearchRadiusFrameCount;
+		f64 bestSimilarity = 0.0;
+		for (i32 offset = 0; offset <= (SearchRadiusFrameCount * 2); offset++)
+		{
+			const f64 similarity = similarityAt(offset, candidateEnergy);
+			if (similarity > bestSimilarity || (similarity == bestSimilarity && Absolute(offset - SearchRadiusFrameCount) < Absolute(bestOffset - SearchRadiusFrameCount)))
+			{
+				bestOffset = offset;
+				bestSimilarity = similarity;
+			}
+
+			if (offset < (SearchRadiusFrameCount * 2))
+			{
+				const f64 leaving = searchCandidateSamples[offset], entering = searchCandidateSamples[offset + HopFrameCount];
+				candidateEnergy += (entering * entering) - (leaving * leaving);
+			}
+		}
+
+		return nominalSegmentStart + (bestOffset - SearchRadiusFrameCount);
+	}
+}
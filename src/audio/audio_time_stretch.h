@@ -0,0 +1,56 @@
+#pragma once
+#include "core_types.h"
+#include <array>
+
+namespace Audio
+{
+	// NOTE: Real-time WSOLA (waveform similarity overlap-add) time stretching, changing the playback speed of an interleaved stereo source without affecting its pitch.
+	//		 Output is synthesized one hop at a time by overlap-adding hann windowed source segments, each of which is shifted (within a small search radius)
+	//		 to best line up with the waveform that the previous segment would have naturally continued with, avoiding the phase cancellation of a naive overlap-add.
+	//		 All buffers are fixed size members so that it can be used on the render thread without ever having to allocate
+	class TimeStretcher
+	{
+	public:
+		static constexpr u32 ChannelCount = 2;
+		static constexpr i32 SegmentFrameCount = 1024;
+		static constexpr i32 HopFrameCount = (SegmentFrameCount / 2);
+		// NOTE: Large enough to line up the period of anything down to ~86 Hz (at 44100 Hz), which is plenty for the rhythmic content it is used for
+		static constexpr i32 SearchRadiusFrameCount = 256;
+
+	public:
+		TimeStretcher();
+		~TimeStretcher() = default;
+
+	public:
+		// NOTE: Discards all previous state with the next rendered frame then starting at exactly this (fractional) source frame
+		void Reset(f64 sourceFramePosition);
+
+		// NOTE: Advances the source position by (speed) frames for each rendered frame, with all source frames outside of the given (available) frame range being read as silence
+		void Render(const i16* sourceInterleavedSamples, i64 sourceFrameCount, f32 speed, i16* outInterleavedSamples, i64 outFrameCount);
+
+		// NOTE: Source position of the next frame to be rendered
+		inline f64 GetSourceFramePosition() const { return sourceFramePosition; }
+
+	private:
+		void SynthesizeNextHop(const i16* sourceInterleavedSamples, i64 sourceFrameCount, f32 speed);
+		i64 FindBestMatchingSegmentStart(const i16* sourceInterleavedSamples, i64 sourceFrameCount, i64 nominalSegmentStart);
+
+	private:
+		f64 sourceFramePosition = 0.0;
+		i64 previousSegmentStart = 0;
+		b8 hasPreviousSegment = false;
+
+		// NOTE: Number of frames of the current hop that have already been rendered
+		i32 hopReadFrameIndex = HopFrameCount;
+		std::array<i16, HopFrameCount * ChannelCount> hopSamples;
+
+		// NOTE: Windowed second half of the previous segment, to be added onto the first half of the next one
+		std::array<f32, HopFrameCount * ChannelCount> overlapSamples;
+		std::array<f32, SegmentFrameCount * ChannelCount> segmentSamples;
+		std::array<f32, SegmentFrameCount> window;
+
+		// NOTE: Downmixed source frames used for the similarity search
+		std::array<f32, HopFrameCount> searchTargetSamples;
+		std::array<f32, (SearchRadiusFrameCount * 2) + HopFrameCount> searchCandidateSamples;
+	};
+}
@@ -0,0 +1,316 @@
+#include "audio_waveform.h"
+#include <future>
+#include <thread>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define PEEPO_AUDIO_SSE2_WAVEFORM 1
+#include <emmintrin.h>
+#else
+#define PEEPO_AUDIO_SSE2_WAVEFORM 0
+#endif
+
+namespace Audio
+{
+	static_assert(sizeof(WaveformMinMax) == 2);
+
+	// NOTE: Generic fallback for any channel count and frames per sample, with the last sample only covering whatever frames are left
+	static void ReduceChannelFramesToMinMax(const PCMSampleBuffer& inSampleBuffer, u32 channelIndex, size_t framesPerSample, size_t firstSample, size_t endSample, WaveformMinMax* outSamples)
+	{
+		const size_t channelCount = inSampleBuffer.ChannelCount, frameCount = static_cast<size_t>(inSampleBuffer.FrameCount);
+		for (size_t sampleIndex = firstSample; sampleIndex < endSample; sampleIndex++)
+		{
+			const size_t firstFrame = (sampleIndex * framesPerSample), endFrame = Min(firstFrame + framesPerSample, frameCount);
+			i16 minSample = I16Max, maxSample = I16Min;
+			for (size_t frame = firstFrame; frame < endFrame; frame++)
+			{
+				const i16 sample = inSampleBuffer.InterleavedSamples[(frame * channelCount) + channelIndex];
+				minSample = Min(minSample, sample);
+				maxSample = Max(maxSample, sample);
+			}
+			outSamples[sampleIndex] = (endFrame > firstFrame) ? QuantizeWaveformMinMax(minSample, maxSample) : WaveformMinMax {};
+		}
+	}
+
+	// NOTE: Both channels of an interleaved stereo buffer at once, four (4 frame) samples per iteration
+	static void ReduceStereoFramesToMinMax(const PCMSampleBuffer& inSampleBuffer, size_t framesPerSample, size_t firstSample, size_t endSample, WaveformMinMax* outLeft, WaveformMinMax* outRight)
+	{
+		assert(inSampleBuffer.ChannelCount == 2);
+		size_t sampleIndex = firstSample;
+
+#if PEEPO_AUDIO_SSE2_WAVEFORM
+		if (framesPerSample == 4)
+		{
+			const size_t wholeSampleEnd = Min(endSample, static_cast<size_t>(inSampleBuffer.FrameCount) / 4);
+			const __m128i roundUpOffset = _mm_set1_epi16(0xFF);
+			for (; (sampleIndex + 4) <= wholeSampleEnd; sampleIndex += 4)
+			{
+				// NOTE: Each register holding the 4 frames [L0 R0 L1 R1 L2 R2 L3 R3] of one sample, with every 32-bit lane being a single (L, R) frame.
+				//		 Interleaving the lanes of two samples at a time then reduces the frames of all four down to a single (L, R) lane each
+				const __m128i* frames = reinterpret_cast<const __m128i*>(&inSampleBuffer.InterleavedSamples[sampleIndex * 8]);
+				const __m128i a = _mm_loadu_si128(frames + 0), b = _mm_loadu_si128(frames + 1), c = _mm_loadu_si128(frames + 2), d = _mm_loadu_si128(frames + 3);
+				const __m128i abLo = _mm_unpacklo_epi32(a, b), abHi = _mm_unpackhi_epi32(a, b), cdLo = _mm_unpacklo_epi32(c, d), cdHi = _mm_unpackhi_epi32(c, d);
+
+				const __m128i abMin = _mm_min_epi16(abLo, abHi), cdMin = _mm_min_epi16(cdLo, cdHi);
+				const __m128i abMax = _mm_max_epi16(abLo, abHi), cdMax = _mm_max_epi16(cdLo, cdHi);
+				const __m128i lows = _mm_min_epi16(_mm_unpacklo_epi64(abMin, cdMin), _mm_unpackhi_epi64(abMin, cdMin));
+				const __m128i highs = _mm_max_epi16(_mm_unpacklo_epi64(abMax, cdMax), _mm_unpackhi_epi64(abMax, cdMax));
+
+				// NOTE: Same as QuantizeWaveformMinMax(), with the saturating add clamping the rounded up maximum to I8Max. Then interleaved into [Low High] byte pairs
+				//		 ordered [L R L R ...] and finally split up into the two channels
+				const __m128i quantized = _mm_packs_epi16(_mm_srai_epi16(lows, 8), _mm_srai_epi16(_mm_adds_epi16(highs, roundUpOffset), 8));
+				__m128i pairs = _mm_unpacklo_epi8(quantized, _mm_srli_si128(quantized, 8));
+				pairs = _mm_shufflelo_epi16(pairs, _MM_SHUFFLE(3, 1, 2, 0));
+				pairs = _mm_shufflehi_epi16(pairs, _MM_SHUFFLE(3, 1, 2, 0));
+				pairs = _mm_shuffle_epi32(pairs, _MM_SHUFFLE(3, 1, 2, 0));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&outLeft[sampleIndex]), pairs);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&outRight[sampleIndex]), _mm_srli_si128(pairs, 8));
+			}
+		}
+#endif
+
+		ReduceChannelFramesToMinMax(inSampleBuffer, 0, framesPerSample, sampleIndex, endSample, outLeft);
+		ReduceChannelFramesToMinMax(inSampleBuffer, 1, framesPerSample, sampleIndex, endSample, outRight);
+	}
+
+	// NOTE: Each sample combining two parent samples, with the last one possibly only having a single parent
+	static void ReduceParentMipToMinMax(const WaveformMinMax* parentSamples, size_t parentSampleCount, size_t firstSample, size_t endSample, WaveformMinMax* outSamples)
+	{
+		size_t sampleIndex = firstSample;
+
+#if PEEPO_AUDIO_SSE2_WAVEFORM
+		// NOTE: 8 parent samples [L0 H0 L1 H1 ...] per register, with signed bytes being flipped to unsigned for the SSE2 (unsigned only) byte min/max instructions
+		const size_t wholeSampleEnd = Min(endSample, parentSampleCount / 2);
+		const __m128i signFlip = _mm_set1_epi8(static_cast<char>(0x80));
+		const __m128i lowByteMask = _mm_set1_epi32(0x000000FF), highByteMask = _mm_set1_epi32(0x0000FF00);
+		for (; (sampleIndex + 4) <= wholeSampleEnd; sampleIndex += 4)
+		{
+			const __m128i parents = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&parentSamples[sampleIndex * 2])), signFlip);
+			const __m128i nextParents = _mm_srli_epi32(parents, 16);
+			const __m128i combined = _mm_xor_si128(_mm_or_si128(
+				_mm_and_si128(_mm_min_epu8(parents, nextParents), lowByteMask),
+				_mm_and_si128(_mm_max_epu8(parents, nextParents), highByteMask)), signFlip);
+
+			// NOTE: Gather the lower 16 bits of each 32-bit lane into the lower 64 bits
+			__m128i packed = _mm_shufflelo_epi16(combined, _MM_SHUFFLE(3, 1, 2, 0));
+			packed = _mm_shufflehi_epi16(packed, _MM_SHUFFLE(3, 1, 2, 0));
+			packed = _mm_shuffle_epi32(packed, _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&outSamples[sampleIndex]), packed);
+		}
+#endif
+
+		for (; sampleIndex < endSample; sampleIndex++)
+		{
+			const size_t parentIndex = (sampleIndex * 2);
+			outSamples[sampleIndex] = ((parentIndex + 1) < parentSampleCount) ? CombineWaveformMinMax(parentSamples[parentIndex], parentSamples[parentIndex + 1]) : parentSamples[parentIndex];
+		}
+	}
+
+	// NOTE: Splits the range into (roughly) equal parts to be processed at the same time, with the last part always running on the calling thread
+	template <typename Func>
+	static void ParallelForSampleRange(size_t firstSample, size_t endSample, i64 framesPerSample, Func func)
+	{
+		const size_t sampleCount = (endSample - firstSample);
+		const size_t maxTaskCount = static_cast<size_t>(Clamp<u32>(std::thread::hardware_concurrency(), 1, 8));
+		const size_t taskCount = Clamp<size_t>(static_cast<size_t>((static_cast<i64>(sampleCount) * framesPerSample) / WaveformMipChain::MinParallelFrameCount), 1, maxTaskCount);
+		if (taskCount <= 1)
+			return func(firstSample, endSample);
+
+		const size_t samplesPerTask = (sampleCount + taskCount - 1) / taskCount;
+		std::future<void> tasks[8];
+		for (size_t i = 0; i < (taskCount - 1); i++)
+		{
+			const size_t taskFirst = firstSample + (i * samplesPerTask);
+			tasks[i] = std::async(std::launch::async, [&func, taskFirst, taskEnd = Min(taskFirst + samplesPerTask, endSample)] { func(taskFirst, taskEnd); });
+		}
+		func(Min(firstSample + ((taskCount - 1) * samplesPerTask), endSample), endSample);
+
+		for (size_t i = 0; i < (taskCount - 1); i++)
+			tasks[i].get();
+	}
+
+	f32 WaveformMipChain::GetAmplitudeAt(const WaveformMip& mip, Time time, Time timePerPixel) const
+	{
+		if (mip.SampleCount == 0 || mip.SamplesPerSecond <= 0.0) { assert(false); return 0.0f; }
+		const WaveformMinMax* samples = GetMipSamples(mip);
+		auto peakAtIndexOrZero = [&](i64 index) { return (index >= 0 && index < static_cast<i64>(mip.GeneratedSampleCount)) ? samples[index].Peak() : 0; };
+
+		const f64 startIndexF64 = (time.Seconds * mip.SamplesPerSecond);
+		const f64 endIndexF64 = ((time + timePerPixel).Seconds * mip.SamplesPerSecond);
+
+		if ((endIndexF64 - startIndexF64) < 1.0)
+		{
+			const i64 indexLo = static_cast<i64>(Floor(startIndexF64));
+			const f32 fraction = static_cast<f32>(startIndexF64 - static_cast<f64>(indexLo));
+			return Min(Lerp(static_cast<f32>(peakAtIndexOrZero(indexLo)), static_cast<f32>(peakAtIndexOrZero(indexLo + 1)), fraction) / static_cast<f32>(I8Max), 1.0f);
+		}
+
+		const i64 firstIndex = Clamp<i64>(static_cast<i64>(Floor(startIndexF64)), 0, static_cast<i64>(mip.GeneratedSampleCount));
+		const i64 endIndex = Clamp<i64>(static_cast<i64>(Ceil(endIndexF64)), 0, static_cast<i64>(mip.GeneratedSampleCount));
+		i32 peak = 0;
+		for (i64 index = firstIndex; index < endIndex; index++)
+			peak = Max(peak, samples[index].Peak());
+
+		return Min(static_cast<f32>(peak) / static_cast<f32>(I8Max), 1.0f);
+	}
+
+	void WaveformMipChain::GetAmplitudesForPixels(Time startTime, Time timePerPixel, f32* outAmplitudes, size_t pixelCount) const
+	{
+		if (IsEmpty())
+			return std::fill(outAmplitudes, outAmplitudes + pixelCount, 0.0f);
+
+		const WaveformMip& mip = FindClosestMip(timePerPixel);
+		for (size_t pixel = 0; pixel < pixelCount; pixel++)
+			outAmplitudes[pixel] = GetAmplitudeAt(mip, startTime + (timePerPixel * static_cast<f64>(pixel)), timePerPixel);
+	}
+
+	void WaveformMipChain::Clear()
+	{
+		for (auto& mip : AllMips)
+			mip = {};
+		SampleArena = nullptr;
+		SampleArenaSize = SampleArenaCapacity = 0;
+		Duration = {};
+		HasFullSizeMip = false;
+	}
+
+	void WaveformMipChain::GenerateEntireMipChainFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, u32 channelIndex, b8 includeFullSizeMip)
+	{
+		BeginMipChainForSampleBuffer(inSampleBuffer, includeFullSizeMip);
+		UpdateMipChainFromSampleBuffer(inSampleBuffer, channelIndex, inSampleBuffer.FrameCount);
+	}
+
+	void WaveformMipChain::BeginMipChainForSampleBuffer(const PCMSampleBuffer& inSampleBuffer, b8 includeFullSizeMip)
+	{
+		// NOTE: Keeping the previous arena allocation around to be reused (if large enough)
+		for (auto& mip : AllMips)
+			mip = {};
+		SampleArenaSize = 0;
+		Duration = {};
+		HasFullSizeMip = false;
+
+		if (inSampleBuffer.FrameCount <= 0 || inSampleBuffer.SampleRate == 0)
+			return;
+
+		Duration = FramesToTime(inSampleBuffer.FrameCount, inSampleBuffer.SampleRate);
+		HasFullSizeMip = includeFullSizeMip;
+
+		// NOTE: No need to waste memory storing the full size mip if it won't even get sampled AND is already duplicated inside the source buffer
+		size_t framesPerSample = includeFullSizeMip ? 1 : BaseMipFramesPerSample;
+		size_t sampleCount = (static_cast<size_t>(inSampleBuffer.FrameCount) + framesPerSample - 1) / framesPerSample;
+		size_t arenaSize = 0;
+
+		for (size_t i = 0; i < MaxMipLevels; i++)
+		{
+			WaveformMip& newMip = AllMips[i];
+			newMip.SampleCount = sampleCount;
+			newMip.FramesPerSample = framesPerSample;
+			newMip.SamplesPerSecond = (static_cast<f64>(inSampleBuffer.SampleRate) / static_cast<f64>(framesPerSample));
+			newMip.TimePerSample = Time::FromSec(1.0 / newMip.SamplesPerSecond);
+			newMip.ArenaOffset = arenaSize;
+			arenaSize += sampleCount;
+
+			if (sampleCount <= 1)
+				break;
+
+			framesPerSample *= 2;
+			sampleCount = (sampleCount + 1) / 2;
+		}
+
+		if (arenaSize > SampleArenaCapacity)
+		{
+			SampleArena = std::unique_ptr<WaveformMinMax[]>(new WaveformMinMax[arenaSize]);
+			SampleArenaCapacity = arenaSize;
+		}
+		SampleArenaSize = arenaSize;
+	}
+
+	size_t WaveformMipChain::GetCompleteBaseSampleCount(const PCMSampleBuffer& inSampleBuffer, i64 availableFrameCount) const
+	{
+		const WaveformMip& baseMip = AllMips[0];
+		const i64 frameCount = Clamp<i64>(availableFrameCount, 0, inSampleBuffer.FrameCount);
+		if (frameCount >= inSampleBuffer.FrameCount)
+			return baseMip.SampleCount;
+		return Min(static_cast<size_t>(frameCount) / baseMip.FramesPerSample, baseMip.SampleCount);
+	}
+
+	void WaveformMipChain::UpdateMipChainFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, u32 channelIndex, i64 availableFrameCount)
+	{
+		assert(inSampleBuffer.InterleavedSamples != nullptr && channelIndex < inSampleBuffer.ChannelCount);
+		if (IsEmpty())
+			return;
+
+		WaveformMip& baseMip = AllMips[0];
+		const size_t firstSample = baseMip.GeneratedSampleCount, endSample = GetCompleteBaseSampleCount(inSampleBuffer, availableFrameCount);
+		if (endSample <= firstSample)
+			return;
+
+		WaveformMinMax* baseSamples = GetMipSamples(baseMip);
+		ParallelForSampleRange(firstSample, endSample, static_cast<i64>(baseMip.FramesPerSample), [&](size_t rangeFirst, size_t rangeEnd)
+		{
+			ReduceChannelFramesToMinMax(inSampleBuffer, channelIndex, baseMip.FramesPerSample, rangeFirst, rangeEnd, baseSamples);
+		});
+		baseMip.GeneratedSampleCount = endSample;
+
+		UpdateUpperMips();
+	}
+
+	void WaveformMipChain::GenerateStereoMipChainsFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, WaveformMipChain& outLeft, WaveformMipChain& outRight, b8 includeFullSizeMip)
+	{
+		outLeft.BeginMipChainForSampleBuffer(inSampleBuffer, includeFullSizeMip);
+		outRight.BeginMipChainForSampleBuffer(inSampleBuffer, includeFullSizeMip);
+		UpdateStereoMipChainsFromSampleBuffer(inSampleBuffer, outLeft, outRight, inSampleBuffer.FrameCount);
+	}
+
+	void WaveformMipChain::UpdateStereoMipChainsFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, WaveformMipChain& inOutLeft, WaveformMipChain& inOutRight, i64 availableFrameCount)
+	{
+		assert(inSampleBuffer.InterleavedSamples != nullptr && inSampleBuffer.ChannelCount == 2);
+		assert(inOutLeft.AllMips[0].SampleCount == inOutRight.AllMips[0].SampleCount && inOutLeft.AllMips[0].GeneratedSampleCount == inOutRight.AllMips[0].GeneratedSampleCount);
+		if (inOutLeft.IsEmpty() || inOutRight.IsEmpty())
+			return;
+
+		WaveformMip& baseMipL = inOutLeft.AllMips[0];
+		WaveformMip& baseMipR = inOutRight.AllMips[0];
+		const size_t firstSample = baseMipL.GeneratedSampleCount, endSample = inOutLeft.GetCompleteBaseSampleCount(inSampleBuffer, availableFrameCount);
+		if (endSample <= firstSample)
+			return;
+
+		WaveformMinMax* baseSamplesL = inOutLeft.GetMipSamples(baseMipL);
+		WaveformMinMax* baseSamplesR = inOutRight.GetMipSamples(baseMipR);
+		ParallelForSampleRange(firstSample, endSample, static_cast<i64>(baseMipL.FramesPerSample), [&](size_t rangeFirst, size_t rangeEnd)
+		{
+			ReduceStereoFramesToMinMax(inSampleBuffer, baseMipL.FramesPerSample, rangeFirst, rangeEnd, baseSamplesL, baseSamplesR);
+		});
+		baseMipL.GeneratedSampleCount = endSample;
+		baseMipR.GeneratedSampleCount = endSample;
+
+		// NOTE: The upper mips of each channel only depend on their own base mip, so the two can be built independently
+		if (static_cast<i64>((endSample - firstSample) * baseMipL.FramesPerSample) >= MinParallelFrameCount)
+		{
+			auto leftTask = std::async(std::launch::async, [&inOutLeft] { inOutLeft.UpdateUpperMips(); });
+			inOutRight.UpdateUpperMips();
+			leftTask.get();
+		}
+		else
+		{
+			inOutLeft.UpdateUpperMips();
+			inOutRight.UpdateUpperMips();
+		}
+	}
+
+	void WaveformMipChain::UpdateUpperMips()
+	{
+		for (size_t i = 1; i < MaxMipLevels; i++)
+		{
+			const WaveformMip& parentMip = AllMips[i - 1];
+			WaveformMip& thisMip = AllMips[i];
+			if (thisMip.SampleCount == 0)
+				break;
+
+			const b8 parentComplete = (parentMip.GeneratedSampleCount >= parentMip.SampleCount);
+			const size_t endSample = parentComplete ? thisMip.SampleCount : Min(parentMip.GeneratedSampleCount / 2, thisMip.SampleCount);
+			if (endSample > thisMip.GeneratedSampleCount)
+				ReduceParentMipToMinMax(GetMipSamples(parentMip), parentMip.SampleCount, thisMip.GeneratedSampleCount, endSample, GetMipSamples(thisMip));
+			thisMip.GeneratedSampleCount = Max(thisMip.GeneratedSampleCount, endSample);
+		}
+	}
+}
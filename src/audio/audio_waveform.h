@@ -1,180 +1,125 @@
 #pragma once
 #include "core_types.h"
 #include "audio_common.h"
+#include <memory>
 
 // TODO: Texture cache (create interface for uploading texture pixels to have a clean separation from the actual rendering?)
 
 namespace Audio
 {
-	constexpr i16 AverageTwoI16SamplesTogether(i16 a, i16 b) { return static_cast<i16>((static_cast<i32>(a) + static_cast<i32>(b)) / 2); };
+	// NOTE: Lowest and highest sample value of all source frames covered by a mip sample, quantized down to 8-bit (rounding outwards so that peaks are never understated).
+	//		 Unlike averaging this lets short transients (such as drum onsets) survive all the way up to the coarsest mip
+	struct WaveformMinMax
+	{
+		i8 Low;
+		i8 High;
+
+		constexpr i32 Peak() const { return Max(-static_cast<i32>(Low), static_cast<i32>(High)); }
+	};
+
+	constexpr WaveformMinMax QuantizeWaveformMinMax(i16 minSample, i16 maxSample)
+	{
+		return WaveformMinMax { static_cast<i8>(minSample >> 8), static_cast<i8>(Min<i32>((static_cast<i32>(maxSample) + 0xFF) >> 8, I8Max)) };
+	}
+
+	constexpr WaveformMinMax CombineWaveformMinMax(WaveformMinMax a, WaveformMinMax b)
+	{
+		return WaveformMinMax { Min(a.Low, b.Low), Max(a.High, b.High) };
+	}
 
 	struct WaveformMip
 	{
-		size_t PowerOfTwoSampleCount = {};
+		size_t SampleCount = {};
+		// NOTE: Number of source frames covered by each sample, with the last one possibly covering fewer
+		size_t FramesPerSample = {};
 		Time TimePerSample = {};
 		f64 SamplesPerSecond = {};
-		std::vector<i16> AbsoluteSamples {};
+		// NOTE: Start of this mip's samples within the WaveformMipChain::SampleArena
+		size_t ArenaOffset = {};
+		// NOTE: Number of leading samples that have already been generated, the remaining ones are still zero while the source buffer is being decoded
+		size_t GeneratedSampleCount = {};
 
 		inline Time GetDuration() const
 		{
-			return Time::FromSec(static_cast<f64>(AbsoluteSamples.size()) / SamplesPerSecond);
-		}
-
-		inline i16 SampleAtIndexOrZero(size_t sampleIndex) const
-		{
-			return (sampleIndex < AbsoluteSamples.size()) ? AbsoluteSamples[sampleIndex] : static_cast<i16>(0);
-		}
-
-		inline i16 LinearSampleAtTimeOrZero(Time time) const
-		{
-			const f32 sampleIndexF32 = static_cast<f32>(time.Seconds * SamplesPerSecond);
-			const f32 sampleIndexFraction = sampleIndexF32 - static_cast<i32>(sampleIndexF32);
-
-			const size_t sampleIndexLo = (sampleIndexF32 <= 0.0f) ? 0 : static_cast<size_t>(sampleIndexF32);
-			const size_t sampleIndexHi = (sampleIndexLo + 1);
-
-			const i16 sampleLo = SampleAtIndexOrZero(sampleIndexLo);
-			const i16 sampleHi = SampleAtIndexOrZero(sampleIndexHi);
-
-			const f32 normalizedSampleLo = static_cast<f32>(sampleLo / static_cast<f32>(I16Max));
-			const f32 normalizedSampleHi = static_cast<f32>(sampleHi / static_cast<f32>(I16Max));
-			const f32 normalizedSample = Lerp(normalizedSampleLo, normalizedSampleHi, sampleIndexFraction);
-
-			return static_cast<i16>(normalizedSample * static_cast<f32>(I16Max));
-		}
-
-		f32 AverageNormalizedSampleInTimeRange(Time startTime, Time endTime) const
-		{
-			if (TimePerSample.Seconds <= 0.0) { assert(false); return 0.0f; }
-
-			i32 sampleSum = 0, sampleCount = 0;
-			for (Time timeIt = startTime; timeIt < endTime; timeIt += TimePerSample) { sampleSum += LinearSampleAtTimeOrZero(timeIt); sampleCount++; }
-
-			const i32 sampleAverage = (sampleSum / Max(sampleCount, 1));
-			return sampleAverage / static_cast<f32>(I16Max);
-		}
-
-		void Clear()
-		{
-			PowerOfTwoSampleCount = {};
-			TimePerSample = {};
-			SamplesPerSecond = {};
-			AbsoluteSamples.clear();
+			return Time::FromSec(static_cast<f64>(SampleCount) / SamplesPerSecond);
 		}
 	};
 
 	struct WaveformMipChain
 	{
-		static constexpr size_t MaxMipLevels = 24;
-		static constexpr size_t MinMipSampleCount = 256;
+		// NOTE: Every mip halves the sample count of the previous one all the way down to a single sample, which is enough levels for any buffer
+		//		 below 2^47 (full size mip) frames. This way no zoom level ever has to look at more than the few samples covered by a single pixel
+		static constexpr size_t MaxMipLevels = 48;
+		// NOTE: The base mip already reduces this many source frames down into a single sample, unless the full size mip is explicitly requested
+		static constexpr size_t BaseMipFramesPerSample = 4;
+		// NOTE: Updates of fewer (pending) frames than this are always generated on the calling thread
+		static constexpr i64 MinParallelFrameCount = (1 << 20);
 
 		WaveformMip AllMips[MaxMipLevels] {};
+		// NOTE: Samples of every mip level back to back in a single allocation, with each mip only storing its offset into it.
+		//		 Left uninitialized past the generated samples of each mip, as filling in the entire arena upfront would take about as long as generating it
+		std::unique_ptr<WaveformMinMax[]> SampleArena {};
+		size_t SampleArenaSize = 0, SampleArenaCapacity = 0;
 		Time Duration {};
+		b8 HasFullSizeMip = false;
 
 		inline b8 IsEmpty() const
 		{
-			return AllMips[0].PowerOfTwoSampleCount == 0;
+			return AllMips[0].SampleCount == 0;
 		}
 
 		inline i32 GetUsedMipCount() const
 		{
 			for (i32 i = 0; i < static_cast<i32>(MaxMipLevels); i++)
 			{
-				if (AllMips[i].PowerOfTwoSampleCount == 0)
+				if (AllMips[i].SampleCount == 0)
 					return i;
 			}
 			return static_cast<i32>(MaxMipLevels);
 		}
 
+		// NOTE: Coarsest mip that still has at least one sample per pixel (or the base mip if not even that has), so that each pixel only ever covers between one and two
+		//		 of its samples and no peak can fall in between two pixels. With every mip having exactly twice the time per sample of the previous one the level is simply log2 of the ratio
 		inline const WaveformMip& FindClosestMip(Time timePerPixel) const
 		{
-			const WaveformMip* closestMip = &AllMips[0];
-			for (size_t i = 1; i < MaxMipLevels; i++)
-			{
-				if (AllMips[i].PowerOfTwoSampleCount == 0)
-					break;
-				if (Absolute((AllMips[i].TimePerSample - timePerPixel).Seconds < Absolute((closestMip->TimePerSample - timePerPixel).Seconds)))
-					closestMip = &AllMips[i];
-			}
-			return *closestMip;
-		}
+			const f64 baseSamplesPerPixel = (timePerPixel.Seconds * AllMips[0].SamplesPerSecond);
+			if (!(baseSamplesPerPixel >= 2.0))
+				return AllMips[0];
 
-		inline f32 GetAmplitudeAt(const WaveformMip& mip, Time time, Time timePerPixel) const
-		{
-			return mip.AverageNormalizedSampleInTimeRange(time, time + timePerPixel);
+			const i32 level = Min(static_cast<i32>(::log2(baseSamplesPerPixel)), GetUsedMipCount() - 1);
+			return AllMips[ClampBot(level, 0)];
 		}
 
-		inline void GenerateEntireMipChainFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, u32 channelIndex, b8 includeFullSizeMip = false)
-		{
-			assert(inSampleBuffer.InterleavedSamples != nullptr && channelIndex < inSampleBuffer.ChannelCount);
+		inline const WaveformMinMax* GetMipSamples(const WaveformMip& mip) const { return SampleArena.get() + mip.ArenaOffset; }
+		inline WaveformMinMax* GetMipSamples(const WaveformMip& mip) { return SampleArena.get() + mip.ArenaOffset; }
 
-			Duration = FramesToTime(inSampleBuffer.FrameCount, inSampleBuffer.SampleRate);
-			if (AllMips[0].PowerOfTwoSampleCount != 0)
-				for (auto& mip : AllMips) mip.Clear();
+		// NOTE: Normalized peak amplitude of the time range, linearly interpolated between neighboring samples if the range covers less than a single one.
+		//		 Samples that haven't been generated yet are treated as silence
+		f32 GetAmplitudeAt(const WaveformMip& mip, Time time, Time timePerPixel) const;
 
-			WaveformMip& baseMip = AllMips[0];
-			baseMip.PowerOfTwoSampleCount = RoundUpToPowerOfTwo(static_cast<u32>(inSampleBuffer.FrameCount));
-			baseMip.TimePerSample = Time::FromSec(1.0 / static_cast<f64>(inSampleBuffer.SampleRate));
-			baseMip.SamplesPerSecond = static_cast<f64>(inSampleBuffer.SampleRate);
+		// NOTE: Same as calling GetAmplitudeAt() with FindClosestMip() for (pixelCount) consecutive pixels, the first one starting at (startTime).
+		//		 Each pixel only ever has to look at up to three mip samples, so the cost only depends on the number of pixels and not on the zoom level
+		void GetAmplitudesForPixels(Time startTime, Time timePerPixel, f32* outAmplitudes, size_t pixelCount) const;
 
-			if (includeFullSizeMip)
-			{
-				baseMip.AbsoluteSamples.resize(inSampleBuffer.FrameCount);
-				for (size_t frameIndex = 0; frameIndex < static_cast<size_t>(inSampleBuffer.FrameCount); frameIndex++)
-					baseMip.AbsoluteSamples[frameIndex] = Absolute(inSampleBuffer.InterleavedSamples[(frameIndex * inSampleBuffer.ChannelCount) + channelIndex]);
-			}
-			else // NOTE: No need to waste memory storing the full size mip if it won't even get sampled AND is already duplicated inside the source buffer
-			{
-				baseMip.PowerOfTwoSampleCount /= 2;
-				baseMip.TimePerSample = baseMip.TimePerSample * 2.0;
-				baseMip.SamplesPerSecond = baseMip.SamplesPerSecond / 2.0;
-				baseMip.AbsoluteSamples.resize(baseMip.PowerOfTwoSampleCount);
-				const size_t samplesToFill = ClampTop(baseMip.AbsoluteSamples.size(), static_cast<size_t>(inSampleBuffer.FrameCount / 2));
-				for (size_t frameIndex = 0; frameIndex < samplesToFill; frameIndex++)
-				{
-					baseMip.AbsoluteSamples[frameIndex] = AverageTwoI16SamplesTogether(
-						Absolute(inSampleBuffer.InterleavedSamples[(((frameIndex * 2 + 0) * inSampleBuffer.ChannelCount) + channelIndex)]),
-						Absolute(inSampleBuffer.InterleavedSamples[(((frameIndex * 2 + 1) * inSampleBuffer.ChannelCount) + channelIndex)]));
-				}
-			}
+		void Clear();
 
-			// NOTE: First loop (separated) to compute sample counts
-			for (size_t i = 1; i < MaxMipLevels; i++)
-			{
-				const WaveformMip& parentMip = AllMips[i - 1];
-				if (parentMip.PowerOfTwoSampleCount <= MinMipSampleCount)
-					break;
-
-				WaveformMip& newMip = AllMips[i];
-				newMip.PowerOfTwoSampleCount = (parentMip.PowerOfTwoSampleCount / 2);
-				newMip.TimePerSample = (parentMip.TimePerSample * 2.0);
-				newMip.SamplesPerSecond = (parentMip.SamplesPerSecond / 2.0);
-			}
+		void GenerateEntireMipChainFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, u32 channelIndex, b8 includeFullSizeMip = false);
 
-			// TODO: Consider having single continuous sample buffer and store view pointer (or start index) inside each WaveformMip
-			[[maybe_unused]] size_t totalSampleCountAcrossAllMips = 0;
-			for (const WaveformMip& mip : AllMips)
-				totalSampleCountAcrossAllMips += (&mip == &baseMip) ? baseMip.AbsoluteSamples.size() : mip.PowerOfTwoSampleCount;
+		// NOTE: Allocates every mip for the full length of the sample buffer, to then be filled in progressively while the buffer is still being decoded
+		void BeginMipChainForSampleBuffer(const PCMSampleBuffer& inSampleBuffer, b8 includeFullSizeMip = false);
 
-			// NOTE: Second loop to then generate the actual mip sample buffers
-			for (size_t i = 1; i < MaxMipLevels; i++)
-			{
-				const WaveformMip& parentMip = AllMips[i - 1];
-				if (parentMip.PowerOfTwoSampleCount == 0)
-					break;
-				const size_t parentSampleCount = parentMip.AbsoluteSamples.size();
-				const i16* parentSamples = parentMip.AbsoluteSamples.data();
-
-				WaveformMip& thisMip = AllMips[i];
-				thisMip.AbsoluteSamples.resize(thisMip.PowerOfTwoSampleCount);
-				const size_t samplesToFill = ClampTop(thisMip.AbsoluteSamples.size(), (parentSampleCount / 2));
-				for (size_t sampleIndex = 0; sampleIndex < samplesToFill; sampleIndex++)
-				{
-					// ... assert(parentSamples >= &parentMip.AbsoluteSamples.front() && parentSamples <= &parentMip.AbsoluteSamples.back());
-					thisMip.AbsoluteSamples[sampleIndex] = AverageTwoI16SamplesTogether(parentSamples[0], parentSamples[1]);
-					parentSamples += 2;
-				}
-			}
-		}
+		// NOTE: Only generates the mip samples for frames that haven't been processed by a previous call yet. Each sample only depends on the samples below it
+		//		 so the end result is identical to generating everything at once, with the partially covered tail of each mip being treated as complete once all frames are available
+		void UpdateMipChainFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, u32 channelIndex, i64 availableFrameCount);
+
+		// NOTE: Same result as generating / updating the first two channels separately, but reading each interleaved frame only once with the work of larger updates
+		//		 being split across multiple threads (first by frame range for the base mips, then by channel for all others). Both chains must have been begun the same way
+		static void GenerateStereoMipChainsFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, WaveformMipChain& outLeft, WaveformMipChain& outRight, b8 includeFullSizeMip = false);
+		static void UpdateStereoMipChainsFromSampleBuffer(const PCMSampleBuffer& inSampleBuffer, WaveformMipChain& inOutLeft, WaveformMipChain& inOutRight, i64 availableFrameCount);
+
+	private:
+		// NOTE: Number of base mip samples whose frames are all available
+		size_t GetCompleteBaseSampleCount(const PCMSampleBuffer& inSampleBuffer, i64 availableFrameCount) const;
+		void UpdateUpperMips();
 	};
 }
@@ -0,0 +1,1174 @@
+#include "benchmark_common.h"
+#include "audio/audio_common.h"
+#include "audio/audio_file_formats.h"
+#include "audio/audio_resampler.h"
+#include "audio/audio_time_stretch.h"
+#include "audio/audio_waveform.h"
+#include "audio/audio_engine.h"
+#include "file_format_tja.h"
+#include "peepo_drum_kit/chart_audio_render.h"
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+namespace Benchmark
+{
+	struct SyntheticSong
+	{
+		u32 ChannelCount;
+		u32 SampleRate;
+		i64 FrameCount;
+		std::vector<i16> InterleavedSamples;
+		std::vector<u8> WavFileContent;
+	};
+
+	// NOTE: Noise on top of a slowly changing sine wave so that every waveform mip level ends up with distinct sample values
+	static SyntheticSong CreateSyntheticSong(u32 channelCount, u32 sampleRate, Time duration)
+	{
+		SyntheticSong song {};
+		song.ChannelCount = channelCount;
+		song.SampleRate = sampleRate;
+		song.FrameCount = Audio::TimeToFrames(duration, sampleRate);
+		song.InterleavedSamples.resize(static_cast<size_t>(song.FrameCount) * channelCount);
+
+		RandomGenerator random {};
+		for (i64 frame = 0; frame < song.FrameCount; frame++)
+		{
+			const f64 envelope = 0.5 + 0.5 * ::sin((static_cast<f64>(frame) / static_cast<f64>(sampleRate)) * 0.37);
+			for (u32 channel = 0; channel < channelCount; channel++)
+				song.InterleavedSamples[static_cast<size_t>(frame) * channelCount + channel] = static_cast<i16>(((random.NextF32() * 2.0f) - 1.0f) * static_cast<f32>(envelope) * 32767.0f);
+		}
+
+		Audio::EncodeWaveFile(song.InterleavedSamples.data(), song.FrameCount, channelCount, sampleRate, song.WavFileContent);
+		return song;
+	}
+
+	static Audio::PCMSampleBuffer CreateSampleBuffer(const std::vector<i16>& interleavedSamples, u32 channelCount, u32 sampleRate)
+	{
+		Audio::PCMSampleBuffer buffer {};
+		buffer.ChannelCount = channelCount;
+		buffer.SampleRate = sampleRate;
+		buffer.FrameCount = static_cast<i64>(interleavedSamples.size() / channelCount);
+		buffer.InterleavedSamples = std::make_unique<i16[]>(interleavedSamples.size());
+		std::copy(interleavedSamples.begin(), interleavedSamples.end(), buffer.InterleavedSamples.get());
+		return buffer;
+	}
+
+	static b8 AreSampleBuffersEqual(const Audio::PCMSampleBuffer& a, const Audio::PCMSampleBuffer& b)
+	{
+		if (a.ChannelCount != b.ChannelCount || a.SampleRate != b.SampleRate || a.FrameCount != b.FrameCount)
+			return false;
+		return (a.SampleCount() == 0) || (memcmp(a.InterleavedSamples.get(), b.InterleavedSamples.get(), a.ByteSize()) == 0);
+	}
+
+	static b8 AreMipChainsEqual(const Audio::WaveformMipChain& a, const Audio::WaveformMipChain& b)
+	{
+		for (size_t i = 0; i < Audio::WaveformMipChain::MaxMipLevels; i++)
+		{
+			const Audio::WaveformMip& mipA = a.AllMips[i];
+			const Audio::WaveformMip& mipB = b.AllMips[i];
+			if (mipA.SampleCount != mipB.SampleCount || mipA.FramesPerSample != mipB.FramesPerSample || mipA.ArenaOffset != mipB.ArenaOffset || mipA.GeneratedSampleCount != mipB.GeneratedSampleCount)
+				return false;
+		}
+		return (a.SampleArenaSize == b.SampleArenaSize) && (a.SampleArenaSize == 0 || memcmp(a.SampleArena.get(), b.SampleArena.get(), a.SampleArenaSize * sizeof(Audio::WaveformMinMax)) == 0);
+	}
+
+	// NOTE: Size of the previous layout, a separate vector of averaged absolute i16 samples per mip with the base mip rounded up to a power of two (at half the frame count)
+	//		 and with the chain stopping at the first mip of no more than 256 samples
+	static size_t GetAveragedPowerOfTwoMipChainByteSize(i64 frameCount)
+	{
+		constexpr size_t previousMaxMipLevels = 24, previousMinMipSampleCount = 256;
+		size_t byteSize = 0;
+		for (size_t sampleCount = (RoundUpToPowerOfTwo(static_cast<u32>(frameCount)) / 2), level = 0; level < previousMaxMipLevels; sampleCount /= 2, level++)
+		{
+			byteSize += (sampleCount * sizeof(i16));
+			if (sampleCount <= previousMinMipSampleCount)
+				break;
+		}
+		return byteSize;
+	}
+
+	void RunAudioDecodeBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "AudioDecode";
+		static constexpr std::string_view names[] = { "StreamedChunksMatchSource", "StreamedResampleMatchesEntireBuffer", "ProgressiveMipsMatchEntireMips", "OpenAndDecodeFirstChunk", "DecodeEntireFile", "DecodeEntireFileResampled (44100->48000)",
+			"StereoMipsMatchSeparateMips", "MipsPreservePeaks", "MipArenaSmallerThanAveragedMips", "GenerateEntireMipChain", "GenerateStereoMipChains",
+			"ClosestMipCoversOneToTwoSamplesPerPixel", "PixelAmplitudesCoverSourcePeaks", "GetAmplitudesForPixels (Entire Song)", "GetAmplitudesForPixels (1 Second)", "GetAmplitudeAt (Base Mip, Entire Song)" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		// NOTE: Roughly the length of a long song, which is where the time until the first chunk becomes audible matters the most
+		const SyntheticSong song = CreateSyntheticSong(2, 44100, Time::FromSec(10.0 * 60.0));
+		const std::string_view fileName = "song.wav";
+
+		{
+			Audio::PCMSampleBuffer streamed {};
+			Audio::StreamingDecoder decoder {};
+			b8 passed = (decoder.Open(fileName, song.WavFileContent.data(), song.WavFileContent.size(), streamed) == Audio::DecodeFileResult::FeelsGoodMan);
+
+			// NOTE: Every chunk must be published in order, with none of the frames past the published count having been relied upon
+			i64 previousAvailableFrameCount = streamed.GetAvailableFrameCount();
+			passed &= (previousAvailableFrameCount == 0) && (streamed.FrameCount == song.FrameCount);
+			while (passed && decoder.DecodeNextChunk())
+			{
+				const i64 availableFrameCount = streamed.GetAvailableFrameCount();
+				passed &= (availableFrameCount > previousAvailableFrameCount);
+				passed &= (memcmp(streamed.InterleavedSamples.get(), song.InterleavedSamples.data(), static_cast<size_t>(availableFrameCount) * song.ChannelCount * sizeof(i16)) == 0);
+				previousAvailableFrameCount = availableFrameCount;
+			}
+			passed &= decoder.IsFinished() && streamed.IsFullyAvailable();
+			passed &= (memcmp(streamed.InterleavedSamples.get(), song.InterleavedSamples.data(), song.InterleavedSamples.size() * sizeof(i16)) == 0);
+			context.Check(passed, suite, "StreamedChunksMatchSource", static_cast<size_t>(song.FrameCount));
+		}
+
+		if (context.PassesFilter(suite, "StreamedResampleMatchesEntireBuffer"))
+		{
+			Audio::PCMSampleBuffer reference {};
+			Audio::DecodeEntireFile(fileName, song.WavFileContent.data(), song.WavFileContent.size(), reference);
+			Audio::ResampleBuffer(reference.InterleavedSamples, reference.FrameCount, reference.SampleRate, reference.ChannelCount, 48000);
+
+			Audio::PCMSampleBuffer streamed {};
+			Audio::StreamingDecoder decoder {};
+			b8 passed = (decoder.Open(fileName, song.WavFileContent.data(), song.WavFileContent.size(), streamed, 48000) == Audio::DecodeFileResult::FeelsGoodMan);
+			passed &= passed && decoder.DecodeAllRemainingChunks();
+			streamed.StreamingDecodedFrameCount = nullptr;
+			context.Check(passed && AreSampleBuffersEqual(streamed, reference), suite, "StreamedResampleMatchesEntireBuffer", static_cast<size_t>(reference.FrameCount));
+		}
+
+		Audio::PCMSampleBuffer decoded {};
+		Audio::DecodeEntireFile(fileName, song.WavFileContent.data(), song.WavFileContent.size(), decoded);
+
+		if (context.PassesFilter(suite, "ProgressiveMipsMatchEntireMips"))
+		{
+			b8 passed = true;
+			for (const b8 includeFullSizeMip : { false, true })
+			{
+				Audio::WaveformMipChain entire {};
+				entire.GenerateEntireMipChainFromSampleBuffer(decoded, 1, includeFullSizeMip);
+
+				// NOTE: Odd sized steps so that the chunk boundaries never line up with any of the power of two mip boundaries
+				Audio::WaveformMipChain progressive {};
+				progressive.BeginMipChainForSampleBuffer(decoded, includeFullSizeMip);
+				for (i64 availableFrameCount = 0; availableFrameCount < decoded.FrameCount; availableFrameCount += (Audio::StreamingDecoder::ChunkFrameCount + 4099))
+					progressive.UpdateMipChainFromSampleBuffer(decoded, 1, availableFrameCount);
+				progressive.UpdateMipChainFromSampleBuffer(decoded, 1, decoded.FrameCount);
+
+				passed &= AreMipChainsEqual(entire, progressive);
+			}
+			context.Check(passed, suite, "ProgressiveMipsMatchEntireMips", static_cast<size_t>(decoded.FrameCount));
+		}
+
+		if (context.PassesFilter(suite, "StereoMipsMatchSeparateMips"))
+		{
+			b8 passed = true;
+			for (const b8 includeFullSizeMip : { false, true })
+			{
+				Audio::WaveformMipChain separateL {}, separateR {};
+				separateL.GenerateEntireMipChainFromSampleBuffer(decoded, 0, includeFullSizeMip);
+				separateR.GenerateEntireMipChainFromSampleBuffer(decoded, 1, includeFullSizeMip);
+
+				Audio::WaveformMipChain stereoL {}, stereoR {};
+				Audio::WaveformMipChain::GenerateStereoMipChainsFromSampleBuffer(decoded, stereoL, stereoR, includeFullSizeMip);
+				passed &= AreMipChainsEqual(separateL, stereoL) && AreMipChainsEqual(separateR, stereoR);
+
+				Audio::WaveformMipChain progressiveL {}, progressiveR {};
+				progressiveL.BeginMipChainForSampleBuffer(decoded, includeFullSizeMip);
+				progressiveR.BeginMipChainForSampleBuffer(decoded, includeFullSizeMip);
+				for (i64 availableFrameCount = 0; availableFrameCount < decoded.FrameCount; availableFrameCount += (Audio::StreamingDecoder::ChunkFrameCount + 4099))
+					Audio::WaveformMipChain::UpdateStereoMipChainsFromSampleBuffer(decoded, progressiveL, progressiveR, availableFrameCount);
+				Audio::WaveformMipChain::UpdateStereoMipChainsFromSampleBuffer(decoded, progressiveL, progressiveR, decoded.FrameCount);
+				passed &= AreMipChainsEqual(separateL, progressiveL) && AreMipChainsEqual(separateR, progressiveR);
+			}
+			context.Check(passed, suite, "StereoMipsMatchSeparateMips", static_cast<size_t>(decoded.FrameCount));
+		}
+
+		if (context.PassesFilter(suite, "MipsPreservePeaks"))
+		{
+			// NOTE: A single sample click in otherwise complete silence, which averaging would have spread out to nothing after only a few mips
+			constexpr i64 clickFrame = 1234567;
+			constexpr i16 clickSampleL = -20000, clickSampleR = 30000;
+			std::vector<i16> clickSamples(static_cast<size_t>(song.FrameCount) * 2, 0);
+			clickSamples[(clickFrame * 2) + 0] = clickSampleL;
+			clickSamples[(clickFrame * 2) + 1] = clickSampleR;
+			const Audio::PCMSampleBuffer clickBuffer = CreateSampleBuffer(clickSamples, 2, song.SampleRate);
+
+			Audio::WaveformMipChain waveformL {}, waveformR {};
+			Audio::WaveformMipChain::GenerateStereoMipChainsFromSampleBuffer(clickBuffer, waveformL, waveformR);
+
+			b8 passed = (waveformL.GetUsedMipCount() > 8);
+			for (i32 i = 0; i < waveformL.GetUsedMipCount(); i++)
+			{
+				const Audio::WaveformMip& mipL = waveformL.AllMips[i];
+				const Audio::WaveformMip& mipR = waveformR.AllMips[i];
+				const size_t clickSampleIndex = static_cast<size_t>(clickFrame) / mipL.FramesPerSample;
+				passed &= (waveformL.GetMipSamples(mipL)[clickSampleIndex].Low == Audio::QuantizeWaveformMinMax(clickSampleL, 0).Low);
+				passed &= (waveformR.GetMipSamples(mipR)[clickSampleIndex].High == Audio::QuantizeWaveformMinMax(0, clickSampleR).High);
+				passed &= (waveformR.GetMipSamples(mipR)[clickSampleIndex + 1].Peak() == 0);
+
+				const Time clickTime = Audio::FramesToTime(clickFrame, song.SampleRate);
+				passed &= (waveformR.GetAmplitudeAt(mipR, clickTime - mipR.TimePerSample, mipR.TimePerSample * 3.0) >= (static_cast<f32>(clickSampleR) / 32768.0f));
+			}
+			context.Check(passed, suite, "MipsPreservePeaks", static_cast<size_t>(waveformL.GetUsedMipCount()));
+		}
+
+		if (context.PassesFilter(suite, "MipArenaSmallerThanAveragedMips"))
+		{
+			Audio::WaveformMipChain waveform {};
+			waveform.BeginMipChainForSampleBuffer(decoded);
+			const size_t arenaByteSize = (waveform.SampleArenaSize * sizeof(Audio::WaveformMinMax));
+			context.Check(arenaByteSize < GetAveragedPowerOfTwoMipChainByteSize(decoded.FrameCount), suite, "MipArenaSmallerThanAveragedMips", arenaByteSize);
+		}
+
+		constexpr size_t timelinePixelCount = 2048;
+		Audio::WaveformMipChain decodedWaveformL {}, decodedWaveformR {};
+		Audio::WaveformMipChain::GenerateStereoMipChainsFromSampleBuffer(decoded, decodedWaveformL, decodedWaveformR);
+
+		if (context.PassesFilter(suite, "ClosestMipCoversOneToTwoSamplesPerPixel"))
+		{
+			const Audio::WaveformMip& baseMip = decodedWaveformL.AllMips[0];
+			const Audio::WaveformMip& topMip = decodedWaveformL.AllMips[decodedWaveformL.GetUsedMipCount() - 1];
+
+			b8 passed = true;
+			size_t checkedCount = 0;
+			for (Time timePerPixel = (baseMip.TimePerSample * 0.25); timePerPixel < (decodedWaveformL.Duration * 2.0); timePerPixel = (timePerPixel * 1.1))
+			{
+				const Audio::WaveformMip& mip = decodedWaveformL.FindClosestMip(timePerPixel);
+				if (timePerPixel < baseMip.TimePerSample)
+					passed &= (&mip == &baseMip);
+				else if (timePerPixel >= (topMip.TimePerSample * 2.0))
+					passed &= (&mip == &topMip);
+				else
+					passed &= (mip.TimePerSample <= timePerPixel) && (timePerPixel < (mip.TimePerSample * 2.0));
+				checkedCount++;
+			}
+			context.Check(passed, suite, "ClosestMipCoversOneToTwoSamplesPerPixel", checkedCount);
+		}
+
+		if (context.PassesFilter(suite, "PixelAmplitudesCoverSourcePeaks"))
+		{
+			// NOTE: No matter the zoom level, the amplitude of each pixel should never be lower than the loudest source frame entirely inside of it
+			b8 passed = true;
+			std::vector<f32> amplitudes(timelinePixelCount);
+			for (const Time visibleDuration : { Time::FromSec(1.0), Time::FromSec(30.0), decodedWaveformL.Duration })
+			{
+				const Time startTime = (decodedWaveformL.Duration - visibleDuration) * 0.5;
+				const Time timePerPixel = Time::FromSec(visibleDuration.Seconds / static_cast<f64>(timelinePixelCount));
+				decodedWaveformL.GetAmplitudesForPixels(startTime, timePerPixel, amplitudes.data(), amplitudes.size());
+
+				for (size_t pixel = 0; pixel < timelinePixelCount; pixel++)
+				{
+					const Time pixelStart = startTime + (timePerPixel * static_cast<f64>(pixel));
+					const i64 firstFrame = static_cast<i64>(Ceil(pixelStart.Seconds * static_cast<f64>(decoded.SampleRate)));
+					const i64 endFrame = Min(static_cast<i64>(Floor((pixelStart + timePerPixel).Seconds * static_cast<f64>(decoded.SampleRate))), decoded.FrameCount);
+
+					i32 peak = 0;
+					for (i64 frame = firstFrame; frame < endFrame; frame++)
+						peak = Max(peak, Absolute(static_cast<i32>(decoded.InterleavedSamples[frame * 2])));
+					passed &= (amplitudes[pixel] >= Min(static_cast<f32>(peak) / 32768.0f, 1.0f));
+				}
+			}
+			context.Check(passed, suite, "PixelAmplitudesCoverSourcePeaks", timelinePixelCount * 3);
+		}
+
+		{
+			Audio::PCMSampleBuffer buffer {};
+			context.Run(suite, "OpenAndDecodeFirstChunk", static_cast<size_t>(song.FrameCount), 1, [&] { buffer = {}; }, [&]
+			{
+				Audio::StreamingDecoder decoder {};
+				decoder.Open(fileName, song.WavFileContent.data(), song.WavFileContent.size(), buffer);
+				decoder.DecodeNextChunk();
+				DoNotOptimizeAway(buffer.GetAvailableFrameCount());
+			});
+		}
+
+		{
+			Audio::PCMSampleBuffer buffer {};
+			context.Run(suite, "DecodeEntireFile", static_cast<size_t>(song.FrameCount), 1, [&] { buffer = {}; }, [&]
+			{
+				Audio::DecodeEntireFile(fileName, song.WavFileContent.data(), song.WavFileContent.size(), buffer);
+				DoNotOptimizeAway(buffer.FrameCount);
+			});
+		}
+
+		{
+			Audio::PCMSampleBuffer buffer {};
+			context.Run(suite, "DecodeEntireFileResampled (44100->48000)", static_cast<size_t>(song.FrameCount), 1, [&] { buffer = {}; }, [&]
+			{
+				Audio::DecodeEntireFile(fileName, song.WavFileContent.data(), song.WavFileContent.size(), buffer, 48000);
+				DoNotOptimizeAway(buffer.FrameCount);
+			});
+		}
+
+		{
+			Audio::WaveformMipChain waveform {};
+			context.Run(suite, "GenerateEntireMipChain", static_cast<size_t>(decoded.FrameCount), 1, [&]
+			{
+				waveform.GenerateEntireMipChainFromSampleBuffer(decoded, 0);
+				DoNotOptimizeAway(waveform.SampleArenaSize);
+			});
+		}
+
+		{
+			Audio::WaveformMipChain waveformL {}, waveformR {};
+			context.Run(suite, "GenerateStereoMipChains", static_cast<size_t>(decoded.FrameCount), 1, [&]
+			{
+				Audio::WaveformMipChain::GenerateStereoMipChainsFromSampleBuffer(decoded, waveformL, waveformR);
+				DoNotOptimizeAway(waveformR.SampleArenaSize);
+			});
+		}
+
+		// NOTE: Roughly the width of a maximized timeline, with the cost per pixel being independent of how much of the song is visible
+		for (const auto[name, visibleDuration] : { std::pair { "GetAmplitudesForPixels (Entire Song)", decodedWaveformL.Duration }, std::pair { "GetAmplitudesForPixels (1 Second)", Time::FromSec(1.0) } })
+		{
+			std::vector<f32> amplitudes(timelinePixelCount);
+			const Time timePerPixel = Time::FromSec(visibleDuration.Seconds / static_cast<f64>(timelinePixelCount));
+			context.Run(suite, name, timelinePixelCount, timelinePixelCount, [&]
+			{
+				decodedWaveformL.GetAmplitudesForPixels(Time::Zero(), timePerPixel, amplitudes.data(), amplitudes.size());
+				DoNotOptimizeAway(amplitudes[timelinePixelCount - 1]);
+			});
+		}
+
+		{
+			// NOTE: For reference, the cost of always reading every base mip sample covered by each pixel
+			std::vector<f32> amplitudes(timelinePixelCount);
+			const Time timePerPixel = Time::FromSec(decodedWaveformL.Duration.Seconds / static_cast<f64>(timelinePixelCount));
+			context.Run(suite, "GetAmplitudeAt (Base Mip, Entire Song)", timelinePixelCount, timelinePixelCount, [&]
+			{
+				for (size_t pixel = 0; pixel < timelinePixelCount; pixel++)
+					amplitudes[pixel] = decodedWaveformL.GetAmplitudeAt(decodedWaveformL.AllMips[0], timePerPixel * static_cast<f64>(pixel), timePerPixel);
+				DoNotOptimizeAway(amplitudes[timelinePixelCount - 1]);
+			});
+		}
+	}
+
+	// NOTE: Linear sine sweep which can be evaluated analytically at any point in time, so that the ideal resampled output is known exactly
+	struct SineSweep
+	{
+		f64 StartFrequency;
+		f64 EndFrequency;
+		f64 DurationSec;
+		f64 Amplitude = 16384.0;
+
+		inline f64 SampleAt(f64 second) const
+		{
+			const f64 phase = (StartFrequency * second) + ((EndFrequency - StartFrequency) * (second * second) / (2.0 * DurationSec));
+			return Amplitude * ::sin(2.0 * 3.14159265358979323846 * phase);
+		}
+	};
+
+	static std::vector<i16> CreateSineSweepSamples(const SineSweep& sweep, u32 sampleRate, u32 channelCount)
+	{
+		std::vector<i16> samples(static_cast<size_t>(sweep.DurationSec * sampleRate) * channelCount);
+		for (size_t frame = 0; frame < (samples.size() / channelCount); frame++)
+		{
+			const i16 sample = static_cast<i16>(::round(sweep.SampleAt(static_cast<f64>(frame) / static_cast<f64>(sampleRate))));
+			for (u32 channel = 0; channel < channelCount; channel++)
+				samples[(frame * channelCount) + channel] = sample;
+		}
+		return samples;
+	}
+
+	// NOTE: Either the signal to noise ratio compared to the ideal sweep, or (for sweeps entirely above the target nyquist frequency) the level of whatever aliased back down,
+	//		 both in decibel. The beginning and end are skipped as the sweep abruptly starting and stopping isn't band limited itself
+	static f64 MeasureResampledSweepErrorDB(const SineSweep& sweep, const i16* samples, i64 frameCount, u32 sampleRate, u32 channelCount, b8 expectSilence)
+	{
+		const i64 edgeFrameCount = static_cast<i64>(sampleRate / 20);
+		f64 signalPower = 0.0, errorPower = 0.0;
+		for (i64 frame = edgeFrameCount; frame < (frameCount - edgeFrameCount); frame++)
+		{
+			const f64 expected = sweep.SampleAt(static_cast<f64>(frame) / static_cast<f64>(sampleRate));
+			for (u32 channel = 0; channel < channelCount; channel++)
+			{
+				const f64 error = static_cast<f64>(samples[(frame * channelCount) + channel]) - (expectSilence ? 0.0 : expected);
+				signalPower += (expected * expected);
+				errorPower += (error * error);
+			}
+		}
+		return 10.0 * ::log10(ClampBot(errorPower, 1.0) / ClampBot(signalPower, 1.0));
+	}
+
+	void RunAudioResampleBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "AudioResample";
+		static constexpr std::string_view names[] = { "StreamedChunksMatchEntireBuffer", "SineSweepSNR (48000->44100)", "SineSweepSNR (32000->44100)", "AliasingFloor (48000->44100)",
+			"ResampleSong 48000->44100 (Polyphase)", "ResampleSong 48000->44100 (Linear)" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		constexpr u32 targetSampleRate = 44100;
+		auto resample = [](const std::vector<i16>& samples, u32 channelCount, u32 sampleRate, b8 linear) -> std::pair<std::unique_ptr<i16[]>, i64>
+		{
+			i64 frameCount = static_cast<i64>(samples.size() / channelCount);
+			auto buffer = std::unique_ptr<i16[]>(new i16[samples.size()]);
+			std::copy(samples.begin(), samples.end(), buffer.get());
+			if (linear)
+				Audio::LinearlyResampleBuffer<i16>(buffer, frameCount, sampleRate, channelCount, targetSampleRate);
+			else
+				Audio::ResampleBuffer(buffer, frameCount, sampleRate, channelCount, targetSampleRate);
+			return { std::move(buffer), frameCount };
+		};
+
+		if (context.PassesFilter(suite, "StreamedChunksMatchEntireBuffer"))
+		{
+			// NOTE: Odd chunk sizes (down to single frames) for both an exact phase ratio and one that has to round to the closest of the maximum number of phases
+			const SyntheticSong song = CreateSyntheticSong(2, 48000, Time::FromSec(3.0));
+			b8 passed = true;
+			for (const u32 sourceSampleRate : { 48000u, 44056u })
+			{
+				const auto [reference, referenceFrameCount] = resample(song.InterleavedSamples, song.ChannelCount, sourceSampleRate, false);
+
+				Audio::PolyphaseResampler resampler {};
+				resampler.Initialize(sourceSampleRate, targetSampleRate, song.ChannelCount);
+				std::vector<i16> streamed(static_cast<size_t>(referenceFrameCount) * song.ChannelCount);
+
+				static constexpr i64 chunkFrameCounts[] = { 1, 7, 4099, 63, 16384, 2 };
+				i64 readFrameCount = 0, writtenFrameCount = 0;
+				for (size_t i = 0; readFrameCount < song.FrameCount; i++)
+				{
+					const i64 framesToRead = Min(chunkFrameCounts[i % ArrayCount(chunkFrameCounts)], (song.FrameCount - readFrameCount));
+					writtenFrameCount += resampler.Process(&song.InterleavedSamples[static_cast<size_t>(readFrameCount) * song.ChannelCount], framesToRead, &streamed[static_cast<size_t>(writtenFrameCount) * song.ChannelCount], (referenceFrameCount - writtenFrameCount));
+					readFrameCount += framesToRead;
+				}
+				writtenFrameCount += resampler.ProcessEndOfInput(&streamed[static_cast<size_t>(writtenFrameCount) * song.ChannelCount], (referenceFrameCount - writtenFrameCount));
+
+				passed &= (writtenFrameCount == referenceFrameCount);
+				passed &= (memcmp(streamed.data(), reference.get(), streamed.size() * sizeof(i16)) == 0);
+			}
+			context.Check(passed, suite, "StreamedChunksMatchEntireBuffer", static_cast<size_t>(song.FrameCount));
+		}
+
+		// NOTE: The linear interpolation is measured as well, with the band limited version having to beat it by a wide margin on top of meeting the absolute thresholds
+		struct QualityCheck { std::string_view Name; u32 SourceSampleRate; SineSweep Sweep; b8 ExpectSilence; f64 MaxErrorDB; };
+		const QualityCheck qualityChecks[] =
+		{
+			{ names[1], 48000, SineSweep { 20.0, 16000.0, 4.0 }, false, -60.0 },
+			{ names[2], 32000, SineSweep { 20.0, 12000.0, 4.0 }, false, -60.0 },
+			{ names[3], 48000, SineSweep { 22400.0, 23900.0, 4.0 }, true, -70.0 },
+		};
+		for (const QualityCheck& check : qualityChecks)
+		{
+			if (!context.PassesFilter(suite, check.Name))
+				continue;
+
+			const std::vector<i16> sweepSamples = CreateSineSweepSamples(check.Sweep, check.SourceSampleRate, 2);
+			const auto [polyphase, polyphaseFrameCount] = resample(sweepSamples, 2, check.SourceSampleRate, false);
+			const auto [linear, linearFrameCount] = resample(sweepSamples, 2, check.SourceSampleRate, true);
+
+			const f64 polyphaseErrorDB = MeasureResampledSweepErrorDB(check.Sweep, polyphase.get(), polyphaseFrameCount, targetSampleRate, 2, check.ExpectSilence);
+			const f64 linearErrorDB = MeasureResampledSweepErrorDB(check.Sweep, linear.get(), linearFrameCount, targetSampleRate, 2, check.ExpectSilence);
+			context.Check((polyphaseErrorDB <= check.MaxErrorDB) && (polyphaseErrorDB <= (linearErrorDB - 20.0)), suite, check.Name, static_cast<size_t>(polyphaseFrameCount));
+		}
+
+		const SyntheticSong song = CreateSyntheticSong(2, 48000, Time::FromSec(60.0));
+		for (const auto& [name, linear] : { std::pair<std::string_view, b8> { names[4], false }, std::pair<std::string_view, b8> { names[5], true } })
+		{
+			const i64 outputSampleCount = Audio::PolyphaseResampler::GetOutputFrameCount(song.FrameCount, song.SampleRate, targetSampleRate) * song.ChannelCount;
+			context.Run(suite, name, song.InterleavedSamples.size(), static_cast<size_t>(outputSampleCount), [&]
+			{
+				const auto [resampled, frameCount] = resample(song.InterleavedSamples, song.ChannelCount, song.SampleRate, linear);
+				DoNotOptimizeAway(resampled[static_cast<size_t>(frameCount - 1)]);
+			});
+		}
+	}
+
+	void RunAudioMixBusBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "AudioMixBus";
+		static constexpr std::string_view names[] = { "KernelsMatchScalar", "SingleFinalClamp", "LegacyI16PerVoiceClamp", "F32BusConstantVolume", "F32BusVolumeRamp" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		// NOTE: The song, the metronome and a full pool of hit sound voices all active at once, rendering the default 64 frame stereo buffers
+		constexpr size_t voiceCount = 34, frameCount = 64, sampleCount = (frameCount * 2), callbackCount = 1024;
+		constexpr f32 masterVolume = 0.75f;
+
+		RandomGenerator random {};
+		std::vector<i16> voiceSamples(voiceCount * sampleCount);
+		std::vector<f32> voiceVolumes(voiceCount), frameVolumes(frameCount);
+		for (i16& sample : voiceSamples) sample = static_cast<i16>(random.NextI32InRange(-12000, 12000));
+		for (f32& volume : voiceVolumes) volume = random.NextF32() * 0.5f;
+		for (size_t f = 0; f < frameCount; f++) frameVolumes[f] = static_cast<f32>(f) / static_cast<f32>(frameCount);
+
+		if (context.PassesFilter(suite, "KernelsMatchScalar"))
+		{
+			// NOTE: Odd sizes to also cover the scalar tail loops after the last full vector
+			b8 passed = true;
+			for (const size_t testFrameCount : { frameCount, frameCount - 3 })
+			{
+				const size_t testSampleCount = (testFrameCount * 2);
+				std::vector<f32> bus(testSampleCount, 0.0f), expectedBus(testSampleCount, 0.0f);
+				for (size_t v = 0; v < voiceCount; v++)
+				{
+					const i16* samples = &voiceSamples[v * sampleCount];
+					if (v & 1)
+					{
+						Audio::MixSamplesI16IntoBusF32(bus.data(), samples, testSampleCount, voiceVolumes[v]);
+						for (size_t i = 0; i < testSampleCount; i++) expectedBus[i] += (static_cast<f32>(samples[i]) * voiceVolumes[v]);
+					}
+					else
+					{
+						Audio::MixStereoSamplesI16IntoBusF32(bus.data(), samples, frameVolumes.data(), testFrameCount);
+						for (size_t i = 0; i < testSampleCount; i++) expectedBus[i] += (static_cast<f32>(samples[i]) * frameVolumes[i / 2]);
+					}
+				}
+				passed &= (bus == expectedBus);
+
+				std::vector<i16> output(testSampleCount), expectedOutput(testSampleCount);
+				Audio::ConvertBusF32ToSamplesI16Clamped(bus.data(), output.data(), testSampleCount, masterVolume);
+				for (size_t i = 0; i < testSampleCount; i++) expectedOutput[i] = static_cast<i16>(Clamp(bus[i] * masterVolume, static_cast<f32>(I16Min + 1), static_cast<f32>(I16Max - 1)));
+				passed &= (output == expectedOutput);
+			}
+			context.Check(passed, suite, "KernelsMatchScalar", voiceCount * sampleCount);
+		}
+
+		if (context.PassesFilter(suite, "SingleFinalClamp"))
+		{
+			// NOTE: Two loud voices cancelling each other out must not be clipped individually before being summed together
+			const i16 loud[8] = { 30000, 30000, 30000, 30000, -30000, -30000, -30000, -30000 };
+			const i16 inverse[8] = { -30000, -30000, -30000, -30000, 30000, 30000, 30000, 30000 };
+			f32 bus[8] = {};
+			i16 output[8] = {};
+			Audio::MixSamplesI16IntoBusF32(bus, loud, 8, 2.0f);
+			Audio::MixSamplesI16IntoBusF32(bus, inverse, 8, 2.0f);
+			Audio::ConvertBusF32ToSamplesI16Clamped(bus, output, 8, 1.0f);
+			context.Check(std::all_of(std::begin(output), std::end(output), [](i16 v) { return v == 0; }), suite, "SingleFinalClamp", 8);
+		}
+
+		std::vector<i16> output(sampleCount);
+		std::vector<f32> bus(sampleCount);
+
+		context.Run(suite, "LegacyI16PerVoiceClamp", voiceCount, callbackCount, [&]
+		{
+			for (size_t callback = 0; callback < callbackCount; callback++)
+			{
+				std::fill(output.begin(), output.end(), static_cast<i16>(0));
+				for (size_t v = 0; v < voiceCount; v++)
+				{
+					const i16* samples = &voiceSamples[v * sampleCount];
+					for (size_t i = 0; i < sampleCount; i++)
+						output[i] = Audio::MixSamplesI16_Clamped(output[i], Audio::ScaleSampleI16Linear_AsI32(samples[i], voiceVolumes[v]));
+				}
+				for (size_t i = 0; i < sampleCount; i++)
+					output[i] = Audio::ScaleSampleI16Linear_Clamped(output[i], masterVolume);
+				DoNotOptimizeAway(output[callback % sampleCount]);
+			}
+		});
+
+		context.Run(suite, "F32BusConstantVolume", voiceCount, callbackCount, [&]
+		{
+			for (size_t callback = 0; callback < callbackCount; callback++)
+			{
+				std::fill(bus.begin(), bus.end(), 0.0f);
+				for (size_t v = 0; v < voiceCount; v++)
+					Audio::MixSamplesI16IntoBusF32(bus.data(), &voiceSamples[v * sampleCount], sampleCount, voiceVolumes[v]);
+				Audio::ConvertBusF32ToSamplesI16Clamped(bus.data(), output.data(), sampleCount, masterVolume);
+				DoNotOptimizeAway(output[callback % sampleCount]);
+			}
+		});
+
+		context.Run(suite, "F32BusVolumeRamp", voiceCount, callbackCount, [&]
+		{
+			for (size_t callback = 0; callback < callbackCount; callback++)
+			{
+				std::fill(bus.begin(), bus.end(), 0.0f);
+				for (size_t v = 0; v < voiceCount; v++)
+					Audio::MixStereoSamplesI16IntoBusF32(bus.data(), &voiceSamples[v * sampleCount], frameVolumes.data(), frameCount);
+				Audio::ConvertBusF32ToSamplesI16Clamped(bus.data(), output.data(), sampleCount, masterVolume);
+				DoNotOptimizeAway(output[callback % sampleCount]);
+			}
+		});
+	}
+
+	static std::vector<i16> CreateDecayingSineSoundEffect(f64 frequency, i64 frameCount, u32 sampleRate)
+	{
+		std::vector<i16> samples(static_cast<size_t>(frameCount));
+		for (i64 frame = 0; frame < frameCount; frame++)
+		{
+			const f64 sec = static_cast<f64>(frame) / static_cast<f64>(sampleRate);
+			samples[static_cast<size_t>(frame)] = static_cast<i16>(::sin(sec * frequency * 6.283185307179586) * ::exp(-sec * 30.0) * 24000.0);
+		}
+		return samples;
+	}
+
+	// NOTE: Estimated from the average distance between the (linearly interpolated) rising zero crossings of the first channel, which is good enough for a pure tone
+	static f64 MeasureToneFrequency(const i16* interleavedSamples, i64 frameCount, u32 channelCount, u32 sampleRate)
+	{
+		f64 firstCrossing = 0.0, lastCrossing = 0.0;
+		i64 crossingCount = 0;
+		for (i64 frame = 1; frame < frameCount; frame++)
+		{
+			const f64 previous = interleavedSamples[(frame - 1) * channelCount], current = interleavedSamples[frame * channelCount];
+			if (previous < 0.0 && current >= 0.0)
+			{
+				const f64 crossing = static_cast<f64>(frame - 1) + (-previous / (current - previous));
+				firstCrossing = (crossingCount == 0) ? crossing : firstCrossing;
+				lastCrossing = crossing;
+				crossingCount++;
+			}
+		}
+		return (crossingCount > 1) ? (static_cast<f64>(sampleRate) * static_cast<f64>(crossingCount - 1) / (lastCrossing - firstCrossing)) : 0.0;
+	}
+
+	static f64 MeasureRootMeanSquare(const i16* samples, size_t sampleCount)
+	{
+		f64 sum = 0.0;
+		for (size_t i = 0; i < sampleCount; i++)
+			sum += static_cast<f64>(samples[i]) * static_cast<f64>(samples[i]);
+		return ::sqrt(sum / static_cast<f64>(ClampBot<size_t>(sampleCount, 1)));
+	}
+
+	void RunAudioTimeStretchBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "AudioTimeStretch";
+		struct ToneCheck { std::string_view Name; f32 Speed; };
+		struct EngineRun { std::string_view Name; f32 Speed; b8 PreservePitch; };
+		static constexpr ToneCheck toneChecks[] = { { "PreservesPitchAndLevel (0.25x)", 0.25f }, { "PreservesPitchAndLevel (0.5x)", 0.5f }, { "PreservesPitchAndLevel (2x)", 2.0f }, };
+		static constexpr EngineRun engineRuns[] =
+		{
+			{ "Callback 64 frames 0.25x (PreservePitch)", 0.25f, true },
+			{ "Callback 64 frames 0.5x (PreservePitch)", 0.5f, true },
+			{ "Callback 64 frames 0.75x (PreservePitch)", 0.75f, true },
+			{ "Callback 64 frames 1.5x (PreservePitch)", 1.5f, true },
+			{ "Callback 64 frames 2x (PreservePitch)", 2.0f, true },
+			{ "Callback 64 frames 0.25x (Resample)", 0.25f, false },
+			{ "Callback 64 frames 0.5x (Resample)", 0.5f, false },
+			{ "Callback 64 frames 2x (Resample)", 2.0f, false },
+		};
+		static constexpr std::string_view otherNames[] = { "IndependentOfBufferSize", "WorstCaseCallbackWithinBudget (64 frame buffers)" };
+		if (std::none_of(std::begin(toneChecks), std::end(toneChecks), [&](const ToneCheck& it) { return context.PassesFilter(suite, it.Name); }) &&
+			std::none_of(std::begin(engineRuns), std::end(engineRuns), [&](const EngineRun& it) { return context.PassesFilter(suite, it.Name); }) &&
+			std::none_of(std::begin(otherNames), std::end(otherNames), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		constexpr u32 sampleRate = Audio::AudioEngine::OutputSampleRate;
+		constexpr u32 channelCount = Audio::TimeStretcher::ChannelCount;
+		constexpr f64 toneFrequency = 441.0;
+		static Audio::TimeStretcher stretcher {};
+
+		{
+			// NOTE: Resampling would shift the frequency by the playback speed, whereas time stretching has to keep both the pitch and level of the original tone
+			const std::vector<i16> toneSamples = CreateSineSweepSamples(SineSweep { toneFrequency, toneFrequency, 8.0, 12000.0 }, sampleRate, channelCount);
+			const i64 toneFrameCount = static_cast<i64>(toneSamples.size() / channelCount);
+			const f64 toneRootMeanSquare = MeasureRootMeanSquare(toneSamples.data(), toneSamples.size());
+
+			for (const ToneCheck& check : toneChecks)
+			{
+				if (!context.PassesFilter(suite, check.Name))
+					continue;
+
+				std::vector<i16> output(static_cast<size_t>(sampleRate * 2) * channelCount);
+				stretcher.Reset(static_cast<f64>(sampleRate));
+				stretcher.Render(toneSamples.data(), toneFrameCount, check.Speed, output.data(), static_cast<i64>(output.size() / channelCount));
+
+				const f64 frequency = MeasureToneFrequency(output.data(), static_cast<i64>(output.size() / channelCount), channelCount, sampleRate);
+				const f64 levelDB = 20.0 * ::log10(MeasureRootMeanSquare(output.data(), output.size()) / toneRootMeanSquare);
+				context.Check((Absolute(frequency - toneFrequency) <= (toneFrequency * 0.005)) && (Absolute(levelDB) <= 1.0), suite, check.Name, output.size() / channelCount);
+			}
+		}
+
+		const SyntheticSong song = CreateSyntheticSong(channelCount, sampleRate, Time::FromSec(20.0));
+		if (context.PassesFilter(suite, "IndependentOfBufferSize"))
+		{
+			// NOTE: Hops are only ever synthesized on demand, so how the output is split into buffers must neither affect the output nor the source position
+			constexpr f32 speed = 0.75f;
+			constexpr i64 renderFrameCount = (sampleRate * 3);
+			constexpr f64 startFrame = 12345.5;
+
+			std::vector<i16> whole(static_cast<size_t>(renderFrameCount) * channelCount);
+			stretcher.Reset(startFrame);
+			stretcher.Render(song.InterleavedSamples.data(), song.FrameCount, speed, whole.data(), renderFrameCount);
+			b8 passed = (Absolute(stretcher.GetSourceFramePosition() - (startFrame + (renderFrameCount * static_cast<f64>(speed)))) < 0.0001);
+
+			for (const i64 bufferFrameCount : { 64, 333 })
+			{
+				std::vector<i16> buffered(whole.size());
+				stretcher.Reset(startFrame);
+				for (i64 frame = 0; frame < renderFrameCount; frame += bufferFrameCount)
+					stretcher.Render(song.InterleavedSamples.data(), song.FrameCount, speed, &buffered[static_cast<size_t>(frame) * channelCount], Min(bufferFrameCount, renderFrameCount - frame));
+
+				passed &= (buffered == whole);
+				passed &= (Absolute(stretcher.GetSourceFramePosition() - (startFrame + (renderFrameCount * static_cast<f64>(speed)))) < 0.0001);
+			}
+			context.Check(passed, suite, "IndependentOfBufferSize", static_cast<size_t>(renderFrameCount));
+		}
+
+		Audio::Engine.ApplicationStartup();
+		Audio::Engine.SetBackend(Audio::Backend::Offline);
+		Audio::Engine.SetBufferFrameSize(Audio::AudioEngine::DefaultBufferFrameCount);
+		Audio::Engine.OpenStartStream();
+
+		constexpr u32 bufferFrameCount = Audio::AudioEngine::DefaultBufferFrameCount;
+		constexpr size_t callbackCount = (sampleRate * 5) / bufferFrameCount;
+		const Audio::SourceHandle songSource = Audio::Engine.LoadSourceFromBufferMove("song", CreateSampleBuffer(song.InterleavedSamples, song.ChannelCount, song.SampleRate));
+		Audio::Voice voice = Audio::Engine.AddVoice(songSource, "song", true, Audio::AudioEngine::MaxVolume, true);
+		std::vector<i16> output(bufferFrameCount * Audio::AudioEngine::OutputChannelCount);
+
+		if (context.PassesFilter(suite, "WorstCaseCallbackWithinBudget (64 frame buffers)"))
+		{
+			// NOTE: The most expensive callbacks are the ones synthesizing the next hop, which has to comfortably fit into the duration of a single buffer.
+			//		 Each callback is timed across multiple repetitions with only the fastest one counting, so that the thread being preempted doesn't lead to false positives
+			const Time bufferDuration = Audio::FramesToTime(bufferFrameCount, sampleRate);
+			Time worstCallbackDuration = Time::Zero();
+			for (const f32 speed : { 0.25f, 2.0f })
+			{
+				std::vector<Time> fastestCallbackDurations(callbackCount, Time::FromSec(F64Max));
+				voice.SetPlaybackSpeed(speed);
+				voice.SetPreservePitch(true);
+				for (i32 repetition = 0; repetition < 3; repetition++)
+				{
+					voice.SetPosition(Time::Zero());
+					for (size_t i = 0; i < callbackCount; i++)
+					{
+						CPUStopwatch stopwatch = CPUStopwatch::StartNew();
+						Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+						fastestCallbackDurations[i] = Min(fastestCallbackDurations[i], stopwatch.Stop());
+					}
+				}
+				for (const Time duration : fastestCallbackDurations)
+					worstCallbackDuration = Max(worstCallbackDuration, duration);
+			}
+			context.Check(worstCallbackDuration.ToSec() < (bufferDuration.ToSec() * 0.5), suite, "WorstCaseCallbackWithinBudget (64 frame buffers)", callbackCount * 2);
+		}
+
+		for (const EngineRun& run : engineRuns)
+		{
+			voice.SetPlaybackSpeed(run.Speed);
+			voice.SetPreservePitch(run.PreservePitch);
+			context.Run(suite, run.Name, callbackCount * bufferFrameCount, callbackCount, [&] { voice.SetPosition(Time::Zero()); }, [&]
+			{
+				for (size_t i = 0; i < callbackCount; i++)
+					Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+				DoNotOptimizeAway(output[0]);
+			});
+		}
+
+		Audio::Engine.RemoveVoice(voice);
+		Audio::Engine.StopCloseStream();
+		Audio::Engine.ApplicationShutdown();
+	}
+
+	void RunAudioVoicePoolBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "AudioVoicePool";
+		static constexpr std::string_view names[] = { "StaleVoiceHandlesRejected", "StaleSourceHandlesRejected", "ConfigurablePoolSize (8192 sources)", "AddRemoveVoice (127 others alive)",
+			"LoadUnloadSource (8191 others loaded)", "Callback 64 frames (2 of 128 voices alive)", "Callback 64 frames (128 of 128 voices alive)" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		constexpr u32 sampleRate = Audio::AudioEngine::OutputSampleRate;
+		constexpr size_t voiceCount = 128;
+		constexpr size_t sourceCount = 8192;
+
+		Audio::EngineStartupParam startupParam {};
+		startupParam.MaxSimultaneousVoices = voiceCount;
+		startupParam.MaxLoadedSources = sourceCount;
+		Audio::Engine.ApplicationStartup(startupParam);
+		Audio::Engine.SetBackend(Audio::Backend::Offline);
+
+		const Audio::SourceHandle toneSource = Audio::Engine.LoadSourceFromBufferMove("tone", CreateSampleBuffer(CreateDecayingSineSoundEffect(440.0, sampleRate, sampleRate), 1, sampleRate));
+
+		if (context.PassesFilter(suite, "StaleVoiceHandlesRejected"))
+		{
+			// NOTE: Without any other voices the freed slot is reused right away, with only the generation telling the old and new handle apart
+			Audio::Voice removedVoice = Audio::Engine.AddVoice(toneSource, "removed", false);
+			Audio::Engine.RemoveVoice(removedVoice);
+			Audio::Voice reusedVoice = Audio::Engine.AddVoice(toneSource, "reused", false, 0.5f);
+
+			removedVoice.SetVolume(1.0f);
+			b8 passed = (static_cast<Audio::HandleBaseType>(removedVoice.Handle) & 0xFFFF) == (static_cast<Audio::HandleBaseType>(reusedVoice.Handle) & 0xFFFF);
+			passed &= !removedVoice.IsValid() && reusedVoice.IsValid() && (reusedVoice.GetVolume() == 0.5f) && (removedVoice.GetName() != reusedVoice.GetName());
+
+			Audio::Engine.RemoveVoice(removedVoice);
+			passed &= reusedVoice.IsValid();
+			Audio::Engine.RemoveVoice(reusedVoice);
+			passed &= !reusedVoice.IsValid();
+			context.Check(passed, suite, "StaleVoiceHandlesRejected", 2);
+		}
+
+		if (context.PassesFilter(suite, "StaleSourceHandlesRejected"))
+		{
+			const Audio::SourceHandle unloadedSource = Audio::Engine.LoadSourceFromBufferMove("unloaded", CreateSampleBuffer({ 1, 2, 3, 4 }, 1, sampleRate));
+			Audio::Engine.UnloadSource(unloadedSource);
+			const Audio::SourceHandle reusedSource = Audio::Engine.LoadSourceFromBufferMove("reused", CreateSampleBuffer({ 1, 2 }, 1, sampleRate));
+
+			b8 passed = (static_cast<Audio::HandleBaseType>(unloadedSource) & 0xFFFF) == (static_cast<Audio::HandleBaseType>(reusedSource) & 0xFFFF);
+			passed &= (Audio::Engine.GetSourceSampleBufferView(unloadedSource) == nullptr) && (Audio::Engine.GetSourceName(reusedSource) == "reused");
+
+			Audio::Engine.UnloadSource(unloadedSource);
+			passed &= (Audio::Engine.GetSourceSampleBufferView(reusedSource) != nullptr);
+			Audio::Engine.UnloadSource(reusedSource);
+			context.Check(passed, suite, "StaleSourceHandlesRejected", 2);
+		}
+
+		if (context.PassesFilter(suite, "AddRemoveVoice (127 others alive)"))
+		{
+			// NOTE: Without a running stream all commands are executed right away, so each removed slot is immediately available again
+			std::vector<Audio::VoiceHandle> otherVoices;
+			for (size_t i = 0; i < (voiceCount - 1); i++)
+				otherVoices.push_back(Audio::Engine.AddVoice(toneSource, "other", false));
+
+			constexpr size_t operationCount = 10000;
+			context.Run(suite, "AddRemoveVoice (127 others alive)", voiceCount, operationCount, [&] {}, [&]
+			{
+				for (size_t i = 0; i < operationCount; i++)
+					Audio::Engine.RemoveVoice(Audio::Engine.AddVoice(toneSource, "churn", false));
+			});
+
+			for (const Audio::VoiceHandle voice : otherVoices)
+				Audio::Engine.RemoveVoice(voice);
+		}
+
+		if (context.PassesFilter(suite, "ConfigurablePoolSize (8192 sources)") || context.PassesFilter(suite, "LoadUnloadSource (8191 others loaded)"))
+		{
+			std::vector<Audio::SourceHandle> otherSources;
+			for (size_t i = 0; i < (sourceCount - 2); i++)
+				otherSources.push_back(Audio::Engine.LoadSourceFromBufferMove("other", CreateSampleBuffer({ 0 }, 1, sampleRate)));
+
+			// NOTE: All of them having been loaded successfully also verifies that the pool size is configurable beyond the defaults
+			const b8 allLoaded = std::none_of(otherSources.begin(), otherSources.end(), [](Audio::SourceHandle it) { return it == Audio::SourceHandle::Invalid; });
+			context.Check(allLoaded, suite, "ConfigurablePoolSize (8192 sources)", otherSources.size());
+
+			constexpr size_t operationCount = 10000;
+			context.Run(suite, "LoadUnloadSource (8191 others loaded)", sourceCount, operationCount, [&] {}, [&]
+			{
+				for (size_t i = 0; i < operationCount; i++)
+					Audio::Engine.UnloadSource(Audio::Engine.LoadSourceFromBufferMove("churn", Audio::PCMSampleBuffer {}));
+			});
+
+			for (const Audio::SourceHandle source : otherSources)
+				Audio::Engine.UnloadSource(source);
+			Audio::Engine.FreeRetiredSourceBuffers();
+		}
+
+		Audio::Engine.OpenStartStream();
+		{
+			// NOTE: Looping voices so that none of them ever reach their end, with the callback then only having to iterate the ones actually alive
+			constexpr size_t callbackCount = 4096;
+			constexpr u32 bufferFrameCount = Audio::AudioEngine::DefaultBufferFrameCount;
+			std::vector<i16> output(bufferFrameCount * Audio::AudioEngine::OutputChannelCount);
+
+			for (const auto& [name, aliveCount] : { std::pair<std::string_view, size_t> { names[5], 2 }, std::pair<std::string_view, size_t> { names[6], voiceCount } })
+			{
+				if (!context.PassesFilter(suite, name))
+					continue;
+
+				std::vector<Audio::Voice> aliveVoices;
+				for (size_t i = 0; i < aliveCount; i++)
+				{
+					aliveVoices.push_back(Audio::Engine.AddVoice(toneSource, "alive", true, 0.01f));
+					aliveVoices.back().SetIsLooping(true);
+				}
+
+				context.Run(suite, name, aliveCount, callbackCount, [&] {}, [&]
+				{
+					for (size_t i = 0; i < callbackCount; i++)
+						Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+					DoNotOptimizeAway(output[0]);
+				});
+
+				for (const Audio::Voice voice : aliveVoices)
+					Audio::Engine.RemoveVoice(voice);
+				Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+			}
+		}
+
+		Audio::Engine.StopCloseStream();
+		Audio::Engine.ApplicationShutdown();
+	}
+
+	void RunAudioTelemetryBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "AudioTelemetry";
+		static constexpr std::string_view names[] = { "CountsMatchRenderedCallbacks", "ResetClearsCounts", "ExportsWellFormed", "Callback 64 frames (128 voices, costs tracked)",
+			"Callback 64 frames (128 voices, costs untracked)", "Snapshot (4096 callbacks, 128 voices)", "SnapshotToJSON (4096 callbacks, 128 voices)" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		constexpr u32 sampleRate = Audio::AudioEngine::OutputSampleRate;
+		constexpr u32 bufferFrameCount = Audio::AudioEngine::DefaultBufferFrameCount;
+		constexpr size_t voiceCount = 128;
+		std::vector<i16> output(bufferFrameCount * Audio::AudioEngine::OutputChannelCount);
+
+		Audio::Engine.ApplicationStartup();
+		Audio::Engine.SetBackend(Audio::Backend::Offline);
+		Audio::Engine.SetBufferFrameSize(bufferFrameCount);
+		Audio::Engine.OpenStartStream();
+
+		const Audio::SourceHandle toneSource = Audio::Engine.LoadSourceFromBufferMove("tone", CreateSampleBuffer(CreateDecayingSineSoundEffect(440.0, sampleRate, sampleRate), 1, sampleRate));
+		auto addLoopingVoices = [&](size_t count)
+		{
+			std::vector<Audio::Voice> voices;
+			for (size_t i = 0; i < count; i++)
+			{
+				voices.push_back(Audio::Engine.AddVoice(toneSource, "looping", true, 0.01f));
+				voices.back().SetIsLooping(true);
+			}
+			return voices;
+		};
+		auto removeVoices = [&](const std::vector<Audio::Voice>& voices)
+		{
+			for (const Audio::Voice voice : voices)
+				Audio::Engine.RemoveVoice(voice);
+			Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+		};
+
+		if (context.PassesFilter(suite, "CountsMatchRenderedCallbacks") || context.PassesFilter(suite, "ResetClearsCounts") || context.PassesFilter(suite, "ExportsWellFormed"))
+		{
+			constexpr i64 callbackCount = 100;
+			const std::vector<Audio::Voice> voices = addLoopingVoices(3);
+
+			Audio::Engine.ResetRenderTelemetry();
+			for (i64 i = 0; i < callbackCount; i++)
+				Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+			const Audio::RenderTelemetrySnapshot snapshot = Audio::Engine.GetRenderTelemetrySnapshot();
+
+			i64 histogramCount = 0;
+			for (const i64 binCount : snapshot.DurationHistogram)
+				histogramCount += binCount;
+
+			b8 countsPassed = (snapshot.CallbackCount == callbackCount) && (snapshot.RenderedFrameCount == (callbackCount * bufferFrameCount)) && (histogramCount == callbackCount);
+			countsPassed &= (snapshot.UnderrunCount == 0) && (snapshot.MaxDuration <= snapshot.TotalDuration) && (snapshot.EstimateDurationPercentile(99.9) <= snapshot.MaxDuration);
+			countsPassed &= (snapshot.RecentCallbacks.size() == static_cast<size_t>(callbackCount)) && (snapshot.RecentCallbacks.back().CallbackIndex == (callbackCount - 1));
+			countsPassed &= std::all_of(snapshot.RecentCallbacks.begin(), snapshot.RecentCallbacks.end(), [&](const Audio::RenderTelemetryCallback& it) { return it.FrameCount == bufferFrameCount && it.ActiveVoiceCount == voices.size(); });
+			countsPassed &= (Audio::Engine.DebugGetRenderPerformanceHistory().back() == snapshot.RecentCallbacks.back().Duration);
+
+			Time totalVoiceDuration = {};
+			countsPassed &= (snapshot.VoiceCosts.size() == voices.size());
+			for (const Audio::RenderTelemetryVoiceCost& voiceCost : snapshot.VoiceCosts)
+			{
+				countsPassed &= (voiceCost.CallbackCount == callbackCount) && (voiceCost.Name == "looping") && (voiceCost.MaxDuration <= voiceCost.TotalDuration);
+				totalVoiceDuration += voiceCost.TotalDuration;
+			}
+			countsPassed &= (totalVoiceDuration <= snapshot.TotalDuration);
+			countsPassed &= std::is_sorted(snapshot.VoiceCosts.begin(), snapshot.VoiceCosts.end(), [](auto& a, auto& b) { return a.TotalDuration > b.TotalDuration; });
+			context.Check(countsPassed, suite, "CountsMatchRenderedCallbacks", static_cast<size_t>(callbackCount));
+
+			if (context.PassesFilter(suite, "ExportsWellFormed"))
+			{
+				const std::string csv = Audio::RenderTelemetrySnapshotToCSV(snapshot);
+				const std::string json = Audio::RenderTelemetrySnapshotToJSON(snapshot);
+
+				b8 exportsPassed = (std::count(csv.begin(), csv.end(), '\n') == (callbackCount + 1)) && ASCII::StartsWith(csv, "callback_index,");
+				exportsPassed &= (std::count(json.begin(), json.end(), '{') == std::count(json.begin(), json.end(), '}'));
+				exportsPassed &= (std::count(json.begin(), json.end(), '[') == std::count(json.begin(), json.end(), ']'));
+				exportsPassed &= ASCII::StartsWith(json, "{") && ASCII::EndsWith(json, "}\n") && (json.find("\"callback_count\": 100,") != std::string::npos);
+				exportsPassed &= (json.find(",\n\t]") == std::string::npos) && (json.find("nan") == std::string::npos);
+				context.Check(exportsPassed, suite, "ExportsWellFormed", csv.size() + json.size());
+			}
+
+			if (context.PassesFilter(suite, "ResetClearsCounts"))
+			{
+				Audio::Engine.ResetRenderTelemetry();
+				const Audio::RenderTelemetrySnapshot resetSnapshot = Audio::Engine.GetRenderTelemetrySnapshot();
+				b8 resetPassed = (resetSnapshot.CallbackCount == 0) && (resetSnapshot.RenderedFrameCount == 0) && resetSnapshot.RecentCallbacks.empty() && (resetSnapshot.MaxDuration == Time::Zero());
+				resetPassed &= std::all_of(resetSnapshot.DurationHistogram.begin(), resetSnapshot.DurationHistogram.end(), [](i64 it) { return it == 0; });
+
+				Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+				resetPassed &= (Audio::Engine.GetRenderTelemetrySnapshot().CallbackCount == 1);
+				context.Check(resetPassed, suite, "ResetClearsCounts", 1);
+			}
+
+			removeVoices(voices);
+		}
+
+		{
+			const std::vector<Audio::Voice> voices = addLoopingVoices(voiceCount);
+			constexpr size_t callbackCount = 4096;
+
+			for (const auto& [name, trackCosts] : { std::pair<std::string_view, b8> { names[3], true }, std::pair<std::string_view, b8> { names[4], false } })
+			{
+				if (!context.PassesFilter(suite, name))
+					continue;
+
+				Audio::Engine.SetTrackVoiceRenderCosts(trackCosts);
+				context.Run(suite, name, voiceCount, callbackCount, [&] {}, [&]
+				{
+					for (size_t i = 0; i < callbackCount; i++)
+						Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+					DoNotOptimizeAway(output[0]);
+				});
+			}
+			Audio::Engine.SetTrackVoiceRenderCosts(true);
+
+			if (context.PassesFilter(suite, names[5]) || context.PassesFilter(suite, names[6]))
+			{
+				// NOTE: Filling up the entire callback history first, which is the worst case for both
+				for (size_t i = 0; i < Audio::RenderTelemetryCallbackHistoryCount; i++)
+					Audio::Engine.RenderOfflineFrames(output.data(), bufferFrameCount);
+
+				constexpr size_t snapshotCount = 64;
+				Audio::RenderTelemetrySnapshot snapshot = {};
+				context.Run(suite, names[5], voiceCount, snapshotCount, [&] {}, [&]
+				{
+					for (size_t i = 0; i < snapshotCount; i++)
+						snapshot = Audio::Engine.GetRenderTelemetrySnapshot();
+					DoNotOptimizeAway(snapshot.CallbackCount);
+				});
+
+				std::string json;
+				context.Run(suite, names[6], voiceCount, snapshotCount, [&] {}, [&]
+				{
+					for (size_t i = 0; i < snapshotCount; i++)
+						json = Audio::RenderTelemetrySnapshotToJSON(snapshot);
+					DoNotOptimizeAway(json[0]);
+				});
+			}
+
+			removeVoices(voices);
+		}
+
+		Audio::Engine.StopCloseStream();
+		Audio::Engine.ApplicationShutdown();
+	}
+
+	// NOTE: Fast 1/16th notes at 240 BPM (one measure per second) together with drumrolls and balloons, so that plenty of hit sound voices overlap at once
+	static std::string CreateSyntheticOfflineRenderTJA(i32 measureCount)
+	{
+		std::string tja = "TITLE:Offline Render\r\nBPM:240\r\nWAVE:song.wav\r\nOFFSET:-0.25\r\n\r\nCOURSE:Oni\r\nLEVEL:10\r\nBALLOON:8\r\n\r\n#START\r\n";
+		for (i32 measure = 0; measure < measureCount; measure++)
+		{
+			switch (measure % 8)
+			{
+			case 3: tja.append("5000000000000008,\r\n"); break;
+			case 7: tja.append("7000000000000008,\r\n"); break;
+			default: tja.append("1212112211121222,\r\n"); break;
+			}
+		}
+		tja.append("#END\r\n");
+		return tja;
+	}
+
+
+	void RunAudioOfflineRenderBenchmarks(Context& context)
+	{
+		using namespace PeepoDrumKit;
+
+		static constexpr std::string_view suite = "AudioOfflineRender";
+		static constexpr std::string_view names[] = { "DeterministicRender", "HitSoundStartJitter (64 frame buffers)", "HitSoundStartJitter (333 frame buffers)", "HitSoundStartJitter (1024 frame buffers)",
+			"LateScheduledStartSkipsAhead", "RenderChart (64 frame buffers)", "RenderChart (1024 frame buffers)" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		constexpr u32 sampleRate = Audio::AudioEngine::OutputSampleRate;
+		constexpr i32 measureCount = 60;
+
+		ChartProject chart;
+		{
+			TJA::ErrorList errors;
+			CreateChartProjectFromTJA(TJA::ParseTokens(TJA::TokenizeFileContent(CreateSyntheticOfflineRenderTJA(measureCount)), errors), chart);
+		}
+		const ChartCourse& course = *chart.Courses[0];
+
+		Audio::Engine.ApplicationStartup();
+		Audio::Engine.SetBackend(Audio::Backend::Offline);
+
+		const SyntheticSong song = CreateSyntheticSong(2, sampleRate, Time::FromSec(static_cast<f64>(measureCount)));
+		ChartAudioRenderParam param {};
+		param.Metronome = true;
+		param.SongVolume = 0.5f;
+		param.SongSource = Audio::Engine.LoadSourceFromBufferMove("song", CreateSampleBuffer(song.InterleavedSamples, song.ChannelCount, song.SampleRate));
+		for (size_t i = 0; i < EnumCount<SoundEffectType>; i++)
+			param.SoundEffectSources[i] = Audio::Engine.LoadSourceFromBufferMove(SoundEffectTypeFilePaths[i], CreateSampleBuffer(CreateDecayingSineSoundEffect(220.0 * static_cast<f64>(i + 1), 8000, sampleRate), 1, sampleRate));
+
+		if (context.PassesFilter(suite, "DeterministicRender"))
+		{
+			// NOTE: Neither the previous render nor the buffer size (other than the performance) may affect the output
+			std::vector<i16> first, second, oddBufferSize;
+			b8 passed = RenderChartCourseAudioOffline(chart, course, param, first);
+			passed &= RenderChartCourseAudioOffline(chart, course, param, second);
+			Audio::Engine.SetBufferFrameSize(333);
+			passed &= RenderChartCourseAudioOffline(chart, course, param, oddBufferSize);
+			Audio::Engine.SetBufferFrameSize(Audio::AudioEngine::DefaultBufferFrameCount);
+			passed &= !first.empty() && (first == second) && (first == oddBufferSize);
+			context.Check(passed, suite, "DeterministicRender", first.size() / Audio::AudioEngine::OutputChannelCount);
+		}
+
+		if (std::any_of(std::begin(names) + 1, std::begin(names) + 4, [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+		{
+			// NOTE: Single frame impulses without a song or metronome, so that the onset of every hit sound can be located exactly
+			const Audio::SourceHandle impulseSource = Audio::Engine.LoadSourceFromBufferMove("impulse", CreateSampleBuffer({ 16000 }, 1, sampleRate));
+			ChartAudioRenderParam impulseParam {};
+			impulseParam.DrumrollHitInterval = param.DrumrollHitInterval;
+			for (auto& source : impulseParam.SoundEffectSources)
+				source = impulseSource;
+
+			std::vector<i64> expectedFrames;
+			ForEachNoteHitSound(course.GetNotes(BranchType::Normal), course.TempoMap, impulseParam.DrumrollHitInterval, [&](Time time, NoteType) { expectedFrames.push_back(Audio::TimeToFrames(time, sampleRate)); });
+			std::sort(expectedFrames.begin(), expectedFrames.end());
+
+			// NOTE: Jitter being the onset error of each hit sound relative to its note, which for scheduled starts has to be exactly zero regardless of the buffer size
+			for (const auto& [name, bufferFrameCount] : { std::pair<std::string_view, u32> { names[1], 64 }, std::pair<std::string_view, u32> { names[2], 333 }, std::pair<std::string_view, u32> { names[3], 1024 } })
+			{
+				if (!context.PassesFilter(suite, name))
+					continue;
+
+				Audio::Engine.SetBufferFrameSize(bufferFrameCount);
+				std::vector<i16> output;
+				b8 passed = RenderChartCourseAudioOffline(chart, course, impulseParam, output);
+
+				std::vector<i64> actualFrames;
+				for (size_t frame = 0; frame < (output.size() / Audio::AudioEngine::OutputChannelCount); frame++)
+				{
+					if (output[frame * Audio::AudioEngine::OutputChannelCount] != 0)
+						actualFrames.push_back(static_cast<i64>(frame));
+				}
+
+				i64 maxJitterFrames = 0;
+				passed &= (actualFrames.size() == expectedFrames.size());
+				for (size_t i = 0; i < Min(actualFrames.size(), expectedFrames.size()); i++)
+					maxJitterFrames = Max(maxJitterFrames, Absolute(actualFrames[i] - expectedFrames[i]));
+
+				passed &= (maxJitterFrames == 0);
+				context.Check(passed, suite, name, expectedFrames.size());
+			}
+			Audio::Engine.SetBufferFrameSize(Audio::AudioEngine::DefaultBufferFrameCount);
+		}
+
+		if (context.PassesFilter(suite, "LateScheduledStartSkipsAhead"))
+		{
+			// NOTE: A start that has already been missed should play right away but skipped ahead by exactly as many frames as it is late
+			std::vector<i16> rampSamples(256);
+			for (size_t i = 0; i < rampSamples.size(); i++)
+				rampSamples[i] = static_cast<i16>(i + 1);
+
+			constexpr i64 lateFrameCount = 10;
+			const Audio::SourceHandle rampSource = Audio::Engine.LoadSourceFromBufferMove("ramp", CreateSampleBuffer(rampSamples, 1, sampleRate));
+
+			Audio::Engine.OpenStartStream();
+			Audio::Voice voice = Audio::Engine.AddVoice(rampSource, "ramp", false);
+			voice.SetPauseOnEnd(true);
+
+			std::vector<i16> output(Audio::AudioEngine::DefaultBufferFrameCount * Audio::AudioEngine::OutputChannelCount);
+			b8 passed = Audio::Engine.RenderOfflineFrames(output.data(), Audio::AudioEngine::DefaultBufferFrameCount);
+
+			const i64 lateStartCountBefore = Audio::Engine.DebugGetLateScheduledVoiceStartCount();
+			Audio::Engine.ScheduleVoiceStart(voice, Audio::Engine.GetStreamFramePosition() - lateFrameCount);
+			passed &= Audio::Engine.RenderOfflineFrames(output.data(), Audio::AudioEngine::DefaultBufferFrameCount);
+
+			for (i64 frame = 0; frame < Audio::AudioEngine::DefaultBufferFrameCount; frame++)
+				passed &= (output[frame * Audio::AudioEngine::OutputChannelCount] == rampSamples[lateFrameCount + frame]);
+			passed &= (Audio::Engine.DebugGetLateScheduledVoiceStartCount() == lateStartCountBefore + 1);
+
+			Audio::Engine.RemoveVoice(voice);
+			Audio::Engine.StopCloseStream();
+			context.Check(passed, suite, "LateScheduledStartSkipsAhead", Audio::AudioEngine::DefaultBufferFrameCount);
+		}
+
+		ChartAudioRenderParam fixedDurationParam = param;
+		fixedDurationParam.EndTime = Time::FromSec(static_cast<f64>(measureCount));
+		const i64 renderedFrameCount = Audio::TimeToFrames(fixedDurationParam.EndTime, sampleRate);
+		for (const auto& [name, bufferFrameCount] : { std::pair<std::string_view, u32> { names[5], 64 }, std::pair<std::string_view, u32> { names[6], 1024 } })
+		{
+			Audio::Engine.SetBufferFrameSize(bufferFrameCount);
+			std::vector<i16> output;
+			context.Run(suite, name, static_cast<size_t>(renderedFrameCount), 1, [&] { output.clear(); }, [&]
+			{
+				RenderChartCourseAudioOffline(chart, course, fixedDurationParam, output);
+				DoNotOptimizeAway(output.size());
+			});
+		}
+
+		Audio::Engine.ApplicationShutdown();
+	}
+}
@@ -0,0 +1,284 @@
+#include "benchmark_common.h"
+#include "core_beat.h"
+#include "peepo_drum_kit/chart.h"
+
+namespace Benchmark
+{
+	using namespace PeepoDrumKit;
+
+	// NOTE: Roughly modeled after a dense chart with 1/16th notes and an occasional drumroll "containing" a few other notes
+	static SortedNotesList CreateSyntheticNotesList(size_t noteCount, b8 includeLongNotes)
+	{
+		RandomGenerator random {};
+		SortedNotesList notes;
+		notes.Sorted.reserve(noteCount);
+
+		Beat beatIt = Beat::Zero();
+		for (size_t i = 0; i < noteCount; i++)
+		{
+			Note& note = notes.Sorted.emplace_back();
+			note.BeatTime = beatIt;
+			note.Type = (random.NextU32() % 2 == 0) ? NoteType::Don : NoteType::Ka;
+			if (includeLongNotes && (i % 64) == 0)
+			{
+				note.Type = NoteType::Drumroll;
+				note.BeatDuration = Beat::FromBeats(random.NextI32InRange(1, 8));
+			}
+			beatIt += GetGridBeatSnap(16) * random.NextI32InRange(1, 4);
+		}
+		return notes;
+	}
+
+	static std::vector<Beat> CreateRandomQueryBeats(const SortedNotesList& notes, size_t queryCount)
+	{
+		RandomGenerator random {};
+		const i32 maxTicks = notes.empty() ? Beat::TicksPerBeat : (notes.Sorted.back().GetEnd().Ticks + Beat::TicksPerBeat);
+
+		std::vector<Beat> queryBeats;
+		queryBeats.reserve(queryCount);
+		for (size_t i = 0; i < queryCount; i++)
+			queryBeats.push_back(Beat::FromTicks(random.NextI32InRange(0, maxTicks)));
+		return queryBeats;
+	}
+
+	// NOTE: Same visibility test the timeline performs for each note, with the index range either covering the entire list or only the culled part of it
+	static size_t CountVisibleNotes(const SortedTempoMap& tempoMap, const SortedNotesList& notes, BeatSortedIndexRange indexRange, Time minTime, Time maxTime)
+	{
+		size_t visibleCount = 0;
+		for (size_t i = indexRange.First; i < indexRange.End; i++)
+		{
+			const Note& note = notes[i];
+			const Time startTime = tempoMap.BeatToTime(note.GetStart()) + note.TimeOffset;
+			const Time endTime = (note.BeatDuration > Beat::Zero()) ? tempoMap.BeatToTime(note.GetEnd()) + note.TimeOffset : startTime;
+			visibleCount += !(endTime < minTime || startTime > maxTime);
+		}
+		return visibleCount;
+	}
+
+	void RunBeatSortedListBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "BeatSortedList";
+		static constexpr size_t queryCount = 100000;
+		static constexpr size_t randomInsertCount = 1000;
+
+		for (const size_t itemCount : ScalingItemCounts)
+		{
+			const SortedNotesList sourceNotes = CreateSyntheticNotesList(itemCount, true);
+			const std::vector<Beat> queryBeats = CreateRandomQueryBeats(sourceNotes, queryCount);
+
+			SortedNotesList notes;
+			context.Run(suite, "InsertOrUpdate (ascending)", itemCount, itemCount, [&] { notes = {}; }, [&]
+			{
+				for (const Note& note : sourceNotes)
+					notes.InsertOrUpdate(note);
+				DoNotOptimizeAway(notes.data());
+			});
+
+			std::vector<Note> randomNotesToInsert;
+			for (size_t i = 0; i < randomInsertCount; i++)
+			{
+				Note& note = randomNotesToInsert.emplace_back();
+				note.BeatTime = queryBeats[i];
+				note.Type = NoteType::Don;
+			}
+
+			const size_t insertResultIndex = context.Results.size();
+			context.Run(suite, "InsertOrUpdate (random into existing)", itemCount, randomInsertCount, [&] { notes = sourceNotes; }, [&]
+			{
+				for (const Note& note : randomNotesToInsert)
+					notes.InsertOrUpdate(note);
+				DoNotOptimizeAway(notes.data());
+			});
+
+			context.Run(suite, "RemoveAtBeat (random from existing)", itemCount, randomInsertCount, [&] { notes = sourceNotes; }, [&]
+			{
+				for (size_t i = 0; i < randomInsertCount; i++)
+					notes.RemoveAtBeat(sourceNotes[(i * 7919) % sourceNotes.size()].BeatTime);
+				DoNotOptimizeAway(notes.data());
+			});
+
+			// NOTE: Same operations as above but batched, as done by the multi item undo commands when pasting or deleting a selection
+			context.Run(suite, "InsertOrUpdateMultiple (random into existing)", itemCount, randomInsertCount, [&] { notes = sourceNotes; }, [&]
+			{
+				notes.InsertOrUpdateMultiple(randomNotesToInsert);
+				DoNotOptimizeAway(notes.data());
+			});
+
+			std::vector<Beat> beatsToRemove;
+			for (size_t i = 0; i < randomInsertCount; i++)
+				beatsToRemove.push_back(sourceNotes[(i * 7919) % sourceNotes.size()].BeatTime);
+
+			context.Run(suite, "RemoveAtBeats (random from existing)", itemCount, randomInsertCount, [&] { notes = sourceNotes; }, [&]
+			{
+				notes.RemoveAtBeats(beatsToRemove);
+				DoNotOptimizeAway(notes.data());
+			});
+
+			context.Run(suite, "TryFindLastAtBeat", itemCount, queryCount, [&]
+			{
+				size_t foundCount = 0;
+				for (const Beat beat : queryBeats)
+					foundCount += (sourceNotes.TryFindLastAtBeat(beat) != nullptr);
+				DoNotOptimizeAway(foundCount);
+			});
+
+			context.Run(suite, "TryFindExactAtBeat", itemCount, queryCount, [&]
+			{
+				size_t foundCount = 0;
+				for (const Beat beat : queryBeats)
+					foundCount += (sourceNotes.TryFindExactAtBeat(beat) != nullptr);
+				DoNotOptimizeAway(foundCount);
+			});
+
+			context.Run(suite, "TryFindOverlappingBeat (point)", itemCount, queryCount, [&]
+			{
+				size_t foundCount = 0;
+				for (const Beat beat : queryBeats)
+					foundCount += (sourceNotes.TryFindOverlappingBeat(beat, beat) != nullptr);
+				DoNotOptimizeAway(foundCount);
+			});
+
+			context.Run(suite, "TryFindOverlappingBeat (range, exclusive)", itemCount, queryCount, [&]
+			{
+				size_t foundCount = 0;
+				for (const Beat beat : queryBeats)
+					foundCount += (sourceNotes.TryFindOverlappingBeat(beat, beat + Beat::FromBeats(2), false) != nullptr);
+				DoNotOptimizeAway(foundCount);
+			});
+
+			// NOTE: Includes the cost of keeping the cached overlap bounds up to date after every edit, as happens when placing notes one by one
+			const size_t overlapInsertResultIndex = context.Results.size();
+			context.Run(suite, "InsertOrUpdate + TryFindOverlappingBeat", itemCount, randomInsertCount, [&] { notes = sourceNotes; }, [&]
+			{
+				for (const Note& note : randomNotesToInsert)
+				{
+					if (notes.TryFindOverlappingBeat(note.BeatTime, note.BeatTime) == nullptr)
+						notes.InsertOrUpdate(note);
+				}
+				DoNotOptimizeAway(notes.data());
+			});
+
+			// NOTE: Patching the overlap bounds per edit should only add a small constant factor on top of the (already linear) insertion itself,
+			//		 rather than rebuilding them for the entire list each time. Given some absolute leeway to not fail on timer noise for small lists
+			if (overlapInsertResultIndex > insertResultIndex && context.Results.size() > overlapInsertResultIndex)
+			{
+				const Time insertDuration = context.Results[insertResultIndex].FastestDuration;
+				const Time overlapInsertDuration = context.Results[overlapInsertResultIndex].FastestDuration;
+				context.Check(overlapInsertDuration.ToSec() <= (insertDuration.ToSec() * 2.0) + Time::FromMS(0.5).ToSec(), suite, "InsertOrUpdate + TryFindOverlappingBeat (scaling)", itemCount);
+			}
+
+			// NOTE: Zoomed in to a few seconds at random positions throughout the chart, with every note being shifted by a small (positive or negative) TimeOffset
+			//		 and the tempo changing halfway through. Each frame culls and then tests all three branch note rows, just like the timeline does
+			SortedNotesList offsetNotes = sourceNotes;
+			RandomGenerator random {};
+			for (Note& note : offsetNotes)
+				note.TimeOffset = Time::FromMS(random.NextI32InRange(-35, 36));
+			offsetNotes.InvalidateCachedBeatRanges();
+
+			if (context.PassesFilter(suite, "PatchedBeatRangesMatchRebuild"))
+			{
+				// NOTE: Random single item edits (each patching the cached beat ranges) compared against having them rebuilt from scratch every so often
+				SortedNotesList editedNotes = offsetNotes;
+				b8 passed = true;
+				for (size_t i = 0; i < randomInsertCount; i++)
+				{
+					const size_t randomIndex = random.NextU32() % editedNotes.size();
+					switch (random.NextU32() % 4)
+					{
+					case 0: { Note note = randomNotesToInsert[i]; note.TimeOffset = Time::FromMS(random.NextI32InRange(-50, 51)); note.BeatDuration = Beat::FromTicks(random.NextI32InRange(0, Beat::TicksPerBeat * 16)); editedNotes.InsertOrUpdate(note); } break;
+					case 1: { editedNotes.RemoveAtIndex(randomIndex); } break;
+					case 2: { Note& note = editedNotes[randomIndex]; const Time previousTimeOffset = note.TimeOffset; note.TimeOffset = Time::FromMS(random.NextI32InRange(-50, 51)); editedNotes.SyncCachedBeatRangesAt(randomIndex, note.BeatTime, previousTimeOffset); } break;
+					case 3: { Note& note = editedNotes[randomIndex]; note.BeatDuration = (note.BeatDuration > Beat::Zero()) ? Beat::Zero() : Beat::FromBeats(random.NextI32InRange(1, 32)); editedNotes.SyncCachedBeatRangesAt(randomIndex, note.BeatTime, note.TimeOffset); } break;
+					}
+
+					if ((i % 64) == 0 || (i + 1) == randomInsertCount)
+					{
+						SortedNotesList rebuiltNotes = editedNotes;
+						rebuiltNotes.InvalidateCachedBeatRanges();
+						passed &= (editedNotes.GetRunningMaxEndBeats() == rebuiltNotes.GetRunningMaxEndBeats());
+						passed &= (editedNotes.GetMinTimeOffset() == rebuiltNotes.GetMinTimeOffset()) && (editedNotes.GetMaxTimeOffset() == rebuiltNotes.GetMaxTimeOffset());
+					}
+				}
+				context.Check(passed, suite, "PatchedBeatRangesMatchRebuild", itemCount);
+			}
+
+			SortedTempoMap tempoMap;
+			tempoMap.Tempo.InsertOrUpdate(TempoChange(Beat::Zero(), Tempo(160.0f)));
+			tempoMap.Tempo.InsertOrUpdate(TempoChange(Beat::FromTicks(offsetNotes.Sorted.back().BeatTime.Ticks / 2), Tempo(220.0f)));
+			tempoMap.RebuildAccelerationStructure();
+
+			static constexpr size_t frameCount = 256, branchRowCount = 3;
+			const Time chartDuration = tempoMap.BeatToTime(offsetNotes.Sorted.back().GetEnd());
+			const Time visibleDuration = Time::FromSec(4.0);
+			std::vector<Time> frameStartTimes;
+			for (size_t i = 0; i < frameCount; i++)
+				frameStartTimes.push_back(Time::FromSec(chartDuration.ToSec() * static_cast<f64>(random.NextF32())) - Time::FromSec(1.0));
+
+			if (context.PassesFilter(suite, "CulledNoteRowsMatchAllItems"))
+			{
+				b8 passed = true;
+				for (const Time startTime : frameStartTimes)
+				{
+					const BeatSortedIndexRange allRange = { 0, offsetNotes.size() };
+					const BeatSortedIndexRange culledRange = FindIndexRangeOverlappingTimes(tempoMap, offsetNotes, startTime, startTime + visibleDuration);
+					passed &= (CountVisibleNotes(tempoMap, offsetNotes, allRange, startTime, startTime + visibleDuration) == CountVisibleNotes(tempoMap, offsetNotes, culledRange, startTime, startTime + visibleDuration));
+				}
+				context.Check(passed, suite, "CulledNoteRowsMatchAllItems", itemCount);
+			}
+
+			context.Run(suite, "TimelineNoteRowsFrame (all items)", itemCount, frameCount, [&]
+			{
+				size_t visibleCount = 0;
+				for (const Time startTime : frameStartTimes)
+				{
+					for (size_t row = 0; row < branchRowCount; row++)
+						visibleCount += CountVisibleNotes(tempoMap, offsetNotes, BeatSortedIndexRange { 0, offsetNotes.size() }, startTime, startTime + visibleDuration);
+				}
+				DoNotOptimizeAway(visibleCount);
+			});
+
+			const size_t culledResultIndex = context.Results.size();
+			context.Run(suite, "TimelineNoteRowsFrame (culled)", itemCount, frameCount, [&]
+			{
+				size_t visibleCount = 0;
+				for (const Time startTime : frameStartTimes)
+				{
+					for (size_t row = 0; row < branchRowCount; row++)
+						visibleCount += CountVisibleNotes(tempoMap, offsetNotes, FindIndexRangeOverlappingTimes(tempoMap, offsetNotes, startTime, startTime + visibleDuration), startTime, startTime + visibleDuration);
+				}
+				DoNotOptimizeAway(visibleCount);
+			});
+
+			// NOTE: Same as above but with a few notes being dragged back and forth by a grid step before each frame, so that the culling bounds have to be kept up to date in between
+			static constexpr size_t draggedNoteCount = 16;
+			const Beat dragBeatIncrement = (Beat::FromBars(1) / 64);
+			SortedNotesList draggedNotes = offsetNotes;
+			const size_t draggingResultIndex = context.Results.size();
+			context.Run(suite, "TimelineNoteRowsFrame (culled, dragging notes)", itemCount, frameCount, [&]
+			{
+				size_t visibleCount = 0;
+				for (size_t frame = 0; frame < frameCount; frame++)
+				{
+					const Beat increment = ((frame % 2) == 0) ? dragBeatIncrement : -dragBeatIncrement;
+					for (size_t i = (draggedNotes.size() / 2); i < (draggedNotes.size() / 2) + draggedNoteCount; i++)
+					{
+						draggedNotes[i].BeatTime += increment;
+						draggedNotes.SyncCachedBeatRangesAt(i, draggedNotes[i].BeatTime - increment, draggedNotes[i].TimeOffset);
+					}
+
+					const Time startTime = frameStartTimes[frame];
+					for (size_t row = 0; row < branchRowCount; row++)
+						visibleCount += CountVisibleNotes(tempoMap, draggedNotes, FindIndexRangeOverlappingTimes(tempoMap, draggedNotes, startTime, startTime + visibleDuration), startTime, startTime + visibleDuration);
+				}
+				DoNotOptimizeAway(visibleCount);
+			});
+
+			if (draggingResultIndex > culledResultIndex && context.Results.size() > draggingResultIndex)
+			{
+				const Time culledDuration = context.Results[culledResultIndex].FastestDuration;
+				const Time draggingDuration = context.Results[draggingResultIndex].FastestDuration;
+				context.Check(draggingDuration.ToSec() <= (culledDuration.ToSec() * 2.0) + Time::FromMS(0.5).ToSec(), suite, "TimelineNoteRowsFrame (dragging, scaling)", itemCount);
+			}
+		}
+	}
+}
@@ -0,0 +1,709 @@
+#include "benchmark_common.h"
+#include "core_thread_pool.h"
+#include "file_format_tja.h"
+#include "peepo_drum_kit/chart.h"
+#include "peepo_drum_kit/chart_binary.h"
+#include "file_format_fumen.h"
+#include "core_io.h"
+
+namespace Benchmark
+{
+	// NOTE: A single song with one course per difficulty, each course having its own tempo, delay, scroll and gogo changes
+	static std::string CreateSyntheticMultiCourseTJA(RandomGenerator& random, i32 songIndex, i32 measuresPerCourse)
+	{
+		static constexpr char noteChars[] = { '0', '0', '0', '0', '0', '1', '1', '2', '2', '3', '4', '5', '7' };
+		static constexpr cstr courseNames[] = { "Easy", "Normal", "Hard", "Oni", "Edit" };
+
+		std::string tja;
+		char buffer[128];
+		tja.append(buffer, sprintf_s(buffer, "TITLE:Synthetic Song %d\r\nBPM:%d\r\nWAVE:song_%d.ogg\r\nOFFSET:-1.25\r\n\r\n", songIndex, random.NextI32InRange(80, 240), songIndex));
+
+		for (cstr courseName : courseNames)
+		{
+			tja.append(buffer, sprintf_s(buffer, "COURSE:%s\r\nLEVEL:%d\r\nBALLOON:5,10,15,20,25,30,35,40\r\n\r\n#START\r\n", courseName, random.NextI32InRange(1, 10)));
+			for (i32 measure = 0; measure < measuresPerCourse; measure++)
+			{
+				switch (random.NextU32() % 16)
+				{
+				case 0: tja.append(buffer, sprintf_s(buffer, "#BPMCHANGE %d\r\n", random.NextI32InRange(80, 240))); break;
+				case 1: tja.append("#MEASURE 3/4\r\n"); break;
+				case 2: tja.append("#MEASURE 4/4\r\n"); break;
+				case 3: tja.append("#SCROLL 1.5\r\n"); break;
+				case 4: tja.append("#DELAY 0.25\r\n"); break;
+				case 5: tja.append("#GOGOSTART\r\n"); break;
+				case 6: tja.append("#GOGOEND\r\n"); break;
+				case 7: tja.append(buffer, sprintf_s(buffer, "#LYRIC Synthetic lyric line %d\r\n", measure)); break;
+				default: break;
+				}
+
+				const i32 noteCount = 4 << (random.NextU32() % 4);
+				for (i32 i = 0; i < noteCount; i++)
+				{
+					const char noteChar = noteChars[random.NextU32() % ArrayCount(noteChars)];
+					tja += noteChar;
+					if (noteChar == '5' || noteChar == '7')
+						tja += '8';
+				}
+				tja.append(",\r\n");
+			}
+			tja.append("#END\r\n\r\n");
+		}
+
+		return tja;
+	}
+
+	static void OnDebugCompareChartsMessage(std::string_view message, void* userData)
+	{
+		(*static_cast<i32*>(userData))++;
+	}
+
+	void RunChartImportBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "ChartImport";
+		static constexpr std::string_view names[] = { "Identical serial and parallel courses", "CreateChartProjectFromTJA (serial)", "CreateChartProjectFromTJA (ThreadPool)" };
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		static constexpr i32 songCount = 64;
+		static constexpr i32 measuresPerCourse = 512;
+
+		RandomGenerator random {};
+		std::vector<TJA::ParsedTJA> parsedSongs;
+		parsedSongs.reserve(songCount);
+		size_t totalCourseCount = 0;
+		for (i32 songIndex = 0; songIndex < songCount; songIndex++)
+		{
+			TJA::ErrorList errors;
+			parsedSongs.push_back(TJA::ParseTokens(TJA::TokenizeFileContent(CreateSyntheticMultiCourseTJA(random, songIndex, measuresPerCourse)), errors));
+			totalCourseCount += parsedSongs.back().Courses.size();
+		}
+
+		ThreadPool threadPool {};
+
+		if (context.PassesFilter(suite, names[0]))
+		{
+			i32 mismatchCount = 0;
+			for (const TJA::ParsedTJA& parsed : parsedSongs)
+			{
+				PeepoDrumKit::ChartProject serialChart, parallelChart;
+				PeepoDrumKit::CreateChartProjectFromTJA(parsed, serialChart);
+				PeepoDrumKit::CreateChartProjectFromTJA(parsed, parallelChart, &threadPool);
+
+				PeepoDrumKit::DebugCompareCharts(serialChart, parallelChart, OnDebugCompareChartsMessage, &mismatchCount);
+				mismatchCount += (serialChart.ChartDuration != parallelChart.ChartDuration);
+				for (size_t i = 0; i < Min(serialChart.Courses.size(), parallelChart.Courses.size()); i++)
+					mismatchCount += (serialChart.Courses[i]->Type != parallelChart.Courses[i]->Type);
+			}
+
+			context.Check(mismatchCount == 0, suite, names[0], totalCourseCount);
+		}
+
+		context.Run(suite, names[1], songCount, totalCourseCount, [&]
+		{
+			for (const TJA::ParsedTJA& parsed : parsedSongs)
+			{
+				PeepoDrumKit::ChartProject chart;
+				PeepoDrumKit::CreateChartProjectFromTJA(parsed, chart);
+				DoNotOptimizeAway(chart.ChartDuration);
+			}
+		});
+
+		context.Run(suite, names[2], songCount, totalCourseCount, [&]
+		{
+			for (const TJA::ParsedTJA& parsed : parsedSongs)
+			{
+				PeepoDrumKit::ChartProject chart;
+				PeepoDrumKit::CreateChartProjectFromTJA(parsed, chart, &threadPool);
+				DoNotOptimizeAway(chart.ChartDuration);
+			}
+		});
+	}
+
+	static std::string ExportChartProjectToTJAText(const PeepoDrumKit::ChartProject& chart)
+	{
+		TJA::ParsedTJA exportedTJA;
+		PeepoDrumKit::ConvertChartProjectToTJA(chart, exportedTJA, false);
+		std::string text;
+		TJA::ConvertParsedToText(exportedTJA, text, TJA::Encoding::UTF8);
+		return text;
+	}
+
+	void RunChartBinaryBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "ChartBinary";
+		static constexpr std::string_view names[] =
+		{
+			"Round trip identical to TJA", "Rejects invalid files",
+			"Save TJA text", "Save binary", "Load TJA file (parse + convert)", "Load binary file (mmap)",
+		};
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		static constexpr i32 songCount = 64;
+		static constexpr i32 measuresPerCourse = 512;
+
+		const std::string tempDirectory = Directory::GetExecutableDirectory() + "/benchmark_temp";
+		Directory::CreateRecursive(tempDirectory);
+
+		RandomGenerator random {};
+		std::vector<PeepoDrumKit::ChartProject> charts(songCount);
+		std::vector<std::string> tjaFilePaths(songCount), binaryFilePaths(songCount);
+		size_t totalTJAByteSize = 0, totalBinaryByteSize = 0;
+		for (i32 songIndex = 0; songIndex < songCount; songIndex++)
+		{
+			const std::string tjaText = CreateSyntheticMultiCourseTJA(random, songIndex, measuresPerCourse);
+			TJA::ErrorList errors;
+			PeepoDrumKit::CreateChartProjectFromTJA(TJA::ParseTokens(TJA::TokenizeFileContent(tjaText), errors), charts[songIndex]);
+
+			char buffer[64];
+			tjaFilePaths[songIndex] = std::string(tempDirectory).append(buffer, sprintf_s(buffer, "/song_%02d", songIndex)).append(TJA::Extension);
+			binaryFilePaths[songIndex] = std::string(Path::TrimExtension(tjaFilePaths[songIndex])).append(PeepoDrumKit::ChartBinaryExtension);
+			File::WriteAllBytes(tjaFilePaths[songIndex], tjaText);
+			PeepoDrumKit::SaveChartProjectToBinaryFile(charts[songIndex], binaryFilePaths[songIndex]);
+
+			std::vector<u8> binary;
+			PeepoDrumKit::SaveChartProjectToBinary(charts[songIndex], binary);
+			totalTJAByteSize += tjaText.size();
+			totalBinaryByteSize += binary.size();
+		}
+
+		if (context.PassesFilter(suite, names[0]))
+		{
+			i32 mismatchCount = 0;
+			for (i32 songIndex = 0; songIndex < songCount; songIndex++)
+			{
+				PeepoDrumKit::ChartProject loadedChart;
+				if (!PeepoDrumKit::LoadChartProjectFromBinaryFile(binaryFilePaths[songIndex], loadedChart)) { mismatchCount++; continue; }
+
+				PeepoDrumKit::DebugCompareCharts(charts[songIndex], loadedChart, OnDebugCompareChartsMessage, &mismatchCount);
+				mismatchCount += (ExportChartProjectToTJAText(charts[songIndex]) != ExportChartProjectToTJAText(loadedChart));
+				mismatchCount += (charts[songIndex].ChartDuration != loadedChart.ChartDuration);
+
+				// NOTE: Saving has to be deterministic, independent of any transient editor state
+				std::vector<u8> binaryA, binaryB;
+				PeepoDrumKit::SaveChartProjectToBinary(charts[songIndex], binaryA);
+				PeepoDrumKit::SaveChartProjectToBinary(loadedChart, binaryB);
+				mismatchCount += (binaryA != binaryB);
+			}
+
+			printf("%-20s %-48s TJA %.2f MB, binary %.2f MB\n", std::string(suite).c_str(), "Total file size", static_cast<f64>(totalTJAByteSize) / (1024.0 * 1024.0), static_cast<f64>(totalBinaryByteSize) / (1024.0 * 1024.0));
+			context.Check(mismatchCount == 0, suite, names[0], songCount);
+		}
+
+		if (context.PassesFilter(suite, names[1]))
+		{
+			std::vector<u8> binary;
+			PeepoDrumKit::SaveChartProjectToBinary(charts[0], binary);
+
+			// NOTE: Every truncation, a wrong version and a flipped byte order marker all have to be rejected without touching the output chart
+			b8 allRejected = true;
+			PeepoDrumKit::ChartProject untouchedChart;
+			for (size_t truncatedSize = 0; truncatedSize < binary.size(); truncatedSize += 97)
+				allRejected &= !PeepoDrumKit::LoadChartProjectFromBinary(binary.data(), truncatedSize, untouchedChart);
+
+			std::vector<u8> corrupted = binary; corrupted[8]++;
+			allRejected &= !PeepoDrumKit::LoadChartProjectFromBinary(corrupted.data(), corrupted.size(), untouchedChart);
+			corrupted = binary; std::swap(corrupted[4], corrupted[7]);
+			allRejected &= !PeepoDrumKit::LoadChartProjectFromBinary(corrupted.data(), corrupted.size(), untouchedChart);
+
+			context.Check(allRejected && untouchedChart.Courses.empty(), suite, names[1], binary.size() / 97);
+		}
+
+		context.Run(suite, names[2], songCount, songCount, [&]
+		{
+			for (const PeepoDrumKit::ChartProject& chart : charts)
+				DoNotOptimizeAway(ExportChartProjectToTJAText(chart).size());
+		});
+
+		context.Run(suite, names[3], songCount, songCount, [&]
+		{
+			std::vector<u8> binary;
+			for (const PeepoDrumKit::ChartProject& chart : charts)
+			{
+				PeepoDrumKit::SaveChartProjectToBinary(chart, binary);
+				DoNotOptimizeAway(binary.size());
+			}
+		});
+
+		context.Run(suite, names[4], songCount, songCount, [&]
+		{
+			for (const std::string& filePath : tjaFilePaths)
+			{
+				const File::UniqueFileContent fileContent = File::ReadAllBytes(filePath);
+				const std::string fileContentUTF8 = UTF8::FromShiftJIS(fileContent.AsString());
+				TJA::ErrorList errors;
+				PeepoDrumKit::ChartProject chart;
+				PeepoDrumKit::CreateChartProjectFromTJA(TJA::ParseTokens(TJA::TokenizeFileContent(fileContentUTF8), errors), chart);
+				DoNotOptimizeAway(chart.ChartDuration);
+			}
+		});
+
+		context.Run(suite, names[5], songCount, songCount, [&]
+		{
+			for (const std::string& filePath : binaryFilePaths)
+			{
+				PeepoDrumKit::ChartProject chart;
+				PeepoDrumKit::LoadChartProjectFromBinaryFile(filePath, chart);
+				DoNotOptimizeAway(chart.ChartDuration);
+			}
+		});
+	}
+
+	static b8 AreFumenRoundTripNotesSame(const PeepoDrumKit::SortedNotesList& notesA, const PeepoDrumKit::SortedNotesList& notesB)
+	{
+		if (notesA.size() != notesB.size())
+			return false;
+		for (size_t i = 0; i < notesA.size(); i++)
+		{
+			const PeepoDrumKit::Note& a = notesA[i];
+			const PeepoDrumKit::Note& b = notesB[i];
+			if (a.BeatTime != b.BeatTime || a.BeatDuration != b.BeatDuration || a.Type != b.Type || (PeepoDrumKit::IsBalloonNote(a.Type) && a.BalloonPopCount != b.BalloonPopCount))
+				return false;
+		}
+		return true;
+	}
+
+	static std::vector<u8> RewriteFumenMeasures(const std::vector<u8>& fileContent, Endianness outEndianness)
+	{
+		std::vector<u8> outFileContent;
+		Fumen::Reader reader { fileContent.data(), fileContent.size() };
+		Fumen::Writer writer { outFileContent, outEndianness };
+		if (!reader.TryReadHeader())
+			return outFileContent;
+
+		writer.BeginFile();
+		for (Fumen::Measure measure {}; reader.TryReadNextMeasure(measure);)
+			writer.WriteMeasure(measure);
+		writer.EndFile(reader.FileHeader);
+		return outFileContent;
+	}
+
+	void RunChartFumenBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "ChartFumen";
+		static constexpr std::string_view names[] =
+		{
+			"Reader + Writer byte identical (LE -> BE -> LE)", "Round trip byte identical", "Round trip notes identical (all branches)", "Rejects truncated files",
+			"ConvertChartCourseToFumen", "CreateChartCourseFromFumen",
+		};
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		static constexpr i32 songCount = 32;
+		static constexpr i32 measuresPerCourse = 512;
+
+		// NOTE: Every other course is turned into a branched one, with the expert and master branches being modified copies of the normal branch
+		RandomGenerator random {};
+		std::vector<PeepoDrumKit::ChartProject> charts(songCount);
+		std::vector<const PeepoDrumKit::ChartCourse*> courses;
+		std::vector<Time> songOffsets;
+		for (i32 songIndex = 0; songIndex < songCount; songIndex++)
+		{
+			TJA::ErrorList errors;
+			PeepoDrumKit::CreateChartProjectFromTJA(TJA::ParseTokens(TJA::TokenizeFileContent(CreateSyntheticMultiCourseTJA(random, songIndex, measuresPerCourse)), errors), charts[songIndex]);
+			for (size_t courseIndex = 0; courseIndex < charts[songIndex].Courses.size(); courseIndex++)
+			{
+				PeepoDrumKit::ChartCourse& course = *charts[songIndex].Courses[courseIndex];
+				if (courseIndex % 2 == 1)
+				{
+					course.Notes_Expert = course.Notes_Normal;
+					course.Notes_Master = course.Notes_Normal;
+					for (PeepoDrumKit::Note& note : course.Notes_Expert.Sorted) note.Type = PeepoDrumKit::FlipNote(note.Type);
+					for (PeepoDrumKit::Note& note : course.Notes_Master.Sorted) note.Type = PeepoDrumKit::ToBigNote(note.Type);
+				}
+				courses.push_back(&course);
+				songOffsets.push_back(charts[songIndex].SongOffset);
+			}
+		}
+
+		std::vector<std::vector<u8>> fumenFiles(courses.size());
+		size_t totalFumenByteSize = 0;
+		for (size_t i = 0; i < courses.size(); i++)
+		{
+			PeepoDrumKit::ConvertChartCourseToFumen(*courses[i], songOffsets[i], fumenFiles[i]);
+			totalFumenByteSize += fumenFiles[i].size();
+		}
+
+		if (context.PassesFilter(suite, names[0]))
+		{
+			i32 mismatchCount = 0;
+			for (const std::vector<u8>& fileContent : fumenFiles)
+			{
+				const std::vector<u8> bigEndianFileContent = RewriteFumenMeasures(fileContent, Endianness::Big);
+				mismatchCount += (bigEndianFileContent == fileContent);
+				mismatchCount += (RewriteFumenMeasures(bigEndianFileContent, Endianness::Little) != fileContent);
+			}
+			context.Check(mismatchCount == 0, suite, names[0], fumenFiles.size());
+		}
+
+		if (context.PassesFilter(suite, names[1]) || context.PassesFilter(suite, names[2]))
+		{
+			i32 byteMismatchCount = 0, noteMismatchCount = 0;
+			for (size_t i = 0; i < courses.size(); i++)
+			{
+				PeepoDrumKit::ChartCourse importedCourse; Time importedSongOffset;
+				importedCourse.Type = courses[i]->Type;
+				if (!PeepoDrumKit::CreateChartCourseFromFumen(fumenFiles[i].data(), fumenFiles[i].size(), importedCourse, importedSongOffset)) { byteMismatchCount++; noteMismatchCount++; continue; }
+
+				std::vector<u8> reexportedFileContent;
+				PeepoDrumKit::ConvertChartCourseToFumen(importedCourse, importedSongOffset, reexportedFileContent, Endianness::Big);
+				byteMismatchCount += (RewriteFumenMeasures(reexportedFileContent, Endianness::Little) != fumenFiles[i]);
+				byteMismatchCount += !ApproxmiatelySame(importedSongOffset.Seconds, songOffsets[i].Seconds, 0.0001);
+
+				for (size_t branchIndex = 0; branchIndex < EnumCount<PeepoDrumKit::BranchType>; branchIndex++)
+				{
+					const auto branch = static_cast<PeepoDrumKit::BranchType>(branchIndex);
+					noteMismatchCount += !AreFumenRoundTripNotesSame(courses[i]->GetNotes(branch), importedCourse.GetNotes(branch));
+				}
+				noteMismatchCount += (importedCourse.ScoreInit != courses[i]->ScoreInit) || (importedCourse.ScoreDiff != courses[i]->ScoreDiff);
+			}
+
+			printf("%-20s %-48s %.2f MB\n", std::string(suite).c_str(), "Total file size", static_cast<f64>(totalFumenByteSize) / (1024.0 * 1024.0));
+			if (context.PassesFilter(suite, names[1])) context.Check(byteMismatchCount == 0, suite, names[1], courses.size());
+			if (context.PassesFilter(suite, names[2])) context.Check(noteMismatchCount == 0, suite, names[2], courses.size());
+		}
+
+		if (context.PassesFilter(suite, names[3]))
+		{
+			const std::vector<u8>& fileContent = fumenFiles[0];
+			PeepoDrumKit::ChartCourse untouchedCourse; Time untouchedSongOffset = Time::FromSec(1.0);
+			b8 allRejected = true;
+			for (size_t truncatedSize = 0; truncatedSize < fileContent.size(); truncatedSize += 61)
+				allRejected &= !PeepoDrumKit::CreateChartCourseFromFumen(fileContent.data(), truncatedSize, untouchedCourse, untouchedSongOffset);
+			context.Check(allRejected && untouchedCourse.Notes_Normal.empty() && untouchedSongOffset == Time::FromSec(1.0), suite, names[3], fileContent.size() / 61);
+		}
+
+		context.Run(suite, names[4], courses.size(), courses.size(), [&]
+		{
+			std::vector<u8> fileContent;
+			for (size_t i = 0; i < courses.size(); i++)
+			{
+				PeepoDrumKit::ConvertChartCourseToFumen(*courses[i], songOffsets[i], fileContent);
+				DoNotOptimizeAway(fileContent.size());
+			}
+		});
+
+		context.Run(suite, names[5], courses.size(), courses.size(), [&]
+		{
+			for (const std::vector<u8>& fileContent : fumenFiles)
+			{
+				PeepoDrumKit::ChartCourse course; Time songOffset;
+				PeepoDrumKit::CreateChartCourseFromFumen(fileContent.data(), fileContent.size(), course, songOffset);
+				DoNotOptimizeAway(course.Notes_Normal.size());
+			}
+		});
+	}
+
+	// NOTE: Evenly spaced notes (same for every branch) with every few being a drumroll, together with regular tempo and scroll changes across the entire course
+	static void CreateSyntheticTimingCourse(RandomGenerator& random, size_t noteCount, PeepoDrumKit::ChartCourse& outCourse)
+	{
+		using namespace PeepoDrumKit;
+		const Beat noteSpacing = (Beat::FromBars(1) / 16);
+
+		std::vector<Note> notes; notes.reserve(noteCount);
+		for (size_t i = 0; i < noteCount; i++)
+		{
+			Note& note = notes.emplace_back();
+			note.BeatTime = noteSpacing * static_cast<i32>(i);
+			note.Type = ((i % 32) == 31) ? NoteType::Drumroll : NoteType::Don;
+			note.BeatDuration = (note.Type == NoteType::Drumroll) ? (noteSpacing * 8) : Beat::Zero();
+		}
+		outCourse.Notes_Normal.InsertOrUpdateMultiple(notes);
+		outCourse.Notes_Expert.InsertOrUpdateMultiple(notes);
+		outCourse.Notes_Master.InsertOrUpdateMultiple(notes);
+
+		for (size_t i = 0; i < noteCount; i += 256)
+			outCourse.TempoMap.Tempo.InsertOrUpdate(TempoChange(noteSpacing * static_cast<i32>(i), Tempo(static_cast<f32>(random.NextI32InRange(80, 240)))));
+		for (size_t i = 0; i < noteCount; i += 128)
+			outCourse.ScrollChanges.InsertOrUpdate(ScrollChange { noteSpacing * static_cast<i32>(i), (random.NextF32() * 2.0f) + 0.5f });
+		outCourse.TempoMap.RebuildAccelerationStructure();
+	}
+
+	static b8 AreCourseTimingCachesSame(const PeepoDrumKit::ChartCourseTimingCache& a, const PeepoDrumKit::ChartCourseTimingCache& b)
+	{
+		static constexpr auto sameTimes = [](const std::vector<Time>& x, const std::vector<Time>& y) { return std::equal(x.begin(), x.end(), y.begin(), y.end(), [](Time l, Time r) { return l.Seconds == r.Seconds; }); };
+		static constexpr auto sameTempos = [](const std::vector<Tempo>& x, const std::vector<Tempo>& y) { return std::equal(x.begin(), x.end(), y.begin(), y.end(), [](Tempo l, Tempo r) { return l.BPM == r.BPM; }); };
+		for (size_t i = 0; i < ArrayCount(a.Notes); i++)
+		{
+			if (!sameTimes(a.Notes[i].HeadTimes, b.Notes[i].HeadTimes) || !sameTimes(a.Notes[i].TailTimes, b.Notes[i].TailTimes) || !sameTempos(a.Notes[i].Tempos, b.Notes[i].Tempos) || a.Notes[i].ScrollSpeeds != b.Notes[i].ScrollSpeeds)
+				return false;
+		}
+		return (a.Bars.Beats == b.Bars.Beats) && sameTimes(a.Bars.Times, b.Bars.Times) && sameTempos(a.Bars.Tempos, b.Bars.Tempos) && (a.Bars.ScrollSpeeds == b.Bars.ScrollSpeeds) && (a.Bars.BarIndices == b.Bars.BarIndices);
+	}
+
+	// NOTE: The same kind of edits the undo commands make (through the generic member functions or directly on the sorted lists), each changing a different part of the cache
+	static void ApplyRandomTimingCacheEdit(RandomGenerator& random, PeepoDrumKit::ChartCourse& course)
+	{
+		using namespace PeepoDrumKit;
+		const BranchType branch = static_cast<BranchType>(random.NextU32() % EnumCount<BranchType>);
+		SortedNotesList& notes = course.GetNotes(branch);
+		const GenericList noteList = static_cast<GenericList>(EnumToIndex(GenericList::Notes_Normal) + EnumToIndex(branch));
+		const Beat randomBeat = Beat::FromTicks(random.NextI32InRange(0, GetBeat(notes.Sorted.back()).Ticks + Beat::FromBars(1).Ticks));
+
+		GenericMemberUnion value {};
+		switch (random.NextU32() % 9)
+		{
+		case 0: { notes.InsertOrUpdate(Note { randomBeat }); } break;
+		case 1: { notes.RemoveAtIndex(random.NextU32() % notes.size()); } break;
+		case 2: { value.TimeV = Time::FromMS(random.NextI32InRange(-50, 50)); TrySetGeneric(course, noteList, random.NextU32() % notes.size(), GenericMember::Time_Offset, value); } break;
+		case 3: { value.BeatV = Beat::FromTicks(random.NextI32InRange(0, Beat::FromBars(1).Ticks)); TrySetGeneric(course, noteList, random.NextU32() % notes.size(), GenericMember::Beat_Duration, value); } break;
+		case 4: { value.TempoV = Tempo(static_cast<f32>(random.NextI32InRange(80, 240))); TrySetGeneric(course, GenericList::TempoChanges, random.NextU32() % course.TempoMap.Tempo.size(), GenericMember::Tempo_V, value); course.TempoMap.RebuildAccelerationStructure(); } break;
+		case 5: { course.TempoMap.Signature.InsertOrUpdate(TimeSignatureChange(Beat::FromBars(randomBeat.Ticks / Beat::FromBars(1).Ticks), TimeSignature(3, 4))); } break;
+		case 6: { course.ScrollChanges.InsertOrUpdate(ScrollChange { randomBeat, random.NextF32() }); } break;
+		case 7: { if (course.ScrollChanges.size() > 1) course.ScrollChanges.RemoveAtIndex(1 + (random.NextU32() % (course.ScrollChanges.size() - 1))); } break;
+		case 8: { course.BarLineChanges.InsertOrUpdate(BarLineChange { Beat::FromBars(randomBeat.Ticks / Beat::FromBars(1).Ticks), (random.NextU32() % 2) == 0 }); } break;
+		}
+	}
+
+	void RunChartTimingCacheBenchmarks(Context& context)
+	{
+		using namespace PeepoDrumKit;
+		static constexpr std::string_view suite = "ChartTimingCache";
+		static constexpr std::string_view names[] =
+		{
+			"IncrementalUpdatesMatchFullBuild",
+			"UpdateCourseTimingCache (full build)",
+			"UpdateCourseTimingCache (note edit)",
+			"UpdateCourseTimingCache (tempo edit)",
+			"PreviewNotesFrame (BeatToTime)",
+			"PreviewNotesFrame (cached)",
+		};
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		for (const size_t itemCount : ScalingItemCounts)
+		{
+			RandomGenerator random {};
+			ChartCourse course;
+			CreateSyntheticTimingCourse(random, itemCount, course);
+			const Beat maxBarBeat = GetBeat(course.Notes_Normal.Sorted.back()) + Beat::FromBars(4);
+			UpdateCourseTimingCache(course, maxBarBeat);
+
+			if (context.PassesFilter(suite, names[0]))
+			{
+				static constexpr i32 editCount = 256;
+				ChartCourse editedCourse = course;
+				b8 allSame = true;
+				for (i32 i = 0; i < editCount; i++)
+				{
+					ApplyRandomTimingCacheEdit(random, editedCourse);
+					const Beat editedMaxBarBeat = ((i % 16) == 0) ? (maxBarBeat - Beat::FromBars(random.NextI32InRange(0, 8))) : editedCourse.TimingCache.MaxBarBeat;
+					UpdateCourseTimingCache(editedCourse, editedMaxBarBeat);
+
+					ChartCourse rebuiltCourse = editedCourse;
+					rebuiltCourse.TimingCache = {};
+					UpdateCourseTimingCache(rebuiltCourse, editedMaxBarBeat);
+					allSame &= AreCourseTimingCachesSame(editedCourse.TimingCache, rebuiltCourse.TimingCache);
+				}
+				context.Check(allSame, suite, names[0], itemCount);
+			}
+
+			context.Run(suite, names[1], itemCount, 1, [&] { course.TimingCache = {}; }, [&]
+			{
+				UpdateCourseTimingCache(course, maxBarBeat);
+				DoNotOptimizeAway(course.TimingCache.LastUpdateNoteCount);
+			});
+
+			static constexpr i32 editsPerRun = 64;
+			context.Run(suite, names[2], itemCount, editsPerRun, [&]
+			{
+				GenericMemberUnion value {};
+				for (i32 i = 0; i < editsPerRun; i++)
+				{
+					value.TimeV = Time::FromMS(i % 2);
+					TrySetGeneric(course, GenericList::Notes_Normal, (course.Notes_Normal.size() / 2) + i, GenericMember::Time_Offset, value);
+					UpdateCourseTimingCache(course, maxBarBeat);
+					DoNotOptimizeAway(course.TimingCache.LastUpdateNoteCount);
+				}
+			});
+
+			context.Run(suite, names[3], itemCount, editsPerRun, [&]
+			{
+				GenericMemberUnion value {};
+				for (i32 i = 0; i < editsPerRun; i++)
+				{
+					value.TempoV = Tempo(160.0f + static_cast<f32>(i % 2));
+					TrySetGeneric(course, GenericList::TempoChanges, course.TempoMap.Tempo.size() / 2, GenericMember::Tempo_V, value);
+					course.TempoMap.RebuildAccelerationStructure();
+					UpdateCourseTimingCache(course, maxBarBeat);
+					DoNotOptimizeAway(course.TimingCache.LastUpdateNoteCount);
+				}
+			});
+
+			// NOTE: Everything the game preview needs to know about each note to place it on the lane, once per frame
+			context.Run(suite, names[4], itemCount, itemCount, [&]
+			{
+				BeatSortedForwardIterator<TempoChange> tempoChangeIt {};
+				BeatSortedForwardIterator<ScrollChange> scrollChangeIt {};
+				f64 sum = 0.0;
+				for (const Note& note : course.Notes_Normal)
+				{
+					const Time head = (course.TempoMap.BeatToTime(note.BeatTime) + note.TimeOffset);
+					const Time tail = (note.BeatDuration > Beat::Zero()) ? (course.TempoMap.BeatToTime(note.GetEnd()) + note.TimeOffset) : head;
+					sum += head.Seconds + tail.Seconds + TempoOrDefault(tempoChangeIt.Next(course.TempoMap.Tempo.Sorted, note.BeatTime)).BPM + ScrollOrDefault(scrollChangeIt.Next(course.ScrollChanges.Sorted, note.BeatTime));
+				}
+				DoNotOptimizeAway(sum);
+			});
+
+			context.Run(suite, names[5], itemCount, itemCount, [&]
+			{
+				UpdateCourseTimingCache(course, maxBarBeat);
+				const ChartCourseTimingCache::NoteTimings& timings = course.TimingCache.Notes[EnumToIndex(BranchType::Normal)];
+				f64 sum = 0.0;
+				for (size_t i = 0; i < timings.HeadTimes.size(); i++)
+					sum += timings.HeadTimes[i].Seconds + timings.TailTimes[i].Seconds + timings.Tempos[i].BPM + timings.ScrollSpeeds[i];
+				DoNotOptimizeAway(sum);
+			});
+		}
+	}
+
+	// NOTE: Reference for what ForEachSelectedChartItem() used to do, checking the IsSelected member of every single item
+	template <typename Func>
+	static void ForEachSelectedChartItemByScanning(const PeepoDrumKit::ChartCourse& course, Func perSelectedItemFunc)
+	{
+		using namespace PeepoDrumKit;
+		for (GenericList list = {}; list < GenericList::Count; IncrementEnum(list))
+		{
+			for (size_t i = 0; i < GetGenericListCount(course, list); i++)
+				if (GenericMemberUnion value; TryGetGeneric(course, list, i, GenericMember::B8_IsSelected, value) && value.B8)
+					perSelectedItemFunc(ForEachChartItemData { list, i });
+		}
+	}
+
+	static b8 AreSelectedIndicesSameAsScanning(const PeepoDrumKit::ChartCourse& course)
+	{
+		using namespace PeepoDrumKit;
+		std::vector<ForEachChartItemData> scanned, indexed;
+		ForEachSelectedChartItemByScanning(course, [&](const ForEachChartItemData& it) { scanned.push_back(it); });
+		ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { indexed.push_back(it); });
+		return (scanned.size() == CountSelectedChartItems(course)) && std::equal(scanned.begin(), scanned.end(), indexed.begin(), indexed.end(),
+			[](const ForEachChartItemData& a, const ForEachChartItemData& b) { return (a.List == b.List) && (a.Index == b.Index); });
+	}
+
+	void RunChartSelectionBenchmarks(Context& context)
+	{
+		using namespace PeepoDrumKit;
+		static constexpr std::string_view suite = "ChartSelection";
+		static constexpr std::string_view names[] =
+		{
+			"SelectedIndicesMatchIsSelected",
+			"SelectAll",
+			"InvertAll",
+			"UnselectAll (64 selected)",
+			"CountSelected (scanning)",
+			"CountSelected (selection index)",
+			"DragSelectedNotes (scanning)",
+			"DragSelectedNotes (selection index)",
+		};
+		if (std::none_of(std::begin(names), std::end(names), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		static constexpr size_t itemCount = 20000;
+		static constexpr size_t sparseSelectionCount = 64;
+
+		RandomGenerator random {};
+		ChartCourse course;
+		{
+			std::vector<Note> notes; notes.reserve(itemCount);
+			for (size_t i = 0; i < itemCount; i++)
+				notes.push_back(Note { (Beat::FromBars(1) / 16) * static_cast<i32>(i) });
+			course.Notes_Normal.InsertOrUpdateMultiple(std::move(notes));
+		}
+
+		auto selectSparse = [&]()
+		{
+			ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, false); });
+			for (size_t i = 0; i < sparseSelectionCount; i++)
+				ForEachChartItemData { GenericList::Notes_Normal, (itemCount / 2) + (i * 4) }.SetIsSelected(course, true);
+		};
+
+		if (context.PassesFilter(suite, names[0]))
+		{
+			// NOTE: Mixing single selection changes with the list edits the undo commands make, each of which either keep the index in sync or have it rebuilt
+			static constexpr i32 editCount = 2048;
+			ChartCourse editedCourse = course;
+			b8 allSame = true;
+			for (i32 i = 0; i < editCount; i++)
+			{
+				SortedNotesList& notes = editedCourse.Notes_Normal;
+				const size_t randomIndex = random.NextU32() % notes.size();
+				switch (random.NextU32() % 8)
+				{
+				case 0: { Note note { Beat::FromTicks(random.NextI32InRange(0, GetBeat(notes.Sorted.back()).Ticks)) }; note.IsSelected = (random.NextU32() % 2) == 0; notes.InsertOrUpdate(note); } break;
+				case 1: { notes.RemoveAtIndex(randomIndex); } break;
+				case 2: { GenericListStruct value {}; TryGetGenericStruct(editedCourse, GenericList::Notes_Normal, randomIndex, value); value.POD.NoteItem.IsSelected ^= true; TrySetGenericStruct(editedCourse, GenericList::Notes_Normal, randomIndex, value); } break;
+				case 3: { notes[randomIndex].BeatDuration = Beat::Zero(); notes.SyncCachedBeatRangesAt(randomIndex, notes[randomIndex].BeatTime, notes[randomIndex].TimeOffset); } break;
+				default: { const ForEachChartItemData it { GenericList::Notes_Normal, randomIndex }; it.SetIsSelected(editedCourse, !it.GetIsSelected(editedCourse)); } break;
+				}
+				if ((i % 16) == 0)
+					allSame &= AreSelectedIndicesSameAsScanning(editedCourse);
+			}
+			allSame &= AreSelectedIndicesSameAsScanning(editedCourse);
+			context.Check(allSame, suite, names[0], itemCount);
+		}
+
+		context.Run(suite, names[1], itemCount, itemCount, [&] { ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, false); }); }, [&]
+		{
+			ForEachChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, true); });
+			DoNotOptimizeAway(CountSelectedChartItems(course));
+		});
+
+		context.Run(suite, names[2], itemCount, itemCount, selectSparse, [&]
+		{
+			ForEachChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, !it.GetIsSelected(course)); });
+			DoNotOptimizeAway(CountSelectedChartItems(course));
+		});
+
+		context.Run(suite, names[3], itemCount, sparseSelectionCount, selectSparse, [&]
+		{
+			ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, false); });
+			DoNotOptimizeAway(CountSelectedChartItems(course));
+		});
+
+		selectSparse();
+		context.Run(suite, names[4], itemCount, sparseSelectionCount, [&]
+		{
+			size_t selectedCount = 0;
+			ForEachSelectedChartItemByScanning(course, [&](const ForEachChartItemData& it) { selectedCount++; });
+			DoNotOptimizeAway(selectedCount);
+		});
+
+		context.Run(suite, names[5], itemCount, sparseSelectionCount, [&]
+		{
+			DoNotOptimizeAway(CountSelectedChartItems(course));
+		});
+
+		// NOTE: Moving the selected notes back and forth by one grid step each frame, same as the timeline does while dragging them
+		static constexpr i32 frameCount = 64;
+		const Beat dragBeatIncrement = (Beat::FromBars(1) / 64);
+		context.Run(suite, names[6], itemCount, frameCount, [&]
+		{
+			SortedNotesList& notes = course.Notes_Normal;
+			for (i32 frame = 0; frame < frameCount; frame++)
+			{
+				const Beat increment = ((frame % 2) == 0) ? dragBeatIncrement : -dragBeatIncrement;
+				size_t selectedCount = 0;
+				ForEachSelectedChartItemByScanning(course, [&](const ForEachChartItemData& it) { selectedCount++; });
+				for (size_t i = 0; i < notes.size(); i++)
+					if (notes[i].IsSelected) { notes[i].BeatTime += increment; notes.SyncCachedBeatRangesAt(i, notes[i].BeatTime - increment, notes[i].TimeOffset); }
+				DoNotOptimizeAway(selectedCount);
+			}
+		});
+
+		context.Run(suite, names[7], itemCount, frameCount, [&]
+		{
+			SortedNotesList& notes = course.Notes_Normal;
+			for (i32 frame = 0; frame < frameCount; frame++)
+			{
+				const Beat increment = ((frame % 2) == 0) ? dragBeatIncrement : -dragBeatIncrement;
+				const size_t selectedCount = CountSelectedChartItems(course);
+				for (const size_t i : notes.GetSelectedIndices())
+				{
+					notes[i].BeatTime += increment;
+					notes.SyncCachedBeatRangesAt(i, notes[i].BeatTime - increment, notes[i].TimeOffset);
+				}
+				DoNotOptimizeAway(selectedCount);
+			}
+		});
+	}
+}
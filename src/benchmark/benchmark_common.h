@@ -0,0 +1,136 @@
+#pragma once
+#include "core_types.h"
+#include "core_string.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+	// NOTE: Small deterministic xorshift generator so that every run (and every machine) measures the exact same input data
+	struct RandomGenerator
+	{
+		u64 State = 0x2545F4914F6CDD1D;
+
+		inline u32 NextU32() { State ^= (State << 13); State ^= (State >> 7); State ^= (State << 17); return static_cast<u32>(State >> 32); }
+		inline i32 NextI32InRange(i32 minInclusive, i32 maxExclusive) { return minInclusive + static_cast<i32>(NextU32() % static_cast<u32>(maxExclusive - minInclusive)); }
+		inline f32 NextF32() { return static_cast<f32>(NextU32() >> 8) / static_cast<f32>(1u << 24); }
+	};
+
+	// NOTE: Prevent the compiler from optimizing away results that are otherwise never read by forcing them into memory and then hiding that memory behind a compiler barrier,
+	//		 which unlike assigning to a volatile T works for any type without requiring volatile qualified member functions
+	template <typename T>
+	inline void DoNotOptimizeAway(const T& value)
+	{
+#if defined(_MSC_VER)
+		static const void* volatile sink; sink = &value; ::_ReadWriteBarrier();
+#else
+		asm volatile("" : : "g"(&value) : "memory");
+#endif
+	}
+
+	struct Result
+	{
+		std::string Suite;
+		std::string Name;
+		size_t ItemCount;
+		size_t OperationCount;
+		i32 RepetitionCount;
+		Time FastestDuration;
+	};
+
+	struct Context
+	{
+		// NOTE: Only run benchmarks containing this string as part of their "Suite/Name", empty to run all
+		std::string_view NameFilter;
+		// NOTE: Each benchmark is repeated until either of these limits has been reached and then the fastest repetition is reported
+		i32 MaxRepetitionCount = 32;
+		Time MinTotalDuration = Time::FromMS(200.0);
+		std::vector<Result> Results;
+		// NOTE: Number of failed correctness checks comparing optimized implementations against their simpler reference versions
+		i32 FailedCheckCount = 0;
+
+		inline b8 PassesFilter(std::string_view suite, std::string_view name) const
+		{
+			if (NameFilter.empty())
+				return true;
+			std::string fullName; fullName.reserve(suite.size() + name.size() + 1);
+			fullName.append(suite).append("/").append(name);
+			return (fullName.find(NameFilter) != std::string::npos);
+		}
+
+		// NOTE: The setup function is run before every repetition without being timed, the benchmark function then performs all "operationCount" operations
+		template <typename SetupFunc, typename BenchmarkFunc>
+		void Run(std::string_view suite, std::string_view name, size_t itemCount, size_t operationCount, SetupFunc setupFunc, BenchmarkFunc benchmarkFunc)
+		{
+			if (!PassesFilter(suite, name))
+				return;
+
+			Result& result = Results.emplace_back();
+			result.Suite = suite;
+			result.Name = name;
+			result.ItemCount = itemCount;
+			result.OperationCount = operationCount;
+			result.RepetitionCount = 0;
+			result.FastestDuration = Time::FromSec(F64Max);
+
+			Time totalDuration = Time::Zero();
+			while (result.RepetitionCount < MaxRepetitionCount && (totalDuration < MinTotalDuration || result.RepetitionCount < 1))
+			{
+				setupFunc();
+				CPUStopwatch stopwatch = CPUStopwatch::StartNew();
+				benchmarkFunc();
+				const Time elapsed = stopwatch.Stop();
+
+				result.FastestDuration = Min(result.FastestDuration, elapsed);
+				totalDuration += elapsed;
+				result.RepetitionCount++;
+			}
+
+			PrintResult(result);
+		}
+
+		template <typename BenchmarkFunc>
+		void Run(std::string_view suite, std::string_view name, size_t itemCount, size_t operationCount, BenchmarkFunc benchmarkFunc)
+		{
+			Run(suite, name, itemCount, operationCount, [] {}, benchmarkFunc);
+		}
+
+		inline void Check(b8 passed, std::string_view suite, std::string_view name, size_t checkedCount)
+		{
+			if (!PassesFilter(suite, name))
+				return;
+
+			FailedCheckCount += passed ? 0 : 1;
+			printf("%-20s %-48s n=%-8zu %s\n", std::string(suite).c_str(), std::string(name).c_str(), checkedCount, passed ? "PASSED" : "FAILED");
+		}
+
+		static inline void PrintResult(const Result& result)
+		{
+			const f64 nanosecondsPerOperation = (result.FastestDuration.ToSec() * 1000000000.0) / static_cast<f64>(ClampBot<size_t>(result.OperationCount, 1));
+			const f64 operationsPerSecond = static_cast<f64>(result.OperationCount) / ClampBot(result.FastestDuration.ToSec(), 0.000000001);
+			printf("%-20s %-48s n=%-8zu ops=%-9zu %12.3f ms %14.2f ns/op %14.0f ops/s\n",
+				result.Suite.c_str(), result.Name.c_str(), result.ItemCount, result.OperationCount,
+				result.FastestDuration.ToMS(), nanosecondsPerOperation, operationsPerSecond);
+		}
+	};
+
+	// NOTE: Item counts used by all suites measuring how an operation scales with the size of a chart
+	constexpr size_t ScalingItemCounts[] = { 1000, 10000, 100000 };
+
+	void RunBeatSortedListBenchmarks(Context& context);
+	void RunTempoMapBenchmarks(Context& context);
+	void RunTJATokenizerBenchmarks(Context& context);
+	void RunChartImportBenchmarks(Context& context);
+	void RunChartBinaryBenchmarks(Context& context);
+	void RunChartFumenBenchmarks(Context& context);
+	void RunChartTimingCacheBenchmarks(Context& context);
+	void RunChartSelectionBenchmarks(Context& context);
+	void RunAudioDecodeBenchmarks(Context& context);
+	void RunAudioResampleBenchmarks(Context& context);
+	void RunAudioMixBusBenchmarks(Context& context);
+	void RunAudioTimeStretchBenchmarks(Context& context);
+	void RunAudioVoicePoolBenchmarks(Context& context);
+	void RunAudioTelemetryBenchmarks(Context& context);
+	void RunAudioOfflineRenderBenchmarks(Context& context);
+}
@@ -0,0 +1,35 @@
+#include "benchmark_common.h"
+#include "core_build_info.h"
+
+// NOTE: Usage: PeepoDrumKitBenchmark.exe [name filter substring, for example "BeatSortedList/TryFind"]
+int main(int argc, const char* argv[])
+{
+	Benchmark::Context context {};
+	context.NameFilter = (argc > 1) ? std::string_view(argv[1]) : std::string_view();
+
+	printf("Peepo Drum Kit Benchmark (%s build, compiled %s %s)\n\n", BuildInfo::BuildConfiguration(), BuildInfo::CompilationDate(), BuildInfo::CompilationTime());
+
+	Benchmark::RunBeatSortedListBenchmarks(context);
+	Benchmark::RunTempoMapBenchmarks(context);
+	Benchmark::RunTJATokenizerBenchmarks(context);
+	Benchmark::RunChartImportBenchmarks(context);
+	Benchmark::RunChartBinaryBenchmarks(context);
+	Benchmark::RunChartFumenBenchmarks(context);
+	Benchmark::RunChartTimingCacheBenchmarks(context);
+	Benchmark::RunChartSelectionBenchmarks(context);
+	Benchmark::RunAudioDecodeBenchmarks(context);
+	Benchmark::RunAudioResampleBenchmarks(context);
+	Benchmark::RunAudioMixBusBenchmarks(context);
+	Benchmark::RunAudioTimeStretchBenchmarks(context);
+	Benchmark::RunAudioVoicePoolBenchmarks(context);
+	Benchmark::RunAudioTelemetryBenchmarks(context);
+	Benchmark::RunAudioOfflineRenderBenchmarks(context);
+
+	printf("\nFinished running %zu benchmarks\n", context.Results.size());
+	if (context.FailedCheckCount > 0)
+	{
+		printf("%d correctness check(s) FAILED\n", context.FailedCheckCount);
+		return 1;
+	}
+	return 0;
+}
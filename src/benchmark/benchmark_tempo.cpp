@@ -0,0 +1,273 @@
+#include "benchmark_common.h"
+#include "core_beat.h"
+#include <cmath>
+#include <string.h>
+
+namespace Benchmark
+{
+	// NOTE: Straight forward per-tick lookup table as a reference implementation to verify the segment based TempoMapAccelerationStructure against
+	struct ReferenceTempoMapLookupTable
+	{
+		std::vector<Time> BeatTickToTimes;
+		std::vector<TempoChange> TempoBuffer;
+		f64 FirstTempoBPM = 0.0, LastTempoBPM = 0.0;
+
+		Time GetLastCalculatedTime() const
+		{
+			return BeatTickToTimes.empty() ? Time::Zero() : BeatTickToTimes.back();
+		}
+
+		Time ConvertBeatToTime(Beat beat) const
+		{
+			const i32 beatTickToTimesCount = static_cast<i32>(BeatTickToTimes.size());
+			const i32 totalBeatTicks = beat.Ticks;
+
+			if (totalBeatTicks < 0)
+			{
+				const Time firstTickDuration = Time::FromSec((60.0 / FirstTempoBPM) / Beat::TicksPerBeat);
+				return firstTickDuration * totalBeatTicks;
+			}
+			else if (totalBeatTicks >= beatTickToTimesCount)
+			{
+				const Time lastTime = GetLastCalculatedTime();
+				const Time lastTickDuration = Time::FromSec((60.0 / LastTempoBPM) / Beat::TicksPerBeat);
+				const i32 remainingTicks = (totalBeatTicks - beatTickToTimesCount) + 1;
+				return lastTime + (lastTickDuration * remainingTicks);
+			}
+			else
+			{
+				return BeatTickToTimes[totalBeatTicks];
+			}
+		}
+
+		Beat ConvertTimeToBeat(Time time) const
+		{
+			const i32 beatTickToTimesCount = static_cast<i32>(BeatTickToTimes.size());
+			const Time lastTime = GetLastCalculatedTime();
+
+			if (time < Time::FromSec(0.0))
+			{
+				const Time firstTickDuration = Time::FromSec((60.0 / FirstTempoBPM) / Beat::TicksPerBeat);
+				return Beat(static_cast<i32>(time / firstTickDuration));
+			}
+			else if (time >= lastTime)
+			{
+				const Time timePastLast = (time - lastTime);
+				const Time lastTickDuration = Time::FromSec((60.0 / LastTempoBPM) / Beat::TicksPerBeat);
+				const f64 ticks = (timePastLast / lastTickDuration);
+				return Beat(static_cast<i32>(beatTickToTimesCount + ticks - 1));
+			}
+			else
+			{
+				i32 left = 0, right = beatTickToTimesCount - 1;
+				while (left <= right)
+				{
+					const i32 mid = (left + right) / 2;
+					if (time < BeatTickToTimes[mid])
+						right = mid - 1;
+					else if (time > BeatTickToTimes[mid])
+						left = mid + 1;
+					else
+						return Beat::FromTicks(mid);
+				}
+				return Beat::FromTicks((BeatTickToTimes[left] - time) < (time - BeatTickToTimes[right]) ? left : right);
+			}
+		}
+
+		void Rebuild(const TempoChange* inTempoChanges, size_t inTempoCount)
+		{
+			const TempoChange* tempoChanges = inTempoChanges;
+			size_t tempoCount = inTempoCount;
+
+			if (inTempoCount < 1 || inTempoChanges[0].BeatTime > Beat::Zero())
+			{
+				TempoBuffer.resize(inTempoCount + 1);
+				TempoBuffer[0] = TempoChange(Beat::Zero(), FallbackTempo);
+				std::copy_n(inTempoChanges, inTempoCount, TempoBuffer.begin() + 1);
+
+				tempoChanges = TempoBuffer.data();
+				tempoCount = TempoBuffer.size();
+			}
+
+			BeatTickToTimes.resize((tempoCount > 0) ? tempoChanges[tempoCount - 1].BeatTime.Ticks + 1 : 0);
+
+			f64 lastEndTime = 0.0;
+			for (size_t tempoChangeIndex = 0; tempoChangeIndex < tempoCount; tempoChangeIndex++)
+			{
+				const TempoChange& tempoChange = tempoChanges[tempoChangeIndex];
+
+				const f64 bpm = SafetyCheckTempo(tempoChange.TempoValue).BPM;
+				const f64 beatDuration = (60.0 / bpm);
+				const f64 tickDuration = (beatDuration / Beat::TicksPerBeat);
+
+				const b8 isSingleOrLastTempo = (tempoCount == 1) || (tempoChangeIndex == (tempoCount - 1));
+				const size_t timesCount = isSingleOrLastTempo ? BeatTickToTimes.size() : (tempoChanges[tempoChangeIndex + 1].BeatTime.Ticks);
+
+				for (size_t i = 0, t = tempoChange.BeatTime.Ticks; t < timesCount; t++)
+					BeatTickToTimes[t] = Time::FromSec((tickDuration * i++) + lastEndTime);
+
+				if (tempoCount > 1)
+					lastEndTime = BeatTickToTimes[timesCount - 1].ToSec() + tickDuration;
+
+				FirstTempoBPM = (tempoChangeIndex == 0) ? bpm : FirstTempoBPM;
+				LastTempoBPM = bpm;
+			}
+
+			if (!TempoBuffer.empty())
+				TempoBuffer.clear();
+		}
+	};
+
+	static inline b8 AreBitIdentical(Time a, Time b) { return (memcmp(&a, &b, sizeof(Time)) == 0); }
+
+	// NOTE: Mostly sane tempos with the occasional invalid or absurdly high one thrown in, as well as
+	//		 multiple changes on the same beat (which aren't normally possible to create but could come from an imported file)
+	static std::vector<TempoChange> CreateRandomTempoChanges(RandomGenerator& random, size_t tempoCount, i32 maxBeatSpacing)
+	{
+		std::vector<TempoChange> tempoChanges;
+		tempoChanges.reserve(tempoCount);
+
+		Beat beatIt = (random.NextU32() % 2 == 0) ? Beat::Zero() : Beat::FromTicks(random.NextI32InRange(1, Beat::TicksPerBeat * 8));
+		for (size_t i = 0; i < tempoCount; i++)
+		{
+			f32 bpm = 30.0f + random.NextF32() * 370.0f;
+			switch (random.NextU32() % 64)
+			{
+			case 0: bpm = 0.0f; break;
+			case 1: bpm = -bpm; break;
+			case 2: bpm = 1.0e30f; break;
+			case 3: bpm = random.NextF32() * 2.0f; break;
+			}
+
+			tempoChanges.push_back(TempoChange(beatIt, Tempo(bpm)));
+			if (beatIt.Ticks == 0 || random.NextU32() % 32 != 0)
+				beatIt += Beat::FromTicks(random.NextI32InRange(1, Beat::TicksPerBeat * maxBeatSpacing));
+		}
+		return tempoChanges;
+	}
+
+	static b8 CompareAgainstReferenceLookupTable(RandomGenerator& random, const std::vector<TempoChange>& tempoChanges, size_t& inOutCheckedCount)
+	{
+		ReferenceTempoMapLookupTable reference {};
+		reference.Rebuild(tempoChanges.data(), tempoChanges.size());
+		TempoMapAccelerationStructure segments {};
+		segments.Rebuild(tempoChanges.data(), tempoChanges.size());
+
+		b8 allIdentical = AreBitIdentical(reference.GetLastCalculatedTime(), segments.GetLastCalculatedTime());
+		auto compareBeat = [&](Beat beat) { allIdentical &= AreBitIdentical(reference.ConvertBeatToTime(beat), segments.ConvertBeatToTimeUsingSegmentBinarySearch(beat)); inOutCheckedCount++; };
+		auto compareTime = [&](Time time) { allIdentical &= (reference.ConvertTimeToBeat(time) == segments.ConvertTimeToBeatUsingSegmentBinarySearch(time)); inOutCheckedCount++; };
+
+		const i32 tickCount = static_cast<i32>(reference.BeatTickToTimes.size());
+		for (i32 tick = -Beat::TicksPerBeat; tick < tickCount + Beat::TicksPerBeat; tick++)
+			compareBeat(Beat::FromTicks(tick));
+
+		for (i32 tick = 0; tick < tickCount; tick++)
+		{
+			const Time tickTime = reference.BeatTickToTimes[tick];
+			compareTime(tickTime);
+			compareTime(Time::FromSec(std::nextafter(tickTime.ToSec(), -1.0)));
+			compareTime(Time::FromSec(std::nextafter(tickTime.ToSec(), F64Max)));
+			if (tick + 1 < tickCount)
+				compareTime(Time::FromSec((tickTime.ToSec() + reference.BeatTickToTimes[tick + 1].ToSec()) * 0.5));
+		}
+
+		const f64 maxTimeSec = reference.GetLastCalculatedTime().ToSec() + 10.0;
+		for (size_t i = 0; i < 256; i++)
+			compareTime(Time::FromSec(-1.0 + random.NextF32() * (maxTimeSec + 1.0)));
+
+		return allIdentical;
+	}
+
+	void RunTempoMapBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "TempoMap";
+		static constexpr size_t queryCount = 100000;
+
+		if (context.PassesFilter(suite, "Bit-identical to per-tick lookup table"))
+		{
+			RandomGenerator random {};
+			size_t checkedCount = 0;
+			b8 allIdentical = true;
+			for (size_t i = 0; i < 2000; i++)
+				allIdentical &= CompareAgainstReferenceLookupTable(random, CreateRandomTempoChanges(random, random.NextI32InRange(0, 24), 16), checkedCount);
+			context.Check(allIdentical, suite, "Bit-identical to per-tick lookup table", checkedCount);
+		}
+
+		// NOTE: Number of tempo changes spread across a ~10 minute song, with the last one always near the end
+		static constexpr size_t tempoChangeCounts[] = { 1, 16, 256, 4096 };
+		for (const size_t tempoChangeCount : tempoChangeCounts)
+		{
+			RandomGenerator random {};
+			const i32 songBeatCount = 1600;
+			std::vector<TempoChange> tempoChanges;
+			for (size_t i = 0; i < tempoChangeCount; i++)
+				tempoChanges.push_back(TempoChange(Beat::FromTicks(static_cast<i32>((static_cast<i64>(songBeatCount) * Beat::TicksPerBeat * (i + 1)) / tempoChangeCount)), Tempo(120.0f + random.NextF32() * 120.0f)));
+
+			std::vector<Beat> queryBeats; queryBeats.reserve(queryCount);
+			std::vector<Time> queryTimes; queryTimes.reserve(queryCount);
+			{
+				TempoMapAccelerationStructure segments {};
+				segments.Rebuild(tempoChanges.data(), tempoChanges.size());
+				for (size_t i = 0; i < queryCount; i++)
+				{
+					queryBeats.push_back(Beat::FromTicks(random.NextI32InRange(0, songBeatCount * Beat::TicksPerBeat)));
+					queryTimes.push_back(Time::FromSec(random.NextF32() * segments.GetLastCalculatedTime().ToSec()));
+				}
+			}
+
+			ReferenceTempoMapLookupTable reference {};
+			TempoMapAccelerationStructure segments {};
+
+			context.Run(suite, "Rebuild (per-tick lookup table)", tempoChangeCount, 1, [&] { reference = {}; }, [&]
+			{
+				reference.Rebuild(tempoChanges.data(), tempoChanges.size());
+				DoNotOptimizeAway(reference.BeatTickToTimes.data());
+			});
+
+			context.Run(suite, "Rebuild (segments)", tempoChangeCount, 1, [&] { segments = {}; }, [&]
+			{
+				segments.Rebuild(tempoChanges.data(), tempoChanges.size());
+				DoNotOptimizeAway(segments.Segments.data());
+			});
+
+			// NOTE: As happens every frame while dragging a tempo change, where all buffers have already been allocated
+			context.Run(suite, "Rebuild (segments, reused)", tempoChangeCount, 1, [&]
+			{
+				segments.Rebuild(tempoChanges.data(), tempoChanges.size());
+				DoNotOptimizeAway(segments.Segments.data());
+			});
+
+			context.Run(suite, "BeatToTime (per-tick lookup table)", tempoChangeCount, queryCount, [&]
+			{
+				f64 sum = 0.0;
+				for (const Beat beat : queryBeats)
+					sum += reference.ConvertBeatToTime(beat).ToSec();
+				DoNotOptimizeAway(sum);
+			});
+
+			context.Run(suite, "BeatToTime (segments)", tempoChangeCount, queryCount, [&]
+			{
+				f64 sum = 0.0;
+				for (const Beat beat : queryBeats)
+					sum += segments.ConvertBeatToTimeUsingSegmentBinarySearch(beat).ToSec();
+				DoNotOptimizeAway(sum);
+			});
+
+			context.Run(suite, "TimeToBeat (per-tick lookup table)", tempoChangeCount, queryCount, [&]
+			{
+				i64 sum = 0;
+				for (const Time time : queryTimes)
+					sum += reference.ConvertTimeToBeat(time).Ticks;
+				DoNotOptimizeAway(sum);
+			});
+
+			context.Run(suite, "TimeToBeat (segments)", tempoChangeCount, queryCount, [&]
+			{
+				i64 sum = 0;
+				for (const Time time : queryTimes)
+					sum += segments.ConvertTimeToBeatUsingSegmentBinarySearch(time).Ticks;
+				DoNotOptimizeAway(sum);
+			});
+		}
+	}
+}
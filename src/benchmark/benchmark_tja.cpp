@@ -0,0 +1,179 @@
+#include "benchmark_common.h"
+#include "file_format_tja.h"
+
+namespace Benchmark
+{
+	// NOTE: Concatenation of many synthetic songs, each with a few courses of varying note density, comments and chart commands
+	static std::string CreateSyntheticTJACorpus(size_t targetByteSize)
+	{
+		static constexpr char noteChars[] = { '0', '0', '0', '0', '1', '1', '2', '2', '3', '4' };
+		static constexpr cstr courseNames[] = { "Easy", "Normal", "Hard", "Oni" };
+
+		RandomGenerator random {};
+		std::string corpus;
+		corpus.reserve(targetByteSize + 0x10000);
+
+		char buffer[128];
+		for (i32 songIndex = 0; corpus.size() < targetByteSize; songIndex++)
+		{
+			corpus.append(buffer, sprintf_s(buffer, "TITLE:Synthetic Song %d\r\nSUBTITLE:--Benchmark\r\n", songIndex));
+			corpus.append(buffer, sprintf_s(buffer, "BPM:%d\r\nWAVE:song_%d.ogg\r\nOFFSET:-1.25\r\nDEMOSTART:30.5\r\n\r\n", random.NextI32InRange(80, 240), songIndex));
+
+			for (cstr courseName : courseNames)
+			{
+				corpus.append(buffer, sprintf_s(buffer, "COURSE:%s\r\nLEVEL:%d\r\nBALLOON:10,20\r\n\r\n#START\r\n", courseName, random.NextI32InRange(1, 10)));
+				for (i32 measure = 0; measure < 64; measure++)
+				{
+					switch (random.NextU32() % 16)
+					{
+					case 0: corpus.append(buffer, sprintf_s(buffer, "#BPMCHANGE %d\r\n", random.NextI32InRange(80, 240))); break;
+					case 1: corpus.append("#MEASURE 3/4\r\n"); break;
+					case 2: corpus.append("#SCROLL 1.5\r\n"); break;
+					case 3: corpus.append("// Just a comment line\r\n"); break;
+					default: break;
+					}
+
+					const i32 noteCount = 4 << (random.NextU32() % 4);
+					for (i32 i = 0; i < noteCount; i++)
+						corpus += noteChars[random.NextU32() % ArrayCount(noteChars)];
+					corpus.append((random.NextU32() % 8 == 0) ? ", // Trailing comment\r\n" : ",\r\n");
+				}
+				corpus.append("#END\r\n\r\n");
+			}
+		}
+
+		return corpus;
+	}
+
+	static inline b8 AreTokensIdentical(const TJA::Token& a, const TJA::Token& b)
+	{
+		return (a.Type == b.Type) && (a.KeyID == b.KeyID) && (a.LineIndex == b.LineIndex) &&
+			(a.Line == b.Line) && (a.KeyString == b.KeyString) && (a.ValueString == b.ValueString);
+	}
+
+	static b8 AreTokenListsIdentical(const std::vector<TJA::Token>& a, const std::vector<TJA::Token>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); i++)
+			if (!AreTokensIdentical(a[i], b[i])) return false;
+		return true;
+	}
+
+	void RunTJATokenizerBenchmarks(Context& context)
+	{
+		static constexpr std::string_view suite = "TJATokenizer";
+
+		// NOTE: Edge cases around the line splitting (trailing newline, "\r\n" vs "\n", empty lines, whitespace only lines, etc.)
+		static constexpr std::string_view edgeCaseInputs[] =
+		{
+			"", "\n", "\r\n", "\n\n", "A", "A\n", "A\r\n", "A\n\n", "A\r\n\r\n", "\nA", "A\nB", "A\r\nB\r\n", "A\n \t\nB", "A//B\n//C\r\n#START\n1,\n#END",
+			"TITLE:0123456789abcdef0123456789abcdef\n0123456789abcdef0123456789abcdef\r\n0123456789abcdef0123456789abcdef",
+		};
+
+		if (context.PassesFilter(suite, "Identical to SplitLines + TokenizeLines"))
+		{
+			const std::string corpus = CreateSyntheticTJACorpus(1024 * 1024);
+
+			b8 allIdentical = AreTokenListsIdentical(TJA::TokenizeFileContent(corpus), TJA::TokenizeLines(TJA::SplitLines(corpus)));
+			for (const std::string_view input : edgeCaseInputs)
+				allIdentical &= AreTokenListsIdentical(TJA::TokenizeFileContent(input), TJA::TokenizeLines(TJA::SplitLines(input)));
+
+			context.Check(allIdentical, suite, "Identical to SplitLines + TokenizeLines", ArrayCount(edgeCaseInputs) + 1);
+		}
+
+		if (context.PassesFilter(suite, "LineIndex past 32767 lines"))
+		{
+			static constexpr i32 lineCount = 100000;
+			std::string manyLines = "#START\n";
+			for (i32 i = 0; i < lineCount; i++)
+				manyLines.append("1,\n");
+			manyLines.append("#BOGUS");
+
+			TJA::ErrorList errors;
+			TJA::ParseTokens(TJA::TokenizeFileContent(manyLines), errors);
+			const b8 lastErrorOnLastLine = !errors.Errors.empty() && (errors.Errors.front().LineIndex == (lineCount + 1));
+
+			context.Check(lastErrorOnLastLine, suite, "LineIndex past 32767 lines", lineCount);
+		}
+
+		if (context.PassesFilter(suite, "Note pool spans"))
+		{
+			// NOTE: Every note of a course is referenced by exactly one MeasureNotes span, in order, both when parsed from text and when rebuilt from the converted measures
+			const auto areNoteSpansContiguous = [](const TJA::ParsedCourse& course) -> b8
+			{
+				u32 nextNoteIndex = 0;
+				for (const TJA::ParsedChartCommand& command : course.ChartCommands)
+				{
+					if (command.Type != TJA::ParsedChartCommandType::MeasureNotes)
+						continue;
+					if (command.Param.MeasureNotes.Notes.Index != nextNoteIndex)
+						return false;
+					nextNoteIndex += command.Param.MeasureNotes.Notes.Count;
+				}
+				return (nextNoteIndex == course.NotePool.size());
+			};
+
+			TJA::ErrorList errors;
+			const TJA::ParsedTJA parsed = TJA::ParseTokens(TJA::TokenizeFileContent(CreateSyntheticTJACorpus(256 * 1024)), errors);
+
+			b8 allContiguous = !parsed.Courses.empty();
+			for (const TJA::ParsedCourse& course : parsed.Courses)
+			{
+				const TJA::ConvertedCourse converted = TJA::ConvertParsedToConvertedCourse(parsed, course);
+				TJA::ParsedCourse rebuilt {};
+				TJA::ConvertConvertedMeasuresToParsedCommands(converted.Measures, converted.GoGoRanges, rebuilt);
+				allContiguous &= areNoteSpansContiguous(course) && areNoteSpansContiguous(rebuilt);
+			}
+
+			context.Check(allContiguous, suite, "Note pool spans", parsed.Courses.size());
+		}
+
+		if (context.PassesFilter(suite, "ConvertParsedToText round trip"))
+		{
+			TJA::ErrorList errors;
+			std::string firstText, secondText;
+			TJA::ConvertParsedToText(TJA::ParseTokens(TJA::TokenizeFileContent(CreateSyntheticTJACorpus(256 * 1024)), errors), firstText, TJA::Encoding::UTF8);
+			TJA::ConvertParsedToText(TJA::ParseTokens(TJA::TokenizeFileContent(UTF8::HasBOM(firstText) ? UTF8::TrimBOM(firstText) : std::string_view(firstText)), errors), secondText, TJA::Encoding::UTF8);
+
+			context.Check(!firstText.empty() && (firstText == secondText), suite, "ConvertParsedToText round trip", firstText.size());
+		}
+
+		static constexpr std::string_view benchmarkNames[] = { "SplitLines + TokenizeLines (50 MB)", "TokenizeFileContent (50 MB)", "TokenStream, no token vector (50 MB)", "TokenizeFileContent + ParseTokens (50 MB)" };
+		if (std::none_of(std::begin(benchmarkNames), std::end(benchmarkNames), [&](std::string_view name) { return context.PassesFilter(suite, name); }))
+			return;
+
+		const std::string corpus = CreateSyntheticTJACorpus(50 * 1024 * 1024);
+		const size_t corpusMB = (corpus.size() / (1024 * 1024));
+		const size_t lineCount = TJA::SplitLines(corpus).size();
+
+		context.Run(suite, benchmarkNames[0], corpusMB, lineCount, [&]
+		{
+			const std::vector<TJA::Token> tokens = TJA::TokenizeLines(TJA::SplitLines(corpus));
+			DoNotOptimizeAway(tokens.size());
+		});
+
+		context.Run(suite, benchmarkNames[1], corpusMB, lineCount, [&]
+		{
+			const std::vector<TJA::Token> tokens = TJA::TokenizeFileContent(corpus);
+			DoNotOptimizeAway(tokens.size());
+		});
+
+		context.Run(suite, benchmarkNames[2], corpusMB, lineCount, [&]
+		{
+			TJA::TokenStream stream { corpus };
+			TJA::Token token;
+			size_t chartDataCount = 0;
+			while (stream.TryGetNext(token))
+				chartDataCount += (token.Type == TJA::TokenType::ChartData);
+			DoNotOptimizeAway(chartDataCount);
+		});
+
+		context.Run(suite, benchmarkNames[3], corpusMB, lineCount, [&]
+		{
+			TJA::ErrorList errors;
+			const TJA::ParsedTJA parsed = TJA::ParseTokens(TJA::TokenizeFileContent(corpus), errors);
+			DoNotOptimizeAway(parsed.Courses.size());
+		});
+	}
+}
@@ -0,0 +1,484 @@
+#include "core_types.h"
+#include "core_string.h"
+#include "core_io.h"
+#include "core_build_info.h"
+#include "core_thread_pool.h"
+#include "file_format_tja.h"
+#include "file_format_fumen.h"
+#include "peepo_drum_kit/chart.h"
+#include "peepo_drum_kit/chart_binary.h"
+#include "peepo_drum_kit/chart_audio_render.h"
+#include "audio/audio_engine.h"
+#include "audio/audio_file_formats.h"
+#include <stdio.h>
+#include <algorithm>
+
+namespace Cli
+{
+	using namespace PeepoDrumKit;
+
+	enum class Mode : u8 { Validate, Convert, Render };
+
+	struct Options
+	{
+		Mode SelectedMode = Mode::Validate;
+		i32 ThreadCount = 0;
+		b8 Quiet = false;
+		b8 Binary = false;
+		std::vector<std::string> InputPaths;
+		std::string InputDirectory;
+		std::string OutputDirectory;
+		// NOTE: Render mode only
+		std::string RenderOutputFilePath;
+		i32 RenderCourseIndex = 0;
+		b8 RenderMetronome = false;
+		b8 RenderHitSounds = true;
+		std::string RenderTelemetryFilePath;
+	};
+
+	struct FileResult
+	{
+		std::string InputPath;
+		std::string OutputPath;
+		size_t FileSize = 0;
+		i32 CourseCount = 0;
+		TJA::ErrorList ParseErrors;
+		// NOTE: Fatal per-file problems that aren't TJA syntax errors (file not readable, export not idempotent, etc.)
+		std::vector<std::string> FailureMessages;
+
+		inline b8 HasFailed() const { return !FailureMessages.empty() || !ParseErrors.Errors.empty(); }
+	};
+
+	static void PrintUsage()
+	{
+		fprintf(stderr,
+			"Usage:\n"
+			"  PeepoDrumKitCli validate [options] <file or directory>...\n"
+			"  PeepoDrumKitCli convert [options] <input directory> <output directory>\n"
+			"  PeepoDrumKitCli render [options] <chart file (.tja, .pdkchart or single course fumen .bin)> <output .wav file>\n"
+			"\n"
+			"Options:\n"
+			"  --threads <count>   Number of worker threads, defaults to the number of hardware threads\n"
+			"  --quiet             Only print failing files and the final summary\n"
+			"  --binary            Also check the binary chart format round-trip and write binary (.pdkchart) instead of .tja files\n"
+			"  --course <index>    Course to render, defaults to the first one\n"
+			"  --metronome         Also render the metronome\n"
+			"  --no-hit-sounds     Don't render any note hit sounds\n"
+			"  --telemetry <file>  Also write the audio engine render telemetry to a .json (or per-callback .csv) file\n"
+			"\n"
+			"\"validate\" parses every .tja file, converts all of its courses and checks that exporting is idempotent.\n"
+			"\"convert\" additionally writes the re-exported UTF-8 .tja files to the output directory, preserving the relative directory structure.\n"
+			"\"render\" mixes the song together with the hit sounds of a single course (as heard in the editor) into a 16-bit stereo .wav file, much faster than real-time.\n");
+	}
+
+	static b8 TryParseCommandLine(i32 argc, const char* argv[], Options& out)
+	{
+		if (argc < 2)
+			return false;
+
+		const std::string_view modeArg = argv[1];
+		if (modeArg == "validate")
+			out.SelectedMode = Mode::Validate;
+		else if (modeArg == "convert")
+			out.SelectedMode = Mode::Convert;
+		else if (modeArg == "render")
+			out.SelectedMode = Mode::Render;
+		else
+			return false;
+
+		std::vector<std::string> positionalArgs;
+		for (i32 i = 2; i < argc; i++)
+		{
+			const std::string_view arg = argv[i];
+			if (arg == "--threads" && (i + 1) < argc)
+			{
+				if (!ASCII::TryParseI32(argv[++i], out.ThreadCount) || out.ThreadCount < 0)
+					return false;
+			}
+			else if (arg == "--quiet")
+			{
+				out.Quiet = true;
+			}
+			else if (arg == "--binary")
+			{
+				out.Binary = true;
+			}
+			else if (arg == "--course" && (i + 1) < argc)
+			{
+				if (!ASCII::TryParseI32(argv[++i], out.RenderCourseIndex) || out.RenderCourseIndex < 0)
+					return false;
+			}
+			else if (arg == "--metronome")
+			{
+				out.RenderMetronome = true;
+			}
+			else if (arg == "--no-hit-sounds")
+			{
+				out.RenderHitSounds = false;
+			}
+			else if (arg == "--telemetry" && (i + 1) < argc)
+			{
+				out.RenderTelemetryFilePath = Path::CopyAndNormalize(argv[++i]);
+			}
+			else if (ASCII::StartsWith(arg, "--"))
+			{
+				return false;
+			}
+			else
+			{
+				positionalArgs.emplace_back(Path::CopyAndNormalize(arg));
+			}
+		}
+
+		// NOTE: Trailing separators would otherwise mess up the relative output paths
+		for (std::string& path : positionalArgs)
+		{
+			while (path.size() > 1 && path.back() == Path::DirectorySeparator)
+				path.pop_back();
+		}
+
+		if (out.SelectedMode == Mode::Validate)
+		{
+			out.InputPaths = std::move(positionalArgs);
+			return !out.InputPaths.empty();
+		}
+		else if (out.SelectedMode == Mode::Render)
+		{
+			if (positionalArgs.size() != 2)
+				return false;
+			out.InputPaths = { std::move(positionalArgs[0]) };
+			out.RenderOutputFilePath = std::move(positionalArgs[1]);
+			return true;
+		}
+		else
+		{
+			if (positionalArgs.size() != 2)
+				return false;
+			out.InputDirectory = std::move(positionalArgs[0]);
+			out.OutputDirectory = std::move(positionalArgs[1]);
+			return true;
+		}
+	}
+
+	static std::vector<std::string> CollectInputTJAFilePaths(const std::vector<std::string>& inputPaths)
+	{
+		std::vector<std::string> tjaFilePaths;
+		for (const std::string& inputPath : inputPaths)
+		{
+			if (!Directory::Exists(inputPath))
+			{
+				tjaFilePaths.push_back(inputPath);
+				continue;
+			}
+
+			std::vector<std::string> directoryFilePaths;
+			Directory::GetFilesRecursive(inputPath, directoryFilePaths);
+
+			// NOTE: Sorted so that the output order doesn't depend on the file system enumeration order
+			std::sort(directoryFilePaths.begin(), directoryFilePaths.end());
+			for (std::string& filePath : directoryFilePaths)
+			{
+				if (Path::HasExtension(filePath, TJA::Extension))
+					tjaFilePaths.push_back(std::move(filePath));
+			}
+		}
+		return tjaFilePaths;
+	}
+
+	static void ExportChartProjectToTJAText(const ChartProject& chart, std::string& outText)
+	{
+		// NOTE: Without the comment as its embedded date would otherwise make the output differ between runs
+		TJA::ParsedTJA exportedTJA;
+		ConvertChartProjectToTJA(chart, exportedTJA, false);
+		outText.clear();
+		TJA::ConvertParsedToText(exportedTJA, outText, TJA::Encoding::UTF8);
+	}
+
+	static std::string ConvertTJAFileContentToUTF8(std::string_view fileContent)
+	{
+		if (UTF8::HasBOM(fileContent))
+			return std::string(UTF8::TrimBOM(fileContent));
+		else
+			return UTF8::FromShiftJIS(fileContent);
+	}
+
+	static void ProcessTJAFile(const Options& options, FileResult& result)
+	{
+		auto fail = [&result](cstr fmt, ...)
+		{
+			char buffer[512];
+			va_list args;
+			va_start(args, fmt);
+			result.FailureMessages.emplace_back(buffer, vsprintf_s(buffer, fmt, args));
+			va_end(args);
+		};
+
+		const File::UniqueFileContent fileContent = File::ReadAllBytes(result.InputPath);
+		if (fileContent.Content == nullptr)
+			return fail("Failed to read file");
+
+		result.FileSize = fileContent.Size;
+		const std::string fileContentUTF8 = ConvertTJAFileContentToUTF8(fileContent.AsString());
+
+		const std::vector<TJA::Token> tokens = TJA::TokenizeFileContent(fileContentUTF8);
+		const TJA::ParsedTJA parsedTJA = TJA::ParseTokens(tokens, result.ParseErrors);
+
+		result.CourseCount = static_cast<i32>(parsedTJA.Courses.size());
+		if (parsedTJA.Courses.empty())
+			return fail("No courses found");
+
+		ChartProject chart;
+		std::vector<size_t> failedCourseIndices;
+		if (!CreateChartProjectFromTJA(parsedTJA, chart, nullptr, &failedCourseIndices))
+			return fail("Failed to create chart");
+
+		for (const size_t failedCourseIndex : failedCourseIndices)
+			fail("Failed to convert course %d", static_cast<i32>(failedCourseIndex));
+
+		// NOTE: Exporting a chart that has been imported from a previous export should always result in the exact same text
+		std::string exportedText, reExportedText;
+		ExportChartProjectToTJAText(chart, exportedText);
+		{
+			TJA::ErrorList reImportErrors;
+			const std::string_view reImportText = UTF8::HasBOM(exportedText) ? UTF8::TrimBOM(exportedText) : std::string_view(exportedText);
+			const TJA::ParsedTJA reImportedTJA = TJA::ParseTokens(TJA::TokenizeFileContent(reImportText), reImportErrors);
+
+			ChartProject reImportedChart;
+			if (!reImportErrors.Errors.empty() || !CreateChartProjectFromTJA(reImportedTJA, reImportedChart))
+				return fail("Failed to re-import exported chart");
+
+			ExportChartProjectToTJAText(reImportedChart, reExportedText);
+		}
+
+		if (exportedText != reExportedText)
+			return fail("Exported chart is not round-trip stable");
+
+		std::vector<u8> binaryFileContent;
+		if (options.Binary)
+		{
+			SaveChartProjectToBinary(chart, binaryFileContent);
+
+			ChartProject binaryChart;
+			if (!LoadChartProjectFromBinary(binaryFileContent.data(), binaryFileContent.size(), binaryChart))
+				return fail("Failed to load saved binary chart");
+
+			std::string binaryExportedText;
+			ExportChartProjectToTJAText(binaryChart, binaryExportedText);
+			if (exportedText != binaryExportedText)
+				return fail("Binary chart is not round-trip stable");
+		}
+
+		if (options.SelectedMode == Mode::Convert)
+		{
+			Directory::CreateRecursive(Path::GetDirectoryName(result.OutputPath));
+			const b8 writeSucceeded = options.Binary ?
+				File::WriteAllBytes(result.OutputPath, binaryFileContent.data(), binaryFileContent.size()) :
+				File::WriteAllBytes(result.OutputPath, exportedText);
+			if (!writeSucceeded)
+				return fail("Failed to write output file '%.*s'", FmtStrViewArgs(result.OutputPath));
+		}
+	}
+
+	static void PrintFileResult(const Options& options, const FileResult& result)
+	{
+		if (!result.HasFailed())
+		{
+			if (!options.Quiet)
+				printf("%s: OK (%d course(s))\n", result.InputPath.c_str(), result.CourseCount);
+			return;
+		}
+
+		for (const TJA::ErrorList::ErrorLine& error : result.ParseErrors.Errors)
+			printf("%s(%d): %s\n", result.InputPath.c_str(), error.LineIndex + 1, error.Description.c_str());
+		for (const std::string& message : result.FailureMessages)
+			printf("%s: %s\n", result.InputPath.c_str(), message.c_str());
+	}
+
+	static b8 TryLoadChartProjectFile(std::string_view filePath, ChartProject& outChart)
+	{
+		if (Path::HasExtension(filePath, ChartBinaryExtension))
+			return LoadChartProjectFromBinaryFile(filePath, outChart);
+
+		const File::UniqueFileContent fileContent = File::ReadAllBytes(filePath);
+		if (fileContent.Content == nullptr)
+			return false;
+
+		if (Path::HasExtension(filePath, Fumen::Extension))
+			return CreateChartProjectFromFumen(fileContent.Content.get(), fileContent.Size, outChart);
+
+		TJA::ErrorList parseErrors;
+		const TJA::ParsedTJA parsedTJA = TJA::ParseTokens(TJA::TokenizeFileContent(ConvertTJAFileContentToUTF8(fileContent.AsString())), parseErrors);
+		for (const TJA::ErrorList::ErrorLine& error : parseErrors.Errors)
+			fprintf(stderr, "%.*s(%d): %s\n", FmtStrViewArgs(filePath), error.LineIndex + 1, error.Description.c_str());
+
+		return CreateChartProjectFromTJA(parsedTJA, outChart);
+	}
+
+	// NOTE: Resampled to the engine output sample rate during decoding, since voices with a mismatched sample rate would otherwise need variable rate playback
+	static Audio::SourceHandle TryLoadAudioSourceFile(std::string_view filePath)
+	{
+		const File::UniqueFileContent fileContent = File::ReadAllBytes(filePath);
+		if (fileContent.Content == nullptr)
+			return Audio::SourceHandle::Invalid;
+
+		Audio::PCMSampleBuffer sampleBuffer {};
+		{
+			Audio::StreamingDecoder decoder {};
+			if (decoder.Open(filePath, fileContent.Content.get(), fileContent.Size, sampleBuffer, Audio::AudioEngine::OutputSampleRate) != Audio::DecodeFileResult::FeelsGoodMan)
+				return Audio::SourceHandle::Invalid;
+			decoder.DecodeAllRemainingChunks();
+		}
+		sampleBuffer.StreamingDecodedFrameCount = nullptr;
+
+		return Audio::Engine.LoadSourceFromBufferMove(Path::GetFileName(filePath), std::move(sampleBuffer));
+	}
+
+	static i32 RunRender(const Options& options)
+	{
+		// NOTE: Larger than the GUI default as there is no latency to worry about, only the per-callback overhead
+		static constexpr u32 renderBufferFrameCount = 1024;
+
+		const std::string& chartFilePath = options.InputPaths[0];
+		ChartProject chart;
+		if (!TryLoadChartProjectFile(chartFilePath, chart))
+		{
+			fprintf(stderr, "Failed to load chart file '%s'\n", chartFilePath.c_str());
+			return 1;
+		}
+
+		if (options.RenderCourseIndex >= static_cast<i32>(chart.Courses.size()))
+		{
+			fprintf(stderr, "Invalid course index %d, the chart only contains %zu course(s)\n", options.RenderCourseIndex, chart.Courses.size());
+			return 1;
+		}
+
+		Audio::Engine.ApplicationStartup();
+		Audio::Engine.SetBackend(Audio::Backend::Offline);
+		Audio::Engine.SetBufferFrameSize(renderBufferFrameCount);
+
+		ChartAudioRenderParam param {};
+		param.NoteHitSounds = options.RenderHitSounds;
+		param.Metronome = options.RenderMetronome;
+		param.SongVolume = chart.SongVolume;
+		param.SoundEffectVolume = chart.SoundEffectVolume;
+
+		if (!chart.SongFileName.empty())
+		{
+			const std::string songFilePath = Path::TryMakeAbsolute(chart.SongFileName, Path::GetDirectoryName(chartFilePath));
+			if ((param.SongSource = TryLoadAudioSourceFile(songFilePath)) == Audio::SourceHandle::Invalid)
+				fprintf(stderr, "Failed to load song file '%s', rendering without it\n", songFilePath.c_str());
+		}
+
+		// NOTE: Relative to the current working directory, same as for the editor
+		for (size_t i = 0; i < EnumCount<SoundEffectType>; i++)
+		{
+			if ((param.SoundEffectSources[i] = TryLoadAudioSourceFile(SoundEffectTypeFilePaths[i])) == Audio::SourceHandle::Invalid)
+				fprintf(stderr, "Failed to load sound effect file '%s', rendering without it\n", SoundEffectTypeFilePaths[i]);
+		}
+
+		std::vector<i16> interleavedSamples;
+		CPUStopwatch stopwatch = CPUStopwatch::StartNew();
+		const b8 renderSucceeded = RenderChartCourseAudioOffline(chart, *chart.Courses[options.RenderCourseIndex], param, interleavedSamples);
+		const Time elapsed = stopwatch.Stop();
+		const Audio::RenderTelemetrySnapshot telemetry = Audio::Engine.GetRenderTelemetrySnapshot();
+		Audio::Engine.ApplicationShutdown();
+
+		if (!options.RenderTelemetryFilePath.empty())
+		{
+			const std::string telemetryFileContent = Path::HasExtension(options.RenderTelemetryFilePath, ".csv") ?
+				Audio::RenderTelemetrySnapshotToCSV(telemetry) :
+				Audio::RenderTelemetrySnapshotToJSON(telemetry);
+
+			if (!File::WriteAllBytes(options.RenderTelemetryFilePath, std::string_view(telemetryFileContent)))
+				fprintf(stderr, "Failed to write telemetry file '%s'\n", options.RenderTelemetryFilePath.c_str());
+		}
+
+		if (!renderSucceeded)
+		{
+			fprintf(stderr, "Failed to render chart audio\n");
+			return 1;
+		}
+
+		const i64 frameCount = static_cast<i64>(interleavedSamples.size() / Audio::AudioEngine::OutputChannelCount);
+		std::vector<u8> waveFileContent;
+		Audio::EncodeWaveFile(interleavedSamples.data(), frameCount, Audio::AudioEngine::OutputChannelCount, Audio::AudioEngine::OutputSampleRate, waveFileContent);
+
+		if (!File::WriteAllBytes(options.RenderOutputFilePath, waveFileContent.data(), waveFileContent.size()))
+		{
+			fprintf(stderr, "Failed to write output file '%s'\n", options.RenderOutputFilePath.c_str());
+			return 1;
+		}
+
+		const Time renderedDuration = Audio::FramesToTime(frameCount, Audio::AudioEngine::OutputSampleRate);
+		printf("Rendered %.3f sec of audio in %.3f ms (%.1fx real-time) to '%s'\n",
+			renderedDuration.ToSec(), elapsed.ToMS(), renderedDuration.ToSec() / ClampBot(elapsed.ToSec(), 0.000001), options.RenderOutputFilePath.c_str());
+
+		return 0;
+	}
+
+	static i32 Run(const Options& options)
+	{
+		if (options.SelectedMode == Mode::Render)
+			return RunRender(options);
+
+		std::vector<FileResult> results;
+		{
+			const std::vector<std::string> inputFilePaths = (options.SelectedMode == Mode::Convert) ?
+				CollectInputTJAFilePaths({ options.InputDirectory }) :
+				CollectInputTJAFilePaths(options.InputPaths);
+
+			results.resize(inputFilePaths.size());
+			for (size_t i = 0; i < inputFilePaths.size(); i++)
+			{
+				results[i].InputPath = inputFilePaths[i];
+				if (options.SelectedMode == Mode::Convert)
+					results[i].OutputPath = options.OutputDirectory + std::string(ASCII::TrimPrefix(inputFilePaths[i], options.InputDirectory));
+				if (options.SelectedMode == Mode::Convert && options.Binary)
+					results[i].OutputPath = std::string(Path::TrimExtension(results[i].OutputPath)).append(ChartBinaryExtension);
+			}
+		}
+
+		if (options.SelectedMode == Mode::Convert && !Directory::Exists(options.InputDirectory))
+		{
+			fprintf(stderr, "Input directory '%s' does not exist\n", options.InputDirectory.c_str());
+			return 1;
+		}
+
+		CPUStopwatch stopwatch = CPUStopwatch::StartNew();
+		ThreadPool threadPool(options.ThreadCount);
+		threadPool.ParallelFor(results.size(), [&](size_t i) { ProcessTJAFile(options, results[i]); });
+		const Time elapsed = stopwatch.Stop();
+
+		// NOTE: Printed only after all files have finished so that the output order always matches the input order
+		size_t failedFileCount = 0, totalErrorCount = 0, totalByteCount = 0;
+		for (const FileResult& result : results)
+		{
+			PrintFileResult(options, result);
+			failedFileCount += result.HasFailed() ? 1 : 0;
+			totalErrorCount += result.ParseErrors.Errors.size() + result.FailureMessages.size();
+			totalByteCount += result.FileSize;
+		}
+
+		const f64 elapsedSec = ClampBot(elapsed.ToSec(), 0.000001);
+		const f64 totalMB = static_cast<f64>(totalByteCount) / (1024.0 * 1024.0);
+		printf("\n%zu file(s), %zu failed, %zu error(s), %.2f MB in %.3f ms using %d thread(s) (%.1f files/s, %.2f MB/s)\n",
+			results.size(), failedFileCount, totalErrorCount, totalMB, elapsed.ToMS(), threadPool.GetThreadCount(),
+			static_cast<f64>(results.size()) / elapsedSec, totalMB / elapsedSec);
+
+		return (failedFileCount > 0) ? 1 : 0;
+	}
+}
+
+// NOTE: Usage: PeepoDrumKitCli.exe (validate|convert|render) [--threads N] [--quiet] [--binary] [--course N] [--metronome] [--no-hit-sounds] [--telemetry FILE] <paths...>
+int main(int argc, const char* argv[])
+{
+	Cli::Options options {};
+	if (!Cli::TryParseCommandLine(argc, argv, options))
+	{
+		fprintf(stderr, "Peepo Drum Kit CLI (%s build, compiled %s %s)\n\n", BuildInfo::BuildConfiguration(), BuildInfo::CompilationDate(), BuildInfo::CompilationTime());
+		Cli::PrintUsage();
+		return 2;
+	}
+
+	return Cli::Run(options);
+}
@@ -1,9 +1,8 @@
 #include "core_beat.h"
 #include <algorithm>
 
-Time TempoMapAccelerationStructure::ConvertBeatToTimeUsingLookupTableIndexing(Beat beat) const
+Time TempoMapAccelerationStructure::ConvertBeatToTimeUsingSegmentBinarySearch(Beat beat) const
 {
-	const i32 beatTickToTimesCount = static_cast<i32>(BeatTickToTimes.size());
 	const i32 totalBeatTicks = beat.Ticks;
 
 	if (totalBeatTicks < 0) // NOTE: Negative tick (tempo changes are assumed to only be positive)
@@ -14,7 +13,7 @@ Time TempoMapAccelerationStructure::ConvertBeatToTimeUsingLookupTableIndexing(Be
 		// NOTE: Then scale by the negative tick
 		return firstTickDuration * totalBeatTicks;
 	}
-	else if (totalBeatTicks >= beatTickToTimesCount) // NOTE: Tick is outside the defined tempo map
+	else if (totalBeatTicks >= TickCount) // NOTE: Tick is outside the defined tempo map
 	{
 		// NOTE: Take the last calculated time
 		const Time lastTime = GetLastCalculatedTime();
@@ -23,18 +22,17 @@ Time TempoMapAccelerationStructure::ConvertBeatToTimeUsingLookupTableIndexing(Be
 		const Time lastTickDuration = Time::FromSec((60.0 / LastTempoBPM) / Beat::TicksPerBeat);
 
 		// NOTE: Then scale by the remaining ticks
-		const i32 remainingTicks = (totalBeatTicks - beatTickToTimesCount) + 1;
+		const i32 remainingTicks = (totalBeatTicks - TickCount) + 1;
 		return lastTime + (lastTickDuration * remainingTicks);
 	}
-	else // NOTE: Use the pre calculated lookup table directly
+	else // NOTE: Find the segment containing the tick and calculate its time from there
 	{
-		return BeatTickToTimes.at(totalBeatTicks);
+		return GetTickTimeWithinSegment(FindSegmentIndexForTick(totalBeatTicks), totalBeatTicks);
 	}
 }
 
-Beat TempoMapAccelerationStructure::ConvertTimeToBeatUsingLookupTableBinarySearch(Time time) const
+Beat TempoMapAccelerationStructure::ConvertTimeToBeatUsingSegmentBinarySearch(Time time) const
 {
-	const i32 beatTickToTimesCount = static_cast<i32>(BeatTickToTimes.size());
 	const Time lastTime = GetLastCalculatedTime();
 
 	if (time < Time::FromSec(0.0)) // NOTE: Negative time
@@ -56,73 +54,119 @@ Beat TempoMapAccelerationStructure::ConvertTimeToBeatUsingLookupTableBinarySearc
 		const f64 ticks = (timePastLast / lastTickDuration);
 
 		// NOTE: And add it to the last tick
-		return Beat(static_cast<i32>(beatTickToTimesCount + ticks - 1));
+		return Beat(static_cast<i32>(TickCount + ticks - 1));
 	}
-	else // NOTE: Perform a binary search
+	else // NOTE: Perform a binary search for the segment, then estimate the tick within it
 	{
-		i32 left = 0, right = beatTickToTimesCount - 1;
-
-		while (left <= right)
+		const size_t segmentIndex = FindSegmentIndexForTime(time);
+		const Segment& segment = Segments[segmentIndex];
+		const i32 segmentEndTick = GetSegmentEndTick(segmentIndex);
+
+		// NOTE: The estimate may be off by a tick due to rounding, so step to the last tick at or before the target time.
+		//		 Every tick of the next segment is guaranteed to be later than the target time
+		const f64 estimatedTicks = Clamp((time.ToSec() - segment.StartTimeSec) / segment.TickDurationSec, 0.0, static_cast<f64>(segmentEndTick - segment.StartTick - 1));
+		i32 right = segment.StartTick + static_cast<i32>(estimatedTicks);
+		while (right > segment.StartTick && GetTickTimeWithinSegment(segmentIndex, right) > time)
+			right--;
+		while ((right + 1) < segmentEndTick && GetTickTimeWithinSegment(segmentIndex, right + 1) <= time)
+			right++;
+
+		const Time rightTime = GetTickTimeWithinSegment(segmentIndex, right);
+		if (rightTime == time)
 		{
-			const i32 mid = (left + right) / 2;
-
-			if (time < BeatTickToTimes[mid])
-				right = mid - 1;
-			else if (time > BeatTickToTimes[mid])
-				left = mid + 1;
-			else
-				return Beat::FromTicks(mid);
+			// NOTE: Only possible with absurdly high tempos for which multiple consecutive ticks round to the same time,
+			//		 in which case replicate the exact steps of a per-tick binary search to still end up on the same tick
+			if (right > 0 && GetTickTimeWithinSegment(FindSegmentIndexForTick(right - 1), right - 1) == time)
+			{
+				i32 searchLeft = 0, searchRight = TickCount - 1;
+				while (searchLeft <= searchRight)
+				{
+					const i32 mid = (searchLeft + searchRight) / 2;
+					const Time midTime = GetTickTimeWithinSegment(FindSegmentIndexForTick(mid), mid);
+
+					if (time < midTime)
+						searchRight = mid - 1;
+					else if (time > midTime)
+						searchLeft = mid + 1;
+					else
+						return Beat::FromTicks(mid);
+				}
+			}
+			return Beat::FromTicks(right);
 		}
 
-		return Beat::FromTicks((BeatTickToTimes[left] - time) < (time - BeatTickToTimes[right]) ? left : right);
+		const i32 left = (right + 1);
+		const Time leftTime = (left < segmentEndTick) ? GetTickTimeWithinSegment(segmentIndex, left) : GetTickTimeWithinSegment(segmentIndex + 1, left);
+		return Beat::FromTicks((leftTime - time) < (time - rightTime) ? left : right);
 	}
 }
 
 Time TempoMapAccelerationStructure::GetLastCalculatedTime() const
 {
-	return BeatTickToTimes.empty() ? Time::Zero() : BeatTickToTimes.back();
+	return LastCalculatedTime;
 }
 
 void TempoMapAccelerationStructure::Rebuild(const TempoChange* inTempoChanges, size_t inTempoCount)
 {
-	const TempoChange* tempoChanges = inTempoChanges;
-	size_t tempoCount = inTempoCount;
-
-	// HACK: Handle this special case here by creating an adjusted copy instead of changing the algorithm itself to not risk accidentally messing anything up
-	if (inTempoCount < 1 || inTempoChanges[0].Beat > Beat::Zero())
-	{
-		TempoBuffer.resize(inTempoCount + 1);
-		TempoBuffer[0] = TempoChange(Beat::Zero(), FallbackTempo);
-		memcpy(TempoBuffer.data() + 1, inTempoChanges, sizeof(TempoChange) * inTempoCount);
-
-		tempoChanges = TempoBuffer.data();
-		tempoCount = TempoBuffer.size();
-	}
+	// NOTE: Implicitly start with the fallback tempo unless there is a change at the very first beat
+	const TempoChange fallbackTempoChange = TempoChange(Beat::Zero(), FallbackTempo);
+	const b8 prependFallbackTempo = (inTempoCount < 1 || inTempoChanges[0].BeatTime > Beat::Zero());
+	const size_t tempoCount = prependFallbackTempo ? (inTempoCount + 1) : inTempoCount;
+	auto getTempoChange = [&](size_t index) -> const TempoChange& { return !prependFallbackTempo ? inTempoChanges[index] : (index == 0) ? fallbackTempoChange : inTempoChanges[index - 1]; };
 
-	BeatTickToTimes.resize((tempoCount > 0) ? tempoChanges[tempoCount - 1].Beat.Ticks + 1 : 0);
+	Segments.clear();
+	TickCount = (tempoCount > 0) ? getTempoChange(tempoCount - 1).BeatTime.Ticks + 1 : 0;
 
-	f64 lastEndTime = 0.0;
+	f64 lastEndTime = 0.0, lastTickTime = 0.0;
 	for (size_t tempoChangeIndex = 0; tempoChangeIndex < tempoCount; tempoChangeIndex++)
 	{
-		const TempoChange& tempoChange = tempoChanges[tempoChangeIndex];
+		const TempoChange& tempoChange = getTempoChange(tempoChangeIndex);
 
-		const f64 bpm = SafetyCheckTempo(tempoChange.Tempo).BPM;
+		const f64 bpm = SafetyCheckTempo(tempoChange.TempoValue).BPM;
 		const f64 beatDuration = (60.0 / bpm);
 		const f64 tickDuration = (beatDuration / Beat::TicksPerBeat);
 
 		const b8 isSingleOrLastTempo = (tempoCount == 1) || (tempoChangeIndex == (tempoCount - 1));
-		const size_t timesCount = isSingleOrLastTempo ? BeatTickToTimes.size() : (tempoChanges[tempoChangeIndex + 1].Beat.Ticks);
+		const i32 endTick = isSingleOrLastTempo ? TickCount : getTempoChange(tempoChangeIndex + 1).BeatTime.Ticks;
 
-		for (size_t i = 0, t = tempoChange.Beat.Ticks; t < timesCount; t++)
-			BeatTickToTimes[t] = Time::FromSec((tickDuration * i++) + lastEndTime);
+		// NOTE: Multiple changes on the same beat don't span any ticks themselves but their tempo still determines the start time of the next segment
+		if (tempoChange.BeatTime.Ticks < endTick)
+		{
+			Segments.push_back(Segment { tempoChange.BeatTime.Ticks, lastEndTime, tickDuration });
+			lastTickTime = GetTickTimeWithinSegment(Segments.size() - 1, endTick - 1).ToSec();
+		}
 
 		if (tempoCount > 1)
-			lastEndTime = BeatTickToTimes[timesCount - 1].ToSec() + tickDuration;
+			lastEndTime = lastTickTime + tickDuration;
 
 		FirstTempoBPM = (tempoChangeIndex == 0) ? bpm : FirstTempoBPM;
 		LastTempoBPM = bpm;
 	}
 
-	if (!TempoBuffer.empty())
-		TempoBuffer.clear();
+	LastCalculatedTime = Segments.empty() ? Time::Zero() : GetTickTimeWithinSegment(Segments.size() - 1, TickCount - 1);
+}
+
+size_t TempoMapAccelerationStructure::FindSegmentIndexForTick(i32 tick) const
+{
+	assert(!Segments.empty() && tick >= Segments.front().StartTick);
+	const auto it = std::upper_bound(Segments.begin(), Segments.end(), tick, [](i32 tick, const Segment& segment) { return tick < segment.StartTick; });
+	return static_cast<size_t>(it - Segments.begin()) - 1;
+}
+
+size_t TempoMapAccelerationStructure::FindSegmentIndexForTime(Time time) const
+{
+	assert(!Segments.empty() && time.ToSec() >= Segments.front().StartTimeSec);
+	const auto it = std::upper_bound(Segments.begin(), Segments.end(), time.ToSec(), [](f64 timeSec, const Segment& segment) { return timeSec < segment.StartTimeSec; });
+	return static_cast<size_t>(it - Segments.begin()) - 1;
+}
+
+i32 TempoMapAccelerationStructure::GetSegmentEndTick(size_t segmentIndex) const
+{
+	return ((segmentIndex + 1) < Segments.size()) ? Segments[segmentIndex + 1].StartTick : TickCount;
+}
+
+Time TempoMapAccelerationStructure::GetTickTimeWithinSegment(size_t segmentIndex, i32 tick) const
+{
+	const Segment& segment = Segments[segmentIndex];
+	return Time::FromSec((segment.TickDurationSec * static_cast<f64>(tick - segment.StartTick)) + segment.StartTimeSec);
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "core_types.h"
 #include <vector>
+#include <algorithm>
 
 struct Beat
 {
@@ -18,7 +19,7 @@ struct Beat
 	static constexpr Beat FromTicks(i32 ticks) { return Beat(ticks); }
 	static constexpr Beat FromBeats(i32 beats) { return Beat(TicksPerBeat * beats); }
 	static constexpr Beat FromBars(i32 bars, i32 beatsPerBar = 4) { return FromBeats(bars * beatsPerBar); }
-	static constexpr Beat FromBeatsFraction(f64 fraction) { return FromTicks(static_cast<i32>(Round(fraction * static_cast<f64>(TicksPerBeat)))); }
+	static inline Beat FromBeatsFraction(f64 fraction) { return FromTicks(static_cast<i32>(Round(fraction * static_cast<f64>(TicksPerBeat)))); }
 
 	constexpr b8 operator==(const Beat& other) const { return Ticks == other.Ticks; }
 	constexpr b8 operator!=(const Beat& other) const { return Ticks != other.Ticks; }
@@ -84,26 +85,26 @@ constexpr b8 IsTimeSignatureSupported(TimeSignature v) { return (v.Numerator > 0
 struct TempoChange
 {
 	constexpr TempoChange() = default;
-	constexpr TempoChange(Beat beat, Tempo tempo) : Beat(beat), Tempo(tempo) {}
+	constexpr TempoChange(Beat beat, Tempo tempo) : BeatTime(beat), TempoValue(tempo) {}
 
-	Beat Beat = {};
-	Tempo Tempo = {};
+	Beat BeatTime = {};
+	Tempo TempoValue = {};
 	b8 IsSelected = false;
 };
 
 struct TimeSignatureChange
 {
 	constexpr TimeSignatureChange() = default;
-	constexpr TimeSignatureChange(Beat beat, TimeSignature signature) : Beat(beat), Signature(signature) {}
+	constexpr TimeSignatureChange(Beat beat, TimeSignature signature) : BeatTime(beat), Signature(signature) {}
 
-	Beat Beat = {};
+	Beat BeatTime = {};
 	TimeSignature Signature = {};
 	b8 IsSelected = false;
 };
 
 // NOTE: Beat accessor function specifically to be used inside templates without coupling to a specific struct member name
-constexpr Beat GetBeat(const TimeSignatureChange& v) { return v.Beat; }
-constexpr Beat GetBeat(const TempoChange& v) { return v.Beat; }
+constexpr Beat GetBeat(const TimeSignatureChange& v) { return v.BeatTime; }
+constexpr Beat GetBeat(const TempoChange& v) { return v.BeatTime; }
 constexpr Beat GetBeatDuration(const TimeSignatureChange& v) { return Beat::Zero(); }
 constexpr Beat GetBeatDuration(const TempoChange& v) { return Beat::Zero(); }
 
@@ -116,11 +117,65 @@ struct BeatSortedForwardIterator
 	inline T* Next(std::vector<T>& sortedList, Beat nextBeat) { return const_cast<T*>(Next(std::as_const(sortedList), nextBeat)); }
 };
 
+// NOTE: Only items which can span a range of beats (long notes, gogo ranges etc.) need to have their overlapping end beats tracked
+template <typename T, typename = void> constexpr b8 HasBeatDurationRange = false;
+template <typename T> constexpr b8 HasBeatDurationRange<T, std::void_t<decltype(std::declval<const T&>().GetEnd())>> = true;
+
+// NOTE: Only notes can be shifted away from their beat by a TimeOffset, which then also has to be accounted for when culling them by beat
+template <typename T, typename = void> constexpr b8 HasTimeOffset = false;
+template <typename T> constexpr b8 HasTimeOffset<T, std::void_t<decltype(std::declval<const T&>().TimeOffset)>> = true;
+
+template <typename T>
+constexpr Time GetTimeOffsetOrZero(const T& v) { if constexpr (HasTimeOffset<T>) return v.TimeOffset; else return Time::Zero(); }
+
+// NOTE: Half open [First, End) range of list indices
+struct BeatSortedIndexRange { size_t First, End; };
+
+// NOTE: Inclusive range of (start) beats at which items have been edited, empty while (Start > End)
+struct EditedBeatRange
+{
+	Beat Start = Beat(I32Max);
+	Beat End = Beat(I32Min);
+
+	static constexpr EditedBeatRange Everything() { return EditedBeatRange { Beat(I32Min), Beat(I32Max) }; }
+	constexpr b8 IsEmpty() const { return (Start > End); }
+	constexpr void Include(Beat editedStart, Beat editedEnd) { Start = Min(Start, editedStart); End = Max(End, editedEnd); }
+};
+
 template <typename T>
 struct BeatSortedList
 {
 	std::vector<T> Sorted;
 
+	// NOTE: Running maximum of all (Beat + BeatDuration) up to each index, used to limit overlap queries to the items that can possibly reach a beat.
+	//		 Single item edits only patch it forward from the edited index until the values match up again (typically just a few items), while bulk edits
+	//		 have it lazily rebuilt instead. Must be synced after editing the beat, duration or time offset of an item in-place (see SyncCachedBeatRangesAt())
+	mutable std::vector<Beat> CachedRunningMaxEndBeats;
+	mutable b8 CachedRunningMaxEndBeatsDirty = true;
+	// NOTE: Lowest and highest TimeOffset of all items (both always zero for types without one), widened by every added item
+	//		 and only rescanned after an item holding one of the extremes has been removed or edited
+	mutable Time CachedMinTimeOffset = {}, CachedMaxTimeOffset = {};
+	mutable b8 CachedTimeOffsetsDirty = true;
+
+	// NOTE: Beats of all items added, removed or edited since the derived data of the owner (see ChartCourseTimingCache) was last brought up to date,
+	//		 tracked by all member functions. Invalidating the cached beat ranges without specifying any beats marks the entire list as edited
+	EditedBeatRange PendingEditedBeats = {};
+
+	// NOTE: Bitset mirroring the IsSelected member of every item, from which the (sorted) indices of all selected items are then compacted on demand.
+	//		 Changing the selection of a single item only flips its bit (see SyncCachedSelectionAt()), so that counting and iterating the selection never has to look
+	//		 at any of the unselected items. All member functions adding, removing or replacing items have it rebuilt instead, same as for the beat ranges
+	mutable std::vector<u32> CachedSelectionBits;
+	mutable std::vector<size_t> CachedSelectedIndices;
+	mutable size_t CachedSelectionItemCount = 0, CachedSelectedCount = 0;
+	mutable b8 CachedSelectionDirty = true;
+	mutable b8 CachedSelectedIndicesDirty = true;
+
+	void UpdateCachedRunningMaxEndBeatsFrom(size_t index);
+	void UpdateCachedBeatRangesAfterInsertAt(size_t index);
+	void UpdateCachedBeatRangesAfterRemoveAt(size_t index, Time removedTimeOffset);
+	void IncludeCachedTimeOffset(Time timeOffset);
+	void ExcludeCachedTimeOffset(Time timeOffset);
+
 public:
 	T* TryFindLastAtBeat(Beat beat);
 	T* TryFindExactAtBeat(Beat beat);
@@ -135,6 +190,32 @@ struct BeatSortedList
 	void RemoveAtBeat(Beat beatToFindAndRemove);
 	void RemoveAtIndex(size_t indexToRemove);
 
+	// NOTE: Same result as calling InsertOrUpdate() / RemoveAtBeat() for each item in order, but sorts the input once and then
+	//		 merges / compacts the list in a single pass, for O(n + k log k) instead of O(n * k) when pasting or deleting many items at once
+	void InsertOrUpdateMultiple(std::vector<T> valuesToInsertOrUpdate);
+	void RemoveAtBeats(std::vector<Beat> beatsToFindAndRemove);
+	void RemoveMultiple(const std::vector<T>& valuesToRemove);
+
+	// NOTE: Must be called after editing the beat, duration or time offset of a single item in-place (without changing the sort order),
+	//		 or the beat ranges invalidated after editing many of them or after any edit that may have changed the sort order
+	void SyncCachedBeatRangesAt(size_t index, Beat previousBeat, Time previousTimeOffset);
+	inline void InvalidateCachedBeatRanges() { CachedRunningMaxEndBeatsDirty = true; PendingEditedBeats = EditedBeatRange::Everything(); InvalidateCachedSelection(); }
+	inline void InvalidateCachedBeatRanges(Beat editedStart, Beat editedEnd) { CachedRunningMaxEndBeatsDirty = true; PendingEditedBeats.Include(editedStart, editedEnd); }
+	const std::vector<Beat>& GetRunningMaxEndBeats() const;
+	inline Time GetMinTimeOffset() const { UpdateCachedTimeOffsets(); return CachedMinTimeOffset; }
+	inline Time GetMaxTimeOffset() const { UpdateCachedTimeOffsets(); return CachedMaxTimeOffset; }
+	void UpdateCachedTimeOffsets() const;
+
+	// NOTE: Must be called after changing the IsSelected member of an item in-place, or the entire selection invalidated after changing many of them
+	void SyncCachedSelectionAt(size_t index);
+	inline void InvalidateCachedSelection() { CachedSelectionDirty = true; }
+	size_t GetSelectedCount() const;
+	const std::vector<size_t>& GetSelectedIndices() const;
+
+	// NOTE: All items overlapping the inclusive [beatStart, beatEnd] range are inside the returned index range, with long items starting earlier being found through
+	//		 the running max end beats. The range can also contain a few (shorter) items in between that end before the start, so each item still has to be checked individually
+	BeatSortedIndexRange FindIndexRangeOverlappingBeats(Beat beatStart, Beat beatEnd) const;
+
 	inline b8 empty() const { return Sorted.empty(); }
 	inline auto begin() { return Sorted.begin(); }
 	inline auto end() { return Sorted.end(); }
@@ -149,16 +230,32 @@ struct BeatSortedList
 
 struct TempoMapAccelerationStructure
 {
-	// NOTE: Pre calculated beat times up to the last tempo change
-	std::vector<Time> BeatTickToTimes;
-	std::vector<TempoChange> TempoBuffer;
+	// NOTE: One segment per tempo change (up to the last one) within which all ticks are evenly spaced.
+	//		 Tick times are always calculated as (TickDurationSec * ticksSinceSegmentStart + StartTimeSec), with each segment
+	//		 starting one tick after the last tick of the previous one, to produce the exact same values as a pre calculated per-tick table would
+	struct Segment
+	{
+		i32 StartTick;
+		f64 StartTimeSec;
+		f64 TickDurationSec;
+	};
+
+	std::vector<Segment> Segments;
+	i32 TickCount = 0;
+	Time LastCalculatedTime = Time::Zero();
 	f64 FirstTempoBPM = 0.0, LastTempoBPM = 0.0;
 
-	Time ConvertBeatToTimeUsingLookupTableIndexing(Beat beat) const;
-	Beat ConvertTimeToBeatUsingLookupTableBinarySearch(Time time) const;
+	Time ConvertBeatToTimeUsingSegmentBinarySearch(Beat beat) const;
+	Beat ConvertTimeToBeatUsingSegmentBinarySearch(Time time) const;
 
 	Time GetLastCalculatedTime() const;
 	void Rebuild(const TempoChange* inTempoChanges, size_t inTempoCount);
+
+private:
+	size_t FindSegmentIndexForTick(i32 tick) const;
+	size_t FindSegmentIndexForTime(Time time) const;
+	i32 GetSegmentEndTick(size_t segmentIndex) const;
+	Time GetTickTimeWithinSegment(size_t segmentIndex, i32 tick) const;
 };
 
 // NOTE: Used when no other tempo / time signature change is defined (empty list or pre-first beat)
@@ -180,10 +277,10 @@ struct SortedTempoMap
 
 	// NOTE: Must manually be called every time a TempoChange has been edited otherwise Beat <-> Time conversions will be incorrect
 	inline void RebuildAccelerationStructure() { AccelerationStructure.Rebuild(Tempo.data(), Tempo.size()); }
-	inline Time BeatToTime(Beat beat) const { return AccelerationStructure.ConvertBeatToTimeUsingLookupTableIndexing(beat); }
-	inline Beat TimeToBeat(Time time) const { return AccelerationStructure.ConvertTimeToBeatUsingLookupTableBinarySearch(time); }
+	inline Time BeatToTime(Beat beat) const { return AccelerationStructure.ConvertBeatToTimeUsingSegmentBinarySearch(beat); }
+	inline Beat TimeToBeat(Time time) const { return AccelerationStructure.ConvertTimeToBeatUsingSegmentBinarySearch(time); }
 
-	struct ForEachBeatBarData { TimeSignature Signature; Beat Beat; i32 BarIndex; b8 IsBar; };
+	struct ForEachBeatBarData { TimeSignature Signature; Beat BeatTime; i32 BarIndex; b8 IsBar; };
 	template <typename Func>
 	inline void ForEachBeatBar(Func perBeatBarFunc) const
 	{
@@ -215,6 +312,16 @@ struct SortedTempoMap
 	}
 };
 
+// NOTE: Same as FindIndexRangeOverlappingBeats() but for an inclusive time range, first widened by the most extreme TimeOffsets of the list (so that notes shifted
+//		 into it from just outside are still included) and by an extra tick on both ends to make up for the rounding of the time to beat conversion
+template <typename T>
+inline BeatSortedIndexRange FindIndexRangeOverlappingTimes(const SortedTempoMap& tempoMap, const BeatSortedList<T>& sortedList, Time timeStart, Time timeEnd)
+{
+	const Beat beatStart = tempoMap.TimeToBeat(timeStart - sortedList.GetMaxTimeOffset()) - Beat::FromTicks(1);
+	const Beat beatEnd = tempoMap.TimeToBeat(timeEnd - sortedList.GetMinTimeOffset()) + Beat::FromTicks(1);
+	return sortedList.FindIndexRangeOverlappingBeats(beatStart, beatEnd);
+}
+
 template <typename T>
 inline const T* BeatSortedForwardIterator<T>::Next(const std::vector<T>& sortedList, Beat nextBeat)
 {
@@ -243,34 +350,40 @@ T* BeatSortedList<T>::TryFindExactAtBeat(Beat beat)
 	return const_cast<T*>(static_cast<const BeatSortedList<T>*>(this)->TryFindExactAtBeat(beat));
 }
 
+// NOTE: Index of the first item with (GetBeat(item) >= beat), or the list size if there is none
+template <typename T>
+inline size_t BinarySearchForInsertionIndex(const BeatSortedList<T>& sortedList, Beat beat)
+{
+	const auto it = std::lower_bound(sortedList.begin(), sortedList.end(), beat, [](const T& item, Beat beat) { return GetBeat(item) < beat; });
+	return static_cast<size_t>(it - sortedList.begin());
+}
+
+// NOTE: Index of the first item with (GetBeat(item) > beat), or the list size if there is none
+template <typename T>
+inline size_t BinarySearchForUpperBoundIndex(const BeatSortedList<T>& sortedList, Beat beat)
+{
+	const auto it = std::upper_bound(sortedList.begin(), sortedList.end(), beat, [](Beat beat, const T& item) { return beat < GetBeat(item); });
+	return static_cast<size_t>(it - sortedList.begin());
+}
+
+template <typename T>
+inline b8 ValidateIsSortedByBeat(const BeatSortedList<T>& sortedList)
+{
+	return std::is_sorted(sortedList.begin(), sortedList.end(), [](const T& a, const T& b) { return GetBeat(a) < GetBeat(b); });
+}
+
 template <typename T>
 const T* BeatSortedList<T>::TryFindLastAtBeat(Beat beat) const
 {
-	// TODO: Optimize using binary search
-	if (Sorted.size() == 0)
-		return nullptr;
-	if (Sorted.size() == 1)
-		return (GetBeat(Sorted[0]) <= beat) ? &Sorted[0] : nullptr;
-	if (beat < GetBeat(Sorted[0]))
-		return nullptr;
-	for (size_t i = 0; i < Sorted.size() - 1; i++)
-	{
-		if (GetBeat(Sorted[i]) <= beat && GetBeat(Sorted[i + 1]) > beat)
-			return &Sorted[i];
-	}
-	return &Sorted.back();
+	const size_t upperBoundIndex = BinarySearchForUpperBoundIndex(*this, beat);
+	return (upperBoundIndex > 0) ? &Sorted[upperBoundIndex - 1] : nullptr;
 }
 
 template <typename T>
 const T* BeatSortedList<T>::TryFindExactAtBeat(Beat beat) const
 {
-	// TODO: Optimize using binary search
-	for (const T& v : Sorted)
-	{
-		if (GetBeat(v) == beat)
-			return &v;
-	}
-	return nullptr;
+	const size_t insertionIndex = BinarySearchForInsertionIndex(*this, beat);
+	return (insertionIndex < Sorted.size() && GetBeat(Sorted[insertionIndex]) == beat) ? &Sorted[insertionIndex] : nullptr;
 }
 
 template <typename T>
@@ -284,63 +397,233 @@ const T* BeatSortedList<T>::TryFindOverlappingBeat(Beat beatStart, Beat beatEnd,
 {
 	assert(beatEnd >= beatStart && "Don't accidentally mix up BeatEnd with BeatDuration");
 
-	// TODO: Optimize using binary search
-	const T* found = nullptr;
-	if (inclusiveBeatCheck)
+	// NOTE: Only the items starting before (or at) the end can overlap at all. Of those the last overlapping one is returned
+	//		 to correctly handle long notes with other notes "inside" (even if they should't be placable in the first place)
+	const size_t candidateCount = inclusiveBeatCheck ? BinarySearchForUpperBoundIndex(*this, beatEnd) : BinarySearchForInsertionIndex(*this, beatEnd);
+	auto reachesStart = [&](Beat endBeat) { return inclusiveBeatCheck ? (beatStart <= endBeat) : (beatStart < endBeat); };
+
+	if constexpr (HasBeatDurationRange<T>)
 	{
-		for (const T& v : Sorted)
+		// NOTE: Walk backwards until no earlier item can reach the start anymore, which typically is just a single item
+		const std::vector<Beat>& runningMaxEndBeats = GetRunningMaxEndBeats();
+		for (size_t i = candidateCount; i-- > 0;)
 		{
-			// NOTE: Only break after a large beat has been found to correctly handle long notes with other notes "inside"
-			//		 (even if they should't be placable in the first place)
-			if (GetBeat(v) <= beatEnd && beatStart <= (GetBeat(v) + GetBeatDuration(v)))
-				found = &v;
-			else if ((GetBeat(v) + GetBeatDuration(v)) > beatEnd)
+			if (!reachesStart(runningMaxEndBeats[i]))
 				break;
+			if (reachesStart(GetBeat(Sorted[i]) + GetBeatDuration(Sorted[i])))
+				return &Sorted[i];
 		}
+		return nullptr;
 	}
 	else
 	{
-		for (const T& v : Sorted)
+		return (candidateCount > 0 && reachesStart(GetBeat(Sorted[candidateCount - 1]) + GetBeatDuration(Sorted[candidateCount - 1]))) ? &Sorted[candidateCount - 1] : nullptr;
+	}
+}
+
+template <typename T>
+const std::vector<Beat>& BeatSortedList<T>::GetRunningMaxEndBeats() const
+{
+	if (CachedRunningMaxEndBeatsDirty || CachedRunningMaxEndBeats.size() != Sorted.size())
+	{
+		CachedRunningMaxEndBeats.resize(Sorted.size());
+		Beat runningMaxEnd = Beat(I32Min);
+		for (size_t i = 0; i < Sorted.size(); i++)
+			CachedRunningMaxEndBeats[i] = runningMaxEnd = Max(runningMaxEnd, GetBeat(Sorted[i]) + GetBeatDuration(Sorted[i]));
+
+		// NOTE: Whatever invalidated the running max end beats (including items having been added directly) may just as well have changed the time offsets
+		CachedRunningMaxEndBeatsDirty = false;
+		CachedTimeOffsetsDirty = true;
+	}
+	return CachedRunningMaxEndBeats;
+}
+
+template <typename T>
+void BeatSortedList<T>::UpdateCachedTimeOffsets() const
+{
+	GetRunningMaxEndBeats();
+	if (CachedTimeOffsetsDirty)
+	{
+		CachedMinTimeOffset = CachedMaxTimeOffset = Time::Zero();
+		if constexpr (HasTimeOffset<T>)
 		{
-			if (GetBeat(v) < beatEnd && beatStart < (GetBeat(v) + GetBeatDuration(v)))
-				found = &v;
-			else if ((GetBeat(v) + GetBeatDuration(v)) > beatEnd)
-				break;
+			for (const T& item : Sorted)
+			{
+				CachedMinTimeOffset = Min(CachedMinTimeOffset, item.TimeOffset);
+				CachedMaxTimeOffset = Max(CachedMaxTimeOffset, item.TimeOffset);
+			}
 		}
+		CachedTimeOffsetsDirty = false;
 	}
-	return found;
 }
 
 template <typename T>
-inline size_t LinearlySearchForInsertionIndex(const BeatSortedList<T>& sortedList, Beat beat)
+void BeatSortedList<T>::UpdateCachedRunningMaxEndBeatsFrom(size_t index)
 {
-	// TODO: Optimize using binary search
-	for (size_t i = 0; i < sortedList.size(); i++)
-		if (beat <= GetBeat(sortedList[i])) return i;
-	return sortedList.size();
+	// NOTE: Once a recomputed value matches the cached one all following values are guaranteed to be unchanged as well
+	Beat runningMaxEnd = (index > 0) ? CachedRunningMaxEndBeats[index - 1] : Beat(I32Min);
+	for (size_t i = index; i < Sorted.size(); i++)
+	{
+		runningMaxEnd = Max(runningMaxEnd, GetBeat(Sorted[i]) + GetBeatDuration(Sorted[i]));
+		if (CachedRunningMaxEndBeats[i] == runningMaxEnd)
+			break;
+		CachedRunningMaxEndBeats[i] = runningMaxEnd;
+	}
 }
 
 template <typename T>
-inline b8 ValidateIsSortedByBeat(const BeatSortedList<T>& sortedList)
+void BeatSortedList<T>::UpdateCachedBeatRangesAfterInsertAt(size_t index)
 {
-	return std::is_sorted(sortedList.begin(), sortedList.end(), [](const T& a, const T& b) { return GetBeat(a) < GetBeat(b); });
+	if (CachedRunningMaxEndBeatsDirty || CachedRunningMaxEndBeats.size() + 1 != Sorted.size())
+	{
+		CachedRunningMaxEndBeatsDirty = true;
+		return;
+	}
+
+	// NOTE: Placeholder never matching any actual end beat, so that the update always continues on to the items after the inserted one
+	CachedRunningMaxEndBeats.insert(CachedRunningMaxEndBeats.begin() + index, Beat(I32Min));
+	UpdateCachedRunningMaxEndBeatsFrom(index);
+	IncludeCachedTimeOffset(GetTimeOffsetOrZero(Sorted[index]));
+}
+
+template <typename T>
+void BeatSortedList<T>::UpdateCachedBeatRangesAfterRemoveAt(size_t index, Time removedTimeOffset)
+{
+	if (CachedRunningMaxEndBeatsDirty || CachedRunningMaxEndBeats.size() != Sorted.size() + 1)
+	{
+		CachedRunningMaxEndBeatsDirty = true;
+		return;
+	}
+
+	CachedRunningMaxEndBeats.erase(CachedRunningMaxEndBeats.begin() + index);
+	UpdateCachedRunningMaxEndBeatsFrom(index);
+	ExcludeCachedTimeOffset(removedTimeOffset);
+}
+
+template <typename T>
+void BeatSortedList<T>::IncludeCachedTimeOffset(Time timeOffset)
+{
+	CachedMinTimeOffset = Min(CachedMinTimeOffset, timeOffset);
+	CachedMaxTimeOffset = Max(CachedMaxTimeOffset, timeOffset);
+}
+
+template <typename T>
+void BeatSortedList<T>::ExcludeCachedTimeOffset(Time timeOffset)
+{
+	// NOTE: Other items may still share the same extreme, though finding out requires a rescan either way
+	if (timeOffset != Time::Zero() && (timeOffset <= CachedMinTimeOffset || timeOffset >= CachedMaxTimeOffset))
+		CachedTimeOffsetsDirty = true;
+}
+
+template <typename T>
+void BeatSortedList<T>::SyncCachedBeatRangesAt(size_t index, Beat previousBeat, Time previousTimeOffset)
+{
+	if (!InBounds(index, Sorted))
+		return;
+
+	PendingEditedBeats.Include(Min(previousBeat, GetBeat(Sorted[index])), Max(previousBeat, GetBeat(Sorted[index])));
+	if (CachedRunningMaxEndBeatsDirty || CachedRunningMaxEndBeats.size() != Sorted.size())
+	{
+		CachedRunningMaxEndBeatsDirty = true;
+		return;
+	}
+
+	UpdateCachedRunningMaxEndBeatsFrom(index);
+	if (const Time timeOffset = GetTimeOffsetOrZero(Sorted[index]); timeOffset != previousTimeOffset)
+	{
+		ExcludeCachedTimeOffset(previousTimeOffset);
+		IncludeCachedTimeOffset(timeOffset);
+	}
+}
+
+template <typename T>
+void BeatSortedList<T>::SyncCachedSelectionAt(size_t index)
+{
+	if (CachedSelectionDirty || CachedSelectionItemCount != Sorted.size() || !InBounds(index, Sorted))
+	{
+		CachedSelectionDirty = true;
+		return;
+	}
+
+	const u32 bit = (1u << (index % 32));
+	u32& word = CachedSelectionBits[index / 32];
+	if (((word & bit) != 0) == Sorted[index].IsSelected)
+		return;
+
+	word ^= bit;
+	CachedSelectedCount = Sorted[index].IsSelected ? (CachedSelectedCount + 1) : (CachedSelectedCount - 1);
+	CachedSelectedIndicesDirty = true;
+}
+
+template <typename T>
+size_t BeatSortedList<T>::GetSelectedCount() const
+{
+	if (CachedSelectionDirty || CachedSelectionItemCount != Sorted.size())
+	{
+		CachedSelectionItemCount = Sorted.size();
+		CachedSelectionBits.assign((Sorted.size() + 31) / 32, 0);
+		CachedSelectedCount = 0;
+		for (size_t i = 0; i < Sorted.size(); i++)
+		{
+			if (Sorted[i].IsSelected)
+			{
+				CachedSelectionBits[i / 32] |= (1u << (i % 32));
+				CachedSelectedCount++;
+			}
+		}
+		CachedSelectionDirty = false;
+		CachedSelectedIndicesDirty = true;
+	}
+	return CachedSelectedCount;
+}
+
+template <typename T>
+const std::vector<size_t>& BeatSortedList<T>::GetSelectedIndices() const
+{
+	GetSelectedCount();
+	if (CachedSelectedIndicesDirty)
+	{
+		// NOTE: Skipping over 32 unselected items at a time, so even after flipping a single bit this only has to look at a fraction of the list
+		CachedSelectedIndices.clear();
+		CachedSelectedIndices.reserve(CachedSelectedCount);
+		for (size_t wordIndex = 0; wordIndex < CachedSelectionBits.size(); wordIndex++)
+		{
+			for (u32 word = CachedSelectionBits[wordIndex]; word != 0; word &= (word - 1))
+				CachedSelectedIndices.push_back((wordIndex * 32) + CountTrailingZeroBits(word));
+		}
+		CachedSelectedIndicesDirty = false;
+	}
+	return CachedSelectedIndices;
+}
+
+template <typename T>
+BeatSortedIndexRange BeatSortedList<T>::FindIndexRangeOverlappingBeats(Beat beatStart, Beat beatEnd) const
+{
+	// NOTE: The running max end beats are never decreasing, so everything before the first one reaching the start can be skipped entirely
+	const size_t endIndex = BinarySearchForUpperBoundIndex(*this, beatEnd);
+	const std::vector<Beat>& runningMaxEndBeats = GetRunningMaxEndBeats();
+	const size_t firstIndex = static_cast<size_t>(std::lower_bound(runningMaxEndBeats.begin(), runningMaxEndBeats.begin() + endIndex, beatStart) - runningMaxEndBeats.begin());
+	return BeatSortedIndexRange { firstIndex, endIndex };
 }
 
 template <typename T>
 void BeatSortedList<T>::InsertOrUpdate(T valueToInsertOrUpdate)
 {
-	const size_t insertionIndex = LinearlySearchForInsertionIndex(*this, GetBeat(valueToInsertOrUpdate));
-	if (InBounds(insertionIndex, Sorted))
+	const Beat beat = GetBeat(valueToInsertOrUpdate);
+	const size_t insertionIndex = BinarySearchForInsertionIndex(*this, beat);
+	if (InBounds(insertionIndex, Sorted) && GetBeat(Sorted[insertionIndex]) == beat)
 	{
-		if (T& existing = Sorted[insertionIndex]; GetBeat(existing) == GetBeat(valueToInsertOrUpdate))
-			existing = valueToInsertOrUpdate;
-		else
-			Sorted.insert(Sorted.begin() + insertionIndex, valueToInsertOrUpdate);
+		const Time previousTimeOffset = GetTimeOffsetOrZero(Sorted[insertionIndex]);
+		Sorted[insertionIndex] = valueToInsertOrUpdate;
+		SyncCachedBeatRangesAt(insertionIndex, beat, previousTimeOffset);
 	}
 	else
 	{
-		Sorted.push_back(valueToInsertOrUpdate);
+		Sorted.insert(Sorted.begin() + insertionIndex, valueToInsertOrUpdate);
+		PendingEditedBeats.Include(beat, beat);
+		UpdateCachedBeatRangesAfterInsertAt(insertionIndex);
 	}
+	InvalidateCachedSelection();
 
 #if PEEPO_DEBUG
 	assert(GetBeat(valueToInsertOrUpdate).Ticks >= 0);
@@ -359,5 +642,99 @@ template <typename T>
 void BeatSortedList<T>::RemoveAtIndex(size_t indexToRemove)
 {
 	if (InBounds(indexToRemove, Sorted))
+	{
+		const Beat removedBeat = GetBeat(Sorted[indexToRemove]);
+		const Time removedTimeOffset = GetTimeOffsetOrZero(Sorted[indexToRemove]);
 		Sorted.erase(Sorted.begin() + indexToRemove);
+		PendingEditedBeats.Include(removedBeat, removedBeat);
+		UpdateCachedBeatRangesAfterRemoveAt(indexToRemove, removedTimeOffset);
+		InvalidateCachedSelection();
+	}
+}
+
+template <typename T>
+void BeatSortedList<T>::InsertOrUpdateMultiple(std::vector<T> valuesToInsertOrUpdate)
+{
+	if (valuesToInsertOrUpdate.empty())
+		return;
+
+	// NOTE: Stable so that out of multiple new values at the same beat the last one wins, just like it would when inserting them one by one
+	std::stable_sort(valuesToInsertOrUpdate.begin(), valuesToInsertOrUpdate.end(), [](const T& a, const T& b) { return GetBeat(a) < GetBeat(b); });
+	const Beat editedStart = GetBeat(valuesToInsertOrUpdate.front()), editedEnd = GetBeat(valuesToInsertOrUpdate.back());
+
+	std::vector<T> merged;
+	merged.reserve(Sorted.size() + valuesToInsertOrUpdate.size());
+
+	size_t existingIndex = 0;
+	for (size_t i = 0; i < valuesToInsertOrUpdate.size(); i++)
+	{
+		const Beat beat = GetBeat(valuesToInsertOrUpdate[i]);
+		if (i + 1 < valuesToInsertOrUpdate.size() && GetBeat(valuesToInsertOrUpdate[i + 1]) == beat)
+			continue;
+
+		while (existingIndex < Sorted.size() && GetBeat(Sorted[existingIndex]) < beat)
+			merged.push_back(std::move(Sorted[existingIndex++]));
+		if (existingIndex < Sorted.size() && GetBeat(Sorted[existingIndex]) == beat)
+			existingIndex++;
+
+		merged.push_back(std::move(valuesToInsertOrUpdate[i]));
+	}
+	while (existingIndex < Sorted.size())
+		merged.push_back(std::move(Sorted[existingIndex++]));
+
+	Sorted = std::move(merged);
+	InvalidateCachedBeatRanges(editedStart, editedEnd);
+	InvalidateCachedSelection();
+
+#if PEEPO_DEBUG
+	assert(Sorted.empty() || GetBeat(Sorted.front()).Ticks >= 0);
+	assert(ValidateIsSortedByBeat(*this));
+#endif
+}
+
+template <typename T>
+void BeatSortedList<T>::RemoveAtBeats(std::vector<Beat> beatsToFindAndRemove)
+{
+	if (beatsToFindAndRemove.empty() || Sorted.empty())
+		return;
+
+	std::sort(beatsToFindAndRemove.begin(), beatsToFindAndRemove.end());
+
+	// NOTE: Everything before the first beat to remove stays in place, after that mark and compact in a single pass.
+	//		 Each beat removes at most one item, again same as calling RemoveAtBeat() once per beat would
+	size_t writeIndex = BinarySearchForInsertionIndex(*this, beatsToFindAndRemove.front());
+	size_t beatIndex = 0;
+	for (size_t readIndex = writeIndex; readIndex < Sorted.size(); readIndex++)
+	{
+		const Beat beat = GetBeat(Sorted[readIndex]);
+		while (beatIndex < beatsToFindAndRemove.size() && beatsToFindAndRemove[beatIndex] < beat)
+			beatIndex++;
+
+		if (beatIndex < beatsToFindAndRemove.size() && beatsToFindAndRemove[beatIndex] == beat)
+		{
+			beatIndex++;
+			continue;
+		}
+
+		if (writeIndex != readIndex)
+			Sorted[writeIndex] = std::move(Sorted[readIndex]);
+		writeIndex++;
+	}
+
+	if (writeIndex < Sorted.size())
+	{
+		Sorted.erase(Sorted.begin() + writeIndex, Sorted.end());
+		InvalidateCachedBeatRanges(beatsToFindAndRemove.front(), beatsToFindAndRemove.back());
+		InvalidateCachedSelection();
+	}
+}
+
+template <typename T>
+void BeatSortedList<T>::RemoveMultiple(const std::vector<T>& valuesToRemove)
+{
+	std::vector<Beat> beatsToRemove;
+	beatsToRemove.reserve(valuesToRemove.size());
+	for (const T& value : valuesToRemove)
+		beatsToRemove.push_back(GetBeat(value));
+	RemoveAtBeats(std::move(beatsToRemove));
 }
@@ -2,11 +2,22 @@
 #include "core_string.h"
 #include <vector>
 #include <algorithm>
+
+#if PEEPO_WIN32
 #include <shlwapi.h>
 #include <shobjidl.h>
 #include <Windows.h>
 #include <wrl.h>
 using Microsoft::WRL::ComPtr;
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 namespace Path
 {
@@ -61,9 +72,12 @@ namespace Path
 	std::string_view GetDirectoryName(std::string_view filePath)
 	{
 		const std::string_view fileName = GetFileName(filePath);
+		if (fileName.size() == filePath.size())
+			return std::string_view(filePath.data(), 0);
 		return fileName.empty() ? filePath : filePath.substr(0, filePath.size() - fileName.size() - 1);
 	}
 
+#if PEEPO_WIN32
 	b8 IsRelative(std::string_view filePath)
 	{
 		return ::PathIsRelativeW(UTF8::WideArg(filePath).c_str());
@@ -73,6 +87,18 @@ namespace Path
 	{
 		return ::PathIsDirectoryW(UTF8::WideArg(filePath).c_str());
 	}
+#else
+	b8 IsRelative(std::string_view filePath)
+	{
+		return filePath.empty() || (filePath[0] != DirectorySeparator && filePath[0] != DirectorySeparatorWin32);
+	}
+
+	b8 IsDirectory(std::string_view filePath)
+	{
+		struct stat fileStatus = {};
+		return (::stat(std::string(filePath).c_str(), &fileStatus) == 0) && S_ISDIR(fileStatus.st_mode);
+	}
+#endif
 
 	std::string TryMakeAbsolute(std::string_view relativePath, std::string_view baseFileOrDirectory)
 	{
@@ -84,6 +110,7 @@ namespace Path
 		return baseDirectory.append("/").append(relativePath);
 	}
 
+#if PEEPO_WIN32
 	std::string TryMakeRelative(std::string_view absolutePath, std::string_view baseFileOrDirectory)
 	{
 		auto basePathU16 = UTF8::WideArg(CopyAndNormalizeWin32(baseFileOrDirectory));
@@ -96,6 +123,32 @@ namespace Path
 
 		return success ? std::string { ASCII::TrimPrefix(UTF8::Narrow(FixedBufferWStringView(outRelative)), Win32CurrentDirectoryPrefix) } : "";
 	}
+#else
+	std::string TryMakeRelative(std::string_view absolutePath, std::string_view baseFileOrDirectory)
+	{
+		const std::string baseDirectory = CopyAndNormalize(IsDirectory(baseFileOrDirectory) ? baseFileOrDirectory : GetDirectoryName(baseFileOrDirectory));
+		const std::string normalizedAbsolutePath = CopyAndNormalize(absolutePath);
+
+		// NOTE: Split both paths into their directory components and skip the common prefix, then walk back up for every remaining base directory
+		std::vector<std::string_view> baseComponents, absoluteComponents;
+		ASCII::ForEachInCharSeparatedList(baseDirectory, DirectorySeparator, [&](std::string_view component) { if (!component.empty() && component != ".") baseComponents.push_back(component); });
+		ASCII::ForEachInCharSeparatedList(normalizedAbsolutePath, DirectorySeparator, [&](std::string_view component) { if (!component.empty() && component != ".") absoluteComponents.push_back(component); });
+
+		if (IsRelative(baseDirectory) != IsRelative(normalizedAbsolutePath))
+			return "";
+
+		size_t commonCount = 0;
+		while (commonCount < baseComponents.size() && commonCount < absoluteComponents.size() && baseComponents[commonCount] == absoluteComponents[commonCount])
+			commonCount++;
+
+		std::string outRelative;
+		for (size_t i = commonCount; i < baseComponents.size(); i++)
+			outRelative += "../";
+		for (size_t i = commonCount; i < absoluteComponents.size(); i++)
+			outRelative.append(absoluteComponents[i]).append((i + 1 < absoluteComponents.size()) ? "/" : "");
+		return outRelative;
+	}
+#endif
 
 	std::string CopyAndNormalize(std::string_view filePath)
 	{
@@ -126,6 +179,7 @@ namespace Path
 
 namespace File
 {
+#if PEEPO_WIN32
 	UniqueFileContent ReadAllBytes(std::string_view filePath)
 	{
 		if (filePath.empty())
@@ -176,6 +230,50 @@ namespace File
 
 		return true;
 	}
+#else
+	UniqueFileContent ReadAllBytes(std::string_view filePath)
+	{
+		if (filePath.empty())
+			return UniqueFileContent {};
+
+		FILE* fileHandle = ::fopen(std::string(filePath).c_str(), "rb");
+		if (fileHandle == nullptr)
+			return UniqueFileContent {};
+
+		defer { ::fclose(fileHandle); };
+
+		struct stat fileStatus = {};
+		if (::fstat(::fileno(fileHandle), &fileStatus) != 0 || S_ISDIR(fileStatus.st_mode))
+			return UniqueFileContent {};
+
+		const size_t fileSize = static_cast<size_t>(fileStatus.st_size);
+		auto fileContent = std::unique_ptr<u8[]>(new u8[fileSize + 1]);
+
+		if (fileContent == nullptr)
+			return UniqueFileContent {};
+
+		if (::fread(fileContent.get(), 1, fileSize, fileHandle) != fileSize)
+			return UniqueFileContent {};
+
+		fileContent[fileSize] = '\0';
+
+		return UniqueFileContent { std::move(fileContent), fileSize };
+	}
+
+	b8 WriteAllBytes(std::string_view filePath, const void* fileContent, size_t fileSize)
+	{
+		if (filePath.empty() || fileContent == nullptr)
+			return false;
+
+		FILE* fileHandle = ::fopen(std::string(filePath).c_str(), "wb");
+		if (fileHandle == nullptr)
+			return false;
+
+		defer { ::fclose(fileHandle); };
+
+		return (::fwrite(fileContent, 1, fileSize, fileHandle) == fileSize);
+	}
+#endif
 
 	b8 WriteAllBytes(std::string_view filePath, const UniqueFileContent& uniqueFileContent)
 	{
@@ -187,6 +285,98 @@ namespace File
 		return WriteAllBytes(filePath, textFileContent.data(), textFileContent.size());
 	}
 
+#if PEEPO_WIN32
+	b8 MemoryMappedFile::Open(std::string_view filePath)
+	{
+		Close();
+		if (filePath.empty())
+			return false;
+
+		const HANDLE fileHandle = ::CreateFileW(UTF8::WideArg(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER largeIntegerFileSize = {};
+		if (::GetFileSizeEx(fileHandle, &largeIntegerFileSize) == 0 || largeIntegerFileSize.QuadPart <= 0)
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		const HANDLE mappingHandle = ::CreateFileMappingW(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mappingHandle == NULL)
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		const void* mappedView = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (mappedView == nullptr)
+		{
+			::CloseHandle(mappingHandle);
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		Content = static_cast<const u8*>(mappedView);
+		Size = static_cast<size_t>(largeIntegerFileSize.QuadPart);
+		PlatformFileHandle = fileHandle;
+		PlatformMappingHandle = mappingHandle;
+		return true;
+	}
+
+	void MemoryMappedFile::Close()
+	{
+		if (Content != nullptr)
+			::UnmapViewOfFile(Content);
+		if (PlatformMappingHandle != nullptr)
+			::CloseHandle(PlatformMappingHandle);
+		if (PlatformFileHandle != nullptr)
+			::CloseHandle(PlatformFileHandle);
+
+		Content = nullptr;
+		Size = 0;
+		PlatformFileHandle = nullptr;
+		PlatformMappingHandle = nullptr;
+	}
+#else
+	b8 MemoryMappedFile::Open(std::string_view filePath)
+	{
+		Close();
+		if (filePath.empty())
+			return false;
+
+		const int fileDescriptor = ::open(std::string(filePath).c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+			return false;
+
+		// NOTE: The mapping keeps its own reference to the file so the descriptor can be closed right away
+		defer { ::close(fileDescriptor); };
+
+		struct stat fileStatus = {};
+		if (::fstat(fileDescriptor, &fileStatus) != 0 || S_ISDIR(fileStatus.st_mode) || fileStatus.st_size <= 0)
+			return false;
+
+		void* mappedView = ::mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mappedView == MAP_FAILED)
+			return false;
+
+		Content = static_cast<const u8*>(mappedView);
+		Size = static_cast<size_t>(fileStatus.st_size);
+		return true;
+	}
+
+	void MemoryMappedFile::Close()
+	{
+		if (Content != nullptr)
+			::munmap(const_cast<u8*>(Content), Size);
+
+		Content = nullptr;
+		Size = 0;
+	}
+#endif
+
+#if PEEPO_WIN32
 	b8 Exists(std::string_view filePath)
 	{
 		const DWORD attributes = ::GetFileAttributesW(UTF8::WideArg(filePath).c_str());
@@ -197,10 +387,31 @@ namespace File
 	{
 		return ::CopyFileW(UTF8::WideArg(source).c_str(), UTF8::WideArg(destination).c_str(), !overwriteExisting);
 	}
+#else
+	b8 Exists(std::string_view filePath)
+	{
+		struct stat fileStatus = {};
+		return (::stat(std::string(filePath).c_str(), &fileStatus) == 0) && !S_ISDIR(fileStatus.st_mode);
+	}
+
+	b8 Copy(std::string_view source, std::string_view destination, b8 overwriteExisting)
+	{
+		if (!overwriteExisting && Exists(destination))
+			return false;
+
+		const UniqueFileContent sourceContent = ReadAllBytes(source);
+		if (sourceContent.Content == nullptr)
+			return false;
+
+		return WriteAllBytes(destination, sourceContent);
+	}
+#endif
+
 }
 
 namespace CommandLine
 {
+#if PEEPO_WIN32
 	CommandLineArrayView GetCommandLineUTF8()
 	{
 		static b8 initialized = false;
@@ -224,10 +435,13 @@ namespace CommandLine
 		initialized = true;
 		return CommandLineArrayView { static_cast<size_t>(argc), argvStringViews.data() };
 	}
+#endif
+
 }
 
 namespace Directory
 {
+#if PEEPO_WIN32
 	b8 Create(std::string_view directoryPath)
 	{
 		if (directoryPath.empty())
@@ -245,6 +459,41 @@ namespace Directory
 		return (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY));
 	}
 
+	void GetFilesRecursive(std::string_view directoryPath, std::vector<std::string>& outFilePaths)
+	{
+		if (directoryPath.empty())
+			return;
+
+		std::string searchPattern { directoryPath };
+		searchPattern += "/*";
+
+		WIN32_FIND_DATAW findData = {};
+		const HANDLE findHandle = ::FindFirstFileW(UTF8::WideArg(searchPattern).c_str(), &findData);
+		if (findHandle == INVALID_HANDLE_VALUE)
+			return;
+
+		defer { ::FindClose(findHandle); };
+
+		std::vector<std::string> subDirectoryPaths;
+		do
+		{
+			const std::string fileName = UTF8::Narrow(FixedBufferWStringView(findData.cFileName));
+			if (fileName == "." || fileName == "..")
+				continue;
+
+			std::string filePath { directoryPath };
+			filePath.append("/").append(fileName);
+
+			if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				subDirectoryPaths.push_back(std::move(filePath));
+			else
+				outFilePaths.push_back(std::move(filePath));
+		}
+		while (::FindNextFileW(findHandle, &findData));
+
+		for (const std::string& subDirectoryPath : subDirectoryPaths)
+			GetFilesRecursive(subDirectoryPath, outFilePaths);
+	}
 
 	std::string GetExecutablePath()
 	{
@@ -254,11 +503,6 @@ namespace Directory
 		return UTF8::Narrow(FixedBufferWStringView(buffer));
 	}
 
-	std::string GetExecutableDirectory()
-	{
-		return std::string { Path::GetDirectoryName(GetExecutablePath()) };
-	}
-
 	std::string GetWorkingDirectory()
 	{
 		// TODO: First ask for size then resize dynamic buffer accordingly
@@ -271,8 +515,98 @@ namespace Directory
 	{
 		::SetCurrentDirectoryW(UTF8::WideArg(directoryPath).c_str());
 	}
+#else
+	b8 Create(std::string_view directoryPath)
+	{
+		if (directoryPath.empty())
+			return false;
+
+		return (::mkdir(std::string(directoryPath).c_str(), 0755) == 0);
+	}
+
+	b8 Exists(std::string_view directoryPath)
+	{
+		if (directoryPath.empty())
+			return false;
+
+		return Path::IsDirectory(directoryPath);
+	}
+
+	void GetFilesRecursive(std::string_view directoryPath, std::vector<std::string>& outFilePaths)
+	{
+		if (directoryPath.empty())
+			return;
+
+		DIR* directoryHandle = ::opendir(std::string(directoryPath).c_str());
+		if (directoryHandle == nullptr)
+			return;
+
+		defer { ::closedir(directoryHandle); };
+
+		std::vector<std::string> subDirectoryPaths;
+		while (const dirent* directoryEntry = ::readdir(directoryHandle))
+		{
+			const std::string_view fileName = directoryEntry->d_name;
+			if (fileName == "." || fileName == "..")
+				continue;
+
+			std::string filePath { directoryPath };
+			filePath.append("/").append(fileName);
+
+			if (Path::IsDirectory(filePath))
+				subDirectoryPaths.push_back(std::move(filePath));
+			else
+				outFilePaths.push_back(std::move(filePath));
+		}
+
+		for (const std::string& subDirectoryPath : subDirectoryPaths)
+			GetFilesRecursive(subDirectoryPath, outFilePaths);
+	}
+
+	std::string GetExecutablePath()
+	{
+		char buffer[PATH_MAX] = "";
+		const ssize_t pathLength = ::readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+		return (pathLength > 0) ? std::string(buffer, static_cast<size_t>(pathLength)) : "";
+	}
+
+	std::string GetWorkingDirectory()
+	{
+		char buffer[PATH_MAX] = "";
+		return (::getcwd(buffer, sizeof(buffer)) != nullptr) ? std::string(buffer) : "";
+	}
+
+	void SetWorkingDirectory(std::string_view directoryPath)
+	{
+		::chdir(std::string(directoryPath).c_str());
+	}
+#endif
+
+	b8 CreateRecursive(std::string_view directoryPath)
+	{
+		if (directoryPath.empty())
+			return false;
+
+		if (Exists(directoryPath))
+			return true;
+
+		const std::string_view parentDirectoryPath = Path::GetDirectoryName(directoryPath);
+		if (!parentDirectoryPath.empty() && parentDirectoryPath.size() < directoryPath.size() && !Exists(parentDirectoryPath))
+		{
+			if (!CreateRecursive(parentDirectoryPath))
+				return false;
+		}
+
+		return Create(directoryPath) || Exists(directoryPath);
+	}
+
+	std::string GetExecutableDirectory()
+	{
+		return std::string { Path::GetDirectoryName(GetExecutablePath()) };
+	}
 }
 
+#if PEEPO_WIN32
 namespace Shell
 {
 	void OpenInExplorer(std::string_view filePath)
@@ -577,3 +911,18 @@ namespace Shell
 	FileDialogResult FileDialog::OpenSave() { return CreateAndShowFileDialog(*this, DialogType::Save, DialogPickType::File); }
 	FileDialogResult FileDialog::OpenSelectFolder() { return CreateAndShowFileDialog(*this, DialogType::Open, DialogPickType::Folder); }
 }
+#else
+namespace Shell
+{
+	MessageBoxResult ShowMessageBox(std::string_view message, std::string_view title, MessageBoxButtons buttons, MessageBoxIcon icon, void* parentWindowHandle)
+	{
+		fprintf(stderr, "%.*s: %.*s\n", FmtStrViewArgs(title), FmtStrViewArgs(message));
+		return MessageBoxResult::None;
+	}
+
+	// NOTE: Native file dialogs are only available on Windows for now
+	FileDialogResult FileDialog::OpenRead() { return FileDialogResult::Error; }
+	FileDialogResult FileDialog::OpenSave() { return FileDialogResult::Error; }
+	FileDialogResult FileDialog::OpenSelectFolder() { return FileDialogResult::Error; }
+}
+#endif
@@ -1,5 +1,6 @@
 #pragma once
 #include "core_types.h"
+#include <string>
 #include <string_view>
 #include <vector>
 #include <memory>
@@ -57,14 +58,37 @@ namespace File
 
 	b8 Exists(std::string_view filePath);
 	b8 Copy(std::string_view source, std::string_view destination, b8 overwriteExisting = false);
+
+	// NOTE: Read-only view of an entire file mapped into memory, pages are only loaded in by the OS once they are actually accessed.
+	//		 The content stays valid until the object is closed or destroyed
+	struct MemoryMappedFile : NonCopyable
+	{
+		const u8* Content = nullptr;
+		size_t Size = 0;
+		void* PlatformFileHandle = nullptr;
+		void* PlatformMappingHandle = nullptr;
+
+		MemoryMappedFile() = default;
+		~MemoryMappedFile() { Close(); }
+
+		b8 Open(std::string_view filePath);
+		void Close();
+
+		inline b8 IsOpen() const { return (Content != nullptr); }
+		inline std::string_view AsString() const { return std::string_view(reinterpret_cast<const char*>(Content), Size); }
+	};
 }
 
 namespace Directory
 {
-	// TODO: CreateNested, Exists, WIN32FINDFILE wrapper, etc.
 	b8 Create(std::string_view directoryPath);
+	// NOTE: Also creates all missing parent directories, returns true if the directory already exists
+	b8 CreateRecursive(std::string_view directoryPath);
 	b8 Exists(std::string_view directoryPath);
 
+	// NOTE: Appends the paths of all files inside the directory and its subdirectories, as "directoryPath/sub/file.ext"
+	void GetFilesRecursive(std::string_view directoryPath, std::vector<std::string>& outFilePaths);
+
 	std::string GetExecutablePath();
 	std::string GetExecutableDirectory();
 	std::string GetWorkingDirectory();
@@ -79,8 +103,11 @@ namespace CommandLine
 		std::string_view* Arguments;
 	};
 
-	// NOTE: Arguments[0] = program path, the returned string_views are also null-terminated
+#if PEEPO_WIN32
+	// NOTE: Arguments[0] = program path, the returned string_views are also null-terminated.
+	//		 Only available on Windows as there is no portable equivalent to GetCommandLineW(), use the argc / argv passed to main() instead
 	CommandLineArrayView GetCommandLineUTF8();
+#endif
 }
 
 namespace Shell
@@ -89,7 +116,10 @@ namespace Shell
 	// b8 IsFileLink(std::string filePath);
 	// std::string ResolveFileLink(std::string_view lnkFilePath);
 
+#if PEEPO_WIN32
+	// NOTE: Only available on Windows for now, same as the native file dialogs
 	void OpenInExplorer(std::string_view filePath);
+#endif
 	// void OpenExplorerProperties(std::string_view filePath);
 	// void OpenWithDefaultProgram(std::string_view filePath);
 
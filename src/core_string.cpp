@@ -1,7 +1,13 @@
 #include "core_string.h"
 #include <charconv>
+
+#if PEEPO_WIN32
 #include <Windows.h>
 
+// NOTE: According to https://docs.microsoft.com/en-us/windows/win32/intl/code-page-identifiers
+//		 932 | shift_jis | ANSI/OEM Japanese; Japanese (Shift-JIS)
+static constexpr UINT CP_SHIFT_JIS = 932;
+
 static std::string Win32NarrowStdStringWithCodePage(std::wstring_view input, UINT win32CodePage)
 {
 	std::string output;
@@ -30,16 +36,144 @@ static std::wstring Win32WidenStdStringWithCodePage(std::string_view input, UINT
 	return utf16Output;
 }
 
+static std::string NarrowUTF8(std::wstring_view utf16Input) { return Win32NarrowStdStringWithCodePage(utf16Input, CP_UTF8); }
+static std::wstring WidenUTF8(std::string_view utf8Input) { return Win32WidenStdStringWithCodePage(utf8Input, CP_UTF8); }
+static std::string NarrowShiftJIS(std::wstring_view utf16Input) { return Win32NarrowStdStringWithCodePage(utf16Input, CP_SHIFT_JIS); }
+static std::wstring WidenShiftJIS(std::string_view shiftJISInput) { return Win32WidenStdStringWithCodePage(shiftJISInput, CP_SHIFT_JIS); }
+#else
+#include <iconv.h>
+#include <errno.h>
+
+// NOTE: Outside of Windows wchar_t is 32-bit so all "UTF-16" wide strings are really UTF-32 here
+static_assert(sizeof(wchar_t) == sizeof(u32));
+
+static std::string StdNarrowUTF32ToUTF8(std::wstring_view utf32Input)
+{
+	std::string utf8Output;
+	utf8Output.reserve(utf32Input.size());
+
+	for (const wchar_t wideChar : utf32Input)
+	{
+		u32 codePoint = static_cast<u32>(wideChar);
+		if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			codePoint = 0xFFFD;
+
+		if (codePoint < 0x80)
+		{
+			utf8Output += static_cast<char>(codePoint);
+		}
+		else if (codePoint < 0x800)
+		{
+			utf8Output += static_cast<char>(0xC0 | (codePoint >> 6));
+			utf8Output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			utf8Output += static_cast<char>(0xE0 | (codePoint >> 12));
+			utf8Output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			utf8Output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			utf8Output += static_cast<char>(0xF0 | (codePoint >> 18));
+			utf8Output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			utf8Output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			utf8Output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	return utf8Output;
+}
+
+static std::wstring StdWidenUTF8ToUTF32(std::string_view utf8Input)
+{
+	std::wstring utf32Output;
+	utf32Output.reserve(utf8Input.size());
+
+	// NOTE: Invalid sequences are replaced by U+FFFD one byte at a time, same as MultiByteToWideChar() does without MB_ERR_INVALID_CHARS
+	for (size_t i = 0; i < utf8Input.size();)
+	{
+		const u8 leadByte = static_cast<u8>(utf8Input[i]);
+		const size_t sequenceLength = (leadByte < 0x80) ? 1 : ((leadByte >> 5) == 0x06) ? 2 : ((leadByte >> 4) == 0x0E) ? 3 : ((leadByte >> 3) == 0x1E) ? 4 : 0;
+
+		b8 isValidSequence = (sequenceLength > 0 && (i + sequenceLength) <= utf8Input.size());
+		for (size_t c = 1; isValidSequence && c < sequenceLength; c++)
+			isValidSequence = ((static_cast<u8>(utf8Input[i + c]) & 0xC0) == 0x80);
+
+		if (!isValidSequence)
+		{
+			utf32Output += static_cast<wchar_t>(0xFFFD);
+			i++;
+			continue;
+		}
+
+		u32 codePoint = (sequenceLength == 1) ? leadByte : (sequenceLength == 2) ? (leadByte & 0x1F) : (sequenceLength == 3) ? (leadByte & 0x0F) : (leadByte & 0x07);
+		for (size_t c = 1; c < sequenceLength; c++)
+			codePoint = (codePoint << 6) | (static_cast<u8>(utf8Input[i + c]) & 0x3F);
+
+		utf32Output += static_cast<wchar_t>(codePoint);
+		i += sequenceLength;
+	}
+
+	return utf32Output;
+}
+
+// NOTE: Using the "CP932" superset (as used by Windows) rather than strict "SHIFT_JIS" to match the Win32 code page 932 conversion
+static std::string IconvConvertStdString(std::string_view input, cstr toEncoding, cstr fromEncoding)
+{
+	std::string output;
+	const iconv_t converter = ::iconv_open(toEncoding, fromEncoding);
+	if (converter == reinterpret_cast<iconv_t>(-1))
+		return output;
+
+	defer { ::iconv_close(converter); };
+
+	output.resize(input.size() * 2 + 16);
+	char* inputIt = const_cast<char*>(input.data());
+	size_t inputBytesLeft = input.size();
+	char* outputIt = output.data();
+	size_t outputBytesLeft = output.size();
+
+	while (inputBytesLeft > 0)
+	{
+		if (::iconv(converter, &inputIt, &inputBytesLeft, &outputIt, &outputBytesLeft) != static_cast<size_t>(-1))
+			continue;
+
+		if (errno == E2BIG)
+		{
+			const size_t outputBytesWritten = static_cast<size_t>(outputIt - output.data());
+			output.resize(output.size() * 2);
+			outputIt = output.data() + outputBytesWritten;
+			outputBytesLeft = output.size() - outputBytesWritten;
+		}
+		else
+		{
+			// NOTE: Skip over invalid or incomplete input sequences instead of giving up on the entire string
+			inputIt++;
+			inputBytesLeft--;
+		}
+	}
+
+	output.resize(static_cast<size_t>(outputIt - output.data()));
+	return output;
+}
+
+static std::string NarrowUTF8(std::wstring_view utf32Input) { return StdNarrowUTF32ToUTF8(utf32Input); }
+static std::wstring WidenUTF8(std::string_view utf8Input) { return StdWidenUTF8ToUTF32(utf8Input); }
+static std::string NarrowShiftJIS(std::wstring_view utf32Input) { return IconvConvertStdString(StdNarrowUTF32ToUTF8(utf32Input), "CP932", "UTF-8"); }
+static std::wstring WidenShiftJIS(std::string_view shiftJISInput) { return StdWidenUTF8ToUTF32(IconvConvertStdString(shiftJISInput, "UTF-8", "CP932")); }
+#endif
+
 namespace UTF8
 {
 	std::string Narrow(std::wstring_view utf16Input)
 	{
-		return Win32NarrowStdStringWithCodePage(utf16Input, CP_UTF8);
+		return NarrowUTF8(utf16Input);
 	}
 
 	std::wstring Widen(std::string_view utf8Input)
 	{
-		return Win32WidenStdStringWithCodePage(utf8Input, CP_UTF8);
+		return WidenUTF8(utf8Input);
 	}
 
 	std::string FromShiftJIS(std::string_view shiftJISInput)
@@ -48,6 +182,7 @@ namespace UTF8
 		return UTF8::Narrow(ShiftJIS::Widen(shiftJISInput));
 	}
 
+#if PEEPO_WIN32
 	WideArg::WideArg(std::string_view utf8Input)
 	{
 		// NOTE: Length **without** null terminator
@@ -71,6 +206,23 @@ namespace UTF8
 			heapBuffer[convertedLength] = L'\0';
 		}
 	}
+#else
+	WideArg::WideArg(std::string_view utf8Input)
+	{
+		const std::wstring converted = WidenUTF8(utf8Input);
+		convertedLength = static_cast<int>(converted.size());
+
+		wchar_t* buffer = stackBuffer;
+		if (convertedLength >= ArrayCount(stackBuffer))
+		{
+			heapBuffer = std::unique_ptr<wchar_t[]>(new wchar_t[convertedLength + 1]);
+			buffer = heapBuffer.get();
+		}
+
+		::memcpy(buffer, converted.data(), converted.size() * sizeof(wchar_t));
+		buffer[convertedLength] = L'\0';
+	}
+#endif
 
 	const wchar_t* WideArg::c_str() const
 	{
@@ -80,18 +232,14 @@ namespace UTF8
 
 namespace ShiftJIS
 {
-	// NOTE: According to https://docs.microsoft.com/en-us/windows/win32/intl/code-page-identifiers
-	//		 932 | shift_jis | ANSI/OEM Japanese; Japanese (Shift-JIS)
-	static constexpr UINT CP_SHIFT_JIS = 932;
-
 	std::string Narrow(std::wstring_view utf16Input)
 	{
-		return Win32NarrowStdStringWithCodePage(utf16Input, CP_SHIFT_JIS);
+		return NarrowShiftJIS(utf16Input);
 	}
 
 	std::wstring Widen(std::string_view utf8Input)
 	{
-		return Win32WidenStdStringWithCodePage(utf8Input, CP_SHIFT_JIS);
+		return WidenShiftJIS(utf8Input);
 	}
 
 	std::string FromUTF8(std::string_view utf8Input)
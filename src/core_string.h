@@ -1,7 +1,9 @@
 #pragma once
 #include "core_types.h"
+#include <string.h>
 #include <string>
 #include <string_view>
+#include <memory>
 
 // NOTE: Runs the danger of double evaluating the string expression but I'm starting to get really tired of manually typing out the size cast
 #define StrViewFmtString "%.*s"
@@ -0,0 +1,163 @@
+#include "core_thread_pool.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+struct ThreadPool::Impl
+{
+	struct WorkerQueue
+	{
+		std::mutex Mutex;
+		std::deque<ThreadPoolTask> Tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> Queues;
+	std::vector<std::thread> Threads;
+
+	// NOTE: Queued = submitted but not yet started, Pending = submitted but not yet finished
+	std::atomic<i32> QueuedTaskCount = 0;
+	std::atomic<i32> PendingTaskCount = 0;
+	std::atomic<u32> NextSubmitQueueIndex = 0;
+
+	std::mutex SleepMutex;
+	std::condition_variable WorkAvailableCondition;
+	std::condition_variable AllTasksFinishedCondition;
+	b8 StopRequested = false;
+
+	// NOTE: Pass a negative index for threads not owning a queue (the thread calling WaitForAll()), in which case every queue is stolen from
+	b8 TryPopOrSteal(i32 ownQueueIndex, ThreadPoolTask& outTask)
+	{
+		if (ownQueueIndex >= 0)
+		{
+			WorkerQueue& ownQueue = *Queues[ownQueueIndex];
+			std::scoped_lock lock(ownQueue.Mutex);
+			if (!ownQueue.Tasks.empty())
+			{
+				outTask = std::move(ownQueue.Tasks.back());
+				ownQueue.Tasks.pop_back();
+				QueuedTaskCount--;
+				return true;
+			}
+		}
+
+		const i32 queueCount = static_cast<i32>(Queues.size());
+		for (i32 offset = 1; offset <= queueCount; offset++)
+		{
+			const i32 victimIndex = (Max(ownQueueIndex, 0) + offset) % queueCount;
+			if (victimIndex == ownQueueIndex)
+				continue;
+
+			WorkerQueue& victimQueue = *Queues[victimIndex];
+			std::scoped_lock lock(victimQueue.Mutex);
+			if (!victimQueue.Tasks.empty())
+			{
+				outTask = std::move(victimQueue.Tasks.front());
+				victimQueue.Tasks.pop_front();
+				QueuedTaskCount--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void RunTask(ThreadPoolTask& task)
+	{
+		task();
+		task = nullptr;
+
+		if (--PendingTaskCount == 0)
+		{
+			std::scoped_lock lock(SleepMutex);
+			AllTasksFinishedCondition.notify_all();
+		}
+	}
+
+	void WorkerThreadEntryPoint(i32 queueIndex)
+	{
+		ThreadPoolTask task;
+		while (true)
+		{
+			if (TryPopOrSteal(queueIndex, task))
+			{
+				RunTask(task);
+				continue;
+			}
+
+			std::unique_lock lock(SleepMutex);
+			WorkAvailableCondition.wait(lock, [&] { return StopRequested || QueuedTaskCount > 0; });
+			if (StopRequested && QueuedTaskCount <= 0)
+				return;
+		}
+	}
+};
+
+ThreadPool::ThreadPool(i32 threadCount) : impl(std::make_unique<Impl>())
+{
+	if (threadCount <= 0)
+		threadCount = ClampBot(static_cast<i32>(std::thread::hardware_concurrency()), 1);
+
+	impl->Queues.reserve(threadCount);
+	for (i32 i = 0; i < threadCount; i++)
+		impl->Queues.push_back(std::make_unique<Impl::WorkerQueue>());
+
+	// NOTE: All queues must exist before the first thread starts stealing from them
+	impl->Threads.reserve(threadCount);
+	for (i32 i = 0; i < threadCount; i++)
+		impl->Threads.emplace_back([this, i] { impl->WorkerThreadEntryPoint(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	WaitForAll();
+	{
+		std::scoped_lock lock(impl->SleepMutex);
+		impl->StopRequested = true;
+	}
+	impl->WorkAvailableCondition.notify_all();
+
+	for (std::thread& thread : impl->Threads)
+		thread.join();
+}
+
+i32 ThreadPool::GetThreadCount() const
+{
+	return static_cast<i32>(impl->Threads.size());
+}
+
+void ThreadPool::Submit(ThreadPoolTask task)
+{
+	const u32 queueIndex = (impl->NextSubmitQueueIndex++ % static_cast<u32>(impl->Queues.size()));
+	impl->PendingTaskCount++;
+	{
+		Impl::WorkerQueue& queue = *impl->Queues[queueIndex];
+		std::scoped_lock lock(queue.Mutex);
+		queue.Tasks.push_back(std::move(task));
+		impl->QueuedTaskCount++;
+	}
+
+	// NOTE: Lock to avoid a lost wake-up between a worker checking its wait predicate and going to sleep
+	{
+		std::scoped_lock lock(impl->SleepMutex);
+	}
+	impl->WorkAvailableCondition.notify_one();
+}
+
+void ThreadPool::WaitForAll()
+{
+	ThreadPoolTask task;
+	while (impl->PendingTaskCount > 0)
+	{
+		if (impl->TryPopOrSteal(-1, task))
+		{
+			impl->RunTask(task);
+			continue;
+		}
+
+		std::unique_lock lock(impl->SleepMutex);
+		impl->AllTasksFinishedCondition.wait(lock, [&] { return impl->PendingTaskCount <= 0; });
+	}
+}
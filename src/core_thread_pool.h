@@ -0,0 +1,37 @@
+#pragma once
+#include "core_types.h"
+#include <functional>
+#include <memory>
+
+using ThreadPoolTask = std::function<void()>;
+
+// NOTE: Fixed size work-stealing thread pool. Each worker owns a task deque, popping new work from its back (LIFO for cache locality)
+//		 and stealing from the front of the other workers' deques once its own runs empty, so that uneven task durations balance out
+class ThreadPool : NonCopyable
+{
+public:
+	// NOTE: A thread count of zero uses the number of hardware threads
+	explicit ThreadPool(i32 threadCount = 0);
+	~ThreadPool();
+
+public:
+	i32 GetThreadCount() const;
+
+	// NOTE: Tasks are distributed round-robin among the worker deques and may run in any order
+	void Submit(ThreadPoolTask task);
+	// NOTE: Blocks until all submitted tasks have finished, with the calling thread helping out by running queued tasks itself
+	void WaitForAll();
+
+	// NOTE: Run "func(index)" for each index in [0, count) and wait for all of them to finish
+	template <typename Func>
+	void ParallelFor(size_t count, Func func)
+	{
+		for (size_t i = 0; i < count; i++)
+			Submit([&func, i] { func(i); });
+		WaitForAll();
+	}
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl;
+};
@@ -1,6 +1,8 @@
 #include "core_types.h"
 #include <stdio.h>
 #include <time.h>
+#include <math.h>
+#include <string.h>
 
 static_assert(BitsPerByte == 8);
 static_assert((sizeof(u8) * BitsPerByte) == 8 && (sizeof(i8) * BitsPerByte) == 8);
@@ -145,6 +147,7 @@ Date Date::FromString(cstr inBuffer, char separator)
 	return result;
 }
 
+#if PEEPO_WIN32
 #include <Windows.h>
 
 static i64 Win32GetPerformanceCounterTicksPerSecond()
@@ -182,3 +185,30 @@ Time CPUTime::DeltaTime(const CPUTime& startTime, const CPUTime& endTime)
 	const i64 deltaTicks = (endTime.Ticks - startTime.Ticks);
 	return Time::FromSec(static_cast<f64>(deltaTicks) / static_cast<f64>(Win32GlobalPerformanceCounter.TicksPerSecond));
 }
+#else
+#include <chrono>
+
+static i64 StdSteadyClockGetTicksNow()
+{
+	return static_cast<i64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static constexpr i64 StdSteadyClockTicksPerSecond = 1000000000;
+static const i64 StdSteadyClockTicksOnProgramStartup = StdSteadyClockGetTicksNow();
+
+CPUTime CPUTime::GetNow()
+{
+	return CPUTime { StdSteadyClockGetTicksNow() - StdSteadyClockTicksOnProgramStartup };
+}
+
+CPUTime CPUTime::GetNowAbsolute()
+{
+	return CPUTime { StdSteadyClockGetTicksNow() };
+}
+
+Time CPUTime::DeltaTime(const CPUTime& startTime, const CPUTime& endTime)
+{
+	const i64 deltaTicks = (endTime.Ticks - startTime.Ticks);
+	return Time::FromSec(static_cast<f64>(deltaTicks) / static_cast<f64>(StdSteadyClockTicksPerSecond));
+}
+#endif
@@ -1,8 +1,37 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
+#include <climits>
 #include <limits>
 #include <cfloat>
 #include <cmath>
+#include <utility>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(_MSC_VER)
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+
+// NOTE: Only the platform independent parts (everything outside of PEEPO_WIN32 blocks) are expected to be built using other compilers,
+//		 for which these few MSVC specific keywords and "secure" CRT functions then need an equivalent.
+//		 Unlike MSVC the output is silently truncated instead of invoking the invalid parameter handler
+#define __forceinline inline __attribute__((always_inline))
+using errno_t = int;
+
+inline int CompatClampFormattedLength(int result, size_t bufferSize) { return (result < 0 || bufferSize == 0) ? 0 : (static_cast<size_t>(result) < bufferSize) ? result : static_cast<int>(bufferSize - 1); }
+inline int vsprintf_s(char* buffer, size_t bufferSize, const char* format, va_list args) { return CompatClampFormattedLength(::vsnprintf(buffer, bufferSize, format, args), bufferSize); }
+inline int sprintf_s(char* buffer, size_t bufferSize, const char* format, ...) { va_list args; va_start(args, format); const int result = vsprintf_s(buffer, bufferSize, format, args); va_end(args); return result; }
+template <size_t BufferSize> inline int vsprintf_s(char(&buffer)[BufferSize], const char* format, va_list args) { return vsprintf_s(buffer, BufferSize, format, args); }
+template <size_t BufferSize> inline int sprintf_s(char(&buffer)[BufferSize], const char* format, ...) { va_list args; va_start(args, format); const int result = vsprintf_s(buffer, BufferSize, format, args); va_end(args); return result; }
+template <size_t BufferSize> inline int _vsnprintf_s(char(&buffer)[BufferSize], size_t count, const char* format, va_list args) { return vsprintf_s(buffer, (count < BufferSize) ? (count + 1) : BufferSize, format, args); }
+#define sscanf_s sscanf
+inline errno_t localtime_s(tm* outTime, const time_t* inTime) { return (::localtime_r(inTime, outTime) != nullptr) ? 0 : -1; }
+#endif
 
 using i8 = int8_t;
 using u8 = uint8_t;
@@ -337,6 +366,13 @@ inline f64 Mod(f64 value, f64 modulo) { return ::fmod(value, modulo); }
 
 constexpr u32 RoundUpToPowerOfTwo(u32 v) { v--; v |= v >> 1; v |= v >> 2; v |= v >> 4; v |= v >> 8; v |= v >> 16; v++; return v; }
 
+// NOTE: Index of the lowest set bit, undefined for zero
+#if defined(_MSC_VER)
+inline u32 CountTrailingZeroBits(u32 v) { unsigned long index = 0; ::_BitScanForward(&index, v); return static_cast<u32>(index); }
+#else
+inline u32 CountTrailingZeroBits(u32 v) { return static_cast<u32>(__builtin_ctz(v)); }
+#endif
+
 inline f32 Sin(Angle value) { return ::sinf(value.Radians); }
 inline f32 Cos(Angle value) { return ::cosf(value.Radians); }
 
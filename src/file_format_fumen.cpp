@@ -1,3 +1,194 @@
 #include "file_format_fumen.h"
+#include <string.h>
 
-// TODO: ...
+namespace Fumen
+{
+	static constexpr size_t MeasureCountHeaderOffset = 512;
+
+	static inline u32 ByteSwapU32(u32 v) { return ((v >> 24) & 0xFF) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24); }
+	static inline u16 ByteSwapU16(u16 v) { return static_cast<u16>((v >> 8) | (v << 8)); }
+
+	struct ByteReader
+	{
+		const u8* Data;
+		size_t Size;
+		size_t& Offset;
+		b8 SwapBytes;
+
+		inline b8 CanRead(size_t byteSize) const { return (byteSize <= Size) && (Offset <= (Size - byteSize)); }
+		inline u8 U8() { return Data[Offset++]; }
+		inline u16 U16() { u16 v; memcpy(&v, Data + Offset, sizeof(v)); Offset += sizeof(v); return SwapBytes ? ByteSwapU16(v) : v; }
+		inline u32 U32() { u32 v; memcpy(&v, Data + Offset, sizeof(v)); Offset += sizeof(v); return SwapBytes ? ByteSwapU32(v) : v; }
+		inline i32 I32() { return static_cast<i32>(U32()); }
+		inline f32 F32() { const u32 bits = U32(); f32 v; memcpy(&v, &bits, sizeof(v)); return v; }
+	};
+
+	struct ByteWriter
+	{
+		std::vector<u8>& Data;
+		b8 SwapBytes;
+
+		inline void U8(u8 v) { Data.push_back(v); }
+		inline void U16(u16 v) { v = SwapBytes ? ByteSwapU16(v) : v; const size_t offset = Data.size(); Data.resize(offset + sizeof(v)); memcpy(&Data[offset], &v, sizeof(v)); }
+		inline void U32(u32 v) { v = SwapBytes ? ByteSwapU32(v) : v; const size_t offset = Data.size(); Data.resize(offset + sizeof(v)); memcpy(&Data[offset], &v, sizeof(v)); }
+		inline void I32(i32 v) { U32(static_cast<u32>(v)); }
+		inline void F32(f32 v) { u32 bits; memcpy(&bits, &v, sizeof(bits)); U32(bits); }
+	};
+
+	b8 Reader::TryReadHeader()
+	{
+		ReadOffset = 0;
+		MeasuresRead = 0;
+		if (FileContent == nullptr || FileSize < HeaderByteSize)
+			return false;
+
+		// NOTE: There is no magic number or byte order marker, so instead assume whichever interpretation results in the smaller (less absurd) measure count
+		u32 measureCountLittleEndian;
+		memcpy(&measureCountLittleEndian, FileContent + MeasureCountHeaderOffset, sizeof(u32));
+		if constexpr (Endianness::Native != Endianness::Little)
+			measureCountLittleEndian = ByteSwapU32(measureCountLittleEndian);
+		FileEndianness = (measureCountLittleEndian <= ByteSwapU32(measureCountLittleEndian)) ? Endianness::Little : Endianness::Big;
+
+		ByteReader reader { FileContent, FileSize, ReadOffset, (FileEndianness != Endianness::Native) };
+		for (auto& judgeTimings : FileHeader.JudgeTimings)
+			for (f32& judgeTiming : judgeTimings)
+				judgeTiming = reader.F32();
+		FileHeader.HasBranches = reader.I32();
+		for (i32& parameter : FileHeader.GaugeParameters)
+			parameter = reader.I32();
+		FileHeader.MeasureCount = reader.U32();
+		FileHeader.Unknown = reader.I32();
+
+		// NOTE: Every measure takes up at least its header, so this also bounds any allocations made up front based on the measure count
+		assert(ReadOffset == HeaderByteSize);
+		if (FileHeader.MeasureCount > ((FileSize - HeaderByteSize) / MeasureHeaderByteSize))
+			return false;
+
+		return true;
+	}
+
+	b8 Reader::TryReadNextMeasure(Measure& outMeasure)
+	{
+		if (MeasuresRead >= FileHeader.MeasureCount)
+			return false;
+
+		ByteReader reader { FileContent, FileSize, ReadOffset, (FileEndianness != Endianness::Native) };
+		if (!reader.CanRead(MeasureHeaderByteSize))
+			return false;
+
+		outMeasure.BPM = reader.F32();
+		outMeasure.OffsetMS = reader.F32();
+		outMeasure.IsGoGo = (reader.U8() != 0);
+		outMeasure.IsBarLineVisible = (reader.U8() != 0);
+		outMeasure.Unknown0 = reader.U16();
+		for (i32& branchInfo : outMeasure.BranchInfo)
+			branchInfo = reader.I32();
+		outMeasure.Unknown1 = reader.I32();
+
+		for (Measure::BranchData& branch : outMeasure.Branches)
+		{
+			if (!reader.CanRead(BranchHeaderByteSize))
+				return false;
+
+			const u16 noteCount = reader.U16();
+			branch.Unknown = reader.U16();
+			branch.ScrollSpeed = reader.F32();
+
+			branch.Notes.resize(noteCount);
+			for (Note& note : branch.Notes)
+			{
+				if (!reader.CanRead(NoteByteSize))
+					return false;
+
+				note.Type = static_cast<NoteType>(reader.U32());
+				note.PositionMS = reader.F32();
+				note.Item = reader.U32();
+				note.Padding = reader.F32();
+				note.ScoreInitOrBalloonHits = reader.U16();
+				note.ScoreDiffTimesFour = reader.U16();
+				note.DurationMS = reader.F32();
+
+				if (IsDrumrollNote(note.Type))
+				{
+					if (!reader.CanRead(DrumrollDataByteSize))
+						return false;
+					for (u8& byte : note.DrumrollData)
+						byte = reader.U8();
+				}
+				else
+				{
+					memset(note.DrumrollData, 0, sizeof(note.DrumrollData));
+				}
+			}
+		}
+
+		MeasuresRead++;
+		return true;
+	}
+
+	void Writer::BeginFile()
+	{
+		FileContent.clear();
+		FileContent.resize(HeaderByteSize, 0x00);
+		MeasuresWritten = 0;
+	}
+
+	void Writer::WriteMeasure(const Measure& measure)
+	{
+		ByteWriter writer { FileContent, (FileEndianness != Endianness::Native) };
+		writer.F32(measure.BPM);
+		writer.F32(measure.OffsetMS);
+		writer.U8(measure.IsGoGo ? 1 : 0);
+		writer.U8(measure.IsBarLineVisible ? 1 : 0);
+		writer.U16(measure.Unknown0);
+		for (const i32 branchInfo : measure.BranchInfo)
+			writer.I32(branchInfo);
+		writer.I32(measure.Unknown1);
+
+		for (const Measure::BranchData& branch : measure.Branches)
+		{
+			assert(branch.Notes.size() <= U16Max);
+			writer.U16(static_cast<u16>(branch.Notes.size()));
+			writer.U16(branch.Unknown);
+			writer.F32(branch.ScrollSpeed);
+
+			for (const Note& note : branch.Notes)
+			{
+				writer.U32(static_cast<u32>(note.Type));
+				writer.F32(note.PositionMS);
+				writer.U32(note.Item);
+				writer.F32(note.Padding);
+				writer.U16(note.ScoreInitOrBalloonHits);
+				writer.U16(note.ScoreDiffTimesFour);
+				writer.F32(note.DurationMS);
+
+				if (IsDrumrollNote(note.Type))
+				{
+					for (const u8 byte : note.DrumrollData)
+						writer.U8(byte);
+				}
+			}
+		}
+
+		MeasuresWritten++;
+	}
+
+	void Writer::EndFile(const Header& header)
+	{
+		std::vector<u8> headerContent;
+		headerContent.reserve(HeaderByteSize);
+
+		ByteWriter writer { headerContent, (FileEndianness != Endianness::Native) };
+		for (const auto& judgeTimings : header.JudgeTimings)
+			for (const f32 judgeTiming : judgeTimings)
+				writer.F32(judgeTiming);
+		writer.I32(header.HasBranches);
+		for (const i32 parameter : header.GaugeParameters)
+			writer.I32(parameter);
+		writer.U32(MeasuresWritten);
+		writer.I32(header.Unknown);
+
+		assert(headerContent.size() == HeaderByteSize && FileContent.size() >= HeaderByteSize);
+		memcpy(FileContent.data(), headerContent.data(), HeaderByteSize);
+	}
+}
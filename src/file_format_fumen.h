@@ -1,3 +1,122 @@
 #pragma once
+#include "core_types.h"
+#include "core_string.h"
+#include <vector>
 
-// TODO: ...
+// NOTE: Official binary chart format, with one file per difficulty course and no song metadata.
+//		 A file consists of a fixed size header followed by a list of measures, each measure then containing a list of notes for each of the three branches.
+//		 All note positions and durations are stored as milliseconds relative to the start of their measure, with the tempo being constant within a measure.
+//		 Files may be stored in either little or big endian byte order (depending on the target platform), which is detected automatically when reading.
+//		 Unknown / padding fields are kept as they are so that reading and then writing a file again results in the exact same bytes.
+namespace Fumen
+{
+	static constexpr std::string_view Extension = ".bin";
+	static constexpr std::string_view FilterName = "Fumen Binary Chart";
+	static constexpr std::string_view FilterSpec = "*.bin";
+
+	enum class NoteType : u32
+	{
+		None = 0x0,
+		Don = 0x1,
+		Do = 0x2,
+		Ko = 0x3,
+		Ka = 0x4,
+		Kat = 0x5,
+		Drumroll = 0x6,
+		DonBig = 0x7,
+		KaBig = 0x8,
+		DrumrollBig = 0x9,
+		Balloon = 0xA,
+		DonBigHand = 0xB,
+		Kusudama = 0xC,
+		KaBigHand = 0xD,
+		DrumrollAlt = 0x62,
+	};
+
+	// NOTE: Drumrolls are followed by an additional 8 bytes of (unknown) data
+	constexpr b8 IsDrumrollNote(NoteType v) { return (v == NoteType::Drumroll) || (v == NoteType::DrumrollBig) || (v == NoteType::DrumrollAlt); }
+	constexpr b8 IsBalloonNote(NoteType v) { return (v == NoteType::Balloon) || (v == NoteType::Kusudama); }
+
+	enum class Branch : u8 { Normal, Expert, Master, Count };
+
+	constexpr size_t HeaderByteSize = 520;
+	constexpr size_t MeasureHeaderByteSize = 40;
+	constexpr size_t BranchHeaderByteSize = 8;
+	constexpr size_t NoteByteSize = 24;
+	constexpr size_t DrumrollDataByteSize = 8;
+
+	struct Header
+	{
+		// NOTE: Good / ok / bad judgement windows in milliseconds
+		f32 JudgeTimings[36][3];
+		i32 HasBranches;
+		// NOTE: Soul gauge (HP) and branch point parameters, only the first few are known
+		i32 GaugeParameters[19];
+		u32 MeasureCount;
+		i32 Unknown;
+
+		enum GaugeParameterIndex : size_t { Gauge_HPMax, Gauge_HPClear, Gauge_HPGainGood, Gauge_HPGainOk, Gauge_HPLossBad };
+	};
+
+	struct Note
+	{
+		NoteType Type;
+		f32 PositionMS;
+		u32 Item;
+		f32 Padding;
+		// NOTE: Balloon hit count for balloon notes, otherwise the course score init value
+		u16 ScoreInitOrBalloonHits;
+		// NOTE: Four times the course score diff value for regular notes
+		u16 ScoreDiffTimesFour;
+		f32 DurationMS;
+		u8 DrumrollData[DrumrollDataByteSize];
+	};
+
+	struct Measure
+	{
+		f32 BPM;
+		// NOTE: Start time of the measure minus the duration of a 4/4 measure at its tempo
+		f32 OffsetMS;
+		b8 IsGoGo;
+		b8 IsBarLineVisible;
+		u16 Unknown0;
+		i32 BranchInfo[6];
+		i32 Unknown1;
+
+		struct BranchData
+		{
+			u16 Unknown;
+			f32 ScrollSpeed;
+			std::vector<Note> Notes;
+		} Branches[EnumCount<Branch>];
+
+		inline f64 GetStartTimeMS() const { return static_cast<f64>(OffsetMS) + (240000.0 / static_cast<f64>(BPM)); }
+		static inline f32 StartTimeToOffsetMS(f64 startTimeMS, f32 bpm) { return static_cast<f32>(startTimeMS - (240000.0 / static_cast<f64>(bpm))); }
+	};
+
+	// NOTE: Reads the measures one at a time directly from the file content, reusing the note vectors of the output measure between calls
+	struct Reader
+	{
+		const u8* FileContent = nullptr;
+		size_t FileSize = 0;
+		size_t ReadOffset = 0;
+		Endianness FileEndianness = Endianness::Little;
+		Header FileHeader = {};
+		u32 MeasuresRead = 0;
+
+		b8 TryReadHeader();
+		b8 TryReadNextMeasure(Measure& outMeasure);
+	};
+
+	// NOTE: The header is written last so that the measure count doesn't have to be known up front
+	struct Writer
+	{
+		std::vector<u8>& FileContent;
+		Endianness FileEndianness = Endianness::Little;
+		u32 MeasuresWritten = 0;
+
+		void BeginFile();
+		void WriteMeasure(const Measure& measure);
+		void EndFile(const Header& header);
+	};
+}
@@ -1,6 +1,13 @@
 #include "file_format_tja.h"
 #include <algorithm>
 
+#if defined(_M_X64) || defined(__SSE2__)
+#define PEEPO_TJA_SSE2_NEWLINE_SEARCH 1
+#include <emmintrin.h>
+#else
+#define PEEPO_TJA_SSE2_NEWLINE_SEARCH 0
+#endif
+
 namespace TJA
 {
 	// NOTE: Comment marker stored in the format: "// PeepoDrumKit yyyy/MM/dd"
@@ -122,88 +129,167 @@ namespace TJA
 		return outLines;
 	}
 
-	std::vector<Token> TokenizeLines(const std::vector<std::string_view>& lines)
+	// NOTE: Returns the number of tokens written, being either 0, 1 or 2 for a line followed by a trailing comment
+	static i32 TokenizeLine(std::string_view lineFull, i32 lineIndex, b8& inOutCurrentlyBetweenChartStartAndEnd, Token outTokens[2])
 	{
-		std::vector<Token> outTokens;
-		outTokens.reserve(lines.size());
+		i32 outTokenCount = 0;
+		std::string_view lineTrimmed = ASCII::Trim(lineFull);
 
-		b8 currentlyBetweenChartStartAndEnd = false;
-
-		for (size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++)
+		if (lineTrimmed.empty() || ASCII::IsAllWhitespace(lineTrimmed))
 		{
-			const std::string_view lineFull = lines[lineIndex];
-			std::string_view lineTrimmed = ASCII::Trim(lineFull);
+			Token& newToken = (outTokens[outTokenCount++] = Token {});
+			newToken.Type = TokenType::EmptyLine;
+			newToken.LineIndex = lineIndex;
+			newToken.Line = lineTrimmed;
+		}
+		else
+		{
+			const LinePrefixCommentSuffixSplit lineCommentSplit = SplitLineIntoPrefixAndCommentSuffix(lineTrimmed);
+			if (!lineCommentSplit.CommentSuffix.empty())
+				lineTrimmed = ASCII::Trim(lineCommentSplit.LinePrefix);
 
-			if (lineTrimmed.empty() || ASCII::IsAllWhitespace(lineTrimmed))
+			if (!lineTrimmed.empty())
 			{
-				Token& newToken = outTokens.emplace_back();
-				newToken.Type = TokenType::EmptyLine;
-				newToken.LineIndex = static_cast<i16>(lineIndex);
+				Token& newToken = (outTokens[outTokenCount++] = Token {});
+				newToken.Type = TokenType::Unknown;
+				newToken.LineIndex = lineIndex;
 				newToken.Line = lineTrimmed;
-			}
-			else
-			{
-				const LinePrefixCommentSuffixSplit lineCommentSplit = SplitLineIntoPrefixAndCommentSuffix(lineTrimmed);
-				if (!lineCommentSplit.CommentSuffix.empty())
-					lineTrimmed = ASCII::Trim(lineCommentSplit.LinePrefix);
 
-				if (!lineTrimmed.empty())
+				if (lineTrimmed[0] == '#')
 				{
-					Token& newToken = outTokens.emplace_back();
-					newToken.Type = TokenType::Unknown;
-					newToken.LineIndex = static_cast<i16>(lineIndex);
-					newToken.Line = lineTrimmed;
-
-					if (lineTrimmed[0] == '#')
+					newToken.Type = TokenType::HashChartCommand;
+					if (const size_t spaceSeparator = lineTrimmed.find_first_of(' '); spaceSeparator != std::string_view::npos)
 					{
-						newToken.Type = TokenType::HashChartCommand;
-						if (const size_t spaceSeparator = lineTrimmed.find_first_of(' '); spaceSeparator != std::string_view::npos)
-						{
-							newToken.KeyString = lineTrimmed.substr(sizeof('#'), spaceSeparator - sizeof('#'));
-							newToken.ValueString = lineTrimmed.substr(spaceSeparator + sizeof(' '));
-						}
-						else
-						{
-							newToken.KeyString = lineTrimmed.substr(sizeof('#'), lineTrimmed.size() - sizeof('#'));
-							newToken.ValueString = {};
-						}
-
-						for (size_t i = EnumToIndex(Key::HashCommand_First); i <= EnumToIndex(Key::HashCommand_Last); i++)
-							if (newToken.KeyString == KeyStrings[i]) { newToken.Key = static_cast<Key>(i); break; }
-
-						if (newToken.Key == Key::Chart_START)
-							currentlyBetweenChartStartAndEnd = true;
-						else if (newToken.Key == Key::Chart_END)
-							currentlyBetweenChartStartAndEnd = false;
-					}
-					else if (const size_t colonSeparator = lineTrimmed.find_first_of(':'); colonSeparator != std::string_view::npos)
-					{
-						newToken.Type = TokenType::KeyColonValue;
-						newToken.KeyString = lineTrimmed.substr(0, colonSeparator);
-						newToken.ValueString = lineTrimmed.substr(colonSeparator + sizeof(':'));
-
-						for (size_t i = EnumToIndex(Key::KeyColonValue_First); i <= EnumToIndex(Key::KeyColonValue_Last); i++)
-							if (newToken.KeyString == KeyStrings[i]) { newToken.Key = static_cast<Key>(i); break; }
+						newToken.KeyString = lineTrimmed.substr(sizeof('#'), spaceSeparator - sizeof('#'));
+						newToken.ValueString = lineTrimmed.substr(spaceSeparator + sizeof(' '));
 					}
 					else
 					{
-						newToken.Type = currentlyBetweenChartStartAndEnd ? TokenType::ChartData : TokenType::Unknown;
-						newToken.KeyString = {};
-						newToken.ValueString = lineTrimmed;
+						newToken.KeyString = lineTrimmed.substr(sizeof('#'), lineTrimmed.size() - sizeof('#'));
+						newToken.ValueString = {};
 					}
+
+					for (size_t i = EnumToIndex(Key::HashCommand_First); i <= EnumToIndex(Key::HashCommand_Last); i++)
+						if (newToken.KeyString == KeyStrings[i]) { newToken.KeyID = static_cast<Key>(i); break; }
+
+					if (newToken.KeyID == Key::Chart_START)
+						inOutCurrentlyBetweenChartStartAndEnd = true;
+					else if (newToken.KeyID == Key::Chart_END)
+						inOutCurrentlyBetweenChartStartAndEnd = false;
 				}
+				else if (const size_t colonSeparator = lineTrimmed.find_first_of(':'); colonSeparator != std::string_view::npos)
+				{
+					newToken.Type = TokenType::KeyColonValue;
+					newToken.KeyString = lineTrimmed.substr(0, colonSeparator);
+					newToken.ValueString = lineTrimmed.substr(colonSeparator + sizeof(':'));
 
-				if (!lineCommentSplit.CommentSuffix.empty())
+					for (size_t i = EnumToIndex(Key::KeyColonValue_First); i <= EnumToIndex(Key::KeyColonValue_Last); i++)
+						if (newToken.KeyString == KeyStrings[i]) { newToken.KeyID = static_cast<Key>(i); break; }
+				}
+				else
 				{
-					Token& newCommentToken = outTokens.emplace_back();
-					newCommentToken.Type = TokenType::Comment;
-					newCommentToken.LineIndex = static_cast<i16>(lineIndex);
-					newCommentToken.Line = lineTrimmed;
-					newCommentToken.ValueString = ASCII::Trim(lineCommentSplit.CommentSuffix.substr(sizeof('/') * 2));
+					newToken.Type = inOutCurrentlyBetweenChartStartAndEnd ? TokenType::ChartData : TokenType::Unknown;
+					newToken.KeyString = {};
+					newToken.ValueString = lineTrimmed;
 				}
 			}
+
+			if (!lineCommentSplit.CommentSuffix.empty())
+			{
+				Token& newCommentToken = (outTokens[outTokenCount++] = Token {});
+				newCommentToken.Type = TokenType::Comment;
+				newCommentToken.LineIndex = lineIndex;
+				newCommentToken.Line = lineTrimmed;
+				newCommentToken.ValueString = ASCII::Trim(lineCommentSplit.CommentSuffix.substr(sizeof('/') * 2));
+			}
+		}
+
+		return outTokenCount;
+	}
+
+	std::vector<Token> TokenizeLines(const std::vector<std::string_view>& lines)
+	{
+		std::vector<Token> outTokens;
+		outTokens.reserve(lines.size());
+
+		b8 currentlyBetweenChartStartAndEnd = false;
+		Token lineTokens[2];
+
+		for (size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++)
+		{
+			const i32 lineTokenCount = TokenizeLine(lines[lineIndex], static_cast<i32>(lineIndex), currentlyBetweenChartStartAndEnd, lineTokens);
+			for (i32 i = 0; i < lineTokenCount; i++)
+				outTokens.push_back(lineTokens[i]);
+		}
+
+		return outTokens;
+	}
+
+	static inline const char* FindNextNewlineChar(const char* readHead, const char* end)
+	{
+#if PEEPO_TJA_SSE2_NEWLINE_SEARCH
+		// NOTE: Compare 16 bytes at a time, which is where almost all of the time is spent for the long lines of dense charts
+		const __m128i newlineChars = _mm_set1_epi8('\n');
+		while ((end - readHead) >= 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(readHead));
+			const u32 matchMask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlineChars)));
+			if (matchMask != 0)
+				return readHead + CountTrailingZeroBits(matchMask);
+			readHead += 16;
+		}
+#endif
+		while (readHead < end && *readHead != '\n')
+			readHead++;
+		return readHead;
+	}
+
+	b8 TokenStream::TryGetNext(Token& outToken)
+	{
+		while (BufferedTokenReadIndex >= BufferedTokenCount)
+		{
+			if (ReadOffset >= FileContent.size())
+				return false;
+
+			// NOTE: Split lines exactly like ASCII::ForEachLineInMultiLineString() (as used by SplitLines()) so that the resulting tokens are identical,
+			//		 meaning a single trailing newline doesn't start a new line and is instead included in the (later trimmed) last line
+			const char* const begin = FileContent.data();
+			const char* const end = FileContent.data() + FileContent.size();
+			const char* const lineBegin = begin + ReadOffset;
+			const char* const newline = FindNextNewlineChar(lineBegin, end);
+
+			std::string_view line;
+			if (newline >= (end - 1))
+			{
+				line = std::string_view(lineBegin, (end - lineBegin));
+				ReadOffset = FileContent.size();
+			}
+			else
+			{
+				const char* const lineEnd = (newline > begin && newline[-1] == '\r') ? (newline - 1) : newline;
+				line = std::string_view(lineBegin, (lineEnd - lineBegin));
+				ReadOffset = static_cast<size_t>((newline + 1) - begin);
+			}
+
+			BufferedTokenCount = TokenizeLine(line, NextLineIndex++, CurrentlyBetweenChartStartAndEnd, BufferedTokens);
+			BufferedTokenReadIndex = 0;
 		}
 
+		outToken = BufferedTokens[BufferedTokenReadIndex++];
+		return true;
+	}
+
+	std::vector<Token> TokenizeFileContent(std::string_view fileContent)
+	{
+		// NOTE: Rough estimate of the average line length to avoid most reallocations without having to count the lines upfront
+		std::vector<Token> outTokens;
+		outTokens.reserve((fileContent.size() / 16) + 1);
+
+		TokenStream stream { fileContent };
+		Token token;
+		while (stream.TryGetNext(token))
+			outTokens.push_back(token);
+
 		return outTokens;
 	}
 
@@ -381,7 +467,7 @@ namespace TJA
 
 		for (const Token& token : tokens)
 		{
-			const i16 lineIndex = token.LineIndex;
+			const i32 lineIndex = token.LineIndex;
 			switch (token.Type)
 			{
 			case TokenType::Unknown:
@@ -416,11 +502,11 @@ namespace TJA
 
 			case TokenType::KeyColonValue:
 			{
-				if (token.Key >= Key::Main_First && token.Key <= Key::Main_Last)
+				if (token.KeyID >= Key::Main_First && token.KeyID <= Key::Main_Last)
 				{
 					const std::string_view in = ASCII::Trim(token.ValueString);
 					ParsedMainMetadata& out = outTJA.Metadata;
-					switch (token.Key)
+					switch (token.KeyID)
 					{
 					case Key::Main_TITLE: { out.TITLE = in; } break;
 					case Key::Main_TITLEJA: { out.TITLE_JA = in; } break;
@@ -455,14 +541,14 @@ namespace TJA
 					default: { assert(!"Unhandled Key::Main_ switch case despite (Key::Main_First to Key::Main_Last) range check"); } break;
 					}
 				}
-				else if (token.Key >= Key::Course_First && token.Key <= Key::Course_Last)
+				else if (token.KeyID >= Key::Course_First && token.KeyID <= Key::Course_Last)
 				{
 					if (currentCourse == nullptr)
 						currentCourse = &outTJA.Courses.emplace_back();
 
 					const std::string_view in = ASCII::Trim(token.ValueString);
 					ParsedCourseMetadata& out = currentCourse->Metadata;
-					switch (token.Key)
+					switch (token.KeyID)
 					{
 					case Key::Course_COURSE: { if (!tryParseDifficultyType(in, &out.COURSE)) { outErrors.Push(lineIndex, "Invalid difficulty '%.*s'", FmtStrViewArgs(in)); } } break;
 					case Key::Course_LEVEL: { if (!tryParseI32(in, &out.LEVEL)) { outErrors.Push(lineIndex, "Invalid int '%.*s'", FmtStrViewArgs(in)); } } break;
@@ -495,13 +581,13 @@ namespace TJA
 
 			case TokenType::HashChartCommand:
 			{
-				if (token.Key >= Key::Chart_First && token.Key <= Key::Chart_Last)
+				if (token.KeyID >= Key::Chart_First && token.KeyID <= Key::Chart_Last)
 				{
-					if (token.Key != Key::Chart_START && token.Key != Key::Chart_END && !currentlyBetweenChartStartAndEnd)
+					if (token.KeyID != Key::Chart_START && token.KeyID != Key::Chart_END && !currentlyBetweenChartStartAndEnd)
 						outErrors.Push(lineIndex, "Chart commands must be placed between #START and #END");
 
 					const std::string_view in = ASCII::Trim(token.ValueString);
-					switch (token.Key)
+					switch (token.KeyID)
 					{
 					case Key::Chart_START:
 					{
@@ -622,12 +708,12 @@ namespace TJA
 						pushChartCommand(ParsedChartCommandType::BranchEnd);
 					} break;
 					case Key::Chart_SECTION: { pushChartCommand(ParsedChartCommandType::ResetAccuracyValues); } break;
-					case Key::Chart_LYRIC: { pushChartCommand(ParsedChartCommandType::SetLyricLine).Param.SetLyricLine.Value = in; } break;
+					case Key::Chart_LYRIC: { pushChartCommand(ParsedChartCommandType::SetLyricLine).Param.SetLyricLine.Value = currentCourse->PushString(in); } break;
 					case Key::Chart_LEVELHOLD: { pushChartCommand(ParsedChartCommandType::BranchLevelHold); } break;
 					case Key::Chart_BMSCROLL: { pushChartCommand(ParsedChartCommandType::BMScroll); } break;
 					case Key::Chart_HBSCROLL: { pushChartCommand(ParsedChartCommandType::HBScroll); } break;
 					case Key::Chart_SENOTECHANGE: { tryParseI32(in, &pushChartCommand(ParsedChartCommandType::SENoteChange).Param.SENoteChange.Type); } break;
-					case Key::Chart_NEXTSONG: { pushChartCommand(ParsedChartCommandType::SetNextSong).Param.SetNextSong.CommaSeparatedList = in; } break;
+					case Key::Chart_NEXTSONG: { pushChartCommand(ParsedChartCommandType::SetNextSong).Param.SetNextSong.CommaSeparatedList = currentCourse->PushString(in); } break;
 					case Key::Chart_DIRECTION: { tryParseScrollDirection(in, &pushChartCommand(ParsedChartCommandType::ChangeDirection).Param.ChangeDirection.Direction); } break;
 					case Key::Chart_SUDDEN:
 					{
@@ -668,7 +754,7 @@ namespace TJA
 					currentlyInBetweenMeasure = true;
 
 					ParsedChartCommand& newCommand = pushChartCommand(ParsedChartCommandType::MeasureNotes);
-					newCommand.Param.MeasureNotes.Notes.reserve(token.ValueString.size());
+					newCommand.Param.MeasureNotes.Notes = ParsedSpan { static_cast<u32>(currentCourse->NotePool.size()), 0 };
 					for (const char& c : token.ValueString)
 					{
 						if (c == ',')
@@ -695,7 +781,8 @@ namespace TJA
 							//		 The format just doesn't really describe how to handle this...
 							if (!ASCII::IsWhitespace(c))
 							{
-								newCommand.Param.MeasureNotes.Notes.push_back(parsedNoteTypeOrNone);
+								currentCourse->NotePool.push_back(parsedNoteTypeOrNone);
+								newCommand.Param.MeasureNotes.Notes.Count++;
 								currentMeasureNoteCount++;
 							}
 						}
@@ -869,7 +956,7 @@ namespace TJA
 				{
 				case ParsedChartCommandType::MeasureNotes:
 				{
-					for (const NoteType note : command.Param.MeasureNotes.Notes)
+					for (const NoteType note : course.GetNotes(command.Param.MeasureNotes.Notes))
 						out += noteTypeToChar(note);
 
 					if (ArrayItToIndex(&command, &course.ChartCommands[0]) + 1 < course.ChartCommands.size())
@@ -938,7 +1025,7 @@ namespace TJA
 				case ParsedChartCommandType::SetLyricLine:
 				{
 					// TODO: Handle escape characters, most importantly "\n"
-					appendCommandLine(out, Key::Chart_LYRIC, command.Param.SetLyricLine.Value);
+					appendCommandLine(out, Key::Chart_LYRIC, course.GetString(command.Param.SetLyricLine.Value));
 				} break;
 				case ParsedChartCommandType::BMScroll:
 				{
@@ -975,30 +1062,32 @@ namespace TJA
 		}
 	}
 
-	void ConvertConvertedMeasuresToParsedCommands(const std::vector<ConvertedMeasure>& inMeasures, const std::vector<ConvertedGoGoRange>& inGoGo, std::vector<ParsedChartCommand>& outCommands)
+	void ConvertConvertedMeasuresToParsedCommands(const std::vector<ConvertedMeasure>& inMeasures, const std::vector<ConvertedGoGoRange>& inGoGo, ParsedCourse& outCourse)
 	{
-		struct TempCommand { Beat TimeWithinMeasure; ParsedChartCommand ParsedCommand; };
+		// NOTE: Single notes and lyric strings are only moved into the course pools once all commands of a measure have been sorted
+		struct TempCommand { Beat TimeWithinMeasure; ParsedChartCommand ParsedCommand; NoteType Note; std::string_view Lyric; };
 		std::vector<TempCommand> tempBuffer;
 		tempBuffer.reserve(64);
 
+		std::vector<ParsedChartCommand>& outCommands = outCourse.ChartCommands;
 		outCommands.reserve(inMeasures.size() * 4);
 
 		TimeSignature lastSignature = DefaultTimeSignature;
 		for (const ConvertedMeasure& inMeasure : inMeasures)
 		{
-			if (inMeasure.TimeSignature != lastSignature)
+			if (inMeasure.Signature != lastSignature)
 			{
 				ParsedChartCommand& tempCommand = tempBuffer.emplace_back(TempCommand { Beat::Zero() }).ParsedCommand;
 				tempCommand.Type = ParsedChartCommandType::ChangeTimeSignature;
-				tempCommand.Param.ChangeTimeSignature.Value = inMeasure.TimeSignature;
-				lastSignature = inMeasure.TimeSignature;
+				tempCommand.Param.ChangeTimeSignature.Value = inMeasure.Signature;
+				lastSignature = inMeasure.Signature;
 			}
 
 			if (!inGoGo.empty())
 			{
 				// HACK: Could yet again be sped up a lot using a binary search
 				const Beat inMeasureStartTime = inMeasure.StartTime;
-				const Beat inMeasureEndTime = inMeasure.StartTime + inMeasure.TimeSignature.GetDurationPerBar();
+				const Beat inMeasureEndTime = inMeasure.StartTime + inMeasure.Signature.GetDurationPerBar();
 				for (const auto& gogo : inGoGo)
 				{
 					if (gogo.StartTime >= inMeasureStartTime && gogo.StartTime < inMeasureEndTime)
@@ -1019,7 +1108,7 @@ namespace TJA
 			{
 				ParsedChartCommand& tempCommand = tempBuffer.emplace_back(TempCommand { tempoChange.TimeWithinMeasure }).ParsedCommand;
 				tempCommand.Type = ParsedChartCommandType::ChangeTempo;
-				tempCommand.Param.ChangeTempo.Value = tempoChange.Tempo;
+				tempCommand.Param.ChangeTempo.Value = tempoChange.TempoValue;
 			}
 
 			for (const ConvertedScrollChange& scrollChange : inMeasure.ScrollChanges)
@@ -1031,9 +1120,9 @@ namespace TJA
 
 			for (const ConvertedLyricChange& lyricChange : inMeasure.LyricChanges)
 			{
-				ParsedChartCommand& tempCommand = tempBuffer.emplace_back(TempCommand { lyricChange.TimeWithinMeasure }).ParsedCommand;
-				tempCommand.Type = ParsedChartCommandType::SetLyricLine;
-				tempCommand.Param.SetLyricLine.Value = lyricChange.Lyric;
+				TempCommand& tempCommand = tempBuffer.emplace_back(TempCommand { lyricChange.TimeWithinMeasure });
+				tempCommand.ParsedCommand.Type = ParsedChartCommandType::SetLyricLine;
+				tempCommand.Lyric = lyricChange.Lyric;
 			}
 
 			for (const ConvertedDelayChange& delayChange : inMeasure.DelayChanges)
@@ -1045,9 +1134,9 @@ namespace TJA
 
 			for (const ConvertedNote& note : inMeasure.Notes)
 			{
-				ParsedChartCommand& tempCommand = tempBuffer.emplace_back(TempCommand { note.TimeWithinMeasure }).ParsedCommand;
-				tempCommand.Type = ParsedChartCommandType::MeasureNotes;
-				tempCommand.Param.MeasureNotes.Notes.push_back(note.Type);
+				TempCommand& tempCommand = tempBuffer.emplace_back(TempCommand { note.TimeWithinMeasure });
+				tempCommand.ParsedCommand.Type = ParsedChartCommandType::MeasureNotes;
+				tempCommand.Note = note.Type;
 			}
 
 			if (!tempBuffer.empty())
@@ -1086,9 +1175,9 @@ namespace TJA
 
 						if (!noteAlreadyExists)
 						{
-							ParsedChartCommand& tempCommand = tempBuffer.emplace_back(TempCommand { noteBeat }).ParsedCommand;
-							tempCommand.Type = ParsedChartCommandType::MeasureNotes;
-							tempCommand.Param.MeasureNotes.Notes.push_back(NoteType::None);
+							TempCommand& tempCommand = tempBuffer.emplace_back(TempCommand { noteBeat });
+							tempCommand.ParsedCommand.Type = ParsedChartCommandType::MeasureNotes;
+							tempCommand.Note = NoteType::None;
 						}
 					}
 
@@ -1107,25 +1196,26 @@ namespace TJA
 				std::stable_sort(tempBuffer.begin(), tempBuffer.end(), [](const TempCommand& a, const TempCommand& b) { return (a.TimeWithinMeasure < b.TimeWithinMeasure); });
 
 				// NOTE: Merge adjacent single-note MeasureNotes commands
+				for (const TempCommand& tempCommand : tempBuffer)
 				{
-					for (size_t i = 0; i < tempBuffer.size(); i++)
+					if (tempCommand.ParsedCommand.Type == ParsedChartCommandType::MeasureNotes)
 					{
-						TempCommand* lastCommand = (i >= 1) ? &tempBuffer[i - 1] : nullptr;
-						TempCommand& thisCommand = tempBuffer[i];
-
-						if (lastCommand != nullptr && (thisCommand.ParsedCommand.Type == ParsedChartCommandType::MeasureNotes) && (lastCommand->ParsedCommand.Type == ParsedChartCommandType::MeasureNotes))
-						{
-							for (NoteType note : thisCommand.ParsedCommand.Param.MeasureNotes.Notes)
-								lastCommand->ParsedCommand.Param.MeasureNotes.Notes.push_back(note);
+						const b8 mergeWithLastCommand = (!outCommands.empty() && outCommands.back().Type == ParsedChartCommandType::MeasureNotes);
+						if (!mergeWithLastCommand)
+							outCommands.emplace_back(ParsedChartCommand { ParsedChartCommandType::MeasureNotes }).Param.MeasureNotes.Notes = ParsedSpan { static_cast<u32>(outCourse.NotePool.size()), 0 };
 
-							tempBuffer.erase(tempBuffer.begin() + i); i--;
-							continue;
-						}
+						outCourse.NotePool.push_back(tempCommand.Note);
+						outCommands.back().Param.MeasureNotes.Notes.Count++;
+					}
+					else if (tempCommand.ParsedCommand.Type == ParsedChartCommandType::SetLyricLine)
+					{
+						outCommands.emplace_back(tempCommand.ParsedCommand).Param.SetLyricLine.Value = outCourse.PushString(tempCommand.Lyric);
+					}
+					else
+					{
+						outCommands.push_back(tempCommand.ParsedCommand);
 					}
 				}
-
-				for (size_t i = 0; i < tempBuffer.size(); i++)
-					outCommands.push_back(std::move(tempBuffer[i].ParsedCommand));
 				tempBuffer.clear();
 			}
 
@@ -1147,23 +1237,23 @@ namespace TJA
 		// NOTE: Add measures with time signatures and notes (including "empty" ones as needed for time calculations)
 		{
 			ConvertedMeasure* currentMeasure = &out.Measures.emplace_back();
-			currentMeasure->TimeSignature = DefaultTimeSignature;
+			currentMeasure->Signature = DefaultTimeSignature;
 
 			for (const ParsedChartCommand& command : inCourse.ChartCommands)
 			{
 				if (command.Type == ParsedChartCommandType::MeasureNotes)
 				{
-					for (const NoteType note : command.Param.MeasureNotes.Notes)
+					for (const NoteType note : inCourse.GetNotes(command.Param.MeasureNotes.Notes))
 						currentMeasure->Notes.push_back(ConvertedNote { Beat::Zero(), note });
 				}
 				else if (command.Type == ParsedChartCommandType::MeasureEnd)
 				{
 					currentMeasure = &out.Measures.emplace_back();
-					currentMeasure->TimeSignature = out.Measures[out.Measures.size() - 2].TimeSignature;
+					currentMeasure->Signature = out.Measures[out.Measures.size() - 2].Signature;
 				}
 				else if (command.Type == ParsedChartCommandType::ChangeTimeSignature)
 				{
-					currentMeasure->TimeSignature = command.Param.ChangeTimeSignature.Value;
+					currentMeasure->Signature = command.Param.ChangeTimeSignature.Value;
 				}
 			}
 
@@ -1171,13 +1261,13 @@ namespace TJA
 			for (ConvertedMeasure& measure : out.Measures)
 			{
 				measure.StartTime = currentMeasureTime;
-				currentMeasureTime += measure.TimeSignature.GetDurationPerBar();
+				currentMeasureTime += measure.Signature.GetDurationPerBar();
 
 				Beat currentTimeWithinMeasure = Beat::Zero();
 				for (ConvertedNote& note : measure.Notes)
 				{
 					note.TimeWithinMeasure = currentTimeWithinMeasure;
-					currentTimeWithinMeasure += (measure.TimeSignature.GetDurationPerBar() / static_cast<i32>(measure.Notes.size()));
+					currentTimeWithinMeasure += (measure.Signature.GetDurationPerBar() / static_cast<i32>(measure.Notes.size()));
 				}
 			}
 		}
@@ -1192,7 +1282,7 @@ namespace TJA
 			{
 				if (command.Type == ParsedChartCommandType::MeasureNotes)
 				{
-					currentNotesInMeasure += static_cast<i32>(command.Param.MeasureNotes.Notes.size());
+					currentNotesInMeasure += static_cast<i32>(command.Param.MeasureNotes.Notes.Count);
 
 					if (!currentMeasure->Notes.empty() && currentNotesInMeasure > 0)
 						currentTimeWithinMeasure = currentMeasure->Notes[currentNotesInMeasure - 1].TimeWithinMeasure +
@@ -1233,7 +1323,7 @@ namespace TJA
 				}
 				else if (command.Type == ParsedChartCommandType::SetLyricLine)
 				{
-					currentMeasure->LyricChanges.push_back(ConvertedLyricChange { currentTimeWithinMeasure, command.Param.SetLyricLine.Value });
+					currentMeasure->LyricChanges.push_back(ConvertedLyricChange { currentTimeWithinMeasure, std::string(inCourse.GetString(command.Param.SetLyricLine.Value)) });
 				}
 			}
 
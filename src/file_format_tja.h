@@ -5,6 +5,7 @@
 #include "core_beat.h"
 #include <vector>
 #include <cstdarg>
+#include <type_traits>
 
 // NOTE: "Token" -> smallest atomic piece of data.
 //		 A list of tokens basically losslessly represents a TJA file and exists to make parsing easier.
@@ -144,8 +145,8 @@ namespace TJA
 	struct Token
 	{
 		TokenType Type;
-		Key Key;
-		i16 LineIndex;
+		Key KeyID;
+		i32 LineIndex;
 		std::string_view Line;
 		std::string_view KeyString;
 		std::string_view ValueString;
@@ -364,32 +365,66 @@ namespace TJA
 		Count
 	};
 
+	// NOTE: Index + count into one of the pools owned by the ParsedCourse a command belongs to
+	struct ParsedSpan
+	{
+		u32 Index;
+		u32 Count;
+	};
+
+	struct ParsedNoteTypeView
+	{
+		const NoteType* Data;
+		size_t Count;
+
+		inline const NoteType* begin() const { return Data; }
+		inline const NoteType* end() const { return Data + Count; }
+		inline size_t size() const { return Count; }
+		inline b8 empty() const { return (Count == 0); }
+	};
+
+	// NOTE: Variable length parameters (measure notes and strings) are stored as spans into the owning ParsedCourse's pools
+	//		 so that every command is a small trivially copyable struct and parsing doesn't need a heap allocation per command
 	struct ParsedChartCommand
 	{
-		// TODO: Maybe store notes as index + count into single vector (?)
 		ParsedChartCommandType Type;
-		struct ParamData
+		union ParamData
 		{
-			struct { std::vector<NoteType> Notes; } MeasureNotes;
+			struct { ParsedSpan Notes; } MeasureNotes;
 			struct { TimeSignature Value; } ChangeTimeSignature;
 			struct { Tempo Value; } ChangeTempo;
 			struct { Time Value; } ChangeDelay;
 			struct { f32 Value; } ChangeScrollSpeed;
 			struct { b8 Visible; } ChangeBarLine;
 			struct { BranchCondition Condition; i32 RequirementExpert; i32 RequirementMaster; } BranchStart;
-			struct { std::string Value; } SetLyricLine;
+			struct { ParsedSpan Value; } SetLyricLine;
 			struct { i32 Type; } SENoteChange;
-			struct { std::string CommaSeparatedList; } SetNextSong;
+			struct { ParsedSpan CommaSeparatedList; } SetNextSong;
 			struct { ScrollDirection Direction; } ChangeDirection;
 			struct { Time AppearanceOffset, MovementWaitDelay; } SetSudden;
 			struct { Time Duration; f32 MovementDistance; ScrollDirection Direction; } SetScrollTransition;
+
+			// NOTE: Zero initialize all of the above by default, same as if each member was value initialized
+			u64 ZeroInitializedStorage[2];
+			constexpr ParamData() : ZeroInitializedStorage {} {}
 		} Param;
 	};
 
+	static_assert(sizeof(ParsedChartCommand::ParamData) == sizeof(ParsedChartCommand::ParamData::ZeroInitializedStorage));
+	static_assert(std::is_trivially_copyable_v<ParsedChartCommand>);
+
 	struct ParsedCourse
 	{
 		ParsedCourseMetadata Metadata;
 		std::vector<ParsedChartCommand> ChartCommands;
+
+		// NOTE: Storage referenced by the ParsedSpans of the chart commands
+		std::vector<NoteType> NotePool;
+		std::string StringPool;
+
+		inline ParsedNoteTypeView GetNotes(ParsedSpan span) const { return ParsedNoteTypeView { NotePool.data() + span.Index, span.Count }; }
+		inline std::string_view GetString(ParsedSpan span) const { return std::string_view(StringPool).substr(span.Index, span.Count); }
+		inline ParsedSpan PushString(std::string_view value) { const ParsedSpan span { static_cast<u32>(StringPool.size()), static_cast<u32>(value.size()) }; StringPool += value; return span; }
 	};
 
 	struct ParsedTJA
@@ -408,6 +443,28 @@ namespace TJA
 	// NOTE: Designed to never fail, invalid input data just means a different arrangements of (unknown / bad) tokens
 	std::vector<Token> TokenizeLines(const std::vector<std::string_view>& lines);
 
+	// NOTE: Single pass alternative to SplitLines() + TokenizeLines() reading tokens on demand straight from the file content,
+	//		 without building an intermediate vector of lines or allocating anything per line. Outputs the exact same tokens as TokenizeLines()
+	struct TokenStream
+	{
+		std::string_view FileContent;
+		size_t ReadOffset = 0;
+		i32 NextLineIndex = 0;
+		b8 CurrentlyBetweenChartStartAndEnd = false;
+
+		// NOTE: A single line can result in up to two tokens (the line itself followed by its trailing comment)
+		Token BufferedTokens[2] = {};
+		i32 BufferedTokenCount = 0;
+		i32 BufferedTokenReadIndex = 0;
+
+		TokenStream() = default;
+		explicit TokenStream(std::string_view fileContent) : FileContent(fileContent) {}
+
+		b8 TryGetNext(Token& outToken);
+	};
+
+	std::vector<Token> TokenizeFileContent(std::string_view fileContent);
+
 	struct ErrorList
 	{
 		// TODO: Have error enum type instead + std::string_view of the offending data (?)
@@ -440,7 +497,7 @@ namespace TJA
 	struct ConvertedTempoChange
 	{
 		Beat TimeWithinMeasure;
-		Tempo Tempo;
+		Tempo TempoValue;
 	};
 
 	struct ConvertedDelayChange
@@ -470,7 +527,7 @@ namespace TJA
 	struct ConvertedMeasure
 	{
 		Beat StartTime;
-		TimeSignature TimeSignature;
+		TimeSignature Signature;
 		std::vector<ConvertedNote> Notes;
 		std::vector<ConvertedTempoChange> TempoChanges;
 		std::vector<ConvertedDelayChange> DelayChanges;
@@ -499,7 +556,7 @@ namespace TJA
 		std::vector<ConvertedGoGoRange> GoGoRanges;
 	};
 
-	void ConvertConvertedMeasuresToParsedCommands(const std::vector<TJA::ConvertedMeasure>& inMeasures, const std::vector<ConvertedGoGoRange>& inGoGo, std::vector<TJA::ParsedChartCommand>& outCommands);
+	void ConvertConvertedMeasuresToParsedCommands(const std::vector<TJA::ConvertedMeasure>& inMeasures, const std::vector<ConvertedGoGoRange>& inGoGo, ParsedCourse& outCourse);
 
 	ConvertedCourse ConvertParsedToConvertedCourse(const ParsedTJA& inContent, const ParsedCourse& inCourse);
 }
@@ -1,5 +1,7 @@
 #include "chart.h"
 #include "core_build_info.h"
+#include "core_thread_pool.h"
+#include "file_format_fumen.h"
 #include <algorithm>
 
 namespace PeepoDrumKit
@@ -47,12 +49,12 @@ namespace PeepoDrumKit
 						case GenericMember::B8_BarLineVisible: { memberName = "IsVisible"; isSame = (valueA.B8 == valueB.B8); } break;
 						case GenericMember::I16_BalloonPopCount: { memberName = "BalloonPopCount"; isSame = (valueA.I16 == valueB.I16); } break;
 						case GenericMember::F32_ScrollSpeed: { memberName = "ScrollSpeed"; isSame = ApproxmiatelySame(valueA.F32, valueB.F32); } break;
-						case GenericMember::Beat_Start: { memberName = "BeatStart"; isSame = (valueA.Beat == valueB.Beat); } break;
-						case GenericMember::Beat_Duration: { memberName = "BeatDuration"; isSame = (valueA.Beat == valueB.Beat); } break;
-						case GenericMember::Time_Offset: { memberName = "TimeOffset"; isSame = ApproxmiatelySame(valueA.Time.Seconds, valueB.Time.Seconds); } break;
-						case GenericMember::NoteType_V: { memberName = "NoteType"; isSame = (valueA.NoteType == valueB.NoteType); } break;
-						case GenericMember::Tempo_V: { memberName = "Tempo"; isSame = ApproxmiatelySame(valueA.Tempo.BPM, valueB.Tempo.BPM); } break;
-						case GenericMember::TimeSignature_V: { memberName = "TimeSignature"; isSame = (valueA.TimeSignature == valueB.TimeSignature); } break;
+						case GenericMember::Beat_Start: { memberName = "BeatStart"; isSame = (valueA.BeatV == valueB.BeatV); } break;
+						case GenericMember::Beat_Duration: { memberName = "BeatDuration"; isSame = (valueA.BeatV == valueB.BeatV); } break;
+						case GenericMember::Time_Offset: { memberName = "TimeOffset"; isSame = ApproxmiatelySame(valueA.TimeV.Seconds, valueB.TimeV.Seconds); } break;
+						case GenericMember::NoteType_V: { memberName = "NoteType"; isSame = (valueA.NoteTypeV == valueB.NoteTypeV); } break;
+						case GenericMember::Tempo_V: { memberName = "Tempo"; isSame = ApproxmiatelySame(valueA.TempoV.BPM, valueB.TempoV.BPM); } break;
+						case GenericMember::TimeSignature_V: { memberName = "TimeSignature"; isSame = (valueA.TimeSignatureV == valueB.TimeSignatureV); } break;
 						case GenericMember::CStr_Lyric: { memberName = "Lyric"; isSame = safeCStrAreSame(valueA.CStr, valueB.CStr); } break;
 						}
 
@@ -64,8 +66,9 @@ namespace PeepoDrumKit
 		}
 	}
 
-	struct TempTimedDelayCommand { Beat Beat; Time Delay; };
-	static constexpr Beat GetBeat(const TempTimedDelayCommand& v) { return v.Beat; }
+	struct TempTimedDelayCommand { Beat BeatTime; Time Delay; };
+	static constexpr Beat GetBeat(const TempTimedDelayCommand& v) { return v.BeatTime; }
+	static constexpr Beat GetBeatDuration(const TempTimedDelayCommand& v) { return Beat::Zero(); }
 
 	static constexpr NoteType ConvertTJANoteType(TJA::NoteType tjaNoteType)
 	{
@@ -108,8 +111,8 @@ namespace PeepoDrumKit
 	{
 		// NOTE: Technically only need to look at the last item of each sorted list **but just to be sure**, in case there is something wonky going on with out-of-order durations or something
 		Beat maxBeat = Beat::Zero();
-		for (const auto& v : course.TempoMap.Tempo) maxBeat = Max(maxBeat, v.Beat);
-		for (const auto& v : course.TempoMap.Signature) maxBeat = Max(maxBeat, v.Beat);
+		for (const auto& v : course.TempoMap.Tempo) maxBeat = Max(maxBeat, v.BeatTime);
+		for (const auto& v : course.TempoMap.Signature) maxBeat = Max(maxBeat, v.BeatTime);
 		for (size_t i = 0; i < EnumCount<BranchType>; i++)
 			for (const auto& v : course.GetNotes(static_cast<BranchType>(i))) maxBeat = Max(maxBeat, v.BeatTime + Max(Beat::Zero(), v.BeatDuration));
 		for (const auto& v : course.GoGoRanges) maxBeat = Max(maxBeat, v.BeatTime + Max(Beat::Zero(), v.BeatDuration));
@@ -119,7 +122,251 @@ namespace PeepoDrumKit
 		return maxBeat;
 	}
 
-	b8 CreateChartProjectFromTJA(const TJA::ParsedTJA& inTJA, ChartProject& out)
+	// NOTE: Resizes the part of the vector ending at (oldEnd) to instead end at (newEnd), keeping everything before and after it in place
+	template <typename T>
+	static void ResizeVectorSubRange(std::vector<T>& inOutVector, size_t oldEnd, size_t newEnd)
+	{
+		if (newEnd > oldEnd)
+			inOutVector.insert(inOutVector.begin() + oldEnd, newEnd - oldEnd, T {});
+		else if (newEnd < oldEnd)
+			inOutVector.erase(inOutVector.begin() + newEnd, inOutVector.begin() + oldEnd);
+	}
+
+	// NOTE: Positioned at the last item at or before the beat so that it can be advanced from there on, instead of having to start from the very first item
+	template <typename T>
+	static BeatSortedForwardIterator<T> CreateForwardIteratorAtBeat(const BeatSortedList<T>& sortedList, Beat beat)
+	{
+		const size_t upperBoundIndex = BinarySearchForUpperBoundIndex(sortedList, beat);
+		return BeatSortedForwardIterator<T> { (upperBoundIndex > 0) ? (upperBoundIndex - 1) : 0 };
+	}
+
+	// NOTE: An edited scroll / bar line change only affects the items up until the next (unedited) change after it
+	template <typename T>
+	static Beat GetEditedBeatRangeEffectEnd(const BeatSortedList<T>& sortedList, const EditedBeatRange& edited)
+	{
+		if (edited.End >= Beat(I32Max))
+			return Beat(I32Max);
+		const size_t nextIndex = BinarySearchForUpperBoundIndex(sortedList, edited.End);
+		return (nextIndex < sortedList.size()) ? (GetBeat(sortedList[nextIndex]) - Beat::FromTicks(1)) : Beat(I32Max);
+	}
+
+	void UpdateCourseTimingCache(ChartCourse& course, Beat maxBarBeat)
+	{
+		ChartCourseTimingCache& cache = course.TimingCache;
+		cache.LastUpdateNoteCount = 0;
+		cache.LastUpdateBarCount = 0;
+
+		const b8 rebuildEverything = !cache.HasBeenBuilt;
+		const EditedBeatRange editedTempos = std::exchange(course.TempoMap.Tempo.PendingEditedBeats, {});
+		const EditedBeatRange editedSignatures = std::exchange(course.TempoMap.Signature.PendingEditedBeats, {});
+		const EditedBeatRange editedScrolls = std::exchange(course.ScrollChanges.PendingEditedBeats, {});
+		const EditedBeatRange editedBarLines = std::exchange(course.BarLineChanges.PendingEditedBeats, {});
+		const Beat editedScrollsEffectEnd = GetEditedBeatRangeEffectEnd(course.ScrollChanges, editedScrolls);
+
+		for (size_t branchIndex = 0; branchIndex < EnumCount<BranchType>; branchIndex++)
+		{
+			SortedNotesList& notes = course.GetNotes(static_cast<BranchType>(branchIndex));
+			ChartCourseTimingCache::NoteTimings& timings = cache.Notes[branchIndex];
+			const EditedBeatRange editedNotes = std::exchange(notes.PendingEditedBeats, {});
+
+			// NOTE: Union of the edited notes themselves, the notes whose head scroll speed might have changed and the notes overlapping (or after) the first edited tempo change,
+			//		 as those even include long notes starting before it but having their tail shifted. Everything outside of it is known to still be the same as before.
+			//		 Unlike the others an empty range of edited notes still counts, as that is where any removed notes used to be
+			BeatSortedIndexRange edited = { notes.size() + 1, 0 };
+			auto includeIndexRange = [&](BeatSortedIndexRange range, b8 includeIfEmpty)
+			{
+				if (range.First < range.End || includeIfEmpty)
+				{
+					edited.First = Min(edited.First, range.First);
+					edited.End = Max(edited.End, range.End);
+				}
+			};
+
+			if (!editedNotes.IsEmpty())
+				includeIndexRange(BeatSortedIndexRange { BinarySearchForInsertionIndex(notes, editedNotes.Start), BinarySearchForUpperBoundIndex(notes, editedNotes.End) }, true);
+			if (!editedScrolls.IsEmpty())
+				includeIndexRange(BeatSortedIndexRange { BinarySearchForInsertionIndex(notes, editedScrolls.Start), BinarySearchForUpperBoundIndex(notes, editedScrollsEffectEnd) }, false);
+			if (!editedTempos.IsEmpty())
+				includeIndexRange(notes.FindIndexRangeOverlappingBeats(editedTempos.Start, Beat(I32Max)), false);
+
+			// NOTE: The items after the edited range having stayed the same, the only thing that can have changed is the number of items within it.
+			//		 Should that not add up (such as for an in-place edit without invalidation) there is no other choice but to recalculate everything
+			const size_t oldCount = timings.HeadTimes.size(), newCount = notes.size();
+			if (edited.First > edited.End)
+				edited = { newCount, newCount };
+
+			size_t oldEditedEnd = oldCount - Min(newCount - edited.End, oldCount);
+			if (rebuildEverything || (newCount - edited.End) > oldCount || oldEditedEnd < edited.First)
+			{
+				edited = { 0, newCount };
+				oldEditedEnd = oldCount;
+			}
+
+			ResizeVectorSubRange(timings.HeadTimes, oldEditedEnd, edited.End);
+			ResizeVectorSubRange(timings.TailTimes, oldEditedEnd, edited.End);
+			ResizeVectorSubRange(timings.Tempos, oldEditedEnd, edited.End);
+			ResizeVectorSubRange(timings.ScrollSpeeds, oldEditedEnd, edited.End);
+			if (edited.First >= edited.End)
+				continue;
+
+			BeatSortedForwardIterator<TempoChange> tempoChangeIt = CreateForwardIteratorAtBeat(course.TempoMap.Tempo, notes[edited.First].BeatTime);
+			BeatSortedForwardIterator<ScrollChange> scrollChangeIt = CreateForwardIteratorAtBeat(course.ScrollChanges, notes[edited.First].BeatTime);
+			for (size_t i = edited.First; i < edited.End; i++)
+			{
+				const Note& note = notes[i];
+				timings.HeadTimes[i] = (course.TempoMap.BeatToTime(note.BeatTime) + note.TimeOffset);
+				timings.TailTimes[i] = (note.BeatDuration > Beat::Zero()) ? (course.TempoMap.BeatToTime(note.GetEnd()) + note.TimeOffset) : timings.HeadTimes[i];
+				timings.Tempos[i] = TempoOrDefault(tempoChangeIt.Next(course.TempoMap.Tempo.Sorted, note.BeatTime));
+				timings.ScrollSpeeds[i] = ScrollOrDefault(scrollChangeIt.Next(course.ScrollChanges.Sorted, note.BeatTime));
+			}
+			cache.LastUpdateNoteCount += (edited.End - edited.First);
+		}
+
+		// NOTE: Bars are regenerated from the earliest edit onwards, as any tempo or time signature change shifts all bars after it.
+		//		 A different max bar beat leaves all bars up to the lower of the two as they are
+		Beat barsEditedStart = rebuildEverything ? Beat(I32Min) : Beat(I32Max);
+		for (const EditedBeatRange* edited : { &editedTempos, &editedSignatures, &editedScrolls, &editedBarLines })
+		{
+			if (!edited->IsEmpty())
+				barsEditedStart = Min(barsEditedStart, edited->Start);
+		}
+		if (maxBarBeat != cache.MaxBarBeat)
+			barsEditedStart = Min(barsEditedStart, Min(maxBarBeat, cache.MaxBarBeat) + Beat::FromTicks(1));
+
+		if (barsEditedStart < Beat(I32Max))
+		{
+			ChartCourseTimingCache::BarTimings& bars = cache.Bars;
+			const size_t firstEditedBar = static_cast<size_t>(std::lower_bound(bars.Beats.begin(), bars.Beats.end(), barsEditedStart) - bars.Beats.begin());
+			bars.Beats.resize(firstEditedBar);
+			bars.Times.resize(firstEditedBar);
+			bars.Tempos.resize(firstEditedBar);
+			bars.ScrollSpeeds.resize(firstEditedBar);
+			bars.BarIndices.resize(firstEditedBar);
+
+			BeatSortedForwardIterator<TempoChange> tempoChangeIt = CreateForwardIteratorAtBeat(course.TempoMap.Tempo, barsEditedStart);
+			BeatSortedForwardIterator<ScrollChange> scrollChangeIt = CreateForwardIteratorAtBeat(course.ScrollChanges, barsEditedStart);
+			BeatSortedForwardIterator<BarLineChange> barLineChangeIt = CreateForwardIteratorAtBeat(course.BarLineChanges, barsEditedStart);
+
+			course.TempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
+			{
+				if (it.BeatTime > maxBarBeat)
+					return ControlFlow::Break;
+
+				if (!it.IsBar || it.BeatTime < barsEditedStart)
+					return ControlFlow::Continue;
+
+				if (!VisibleOrDefault(barLineChangeIt.Next(course.BarLineChanges.Sorted, it.BeatTime)))
+					return ControlFlow::Continue;
+
+				bars.Beats.push_back(it.BeatTime);
+				bars.Times.push_back(course.TempoMap.BeatToTime(it.BeatTime));
+				bars.Tempos.push_back(TempoOrDefault(tempoChangeIt.Next(course.TempoMap.Tempo.Sorted, it.BeatTime)));
+				bars.ScrollSpeeds.push_back(ScrollOrDefault(scrollChangeIt.Next(course.ScrollChanges.Sorted, it.BeatTime)));
+				bars.BarIndices.push_back(it.BarIndex);
+				cache.LastUpdateBarCount++;
+				return ControlFlow::Continue;
+			});
+		}
+
+		cache.MaxBarBeat = maxBarBeat;
+		cache.HasBeenBuilt = true;
+	}
+
+	// NOTE: Only reads from the shared TJA and only writes to its own output course, so that multiple courses can safely be converted in parallel
+	struct TJACourseConversionResult { Time Duration; b8 Succeeded; };
+
+	static TJACourseConversionResult ConvertTJACourseToChartCourse(const TJA::ParsedTJA& inTJA, const TJA::ParsedCourse& inParsedCourse, ChartCourse& outCourse)
+	{
+		const TJA::ConvertedCourse& inCourse = TJA::ConvertParsedToConvertedCourse(inTJA, inParsedCourse);
+		// NOTE: A course that has chart commands but still ends up without a single measure could not be converted
+		const b8 succeeded = !(inCourse.Measures.empty() && !inParsedCourse.ChartCommands.empty());
+
+		// HACK: Write proper enum conversion functions
+		outCourse.Type = Clamp(static_cast<DifficultyType>(inCourse.CourseMetadata.COURSE), DifficultyType {}, DifficultyType::Count);
+		outCourse.Level = Clamp(static_cast<DifficultyLevel>(inCourse.CourseMetadata.LEVEL), DifficultyLevel::Min, DifficultyLevel::Max);
+		outCourse.CourseCreator = inCourse.CourseMetadata.NOTESDESIGNER;
+
+		outCourse.TempoMap.Tempo.Sorted = { TempoChange(Beat::Zero(), inTJA.Metadata.BPM) };
+		outCourse.TempoMap.Signature.Sorted = { TimeSignatureChange(Beat::Zero(), TimeSignature(4, 4)) };
+		TimeSignature lastSignature = TimeSignature(4, 4);
+
+		i32 currentBalloonIndex = 0;
+
+		BeatSortedList<TempTimedDelayCommand> tempSortedDelayCommands;
+		BeatSortedForwardIterator<TempTimedDelayCommand> tempDelayCommandsIt;
+		for (const TJA::ConvertedMeasure& inMeasure : inCourse.Measures)
+		{
+			for (const TJA::ConvertedDelayChange& inDelayChange : inMeasure.DelayChanges)
+				tempSortedDelayCommands.InsertOrUpdate(TempTimedDelayCommand { inMeasure.StartTime + inDelayChange.TimeWithinMeasure, inDelayChange.Delay });
+		}
+
+		for (const TJA::ConvertedMeasure& inMeasure : inCourse.Measures)
+		{
+			for (const TJA::ConvertedNote& inNote : inMeasure.Notes)
+			{
+				if (inNote.Type == TJA::NoteType::End_BalloonOrDrumroll)
+				{
+					// TODO: Proper handling
+					if (!outCourse.Notes_Normal.Sorted.empty())
+						outCourse.Notes_Normal.Sorted.back().BeatDuration = (inMeasure.StartTime + inNote.TimeWithinMeasure) - outCourse.Notes_Normal.Sorted.back().BeatTime;
+					continue;
+				}
+
+				const NoteType outNoteType = ConvertTJANoteType(inNote.Type);
+				if (outNoteType == NoteType::Count)
+					continue;
+
+				Note& outNote = outCourse.Notes_Normal.Sorted.emplace_back();
+				outNote.BeatTime = (inMeasure.StartTime + inNote.TimeWithinMeasure);
+				outNote.Type = outNoteType;
+
+				const TempTimedDelayCommand* delayCommandForThisNote = tempDelayCommandsIt.Next(tempSortedDelayCommands.Sorted, outNote.BeatTime);
+				outNote.TimeOffset = (delayCommandForThisNote != nullptr) ? delayCommandForThisNote->Delay : Time::Zero();
+
+				if (inNote.Type == TJA::NoteType::Start_Balloon || inNote.Type == TJA::NoteType::Start_BaloonSpecial)
+				{
+					// TODO: Implement properly with correct branch handling
+					if (InBounds(currentBalloonIndex, inCourse.CourseMetadata.BALLOON))
+						outNote.BalloonPopCount = inCourse.CourseMetadata.BALLOON[currentBalloonIndex];
+					currentBalloonIndex++;
+				}
+			}
+
+			if (inMeasure.Signature != lastSignature)
+			{
+				outCourse.TempoMap.Signature.InsertOrUpdate(TimeSignatureChange(inMeasure.StartTime, inMeasure.Signature));
+				lastSignature = inMeasure.Signature;
+			}
+
+			for (const TJA::ConvertedTempoChange& inTempoChange : inMeasure.TempoChanges)
+				outCourse.TempoMap.Tempo.InsertOrUpdate(TempoChange(inMeasure.StartTime + inTempoChange.TimeWithinMeasure, inTempoChange.TempoValue));
+
+			for (const TJA::ConvertedScrollChange& inScrollChange : inMeasure.ScrollChanges)
+				outCourse.ScrollChanges.Sorted.push_back(ScrollChange { (inMeasure.StartTime + inScrollChange.TimeWithinMeasure), inScrollChange.ScrollSpeed });
+
+			for (const TJA::ConvertedBarLineChange& barLineChange : inMeasure.BarLineChanges)
+				outCourse.BarLineChanges.Sorted.push_back(BarLineChange { (inMeasure.StartTime + barLineChange.TimeWithinMeasure), barLineChange.Visibile });
+
+			for (const TJA::ConvertedLyricChange& lyricChange : inMeasure.LyricChanges)
+				outCourse.Lyrics.Sorted.push_back(LyricChange { (inMeasure.StartTime + lyricChange.TimeWithinMeasure), lyricChange.Lyric });
+		}
+
+		for (const TJA::ConvertedGoGoRange& inGoGoRange : inCourse.GoGoRanges)
+			outCourse.GoGoRanges.Sorted.push_back(GoGoRange { inGoGoRange.StartTime, (inGoGoRange.EndTime - inGoGoRange.StartTime) });
+
+		//outCourse.TempoMap.SetTempoChange(TempoChange());
+		//outCourse.TempoMap = inCourse.GoGoRanges;
+
+		outCourse.ScoreInit = inCourse.CourseMetadata.SCOREINIT;
+		outCourse.ScoreDiff = inCourse.CourseMetadata.SCOREDIFF;
+
+		outCourse.TempoMap.RebuildAccelerationStructure();
+
+		const Time duration = !inCourse.Measures.empty() ? outCourse.TempoMap.BeatToTime(inCourse.Measures.back().StartTime /*+ inCourse.Measures.back().TimeSignature.GetDurationPerBar()*/) : Time::Zero();
+		return TJACourseConversionResult { duration, succeeded };
+	}
+
+	b8 CreateChartProjectFromTJA(const TJA::ParsedTJA& inTJA, ChartProject& out, ThreadPool* threadPool, std::vector<size_t>* outFailedCourseIndices)
 	{
 		out.ChartDuration = Time::Zero();
 		out.ChartTitle[Language::Base] = inTJA.Metadata.TITLE;
@@ -145,94 +392,26 @@ namespace PeepoDrumKit
 		out.BackgroundImageFileName = inTJA.Metadata.BGIMAGE;
 		out.BackgroundMovieFileName = inTJA.Metadata.BGMOVIE;
 		out.MovieOffset = inTJA.Metadata.MOVIEOFFSET;
-		for (size_t i = 0; i < inTJA.Courses.size(); i++)
-		{
-			const TJA::ConvertedCourse& inCourse = TJA::ConvertParsedToConvertedCourse(inTJA, inTJA.Courses[i]);
-			ChartCourse& outCourse = *out.Courses.emplace_back(std::make_unique<ChartCourse>());
-
-			// HACK: Write proper enum conversion functions
-			outCourse.Type = Clamp(static_cast<DifficultyType>(inCourse.CourseMetadata.COURSE), DifficultyType {}, DifficultyType::Count);
-			outCourse.Level = Clamp(static_cast<DifficultyLevel>(inCourse.CourseMetadata.LEVEL), DifficultyLevel::Min, DifficultyLevel::Max);
-			outCourse.CourseCreator = inCourse.CourseMetadata.NOTESDESIGNER;
-
-			outCourse.TempoMap.Tempo.Sorted = { TempoChange(Beat::Zero(), inTJA.Metadata.BPM) };
-			outCourse.TempoMap.Signature.Sorted = { TimeSignatureChange(Beat::Zero(), TimeSignature(4, 4)) };
-			TimeSignature lastSignature = TimeSignature(4, 4);
-
-			i32 currentBalloonIndex = 0;
-
-			BeatSortedList<TempTimedDelayCommand> tempSortedDelayCommands;
-			BeatSortedForwardIterator<TempTimedDelayCommand> tempDelayCommandsIt;
-			for (const TJA::ConvertedMeasure& inMeasure : inCourse.Measures)
-			{
-				for (const TJA::ConvertedDelayChange& inDelayChange : inMeasure.DelayChanges)
-					tempSortedDelayCommands.InsertOrUpdate(TempTimedDelayCommand { inMeasure.StartTime + inDelayChange.TimeWithinMeasure, inDelayChange.Delay });
-			}
-
-			for (const TJA::ConvertedMeasure& inMeasure : inCourse.Measures)
-			{
-				for (const TJA::ConvertedNote& inNote : inMeasure.Notes)
-				{
-					if (inNote.Type == TJA::NoteType::End_BalloonOrDrumroll)
-					{
-						// TODO: Proper handling
-						if (!outCourse.Notes_Normal.Sorted.empty())
-							outCourse.Notes_Normal.Sorted.back().BeatDuration = (inMeasure.StartTime + inNote.TimeWithinMeasure) - outCourse.Notes_Normal.Sorted.back().BeatTime;
-						continue;
-					}
-
-					const NoteType outNoteType = ConvertTJANoteType(inNote.Type);
-					if (outNoteType == NoteType::Count)
-						continue;
-
-					Note& outNote = outCourse.Notes_Normal.Sorted.emplace_back();
-					outNote.BeatTime = (inMeasure.StartTime + inNote.TimeWithinMeasure);
-					outNote.Type = outNoteType;
-
-					const TempTimedDelayCommand* delayCommandForThisNote = tempDelayCommandsIt.Next(tempSortedDelayCommands.Sorted, outNote.BeatTime);
-					outNote.TimeOffset = (delayCommandForThisNote != nullptr) ? delayCommandForThisNote->Delay : Time::Zero();
-
-					if (inNote.Type == TJA::NoteType::Start_Balloon || inNote.Type == TJA::NoteType::Start_BaloonSpecial)
-					{
-						// TODO: Implement properly with correct branch handling
-						if (InBounds(currentBalloonIndex, inCourse.CourseMetadata.BALLOON))
-							outNote.BalloonPopCount = inCourse.CourseMetadata.BALLOON[currentBalloonIndex];
-						currentBalloonIndex++;
-					}
-				}
-
-				if (inMeasure.TimeSignature != lastSignature)
-				{
-					outCourse.TempoMap.Signature.InsertOrUpdate(TimeSignatureChange(inMeasure.StartTime, inMeasure.TimeSignature));
-					lastSignature = inMeasure.TimeSignature;
-				}
-
-				for (const TJA::ConvertedTempoChange& inTempoChange : inMeasure.TempoChanges)
-					outCourse.TempoMap.Tempo.InsertOrUpdate(TempoChange(inMeasure.StartTime + inTempoChange.TimeWithinMeasure, inTempoChange.Tempo));
-
-				for (const TJA::ConvertedScrollChange& inScrollChange : inMeasure.ScrollChanges)
-					outCourse.ScrollChanges.Sorted.push_back(ScrollChange { (inMeasure.StartTime + inScrollChange.TimeWithinMeasure), inScrollChange.ScrollSpeed });
 
-				for (const TJA::ConvertedBarLineChange& barLineChange : inMeasure.BarLineChanges)
-					outCourse.BarLineChanges.Sorted.push_back(BarLineChange { (inMeasure.StartTime + barLineChange.TimeWithinMeasure), barLineChange.Visibile });
-
-				for (const TJA::ConvertedLyricChange& lyricChange : inMeasure.LyricChanges)
-					outCourse.Lyrics.Sorted.push_back(LyricChange { (inMeasure.StartTime + lyricChange.TimeWithinMeasure), lyricChange.Lyric });
-			}
-
-			for (const TJA::ConvertedGoGoRange& inGoGoRange : inCourse.GoGoRanges)
-				outCourse.GoGoRanges.Sorted.push_back(GoGoRange { inGoGoRange.StartTime, (inGoGoRange.EndTime - inGoGoRange.StartTime) });
-
-			//outCourse.TempoMap.SetTempoChange(TempoChange());
-			//outCourse.TempoMap = inCourse.GoGoRanges;
+		const size_t firstOutCourseIndex = out.Courses.size();
+		for (size_t i = 0; i < inTJA.Courses.size(); i++)
+			out.Courses.push_back(std::make_unique<ChartCourse>());
 
-			outCourse.ScoreInit = inCourse.CourseMetadata.SCOREINIT;
-			outCourse.ScoreDiff = inCourse.CourseMetadata.SCOREDIFF;
+		// NOTE: Each course is written to its pre-allocated slot and the durations are combined afterwards in course order, so the result is identical to a serial conversion
+		std::vector<TJACourseConversionResult> courseResults(inTJA.Courses.size(), TJACourseConversionResult { Time::Zero(), true });
+		const auto convertCourse = [&](size_t i) { courseResults[i] = ConvertTJACourseToChartCourse(inTJA, inTJA.Courses[i], *out.Courses[firstOutCourseIndex + i]); };
 
-			outCourse.TempoMap.RebuildAccelerationStructure();
+		if (threadPool != nullptr && inTJA.Courses.size() > 1)
+			threadPool->ParallelFor(inTJA.Courses.size(), convertCourse);
+		else
+			for (size_t i = 0; i < inTJA.Courses.size(); i++)
+				convertCourse(i);
 
-			if (!inCourse.Measures.empty())
-				out.ChartDuration = Max(out.ChartDuration, outCourse.TempoMap.BeatToTime(inCourse.Measures.back().StartTime /*+ inCourse.Measures.back().TimeSignature.GetDurationPerBar()*/));
+		for (size_t i = 0; i < courseResults.size(); i++)
+		{
+			out.ChartDuration = Max(out.ChartDuration, courseResults[i].Duration);
+			if (!courseResults[i].Succeeded && outFailedCourseIndices != nullptr)
+				outFailedCourseIndices->push_back(i);
 		}
 
 		return true;
@@ -276,7 +455,7 @@ namespace PeepoDrumKit
 			if (!in.Courses[0]->TempoMap.Tempo.empty())
 			{
 				const TempoChange* initialTempo = in.Courses[0]->TempoMap.Tempo.TryFindLastAtBeat(Beat::Zero());
-				out.Metadata.BPM = (initialTempo != nullptr) ? initialTempo->Tempo : FallbackTempo;
+				out.Metadata.BPM = (initialTempo != nullptr) ? initialTempo->TempoValue : FallbackTempo;
 			}
 		}
 
@@ -303,15 +482,15 @@ namespace PeepoDrumKit
 
 			inCourse.TempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
 			{
-				if (inChartBeatDuration > inChartMaxUsedBeat && (it.Beat >= inChartBeatDuration))
+				if (inChartBeatDuration > inChartMaxUsedBeat && (it.BeatTime >= inChartBeatDuration))
 					return ControlFlow::Break;
 				if (it.IsBar)
 				{
 					TJA::ConvertedMeasure& outConvertedMeasure = outConvertedMeasures.emplace_back();
-					outConvertedMeasure.StartTime = it.Beat;
-					outConvertedMeasure.TimeSignature = it.Signature;
+					outConvertedMeasure.StartTime = it.BeatTime;
+					outConvertedMeasure.Signature = it.Signature;
 				}
-				return (it.Beat >= Max(inChartBeatDuration, inChartMaxUsedBeat)) ? ControlFlow::Break : ControlFlow::Continue;
+				return (it.BeatTime >= Max(inChartBeatDuration, inChartMaxUsedBeat)) ? ControlFlow::Break : ControlFlow::Continue;
 			});
 
 			if (outConvertedMeasures.empty())
@@ -321,18 +500,18 @@ namespace PeepoDrumKit
 			{
 				// TODO: Optimize using binary search
 				for (auto& measure : measures)
-					if (beatToFind >= measure.StartTime && beatToFind < (measure.StartTime + measure.TimeSignature.GetDurationPerBar()))
+					if (beatToFind >= measure.StartTime && beatToFind < (measure.StartTime + measure.Signature.GetDurationPerBar()))
 						return &measure;
 				return nullptr;
 			};
 
 			for (const TempoChange& inTempoChange : inCourse.TempoMap.Tempo)
 			{
-				if (!(&inTempoChange == &inCourse.TempoMap.Tempo[0] && inTempoChange.Tempo.BPM == out.Metadata.BPM.BPM))
+				if (!(&inTempoChange == &inCourse.TempoMap.Tempo[0] && inTempoChange.TempoValue.BPM == out.Metadata.BPM.BPM))
 				{
-					TJA::ConvertedMeasure* outConvertedMeasure = tryFindMeasureForBeat(outConvertedMeasures, inTempoChange.Beat);
+					TJA::ConvertedMeasure* outConvertedMeasure = tryFindMeasureForBeat(outConvertedMeasures, inTempoChange.BeatTime);
 					if (assert(outConvertedMeasure != nullptr); outConvertedMeasure != nullptr)
-						outConvertedMeasure->TempoChanges.push_back(TJA::ConvertedTempoChange { (inTempoChange.Beat - outConvertedMeasure->StartTime), inTempoChange.Tempo });
+						outConvertedMeasure->TempoChanges.push_back(TJA::ConvertedTempoChange { (inTempoChange.BeatTime - outConvertedMeasure->StartTime), inTempoChange.TempoValue });
 				}
 			}
 
@@ -384,11 +563,362 @@ namespace PeepoDrumKit
 			for (const GoGoRange& gogo : inCourse.GoGoRanges)
 				outConvertedGoGoRanges.push_back(TJA::ConvertedGoGoRange { gogo.BeatTime, (gogo.BeatTime + Max(Beat::Zero(), gogo.BeatDuration)) });
 
-			TJA::ConvertConvertedMeasuresToParsedCommands(outConvertedMeasures, outConvertedGoGoRanges, outCourse.ChartCommands);
+			TJA::ConvertConvertedMeasuresToParsedCommands(outConvertedMeasures, outConvertedGoGoRanges, outCourse);
 		}
 
 		return true;
 	}
+
+	static constexpr NoteType ConvertFumenNoteType(Fumen::NoteType fumenNoteType)
+	{
+		switch (fumenNoteType)
+		{
+		case Fumen::NoteType::Don: return NoteType::Don;
+		case Fumen::NoteType::Do: return NoteType::Don;
+		case Fumen::NoteType::Ko: return NoteType::Don;
+		case Fumen::NoteType::Ka: return NoteType::Ka;
+		case Fumen::NoteType::Kat: return NoteType::Ka;
+		case Fumen::NoteType::Drumroll: return NoteType::Drumroll;
+		case Fumen::NoteType::DonBig: return NoteType::DonBig;
+		case Fumen::NoteType::KaBig: return NoteType::KaBig;
+		case Fumen::NoteType::DrumrollBig: return NoteType::DrumrollBig;
+		case Fumen::NoteType::Balloon: return NoteType::Balloon;
+		case Fumen::NoteType::DonBigHand: return NoteType::DonBig;
+		case Fumen::NoteType::Kusudama: return NoteType::BalloonSpecial;
+		case Fumen::NoteType::KaBigHand: return NoteType::KaBig;
+		case Fumen::NoteType::DrumrollAlt: return NoteType::Drumroll;
+		default: return NoteType::Count;
+		}
+	}
+
+	static constexpr Fumen::NoteType ConvertFumenNoteType(NoteType noteType)
+	{
+		switch (noteType)
+		{
+		case NoteType::Don: return Fumen::NoteType::Don;
+		case NoteType::DonBig: return Fumen::NoteType::DonBig;
+		case NoteType::Ka: return Fumen::NoteType::Ka;
+		case NoteType::KaBig: return Fumen::NoteType::KaBig;
+		case NoteType::Drumroll: return Fumen::NoteType::Drumroll;
+		case NoteType::DrumrollBig: return Fumen::NoteType::DrumrollBig;
+		case NoteType::Balloon: return Fumen::NoteType::Balloon;
+		case NoteType::BalloonSpecial: return Fumen::NoteType::Kusudama;
+		default: return Fumen::NoteType::None;
+		}
+	}
+
+	static inline Beat FumenMSToBeat(f64 ms, f32 bpm) { return Beat::FromBeatsFraction(ms * static_cast<f64>(bpm) / 60000.0); }
+	static inline f64 FumenBeatToMS(Beat beat, f32 bpm) { return beat.BeatsFraction() * 60000.0 / static_cast<f64>(bpm); }
+
+	static TimeSignature FumenMeasureDurationToTimeSignature(Beat measureDuration)
+	{
+		// NOTE: Use the smallest supported denominator that can represent the measure duration exactly
+		static constexpr i32 denominators[] = { 4, 8, 16, 32, 64, 96, 192 };
+		for (const i32 denominator : denominators)
+		{
+			const i32 ticksPerDenominator = Beat::FromBars(1).Ticks / denominator;
+			if ((measureDuration.Ticks % ticksPerDenominator) == 0)
+				return TimeSignature(measureDuration.Ticks / ticksPerDenominator, denominator);
+		}
+		return TimeSignature(measureDuration.Ticks, Beat::FromBars(1).Ticks);
+	}
+
+	b8 CreateChartCourseFromFumen(const u8* fileContent, size_t fileSize, ChartCourse& outCourse, Time& outSongOffset)
+	{
+		Fumen::Reader reader { fileContent, fileSize };
+		if (!reader.TryReadHeader())
+			return false;
+
+		ChartCourse newCourse {};
+		newCourse.Type = outCourse.Type;
+		newCourse.Level = outCourse.Level;
+		newCourse.CourseCreator = outCourse.CourseCreator;
+		newCourse.TempoMap.Tempo.Sorted.clear();
+		newCourse.TempoMap.Signature.Sorted = { TimeSignatureChange(Beat::Zero(), TimeSignature(4, 4)) };
+
+		// NOTE: Long note end times can lie inside any of the following measures, so they are resolved once the start beat and tempo of every measure is known
+		struct MeasureSegment { f64 StartMS; Beat StartBeat; f32 BPM; };
+		struct PendingLongNote { BranchType Branch; size_t NoteIndex; f64 EndMS; };
+		std::vector<MeasureSegment> measureSegments;
+		std::vector<PendingLongNote> pendingLongNotes;
+		measureSegments.reserve(reader.FileHeader.MeasureCount);
+
+		// NOTE: The duration of a measure is only known after reading the start time of the next one
+		Fumen::Measure measureBuffers[2] = {};
+		Fumen::Measure* thisMeasure = &measureBuffers[0];
+		Fumen::Measure* nextMeasure = &measureBuffers[1];
+		b8 hasThisMeasure = reader.TryReadNextMeasure(*thisMeasure);
+
+		const b8 hasBranches = (reader.FileHeader.HasBranches != 0);
+		const f64 firstMeasureStartMS = hasThisMeasure ? thisMeasure->GetStartTimeMS() : 0.0;
+
+		Beat measureBeat = Beat::Zero();
+		f32 lastBPM = 0.0f;
+		TimeSignature lastSignature = TimeSignature(4, 4);
+		f32 lastScrollSpeed = 1.0f;
+		b8 lastBarLineVisible = true;
+		b8 isGoGo = false; Beat goGoStartBeat = Beat::Zero();
+		b8 hasScoreInit = false;
+
+		while (hasThisMeasure)
+		{
+			const b8 hasNextMeasure = reader.TryReadNextMeasure(*nextMeasure);
+			const f32 bpm = thisMeasure->BPM;
+			if (!(bpm > 0.0f))
+				return false;
+
+			// NOTE: The last measure has nothing to measure against so it simply continues with the previous time signature
+			const f64 measureStartMS = thisMeasure->GetStartTimeMS();
+			const Beat measureDuration = hasNextMeasure ? Max(Beat::Zero(), FumenMSToBeat(nextMeasure->GetStartTimeMS() - measureStartMS, bpm)) : lastSignature.GetDurationPerBar();
+			measureSegments.push_back(MeasureSegment { measureStartMS, measureBeat, bpm });
+
+			if (bpm != lastBPM)
+			{
+				newCourse.TempoMap.Tempo.InsertOrUpdate(TempoChange(measureBeat, Tempo(bpm)));
+				lastBPM = bpm;
+			}
+
+			if (const TimeSignature signature = FumenMeasureDurationToTimeSignature(measureDuration); hasNextMeasure && measureDuration > Beat::Zero() && signature != lastSignature)
+			{
+				newCourse.TempoMap.Signature.InsertOrUpdate(TimeSignatureChange(measureBeat, signature));
+				lastSignature = signature;
+			}
+
+			// TODO: Have per-branch scroll speed changes (only the normal branch is used for now)
+			if (const f32 scrollSpeed = thisMeasure->Branches[EnumToIndex(Fumen::Branch::Normal)].ScrollSpeed; scrollSpeed != lastScrollSpeed)
+			{
+				newCourse.ScrollChanges.InsertOrUpdate(ScrollChange { measureBeat, scrollSpeed });
+				lastScrollSpeed = scrollSpeed;
+			}
+
+			if (thisMeasure->IsBarLineVisible != lastBarLineVisible)
+			{
+				newCourse.BarLineChanges.InsertOrUpdate(BarLineChange { measureBeat, thisMeasure->IsBarLineVisible });
+				lastBarLineVisible = thisMeasure->IsBarLineVisible;
+			}
+
+			if (thisMeasure->IsGoGo != isGoGo)
+			{
+				if (isGoGo && measureBeat > goGoStartBeat)
+					newCourse.GoGoRanges.Sorted.push_back(GoGoRange { goGoStartBeat, (measureBeat - goGoStartBeat) });
+				goGoStartBeat = measureBeat;
+				isGoGo = thisMeasure->IsGoGo;
+			}
+
+			// NOTE: Files without branches still contain all three branches, usually with the expert and master ones simply being copies of the normal one
+			for (size_t branchIndex = 0; branchIndex < (hasBranches ? EnumCount<BranchType> : 1); branchIndex++)
+			{
+				const BranchType branch = static_cast<BranchType>(branchIndex);
+				SortedNotesList& outNotes = newCourse.GetNotes(branch);
+
+				for (const Fumen::Note& inNote : thisMeasure->Branches[branchIndex].Notes)
+				{
+					const NoteType outNoteType = ConvertFumenNoteType(inNote.Type);
+					if (outNoteType == NoteType::Count)
+						continue;
+
+					Note& outNote = outNotes.Sorted.emplace_back();
+					outNote.BeatTime = measureBeat + FumenMSToBeat(inNote.PositionMS, bpm);
+					outNote.Type = outNoteType;
+
+					if (IsBalloonNote(outNoteType))
+					{
+						outNote.BalloonPopCount = static_cast<i16>(Min<i32>(inNote.ScoreInitOrBalloonHits, I16Max));
+					}
+					else if (!hasScoreInit)
+					{
+						newCourse.ScoreInit = inNote.ScoreInitOrBalloonHits;
+						newCourse.ScoreDiff = (inNote.ScoreDiffTimesFour / 4);
+						hasScoreInit = true;
+					}
+
+					if (IsLongNote(outNoteType) && inNote.DurationMS > 0.0f)
+						pendingLongNotes.push_back(PendingLongNote { branch, (outNotes.size() - 1), (measureStartMS + inNote.PositionMS + inNote.DurationMS) });
+				}
+			}
+
+			measureBeat += measureDuration;
+			std::swap(thisMeasure, nextMeasure);
+			hasThisMeasure = hasNextMeasure;
+		}
+
+		if (reader.MeasuresRead != reader.FileHeader.MeasureCount)
+			return false;
+
+		if (isGoGo && measureBeat > goGoStartBeat)
+			newCourse.GoGoRanges.Sorted.push_back(GoGoRange { goGoStartBeat, (measureBeat - goGoStartBeat) });
+
+		for (const PendingLongNote& pendingLongNote : pendingLongNotes)
+		{
+			auto segmentIt = std::upper_bound(measureSegments.begin(), measureSegments.end(), pendingLongNote.EndMS, [](f64 endMS, const MeasureSegment& segment) { return endMS < segment.StartMS; });
+			const MeasureSegment& segment = (segmentIt == measureSegments.begin()) ? *segmentIt : *(segmentIt - 1);
+
+			Note& note = newCourse.GetNotes(pendingLongNote.Branch).Sorted[pendingLongNote.NoteIndex];
+			note.BeatDuration = Max(Beat::Zero(), (segment.StartBeat + FumenMSToBeat(pendingLongNote.EndMS - segment.StartMS, segment.BPM)) - note.BeatTime);
+		}
+
+		// NOTE: Notes are usually already stored in order, though nothing guarantees that they are
+		for (size_t branchIndex = 0; branchIndex < EnumCount<BranchType>; branchIndex++)
+		{
+			auto& sortedNotes = newCourse.GetNotes(static_cast<BranchType>(branchIndex)).Sorted;
+			static constexpr auto isBeatLess = [](const Note& a, const Note& b) { return a.BeatTime < b.BeatTime; };
+			if (!std::is_sorted(sortedNotes.begin(), sortedNotes.end(), isBeatLess))
+				std::stable_sort(sortedNotes.begin(), sortedNotes.end(), isBeatLess);
+		}
+
+		if (newCourse.TempoMap.Tempo.empty())
+			newCourse.TempoMap.Tempo.Sorted = { TempoChange(Beat::Zero(), FallbackTempo) };
+		newCourse.TempoMap.RebuildAccelerationStructure();
+
+		outCourse = std::move(newCourse);
+		// NOTE: Measure offsets are stored as f32 so round away their imprecision, otherwise exporting the same course again would result in slightly different offsets
+		outSongOffset = Time::FromMS(-Round(firstMeasureStartMS * 1000.0) / 1000.0);
+		return true;
+	}
+
+	b8 CreateChartProjectFromFumen(const u8* fileContent, size_t fileSize, ChartProject& out)
+	{
+		auto course = std::make_unique<ChartCourse>();
+		Time songOffset = Time::Zero();
+		if (!CreateChartCourseFromFumen(fileContent, fileSize, *course, songOffset))
+			return false;
+
+		out.SongOffset = songOffset;
+		out.ChartDuration = course->TempoMap.BeatToTime(FindCourseMaxUsedBeat(*course));
+		out.Courses.push_back(std::move(course));
+		return true;
+	}
+
+	void ConvertChartCourseToFumen(const ChartCourse& inCourse, Time songOffset, std::vector<u8>& outFileContent, Endianness endianness)
+	{
+		const SortedTempoMap& tempoMap = inCourse.TempoMap;
+		const Beat maxUsedBeat = FindCourseMaxUsedBeat(inCourse);
+
+		// NOTE: Every bar up to and including the one containing the last used beat, followed by the end beat of that last bar
+		std::vector<Beat> measureBeats;
+		std::vector<Beat> barBeats;
+		tempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
+		{
+			if (!it.IsBar)
+				return ControlFlow::Continue;
+			barBeats.push_back(it.BeatTime);
+			return (it.BeatTime > maxUsedBeat) ? ControlFlow::Break : ControlFlow::Continue;
+		});
+		if (barBeats.size() < 2)
+			barBeats = { Beat::Zero(), Beat::FromBars(1) };
+
+		// NOTE: Fumen measures can only have a single tempo, scroll speed and gogo state, so bars are additionally split at each of those changes
+		const Beat endBeat = barBeats.back();
+		measureBeats.reserve(barBeats.size() + tempoMap.Tempo.size() + inCourse.ScrollChanges.size() + (inCourse.GoGoRanges.size() * 2));
+		measureBeats.insert(measureBeats.end(), barBeats.begin(), barBeats.end() - 1);
+		for (const TempoChange& v : tempoMap.Tempo) measureBeats.push_back(v.BeatTime);
+		for (const ScrollChange& v : inCourse.ScrollChanges) measureBeats.push_back(v.BeatTime);
+		for (const BarLineChange& v : inCourse.BarLineChanges) measureBeats.push_back(v.BeatTime);
+		for (const GoGoRange& v : inCourse.GoGoRanges) { measureBeats.push_back(v.GetStart()); measureBeats.push_back(v.GetEnd()); }
+		measureBeats.erase(std::remove_if(measureBeats.begin(), measureBeats.end(), [&](Beat v) { return (v < Beat::Zero()) || (v >= endBeat); }), measureBeats.end());
+		std::sort(measureBeats.begin(), measureBeats.end());
+		measureBeats.erase(std::unique(measureBeats.begin(), measureBeats.end()), measureBeats.end());
+		measureBeats.push_back(endBeat);
+
+		const b8 hasBranches = (!inCourse.Notes_Expert.empty() || !inCourse.Notes_Master.empty());
+		const u16 scoreInit = static_cast<u16>(Clamp<i32>(inCourse.ScoreInit, 0, U16Max));
+		const u16 scoreDiffTimesFour = static_cast<u16>(Clamp<i32>(inCourse.ScoreDiff * 4, 0, U16Max));
+
+		Fumen::Writer writer { outFileContent, endianness };
+		writer.BeginFile();
+
+		Fumen::Measure outMeasure = {};
+		for (i32& branchInfo : outMeasure.BranchInfo)
+			branchInfo = -1;
+
+		BeatSortedForwardIterator<TempoChange> tempoIt {};
+		BeatSortedForwardIterator<ScrollChange> scrollIt {};
+		BeatSortedForwardIterator<BarLineChange> barLineIt {};
+		BeatSortedForwardIterator<GoGoRange> goGoIt {};
+		size_t barIndex = 0;
+		size_t branchNoteIndices[EnumCount<BranchType>] = {};
+		size_t regularNoteCount = 0;
+
+		for (size_t measureIndex = 0; measureIndex + 1 < measureBeats.size(); measureIndex++)
+		{
+			const Beat measureBeat = measureBeats[measureIndex];
+			const Beat nextMeasureBeat = measureBeats[measureIndex + 1];
+			const b8 isLastMeasure = (measureIndex + 2 == measureBeats.size());
+
+			const b8 isBarStart = (barIndex < barBeats.size() && barBeats[barIndex] == measureBeat);
+			barIndex += isBarStart;
+
+			const f32 bpm = TempoOrDefault(tempoIt.Next(tempoMap.Tempo.Sorted, measureBeat)).BPM;
+			const f64 measureStartTimeMS = (tempoMap.BeatToTime(measureBeat) - songOffset).ToMS();
+			const GoGoRange* goGo = goGoIt.Next(inCourse.GoGoRanges.Sorted, measureBeat);
+			const b8 isBarLineVisible = VisibleOrDefault(barLineIt.Next(inCourse.BarLineChanges.Sorted, measureBeat));
+
+			outMeasure.BPM = bpm;
+			outMeasure.OffsetMS = Fumen::Measure::StartTimeToOffsetMS(measureStartTimeMS, bpm);
+			outMeasure.IsGoGo = (goGo != nullptr && measureBeat < goGo->GetEnd());
+			outMeasure.IsBarLineVisible = (isBarStart && isBarLineVisible);
+
+			// TODO: Have per-branch scroll speed changes (the same scroll speed is used for all branches for now)
+			const f32 scrollSpeed = ScrollOrDefault(scrollIt.Next(inCourse.ScrollChanges.Sorted, measureBeat));
+			for (size_t branchIndex = 0; branchIndex < EnumCount<BranchType>; branchIndex++)
+			{
+				Fumen::Measure::BranchData& outBranch = outMeasure.Branches[branchIndex];
+				outBranch.ScrollSpeed = scrollSpeed;
+				outBranch.Notes.clear();
+
+				const SortedNotesList& inNotes = hasBranches ? inCourse.GetNotes(static_cast<BranchType>(branchIndex)) : inCourse.Notes_Normal;
+				size_t& noteIndex = branchNoteIndices[branchIndex];
+				for (; noteIndex < inNotes.size() && (isLastMeasure || inNotes[noteIndex].BeatTime < nextMeasureBeat); noteIndex++)
+				{
+					// TODO: Handle note time offsets (delays), which would have to be baked into the measure offsets
+					const Note& inNote = inNotes[noteIndex];
+					Fumen::Note& outNote = outBranch.Notes.emplace_back();
+					outNote = {};
+					outNote.Type = ConvertFumenNoteType(inNote.Type);
+					outNote.PositionMS = static_cast<f32>(FumenBeatToMS(inNote.BeatTime - measureBeat, bpm));
+
+					if (IsBalloonNote(inNote.Type))
+					{
+						outNote.ScoreInitOrBalloonHits = static_cast<u16>(ClampBot<i16>(inNote.BalloonPopCount, 0));
+					}
+					else
+					{
+						outNote.ScoreInitOrBalloonHits = scoreInit;
+						outNote.ScoreDiffTimesFour = scoreDiffTimesFour;
+					}
+
+					if (IsLongNote(inNote.Type) && inNote.BeatDuration > Beat::Zero())
+						outNote.DurationMS = static_cast<f32>((tempoMap.BeatToTime(inNote.GetEnd()) - tempoMap.BeatToTime(inNote.BeatTime)).ToMS());
+
+					regularNoteCount += (branchIndex == 0 && IsRegularNote(inNote.Type));
+				}
+			}
+
+			writer.WriteMeasure(outMeasure);
+		}
+
+		// NOTE: Judgement windows and soul gauge values aren't stored as part of a course so reasonable defaults are used instead,
+		//		 with the gauge being filled up after hitting every regular note with a good judgement
+		const b8 isEasyOrNormal = (inCourse.Type <= DifficultyType::Normal);
+		Fumen::Header outHeader = {};
+		for (auto& judgeTimings : outHeader.JudgeTimings)
+		{
+			judgeTimings[0] = isEasyOrNormal ? 41.7083358765f : 25.0250015259f;
+			judgeTimings[1] = isEasyOrNormal ? 108.441665649f : 75.0750045776f;
+			judgeTimings[2] = isEasyOrNormal ? 125.125f : 108.441665649f;
+		}
+
+		static constexpr i32 gaugeMax = 10000;
+		static constexpr i32 gaugeClearPerDifficulty[EnumCount<DifficultyType>] = { 6000, 7000, 7000, 8000, 8000 };
+		const i32 gaugeGainGood = static_cast<i32>((gaugeMax + ClampBot<size_t>(regularNoteCount, 1) - 1) / ClampBot<size_t>(regularNoteCount, 1));
+		outHeader.HasBranches = hasBranches ? 1 : 0;
+		outHeader.GaugeParameters[Fumen::Header::Gauge_HPMax] = gaugeMax;
+		outHeader.GaugeParameters[Fumen::Header::Gauge_HPClear] = gaugeClearPerDifficulty[EnumToIndex(Clamp(inCourse.Type, DifficultyType {}, DifficultyType::OniUra))];
+		outHeader.GaugeParameters[Fumen::Header::Gauge_HPGainGood] = gaugeGainGood;
+		outHeader.GaugeParameters[Fumen::Header::Gauge_HPGainOk] = isEasyOrNormal ? ((gaugeGainGood * 3) / 4) : (gaugeGainGood / 2);
+		outHeader.GaugeParameters[Fumen::Header::Gauge_HPLossBad] = -(gaugeGainGood * 2);
+		writer.EndFile(outHeader);
+	}
 }
 
 namespace PeepoDrumKit
@@ -398,11 +928,11 @@ namespace PeepoDrumKit
 	{
 		switch (list)
 		{
-		case GenericList::TempoChanges: return { &in.POD.Tempo.Beat, nullptr };
-		case GenericList::SignatureChanges: return { &in.POD.Signature.Beat, nullptr };
-		case GenericList::Notes_Normal: return { &in.POD.Note.BeatTime, &in.POD.Note.BeatDuration };
-		case GenericList::Notes_Expert: return { &in.POD.Note.BeatTime, &in.POD.Note.BeatDuration };
-		case GenericList::Notes_Master: return { &in.POD.Note.BeatTime, &in.POD.Note.BeatDuration };
+		case GenericList::TempoChanges: return { &in.POD.Tempo.BeatTime, nullptr };
+		case GenericList::SignatureChanges: return { &in.POD.Signature.BeatTime, nullptr };
+		case GenericList::Notes_Normal: return { &in.POD.NoteItem.BeatTime, &in.POD.NoteItem.BeatDuration };
+		case GenericList::Notes_Expert: return { &in.POD.NoteItem.BeatTime, &in.POD.NoteItem.BeatDuration };
+		case GenericList::Notes_Master: return { &in.POD.NoteItem.BeatTime, &in.POD.NoteItem.BeatDuration };
 		case GenericList::ScrollChanges: return { &in.POD.Scroll.BeatTime, nullptr };
 		case GenericList::BarLineChanges: return { &in.POD.BarLine.BeatTime, nullptr };
 		case GenericList::GoGoRanges: return { &in.POD.GoGo.BeatTime, &in.POD.GoGo.BeatDuration };
@@ -463,6 +993,48 @@ namespace PeepoDrumKit
 		}
 	}
 
+	const std::vector<size_t>& GetGenericListSelectedIndices(const ChartCourse& course, GenericList list)
+	{
+		switch (list)
+		{
+		case GenericList::TempoChanges: return course.TempoMap.Tempo.GetSelectedIndices();
+		case GenericList::SignatureChanges: return course.TempoMap.Signature.GetSelectedIndices();
+		case GenericList::Notes_Normal: return course.Notes_Normal.GetSelectedIndices();
+		case GenericList::Notes_Expert: return course.Notes_Expert.GetSelectedIndices();
+		case GenericList::Notes_Master: return course.Notes_Master.GetSelectedIndices();
+		case GenericList::ScrollChanges: return course.ScrollChanges.GetSelectedIndices();
+		case GenericList::BarLineChanges: return course.BarLineChanges.GetSelectedIndices();
+		case GenericList::GoGoRanges: return course.GoGoRanges.GetSelectedIndices();
+		case GenericList::Lyrics: return course.Lyrics.GetSelectedIndices();
+		default: assert(false); static const std::vector<size_t> empty; return empty;
+		}
+	}
+
+	size_t GetGenericListSelectedCount(const ChartCourse& course, GenericList list)
+	{
+		switch (list)
+		{
+		case GenericList::TempoChanges: return course.TempoMap.Tempo.GetSelectedCount();
+		case GenericList::SignatureChanges: return course.TempoMap.Signature.GetSelectedCount();
+		case GenericList::Notes_Normal: return course.Notes_Normal.GetSelectedCount();
+		case GenericList::Notes_Expert: return course.Notes_Expert.GetSelectedCount();
+		case GenericList::Notes_Master: return course.Notes_Master.GetSelectedCount();
+		case GenericList::ScrollChanges: return course.ScrollChanges.GetSelectedCount();
+		case GenericList::BarLineChanges: return course.BarLineChanges.GetSelectedCount();
+		case GenericList::GoGoRanges: return course.GoGoRanges.GetSelectedCount();
+		case GenericList::Lyrics: return course.Lyrics.GetSelectedCount();
+		default: assert(false); return 0;
+		}
+	}
+
+	size_t CountSelectedChartItems(const ChartCourse& course)
+	{
+		size_t selectedCount = 0;
+		for (GenericList list = {}; list < GenericList::Count; IncrementEnum(list))
+			selectedCount += GetGenericListSelectedCount(course, list);
+		return selectedCount;
+	}
+
 	GenericMemberFlags GetAvailableMemberFlags(GenericList list)
 	{
 		switch (list)
@@ -498,8 +1070,8 @@ namespace PeepoDrumKit
 				switch (member)
 				{
 				case GenericMember::B8_IsSelected: return &vector[index].IsSelected;
-				case GenericMember::Beat_Start: return &vector[index].Beat;
-				case GenericMember::Tempo_V: return &vector[index].Tempo;
+				case GenericMember::Beat_Start: return &vector[index].BeatTime;
+				case GenericMember::Tempo_V: return &vector[index].TempoValue;
 				}
 			} break;
 		case GenericList::SignatureChanges:
@@ -508,7 +1080,7 @@ namespace PeepoDrumKit
 				switch (member)
 				{
 				case GenericMember::B8_IsSelected: return &vector[index].IsSelected;
-				case GenericMember::Beat_Start: return &vector[index].Beat;
+				case GenericMember::Beat_Start: return &vector[index].BeatTime;
 				case GenericMember::TimeSignature_V: return &vector[index].Signature;
 				}
 			} break;
@@ -592,16 +1164,71 @@ namespace PeepoDrumKit
 		return true;
 	}
 
+	static Beat GetGenericListStructBeatAt(const ChartCourse& course, GenericList list, size_t index)
+	{
+		GenericMemberUnion beat {};
+		return TryGetGeneric(course, list, index, GenericMember::Beat_Start, beat) ? beat.BeatV : Beat::Zero();
+	}
+
+	static Time GetGenericListStructTimeOffsetAt(const ChartCourse& course, GenericList list, size_t index)
+	{
+		GenericMemberUnion timeOffset {};
+		return TryGetGeneric(course, list, index, GenericMember::Time_Offset, timeOffset) ? timeOffset.TimeV : Time::Zero();
+	}
+
+	static void SyncGenericListCachedSelectionAt(ChartCourse& course, GenericList list, size_t index)
+	{
+		switch (list)
+		{
+		case GenericList::TempoChanges: { course.TempoMap.Tempo.SyncCachedSelectionAt(index); } break;
+		case GenericList::SignatureChanges: { course.TempoMap.Signature.SyncCachedSelectionAt(index); } break;
+		case GenericList::Notes_Normal: { course.Notes_Normal.SyncCachedSelectionAt(index); } break;
+		case GenericList::Notes_Expert: { course.Notes_Expert.SyncCachedSelectionAt(index); } break;
+		case GenericList::Notes_Master: { course.Notes_Master.SyncCachedSelectionAt(index); } break;
+		case GenericList::ScrollChanges: { course.ScrollChanges.SyncCachedSelectionAt(index); } break;
+		case GenericList::BarLineChanges: { course.BarLineChanges.SyncCachedSelectionAt(index); } break;
+		case GenericList::GoGoRanges: { course.GoGoRanges.SyncCachedSelectionAt(index); } break;
+		case GenericList::Lyrics: { course.Lyrics.SyncCachedSelectionAt(index); } break;
+		default: assert(false); break;
+		}
+	}
+
+	static void SyncGenericListCachedBeatRangesAt(ChartCourse& course, GenericList list, size_t index, Beat previousBeat, Time previousTimeOffset)
+	{
+		switch (list)
+		{
+		case GenericList::TempoChanges: { course.TempoMap.Tempo.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::SignatureChanges: { course.TempoMap.Signature.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::Notes_Normal: { course.Notes_Normal.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::Notes_Expert: { course.Notes_Expert.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::Notes_Master: { course.Notes_Master.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::ScrollChanges: { course.ScrollChanges.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::BarLineChanges: { course.BarLineChanges.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::GoGoRanges: { course.GoGoRanges.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		case GenericList::Lyrics: { course.Lyrics.SyncCachedBeatRangesAt(index, previousBeat, previousTimeOffset); } break;
+		default: assert(false); break;
+		}
+	}
+
 	b8 TrySetGeneric(ChartCourse& course, GenericList list, size_t index, GenericMember member, const GenericMemberUnion& inValue)
 	{
 		void* voidMember = TryGetGeneric_RawVoidPtr(course, list, index, member);
 		if (voidMember == nullptr)
 			return false;
 
+		const Beat oldBeat = GetGenericListStructBeatAt(course, list, index);
+		const Time oldTimeOffset = GetGenericListStructTimeOffsetAt(course, list, index);
 		if (member == GenericMember::CStr_Lyric)
 			course.Lyrics[index].Lyric.assign(inValue.CStr);
 		else
 			memcpy(voidMember, &inValue, GetGenericMember_RawByteSize(member));
+
+		if (member == GenericMember::B8_IsSelected)
+			SyncGenericListCachedSelectionAt(course, list, index);
+
+		// NOTE: Everything other than these has an effect on either the beat ranges or the derived timing data
+		if (member != GenericMember::B8_IsSelected && member != GenericMember::I16_BalloonPopCount && member != GenericMember::NoteType_V && member != GenericMember::CStr_Lyric)
+			SyncGenericListCachedBeatRangesAt(course, list, index, oldBeat, oldTimeOffset);
 		return true;
 	}
 
@@ -611,9 +1238,9 @@ namespace PeepoDrumKit
 		{
 		case GenericList::TempoChanges: if (InBounds(index, course.TempoMap.Tempo)) { outValue.POD.Tempo = course.TempoMap.Tempo[index]; return true; } break;
 		case GenericList::SignatureChanges: if (InBounds(index, course.TempoMap.Signature)) { outValue.POD.Signature = course.TempoMap.Signature[index]; return true; } break;
-		case GenericList::Notes_Normal: if (InBounds(index, course.Notes_Normal)) { outValue.POD.Note = course.Notes_Normal[index]; return true; } break;
-		case GenericList::Notes_Expert: if (InBounds(index, course.Notes_Expert)) { outValue.POD.Note = course.Notes_Expert[index]; return true; } break;
-		case GenericList::Notes_Master: if (InBounds(index, course.Notes_Master)) { outValue.POD.Note = course.Notes_Master[index]; return true; } break;
+		case GenericList::Notes_Normal: if (InBounds(index, course.Notes_Normal)) { outValue.POD.NoteItem = course.Notes_Normal[index]; return true; } break;
+		case GenericList::Notes_Expert: if (InBounds(index, course.Notes_Expert)) { outValue.POD.NoteItem = course.Notes_Expert[index]; return true; } break;
+		case GenericList::Notes_Master: if (InBounds(index, course.Notes_Master)) { outValue.POD.NoteItem = course.Notes_Master[index]; return true; } break;
 		case GenericList::ScrollChanges: if (InBounds(index, course.ScrollChanges)) { outValue.POD.Scroll = course.ScrollChanges[index]; return true; } break;
 		case GenericList::BarLineChanges: if (InBounds(index, course.BarLineChanges)) { outValue.POD.BarLine = course.BarLineChanges[index]; return true; } break;
 		case GenericList::GoGoRanges: if (InBounds(index, course.GoGoRanges)) { outValue.POD.GoGo = course.GoGoRanges[index]; return true; } break;
@@ -625,20 +1252,29 @@ namespace PeepoDrumKit
 
 	b8 TrySetGenericStruct(ChartCourse& course, GenericList list, size_t index, const GenericListStruct& inValue)
 	{
+		if (index >= GetGenericListCount(course, list))
+			return false;
+
+		const Beat oldBeat = GetGenericListStructBeatAt(course, list, index);
+		const Time oldTimeOffset = GetGenericListStructTimeOffsetAt(course, list, index);
+
 		switch (list)
 		{
-		case GenericList::TempoChanges: if (InBounds(index, course.TempoMap.Tempo)) { course.TempoMap.Tempo[index] = inValue.POD.Tempo; return true; } break;
-		case GenericList::SignatureChanges: if (InBounds(index, course.TempoMap.Signature)) { course.TempoMap.Signature[index] = inValue.POD.Signature; return true; } break;
-		case GenericList::Notes_Normal: if (InBounds(index, course.Notes_Normal)) { course.Notes_Normal[index] = inValue.POD.Note; return true; } break;
-		case GenericList::Notes_Expert: if (InBounds(index, course.Notes_Expert)) { course.Notes_Expert[index] = inValue.POD.Note; return true; } break;
-		case GenericList::Notes_Master: if (InBounds(index, course.Notes_Master)) { course.Notes_Master[index] = inValue.POD.Note; return true; } break;
-		case GenericList::ScrollChanges: if (InBounds(index, course.ScrollChanges)) { course.ScrollChanges[index] = inValue.POD.Scroll; return true; } break;
-		case GenericList::BarLineChanges: if (InBounds(index, course.BarLineChanges)) { course.BarLineChanges[index] = inValue.POD.BarLine; return true; } break;
-		case GenericList::GoGoRanges: if (InBounds(index, course.GoGoRanges)) { course.GoGoRanges[index] = inValue.POD.GoGo; return true; } break;
-		case GenericList::Lyrics: if (InBounds(index, course.Lyrics)) { course.Lyrics[index] = inValue.NonTrivial.Lyric; return true; } break;
-		default: assert(false); break;
+		case GenericList::TempoChanges: { course.TempoMap.Tempo[index] = inValue.POD.Tempo; } break;
+		case GenericList::SignatureChanges: { course.TempoMap.Signature[index] = inValue.POD.Signature; } break;
+		case GenericList::Notes_Normal: { course.Notes_Normal[index] = inValue.POD.NoteItem; } break;
+		case GenericList::Notes_Expert: { course.Notes_Expert[index] = inValue.POD.NoteItem; } break;
+		case GenericList::Notes_Master: { course.Notes_Master[index] = inValue.POD.NoteItem; } break;
+		case GenericList::ScrollChanges: { course.ScrollChanges[index] = inValue.POD.Scroll; } break;
+		case GenericList::BarLineChanges: { course.BarLineChanges[index] = inValue.POD.BarLine; } break;
+		case GenericList::GoGoRanges: { course.GoGoRanges[index] = inValue.POD.GoGo; } break;
+		case GenericList::Lyrics: { course.Lyrics[index] = inValue.NonTrivial.Lyric; } break;
+		default: assert(false); return false;
 		}
-		return false;
+
+		SyncGenericListCachedBeatRangesAt(course, list, index, oldBeat, oldTimeOffset);
+		SyncGenericListCachedSelectionAt(course, list, index);
+		return true;
 	}
 
 	b8 TryAddGenericStruct(ChartCourse& course, GenericList list, GenericListStruct inValue)
@@ -647,9 +1283,9 @@ namespace PeepoDrumKit
 		{
 		case GenericList::TempoChanges: { course.TempoMap.Tempo.InsertOrUpdate(inValue.POD.Tempo); return true; } break;
 		case GenericList::SignatureChanges: { course.TempoMap.Signature.InsertOrUpdate(inValue.POD.Signature); return true; } break;
-		case GenericList::Notes_Normal: { course.Notes_Normal.InsertOrUpdate(inValue.POD.Note); return true; } break;
-		case GenericList::Notes_Expert: { course.Notes_Expert.InsertOrUpdate(inValue.POD.Note); return true; } break;
-		case GenericList::Notes_Master: { course.Notes_Master.InsertOrUpdate(inValue.POD.Note); return true; } break;
+		case GenericList::Notes_Normal: { course.Notes_Normal.InsertOrUpdate(inValue.POD.NoteItem); return true; } break;
+		case GenericList::Notes_Expert: { course.Notes_Expert.InsertOrUpdate(inValue.POD.NoteItem); return true; } break;
+		case GenericList::Notes_Master: { course.Notes_Master.InsertOrUpdate(inValue.POD.NoteItem); return true; } break;
 		case GenericList::ScrollChanges: { course.ScrollChanges.InsertOrUpdate(inValue.POD.Scroll); return true; } break;
 		case GenericList::BarLineChanges: { course.BarLineChanges.InsertOrUpdate(inValue.POD.BarLine); return true; } break;
 		case GenericList::GoGoRanges: { course.GoGoRanges.InsertOrUpdate(inValue.POD.GoGo); return true; } break;
@@ -681,4 +1317,52 @@ namespace PeepoDrumKit
 		}
 		return false;
 	}
+
+	void AddMultipleGenericStructs(ChartCourse& course, const std::vector<GenericListStructWithType>& inValues)
+	{
+		auto insertAllOfList = [&inValues](auto& sortedList, GenericList list, auto getValue)
+		{
+			std::vector<typename std::remove_reference_t<decltype(sortedList.Sorted)>::value_type> valuesOfList;
+			for (const GenericListStructWithType& data : inValues)
+			{
+				if (data.List == list)
+					valuesOfList.push_back(getValue(data.Value));
+			}
+			sortedList.InsertOrUpdateMultiple(std::move(valuesOfList));
+		};
+
+		insertAllOfList(course.TempoMap.Tempo, GenericList::TempoChanges, [](const GenericListStruct& v) { return v.POD.Tempo; });
+		insertAllOfList(course.TempoMap.Signature, GenericList::SignatureChanges, [](const GenericListStruct& v) { return v.POD.Signature; });
+		insertAllOfList(course.Notes_Normal, GenericList::Notes_Normal, [](const GenericListStruct& v) { return v.POD.NoteItem; });
+		insertAllOfList(course.Notes_Expert, GenericList::Notes_Expert, [](const GenericListStruct& v) { return v.POD.NoteItem; });
+		insertAllOfList(course.Notes_Master, GenericList::Notes_Master, [](const GenericListStruct& v) { return v.POD.NoteItem; });
+		insertAllOfList(course.ScrollChanges, GenericList::ScrollChanges, [](const GenericListStruct& v) { return v.POD.Scroll; });
+		insertAllOfList(course.BarLineChanges, GenericList::BarLineChanges, [](const GenericListStruct& v) { return v.POD.BarLine; });
+		insertAllOfList(course.GoGoRanges, GenericList::GoGoRanges, [](const GenericListStruct& v) { return v.POD.GoGo; });
+		insertAllOfList(course.Lyrics, GenericList::Lyrics, [](const GenericListStruct& v) { return v.NonTrivial.Lyric; });
+	}
+
+	void RemoveMultipleGenericStructs(ChartCourse& course, const std::vector<GenericListStructWithType>& inValuesToRemove)
+	{
+		auto removeAllOfList = [&inValuesToRemove](auto& sortedList, GenericList list)
+		{
+			std::vector<Beat> beatsOfList;
+			for (const GenericListStructWithType& data : inValuesToRemove)
+			{
+				if (data.List == list)
+					beatsOfList.push_back(data.GetBeat());
+			}
+			sortedList.RemoveAtBeats(std::move(beatsOfList));
+		};
+
+		removeAllOfList(course.TempoMap.Tempo, GenericList::TempoChanges);
+		removeAllOfList(course.TempoMap.Signature, GenericList::SignatureChanges);
+		removeAllOfList(course.Notes_Normal, GenericList::Notes_Normal);
+		removeAllOfList(course.Notes_Expert, GenericList::Notes_Expert);
+		removeAllOfList(course.Notes_Master, GenericList::Notes_Master);
+		removeAllOfList(course.ScrollChanges, GenericList::ScrollChanges);
+		removeAllOfList(course.BarLineChanges, GenericList::BarLineChanges);
+		removeAllOfList(course.GoGoRanges, GenericList::GoGoRanges);
+		removeAllOfList(course.Lyrics, GenericList::Lyrics);
+	}
 }
@@ -5,6 +5,8 @@
 #include "file_format_tja.h"
 #include <unordered_map>
 
+class ThreadPool;
+
 namespace PeepoDrumKit
 {
 	enum class NoteType : u8
@@ -197,7 +199,7 @@ namespace PeepoDrumKit
 
 	constexpr b8 VisibleOrDefault(const BarLineChange* v) { return (v == nullptr) ? true : v->IsVisible; }
 	constexpr f32 ScrollOrDefault(const ScrollChange* v) { return (v == nullptr) ? 1.0f : v->ScrollSpeed; }
-	constexpr Tempo TempoOrDefault(const TempoChange* v) { return (v == nullptr) ? FallbackTempo : v->Tempo; }
+	constexpr Tempo TempoOrDefault(const TempoChange* v) { return (v == nullptr) ? FallbackTempo : v->TempoValue; }
 
 	enum class Language : u8 { Base, JA, EN, CN, TW, KO, Count };
 	struct PerLanguageString
@@ -214,6 +216,40 @@ namespace PeepoDrumKit
 		inline auto& operator[](Language v) const { return Slots[EnumToIndex(v)]; }
 	};
 
+	// NOTE: Derived timing data of all notes and bar lines of a course, stored as separate arrays so that drawing them only has to read contiguous memory
+	//		 instead of converting each beat to time and walking the tempo / scroll changes every frame. Lazily updated by UpdateCourseTimingCache(),
+	//		 which only recalculates the items affected by the beats the course lists have been edited at since the previous update
+	struct ChartCourseTimingCache
+	{
+		// NOTE: Indexed the same as the notes of their branch, with the tempo and scroll speed being those in effect at the head of each note
+		struct NoteTimings
+		{
+			std::vector<Time> HeadTimes;
+			std::vector<Time> TailTimes;
+			std::vector<Tempo> Tempos;
+			std::vector<f32> ScrollSpeeds;
+		};
+
+		// NOTE: Only the visible bar lines up to (and including) MaxBarBeat, which are the same for every branch
+		struct BarTimings
+		{
+			std::vector<Beat> Beats;
+			std::vector<Time> Times;
+			std::vector<Tempo> Tempos;
+			std::vector<f32> ScrollSpeeds;
+			std::vector<i32> BarIndices;
+		};
+
+		NoteTimings Notes[EnumCount<BranchType>];
+		BarTimings Bars;
+		Beat MaxBarBeat = {};
+		b8 HasBeenBuilt = false;
+
+		// NOTE: Number of items recalculated by the most recent update, mostly for debugging / benchmarking
+		size_t LastUpdateNoteCount = 0;
+		size_t LastUpdateBarCount = 0;
+	};
+
 	struct ChartCourse
 	{
 		DifficultyType Type = DifficultyType::Oni;
@@ -235,11 +271,13 @@ namespace PeepoDrumKit
 		i32 ScoreInit = 0;
 		i32 ScoreDiff = 0;
 
+		ChartCourseTimingCache TimingCache;
+
 		inline auto& GetNotes(BranchType branch) { assert(branch < BranchType::Count); return (&Notes_Normal)[EnumToIndex(branch)]; }
 		inline auto& GetNotes(BranchType branch) const { assert(branch < BranchType::Count); return (&Notes_Normal)[EnumToIndex(branch)]; }
 	};
 
-	// NOTE: Internal representation of a chart. Can then be imported / exported as .tja (and maybe as the native fumen binary format too eventually?)
+	// NOTE: Internal representation of a chart. Can then be imported / exported as .tja or (one course at a time) as the native fumen binary format
 	struct ChartProject
 	{
 		std::vector<std::unique_ptr<ChartCourse>> Courses;
@@ -278,8 +316,20 @@ namespace PeepoDrumKit
 	void DebugCompareCharts(const ChartProject& chartA, const ChartProject& chartB, DebugCompareChartsOnMessageFunc onMessageFunc, void* userData = nullptr);
 
 	Beat FindCourseMaxUsedBeat(const ChartCourse& course);
-	b8 CreateChartProjectFromTJA(const TJA::ParsedTJA& inTJA, ChartProject& out);
+	// NOTE: Must be called after editing the course and before reading its TimingCache (which is a no-op if nothing has changed). Items edited in-place
+	//		 without going through the BeatSortedList member functions need their list to be manually invalidated, just like for the cached beat ranges
+	void UpdateCourseTimingCache(ChartCourse& course, Beat maxBarBeat);
+	// NOTE: Courses are converted in parallel when a thread pool is provided, the output course order is always the same as the input order.
+	//		 The (input) indices of courses that had chart commands but failed to convert to any measures are optionally appended in ascending order
+	b8 CreateChartProjectFromTJA(const TJA::ParsedTJA& inTJA, ChartProject& out, ThreadPool* threadPool = nullptr, std::vector<size_t>* outFailedCourseIndices = nullptr);
 	b8 ConvertChartProjectToTJA(const ChartProject& in, TJA::ParsedTJA& out, b8 includePeepoDrumKitComment = true);
+
+	// NOTE: Measures are streamed directly into the output course, which is left unmodified (and false returned) for truncated or invalid files.
+	//		 The course type, level and creator are kept as they are since fumen files don't store any metadata
+	b8 CreateChartCourseFromFumen(const u8* fileContent, size_t fileSize, ChartCourse& outCourse, Time& outSongOffset);
+	// NOTE: Appends the single (default type and level) course stored inside the fumen file and sets the song offset and chart duration accordingly
+	b8 CreateChartProjectFromFumen(const u8* fileContent, size_t fileSize, ChartProject& out);
+	void ConvertChartCourseToFumen(const ChartCourse& inCourse, Time songOffset, std::vector<u8>& outFileContent, Endianness endianness = Endianness::Little);
 }
 
 namespace PeepoDrumKit
@@ -344,11 +394,11 @@ namespace PeepoDrumKit
 		b8 B8;
 		i16 I16;
 		f32 F32;
-		Beat Beat;
-		Time Time;
-		NoteType NoteType;
-		Tempo Tempo;
-		TimeSignature TimeSignature;
+		Beat BeatV;
+		Time TimeV;
+		NoteType NoteTypeV;
+		Tempo TempoV;
+		TimeSignature TimeSignatureV;
 		cstr CStr;
 
 		inline GenericMemberUnion() { ::memset(this, 0, sizeof(*this)); }
@@ -369,23 +419,23 @@ namespace PeepoDrumKit
 		inline auto& BarLineVisible() { return (*this)[GenericMember::B8_BarLineVisible].B8; }
 		inline auto& BalloonPopCount() { return (*this)[GenericMember::I16_BalloonPopCount].I16; }
 		inline auto& ScrollSpeed() { return (*this)[GenericMember::F32_ScrollSpeed].F32; }
-		inline auto& BeatStart() { return (*this)[GenericMember::Beat_Start].Beat; }
-		inline auto& BeatDuration() { return (*this)[GenericMember::Beat_Duration].Beat; }
-		inline auto& TimeOffset() { return (*this)[GenericMember::Time_Offset].Time; }
-		inline auto& NoteType() { return (*this)[GenericMember::NoteType_V].NoteType; }
-		inline auto& Tempo() { return (*this)[GenericMember::Tempo_V].Tempo; }
-		inline auto& TimeSignature() { return (*this)[GenericMember::TimeSignature_V].TimeSignature; }
+		inline auto& BeatStart() { return (*this)[GenericMember::Beat_Start].BeatV; }
+		inline auto& BeatDuration() { return (*this)[GenericMember::Beat_Duration].BeatV; }
+		inline auto& TimeOffset() { return (*this)[GenericMember::Time_Offset].TimeV; }
+		inline auto& NoteType() { return (*this)[GenericMember::NoteType_V].NoteTypeV; }
+		inline auto& Tempo() { return (*this)[GenericMember::Tempo_V].TempoV; }
+		inline auto& TimeSignature() { return (*this)[GenericMember::TimeSignature_V].TimeSignatureV; }
 		inline auto& Lyric() { return (*this)[GenericMember::CStr_Lyric].CStr; }
 		inline const auto& IsSelected() const { return (*this)[GenericMember::B8_IsSelected].B8; }
 		inline const auto& BarLineVisible() const { return (*this)[GenericMember::B8_BarLineVisible].B8; }
 		inline const auto& BalloonPopCount() const { return (*this)[GenericMember::I16_BalloonPopCount].I16; }
 		inline const auto& ScrollSpeed() const { return (*this)[GenericMember::F32_ScrollSpeed].F32; }
-		inline const auto& BeatStart() const { return (*this)[GenericMember::Beat_Start].Beat; }
-		inline const auto& BeatDuration() const { return (*this)[GenericMember::Beat_Duration].Beat; }
-		inline const auto& TimeOffset() const { return (*this)[GenericMember::Time_Offset].Time; }
-		inline const auto& NoteType() const { return (*this)[GenericMember::NoteType_V].NoteType; }
-		inline const auto& Tempo() const { return (*this)[GenericMember::Tempo_V].Tempo; }
-		inline const auto& TimeSignature() const { return (*this)[GenericMember::TimeSignature_V].TimeSignature; }
+		inline const auto& BeatStart() const { return (*this)[GenericMember::Beat_Start].BeatV; }
+		inline const auto& BeatDuration() const { return (*this)[GenericMember::Beat_Duration].BeatV; }
+		inline const auto& TimeOffset() const { return (*this)[GenericMember::Time_Offset].TimeV; }
+		inline const auto& NoteType() const { return (*this)[GenericMember::NoteType_V].NoteTypeV; }
+		inline const auto& Tempo() const { return (*this)[GenericMember::Tempo_V].TempoV; }
+		inline const auto& TimeSignature() const { return (*this)[GenericMember::TimeSignature_V].TimeSignatureV; }
 		inline const auto& Lyric() const { return (*this)[GenericMember::CStr_Lyric].CStr; }
 	};
 
@@ -395,7 +445,7 @@ namespace PeepoDrumKit
 		{
 			TempoChange Tempo;
 			TimeSignatureChange Signature;
-			Note Note;
+			Note NoteItem;
 			ScrollChange Scroll;
 			BarLineChange BarLine;
 			GoGoRange GoGo;
@@ -431,6 +481,10 @@ namespace PeepoDrumKit
 
 	size_t GetGenericMember_RawByteSize(GenericMember member);
 	size_t GetGenericListCount(const ChartCourse& course, GenericList list);
+	// NOTE: Maintained by each list itself (see BeatSortedList::GetSelectedIndices()), so only ever proportional to the number of selected items
+	const std::vector<size_t>& GetGenericListSelectedIndices(const ChartCourse& course, GenericList list);
+	size_t GetGenericListSelectedCount(const ChartCourse& course, GenericList list);
+	size_t CountSelectedChartItems(const ChartCourse& course);
 	GenericMemberFlags GetAvailableMemberFlags(GenericList list);
 
 	void* TryGetGeneric_RawVoidPtr(const ChartCourse& course, GenericList list, size_t index, GenericMember member);
@@ -443,6 +497,10 @@ namespace PeepoDrumKit
 	b8 TryRemoveGenericStruct(ChartCourse& course, GenericList list, const GenericListStruct& inValueToRemove);
 	b8 TryRemoveGenericStruct(ChartCourse& course, GenericList list, Beat beatToRemove);
 
+	// NOTE: Batched versions of the above, grouping all items by list to then merge / compact each list only once
+	void AddMultipleGenericStructs(ChartCourse& course, const std::vector<GenericListStructWithType>& inValues);
+	void RemoveMultipleGenericStructs(ChartCourse& course, const std::vector<GenericListStructWithType>& inValuesToRemove);
+
 	struct ForEachChartItemData
 	{
 		GenericList List;
@@ -451,9 +509,9 @@ namespace PeepoDrumKit
 		// NOTE: Again just little accessor helpers for the members that should always be available for each list type
 		inline b8 GetIsSelected(const ChartCourse& c) const { GenericMemberUnion v {}; TryGetGeneric(c, List, Index, GenericMember::B8_IsSelected, v); return v.B8; }
 		inline void SetIsSelected(ChartCourse& c, b8 isSelected) const { GenericMemberUnion v {}; v.B8 = isSelected; TrySetGeneric(c, List, Index, GenericMember::B8_IsSelected, v); }
-		inline Beat GetBeat(const ChartCourse& c) const { GenericMemberUnion v {}; TryGetGeneric(c, List, Index, GenericMember::Beat_Start, v); return v.Beat; }
-		inline Beat GetBeatDuration(const ChartCourse& c) const { GenericMemberUnion v {}; TryGetGeneric(c, List, Index, GenericMember::Beat_Duration, v); return v.Beat; }
-		inline void SetBeat(ChartCourse& c, Beat beat) const { GenericMemberUnion v {}; v.Beat = beat; TrySetGeneric(c, List, Index, GenericMember::Beat_Start, v); }
+		inline Beat GetBeat(const ChartCourse& c) const { GenericMemberUnion v {}; TryGetGeneric(c, List, Index, GenericMember::Beat_Start, v); return v.BeatV; }
+		inline Beat GetBeatDuration(const ChartCourse& c) const { GenericMemberUnion v {}; TryGetGeneric(c, List, Index, GenericMember::Beat_Duration, v); return v.BeatV; }
+		inline void SetBeat(ChartCourse& c, Beat beat) const { GenericMemberUnion v {}; v.BeatV = beat; TrySetGeneric(c, List, Index, GenericMember::Beat_Start, v); }
 	};
 
 	template <typename Func>
@@ -466,27 +524,16 @@ namespace PeepoDrumKit
 		}
 	}
 
+	// NOTE: Indexing into the selected indices (instead of iterating them directly) so that changing the selection from within the callback is still safe,
+	//		 as that only flips the bits of the items to then recompact the indices on the next call
 	template <typename Func>
 	void ForEachSelectedChartItem(const ChartCourse& course, Func perSelectedItemFunc)
 	{
-#if 0
 		for (GenericList list = {}; list < GenericList::Count; IncrementEnum(list))
 		{
-			for (size_t i = 0; i < GetGenericListCount(course, list); i++)
-				if (GenericMemberUnion value; TryGetGeneric(course, list, i, GenericMember::B8_IsSelected, value) && value.B8)
-					perSelectedItemFunc(ForEachChartItemData { list, i });
+			const std::vector<size_t>& selectedIndices = GetGenericListSelectedIndices(course, list);
+			for (size_t i = 0; i < selectedIndices.size(); i++)
+				perSelectedItemFunc(ForEachChartItemData { list, selectedIndices[i] });
 		}
-#else // NOTE: Manually unrolled to avoid redundant inner branches
-		for (size_t i = 0; i < course.TempoMap.Tempo.size(); i++) if (course.TempoMap.Tempo[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::TempoChanges, i });
-		for (size_t i = 0; i < course.TempoMap.Signature.size(); i++) if (course.TempoMap.Signature[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::SignatureChanges, i });
-		for (size_t i = 0; i < course.Notes_Normal.size(); i++) if (course.Notes_Normal[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::Notes_Normal, i });
-		for (size_t i = 0; i < course.Notes_Expert.size(); i++) if (course.Notes_Expert[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::Notes_Expert, i });
-		for (size_t i = 0; i < course.Notes_Master.size(); i++) if (course.Notes_Master[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::Notes_Master, i });
-		for (size_t i = 0; i < course.ScrollChanges.size(); i++) if (course.ScrollChanges[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::ScrollChanges, i });
-		for (size_t i = 0; i < course.BarLineChanges.size(); i++) if (course.BarLineChanges[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::BarLineChanges, i });
-		for (size_t i = 0; i < course.GoGoRanges.size(); i++) if (course.GoGoRanges[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::GoGoRanges, i });
-		for (size_t i = 0; i < course.Lyrics.size(); i++) if (course.Lyrics[i].IsSelected) perSelectedItemFunc(ForEachChartItemData { GenericList::Lyrics, i });
-		static_assert(EnumCount<GenericList> == 9);
-#endif
 	}
 }
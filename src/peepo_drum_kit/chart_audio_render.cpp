@@ -0,0 +1,126 @@
+#include "chart_audio_render.h"
+#include <algorithm>
+
+namespace PeepoDrumKit
+{
+	struct ScheduledSoundEffect
+	{
+		i64 StartFrame;
+		SoundEffectType Type;
+	};
+
+	static constexpr b8 IsMetronomeSoundEffect(SoundEffectType type)
+	{
+		return (type == SoundEffectType::MetronomeBar || type == SoundEffectType::MetronomeBeat);
+	}
+
+	b8 RenderChartCourseAudioOffline(const ChartProject& chart, const ChartCourse& course, const ChartAudioRenderParam& param, std::vector<i16>& outInterleavedSamples)
+	{
+		if (Audio::Engine.GetBackend() != Audio::Backend::Offline)
+			return false;
+
+		Audio::Engine.OpenStartStream();
+		if (!Audio::Engine.GetIsStreamOpenRunning())
+			return false;
+
+		constexpr u32 sampleRate = Audio::AudioEngine::OutputSampleRate;
+		constexpr u32 channelCount = Audio::AudioEngine::OutputChannelCount;
+
+		std::vector<std::pair<Time, SoundEffectType>> soundTimes;
+		if (param.NoteHitSounds)
+			ForEachNoteHitSound(course.GetNotes(param.Branch), course.TempoMap, param.DrumrollHitInterval, [&](Time time, NoteType noteType) { soundTimes.push_back({ time, SoundEffectTypeForNoteType(noteType) }); });
+
+		Time endTime = param.EndTime;
+		if (endTime <= param.StartTime)
+		{
+			static constexpr Time lastSoundTailDuration = Time::FromSec(1.0);
+			endTime = chart.ChartDuration;
+
+			if (const Audio::PCMSampleBuffer* songBuffer = Audio::Engine.GetSourceSampleBufferView(param.SongSource); songBuffer != nullptr)
+				endTime = Max(endTime, Audio::FramesToTimeOrZero(songBuffer->FrameCount, songBuffer->SampleRate) + chart.SongOffset);
+			for (const auto& [time, type] : soundTimes)
+				endTime = Max(endTime, time + lastSoundTailDuration);
+		}
+
+		if (param.Metronome)
+		{
+			course.TempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
+			{
+				const Time beatTime = course.TempoMap.BeatToTime(it.BeatTime);
+				if (beatTime >= endTime)
+					return ControlFlow::Break;
+
+				soundTimes.push_back({ beatTime, it.IsBar ? SoundEffectType::MetronomeBar : SoundEffectType::MetronomeBeat });
+				return ControlFlow::Continue;
+			});
+		}
+
+		// NOTE: Converted to absolute output frames only once so that the scheduling itself never accumulates any rounding error
+		std::vector<ScheduledSoundEffect> scheduledSounds;
+		scheduledSounds.reserve(soundTimes.size());
+		for (const auto& [time, type] : soundTimes)
+		{
+			if (time >= param.StartTime && time < endTime)
+				scheduledSounds.push_back({ Audio::TimeToFrames(time - param.StartTime, sampleRate), type });
+		}
+		std::stable_sort(scheduledSounds.begin(), scheduledSounds.end(), [](const ScheduledSoundEffect& a, const ScheduledSoundEffect& b) { return a.StartFrame < b.StartFrame; });
+
+		const i64 totalFrameCount = ClampBot<i64>(Audio::TimeToFrames(endTime - param.StartTime, sampleRate), 0);
+		outInterleavedSamples.resize(static_cast<size_t>(totalFrameCount) * channelCount);
+
+		Audio::Voice songVoice = Audio::Engine.AddVoice(param.SongSource, "ChartAudioRender Song", false, param.SongVolume, true);
+		songVoice.SetPosition(param.StartTime - chart.SongOffset);
+		songVoice.SetIsPlaying(true);
+
+		char nameBuffer[64];
+		Audio::Voice soundEffectVoices[SoundEffectsVoicePool::VoicePoolSize];
+		for (size_t i = 0; i < ArrayCount(soundEffectVoices); i++)
+		{
+			soundEffectVoices[i] = Audio::Engine.AddVoice(Audio::SourceHandle::Invalid, std::string_view(nameBuffer, sprintf_s(nameBuffer, "ChartAudioRender SoundEffect[%02zu]", i)), false);
+			soundEffectVoices[i].SetPauseOnEnd(true);
+		}
+
+		const i64 blockFrameCount = static_cast<i64>(Audio::Engine.GetBufferFrameSize());
+		const i64 streamStartFrame = Audio::Engine.GetStreamFramePosition();
+		size_t nextSoundIndex = 0, voiceRingIndex = 0;
+		b8 allBlocksRendered = true;
+
+		for (i64 blockStartFrame = 0; blockStartFrame < totalFrameCount; blockStartFrame += blockFrameCount)
+		{
+			const i64 blockEndFrame = Min(blockStartFrame + blockFrameCount, totalFrameCount);
+
+			// NOTE: Only scheduled one block ahead, the render thread then starts each voice at its exact frame within the block
+			for (; nextSoundIndex < scheduledSounds.size() && scheduledSounds[nextSoundIndex].StartFrame < blockEndFrame; nextSoundIndex++)
+			{
+				const ScheduledSoundEffect& sound = scheduledSounds[nextSoundIndex];
+				const Audio::SourceHandle source = param.SoundEffectSources[EnumToIndex(sound.Type)];
+				if (source == Audio::SourceHandle::Invalid)
+					continue;
+
+				Audio::Voice voice = soundEffectVoices[voiceRingIndex];
+				voice.SetIsPlaying(false);
+				voice.SetSource(source);
+				voice.SetVolume(IsMetronomeSoundEffect(sound.Type) ? param.MetronomeVolume : param.SoundEffectVolume);
+				Audio::Engine.ScheduleVoiceStart(voice, streamStartFrame + sound.StartFrame);
+
+				if (++voiceRingIndex >= ArrayCount(soundEffectVoices))
+					voiceRingIndex = 0;
+			}
+
+			if (!Audio::Engine.RenderOfflineFrames(&outInterleavedSamples[static_cast<size_t>(blockStartFrame) * channelCount], blockEndFrame - blockStartFrame))
+			{
+				allBlocksRendered = false;
+				break;
+			}
+		}
+
+		for (Audio::Voice& voice : soundEffectVoices)
+			Audio::Engine.RemoveVoice(voice);
+		Audio::Engine.RemoveVoice(songVoice);
+
+		// NOTE: Without a render thread of its own the voice removals would otherwise only be executed during the next render
+		Audio::Engine.StopCloseStream();
+
+		return allBlocksRendered;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "core_types.h"
+#include "chart.h"
+#include "chart_editor_sound.h"
+#include "audio/audio_engine.h"
+
+namespace PeepoDrumKit
+{
+	struct ChartAudioRenderParam
+	{
+		// NOTE: Expected to have already been loaded (and resampled to the output sample rate), any invalid source is simply rendered as silence
+		Audio::SourceHandle SongSource = Audio::SourceHandle::Invalid;
+		Audio::SourceHandle SoundEffectSources[EnumCount<SoundEffectType>] = { Audio::SourceHandle::Invalid, Audio::SourceHandle::Invalid, Audio::SourceHandle::Invalid, Audio::SourceHandle::Invalid, };
+
+		BranchType Branch = BranchType::Normal;
+		b8 NoteHitSounds = true;
+		b8 Metronome = false;
+		Beat DrumrollHitInterval = GetGridBeatSnap(16);
+
+		f32 SongVolume = 1.0f;
+		f32 SoundEffectVolume = 1.0f;
+		f32 MetronomeVolume = 1.0f;
+
+		// NOTE: In chart time space. An end time at or before the start time renders up until the end of the chart duration, song or last hit sound (whichever comes last)
+		Time StartTime = Time::Zero();
+		Time EndTime = Time::Zero();
+	};
+
+	// NOTE: Unlike the editor, which reacts to a moving cursor each frame, all hit sounds and metronome ticks are scheduled upfront relative to the rendered frame count
+	//		 so that the output only depends on the input and is identical between runs. Requires the audio engine to be using Audio::Backend::Offline,
+	//		 whose stream is opened and then closed again once finished. Outputs interleaved samples using the engine output channel count and sample rate
+	b8 RenderChartCourseAudioOffline(const ChartProject& chart, const ChartCourse& course, const ChartAudioRenderParam& param, std::vector<i16>& outInterleavedSamples);
+}
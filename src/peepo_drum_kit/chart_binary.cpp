@@ -0,0 +1,363 @@
+#include "chart_binary.h"
+#include "core_io.h"
+
+namespace PeepoDrumKit
+{
+	static constexpr char ChartBinaryMagic[4] = { 'P', 'D', 'K', 'C' };
+	// NOTE: Written in native byte order so that loading a file on a machine with a different endianness can be detected and rejected
+	static constexpr u32 ChartBinaryByteOrderMarker = 0x01020304;
+	static constexpr size_t ChartBinaryArrayAlignment = 8;
+
+	struct ChartBinaryStringRef { u32 Offset, Size; };
+	struct ChartBinaryArrayRef { u32 Offset, Count; };
+
+	struct ChartBinaryHeader
+	{
+		char Magic[4];
+		u32 ByteOrderMarker;
+		u32 Version;
+		u32 HeaderSize;
+		u64 FileSize;
+
+		u32 CourseCount;
+		u32 CourseTableOffset;
+		u32 StringTableOffset;
+		u32 StringTableSize;
+
+		f64 ChartDuration;
+		f64 SongOffset;
+		f64 SongDemoStartTime;
+		f64 MovieOffset;
+		f32 SongVolume;
+		f32 SoundEffectVolume;
+
+		ChartBinaryStringRef ChartTitle[EnumCount<Language>];
+		ChartBinaryStringRef ChartSubtitle[EnumCount<Language>];
+		ChartBinaryStringRef ChartCreator;
+		ChartBinaryStringRef ChartGenre;
+		ChartBinaryStringRef ChartLyricsFileName;
+		ChartBinaryStringRef SongFileName;
+		ChartBinaryStringRef BackgroundImageFileName;
+		ChartBinaryStringRef BackgroundMovieFileName;
+	};
+
+	struct ChartBinaryCourse
+	{
+		u8 Type;
+		u8 Level;
+		u8 Reserved[2];
+		i32 ScoreInit;
+		i32 ScoreDiff;
+		ChartBinaryStringRef CourseCreator;
+
+		ChartBinaryArrayRef TempoChanges;
+		ChartBinaryArrayRef SignatureChanges;
+		ChartBinaryArrayRef Notes[EnumCount<BranchType>];
+		ChartBinaryArrayRef ScrollChanges;
+		ChartBinaryArrayRef BarLineChanges;
+		ChartBinaryArrayRef GoGoRanges;
+		ChartBinaryArrayRef Lyrics;
+	};
+
+	// NOTE: Only the lyric text has to be moved out into the string table, all other list items are stored exactly as they are laid out in memory
+	struct ChartBinaryLyric
+	{
+		Beat BeatTime;
+		ChartBinaryStringRef Lyric;
+	};
+
+	static_assert(sizeof(ChartBinaryHeader) == 224 && sizeof(ChartBinaryCourse) == 92, "Changing the file layout requires incrementing ChartBinaryVersion");
+	static_assert(sizeof(Note) == 32 && sizeof(TempoChange) == 12 && sizeof(TimeSignatureChange) == 16 && sizeof(ScrollChange) == 12, "Changing the file layout requires incrementing ChartBinaryVersion");
+	static_assert(sizeof(BarLineChange) == 8 && sizeof(GoGoRange) == 20 && sizeof(ChartBinaryLyric) == 12, "Changing the file layout requires incrementing ChartBinaryVersion");
+	static_assert(std::is_trivially_copyable_v<Note> && std::is_trivially_copyable_v<TempoChange> && std::is_trivially_copyable_v<TimeSignatureChange>);
+	static_assert(std::is_trivially_copyable_v<ScrollChange> && std::is_trivially_copyable_v<BarLineChange> && std::is_trivially_copyable_v<GoGoRange>);
+
+	static constexpr Beat GetBeat(const ChartBinaryLyric& v) { return v.BeatTime; }
+
+	// NOTE: b8 is a bool, so any stored byte other than 0 or 1 has to be rejected *before* copying it into an item where reading it would be undefined behavior
+	struct ChartBinaryBoolMemberOffsets { size_t Count; size_t Offsets[2]; };
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const Note*) { return { 1, { offsetof(Note, IsSelected) } }; }
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const TempoChange*) { return { 1, { offsetof(TempoChange, IsSelected) } }; }
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const TimeSignatureChange*) { return { 1, { offsetof(TimeSignatureChange, IsSelected) } }; }
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const ScrollChange*) { return { 1, { offsetof(ScrollChange, IsSelected) } }; }
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const BarLineChange*) { return { 2, { offsetof(BarLineChange, IsVisible), offsetof(BarLineChange, IsSelected) } }; }
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const GoGoRange*) { return { 1, { offsetof(GoGoRange, IsSelected) } }; }
+	static constexpr ChartBinaryBoolMemberOffsets GetBoolMemberOffsets(const ChartBinaryLyric*) { return { 0, {} }; }
+
+	// NOTE: Note types are used as array indices and time signatures as divisors all over the place, so these can't just be trusted blindly either
+	static constexpr b8 IsValidItem(const Note& v) { return (v.Type < NoteType::Count) && (v.BeatDuration.Ticks >= 0); }
+	static constexpr b8 IsValidItem(const TempoChange& v) { return true; }
+	static constexpr b8 IsValidItem(const TimeSignatureChange& v) { return (v.Signature.Numerator > 0) && (v.Signature.Denominator > 0); }
+	static constexpr b8 IsValidItem(const ScrollChange& v) { return true; }
+	static constexpr b8 IsValidItem(const BarLineChange& v) { return true; }
+	static constexpr b8 IsValidItem(const GoGoRange& v) { return (v.BeatDuration.Ticks >= 0); }
+	static constexpr b8 IsValidItem(const ChartBinaryLyric& v) { return true; }
+
+	// NOTE: Transient editor state (selection, animations, render temps) is reset so that saving the same chart always produces the exact same bytes
+	static void CopyPersistentMembers(const Note& in, Note& out) { out.BeatTime = in.BeatTime; out.BeatDuration = in.BeatDuration; out.TimeOffset = in.TimeOffset; out.Type = in.Type; out.BalloonPopCount = in.BalloonPopCount; }
+	static void CopyPersistentMembers(const TempoChange& in, TempoChange& out) { out.BeatTime = in.BeatTime; out.TempoValue = in.TempoValue; }
+	static void CopyPersistentMembers(const TimeSignatureChange& in, TimeSignatureChange& out) { out.BeatTime = in.BeatTime; out.Signature = in.Signature; }
+	static void CopyPersistentMembers(const ScrollChange& in, ScrollChange& out) { out.BeatTime = in.BeatTime; out.ScrollSpeed = in.ScrollSpeed; }
+	static void CopyPersistentMembers(const BarLineChange& in, BarLineChange& out) { out.BeatTime = in.BeatTime; out.IsVisible = in.IsVisible; }
+	static void CopyPersistentMembers(const GoGoRange& in, GoGoRange& out) { out.BeatTime = in.BeatTime; out.BeatDuration = in.BeatDuration; out.ExpansionAnimationCurrent = 0.0f; out.ExpansionAnimationTarget = 1.0f; }
+
+	struct ChartBinaryWriter
+	{
+		std::vector<u8>& Buffer;
+		std::string StringTable;
+
+		inline ChartBinaryStringRef AddString(std::string_view value)
+		{
+			const ChartBinaryStringRef result { static_cast<u32>(StringTable.size()), static_cast<u32>(value.size()) };
+			StringTable += value;
+			return result;
+		}
+
+		inline u32 AllocateAligned(size_t byteSize)
+		{
+			const size_t offset = (Buffer.size() + (ChartBinaryArrayAlignment - 1)) & ~(ChartBinaryArrayAlignment - 1);
+			Buffer.resize(offset + byteSize, 0x00);
+			return static_cast<u32>(offset);
+		}
+
+		template <typename T>
+		ChartBinaryArrayRef WriteArray(const std::vector<T>& items)
+		{
+			const ChartBinaryArrayRef result { AllocateAligned(items.size() * sizeof(T)), static_cast<u32>(items.size()) };
+			for (size_t i = 0; i < items.size(); i++)
+			{
+				// NOTE: Explicitly zero out any padding bytes too
+				T persistentItem; memset(&persistentItem, 0, sizeof(T));
+				CopyPersistentMembers(items[i], persistentItem);
+				memcpy(&Buffer[result.Offset + (i * sizeof(T))], &persistentItem, sizeof(T));
+			}
+			return result;
+		}
+
+		ChartBinaryArrayRef WriteLyricsArray(const std::vector<LyricChange>& lyrics)
+		{
+			const ChartBinaryArrayRef result { AllocateAligned(lyrics.size() * sizeof(ChartBinaryLyric)), static_cast<u32>(lyrics.size()) };
+			for (size_t i = 0; i < lyrics.size(); i++)
+			{
+				const ChartBinaryLyric binaryLyric { lyrics[i].BeatTime, AddString(lyrics[i].Lyric) };
+				memcpy(&Buffer[result.Offset + (i * sizeof(ChartBinaryLyric))], &binaryLyric, sizeof(ChartBinaryLyric));
+			}
+			return result;
+		}
+	};
+
+	void SaveChartProjectToBinary(const ChartProject& in, std::vector<u8>& outFileContent)
+	{
+		outFileContent.clear();
+		ChartBinaryWriter writer { outFileContent };
+
+		ChartBinaryHeader header; memset(&header, 0, sizeof(header));
+		const u32 headerOffset = writer.AllocateAligned(sizeof(ChartBinaryHeader));
+		header.CourseCount = static_cast<u32>(in.Courses.size());
+		header.CourseTableOffset = writer.AllocateAligned(in.Courses.size() * sizeof(ChartBinaryCourse));
+
+		for (size_t courseIndex = 0; courseIndex < in.Courses.size(); courseIndex++)
+		{
+			const ChartCourse& inCourse = *in.Courses[courseIndex];
+			ChartBinaryCourse outCourse; memset(&outCourse, 0, sizeof(outCourse));
+
+			outCourse.Type = static_cast<u8>(inCourse.Type);
+			outCourse.Level = static_cast<u8>(inCourse.Level);
+			outCourse.ScoreInit = inCourse.ScoreInit;
+			outCourse.ScoreDiff = inCourse.ScoreDiff;
+			outCourse.CourseCreator = writer.AddString(inCourse.CourseCreator);
+
+			outCourse.TempoChanges = writer.WriteArray(inCourse.TempoMap.Tempo.Sorted);
+			outCourse.SignatureChanges = writer.WriteArray(inCourse.TempoMap.Signature.Sorted);
+			for (BranchType branch = {}; branch < BranchType::Count; IncrementEnum(branch))
+				outCourse.Notes[EnumToIndex(branch)] = writer.WriteArray(inCourse.GetNotes(branch).Sorted);
+			outCourse.ScrollChanges = writer.WriteArray(inCourse.ScrollChanges.Sorted);
+			outCourse.BarLineChanges = writer.WriteArray(inCourse.BarLineChanges.Sorted);
+			outCourse.GoGoRanges = writer.WriteArray(inCourse.GoGoRanges.Sorted);
+			outCourse.Lyrics = writer.WriteLyricsArray(inCourse.Lyrics.Sorted);
+
+			memcpy(&outFileContent[header.CourseTableOffset + (courseIndex * sizeof(ChartBinaryCourse))], &outCourse, sizeof(outCourse));
+		}
+
+		memcpy(header.Magic, ChartBinaryMagic, sizeof(header.Magic));
+		header.ByteOrderMarker = ChartBinaryByteOrderMarker;
+		header.Version = ChartBinaryVersion;
+		header.HeaderSize = sizeof(ChartBinaryHeader);
+		header.ChartDuration = in.ChartDuration.Seconds;
+		header.SongOffset = in.SongOffset.Seconds;
+		header.SongDemoStartTime = in.SongDemoStartTime.Seconds;
+		header.MovieOffset = in.MovieOffset.Seconds;
+		header.SongVolume = in.SongVolume;
+		header.SoundEffectVolume = in.SoundEffectVolume;
+		for (Language language = {}; language < Language::Count; IncrementEnum(language))
+		{
+			header.ChartTitle[EnumToIndex(language)] = writer.AddString(in.ChartTitle[language]);
+			header.ChartSubtitle[EnumToIndex(language)] = writer.AddString(in.ChartSubtitle[language]);
+		}
+		header.ChartCreator = writer.AddString(in.ChartCreator);
+		header.ChartGenre = writer.AddString(in.ChartGenre);
+		header.ChartLyricsFileName = writer.AddString(in.ChartLyricsFileName);
+		header.SongFileName = writer.AddString(in.SongFileName);
+		header.BackgroundImageFileName = writer.AddString(in.BackgroundImageFileName);
+		header.BackgroundMovieFileName = writer.AddString(in.BackgroundMovieFileName);
+
+		header.StringTableSize = static_cast<u32>(writer.StringTable.size());
+		header.StringTableOffset = writer.AllocateAligned(writer.StringTable.size());
+		memcpy(outFileContent.data() + header.StringTableOffset, writer.StringTable.data(), writer.StringTable.size());
+
+		header.FileSize = outFileContent.size();
+		memcpy(&outFileContent[headerOffset], &header, sizeof(header));
+	}
+
+	b8 SaveChartProjectToBinaryFile(const ChartProject& in, std::string_view filePath)
+	{
+		std::vector<u8> fileContent;
+		SaveChartProjectToBinary(in, fileContent);
+		return File::WriteAllBytes(filePath, fileContent.data(), fileContent.size());
+	}
+
+	struct ChartBinaryReader
+	{
+		const u8* FileContent;
+		size_t FileSize;
+		std::string_view StringTable;
+
+		inline b8 IsInBounds(u64 offset, u64 byteSize) const { return (offset <= FileSize) && (byteSize <= (FileSize - offset)); }
+
+		inline b8 TryReadString(ChartBinaryStringRef ref, std::string& out) const
+		{
+			if ((static_cast<u64>(ref.Offset) + ref.Size) > StringTable.size())
+				return false;
+			out.assign(StringTable.data() + ref.Offset, ref.Size);
+			return true;
+		}
+
+		template <typename T>
+		b8 TryReadArray(ChartBinaryArrayRef ref, std::vector<T>& out) const
+		{
+			const u64 byteSize = static_cast<u64>(ref.Count) * sizeof(T);
+			if (!IsInBounds(ref.Offset, byteSize))
+				return false;
+
+			const ChartBinaryBoolMemberOffsets boolMembers = GetBoolMemberOffsets(static_cast<const T*>(nullptr));
+			for (size_t i = 0; i < ref.Count; i++)
+			{
+				for (size_t m = 0; m < boolMembers.Count; m++)
+				{
+					if (FileContent[ref.Offset + (i * sizeof(T)) + boolMembers.Offsets[m]] > 1)
+						return false;
+				}
+			}
+
+			out.resize(ref.Count);
+			if (ref.Count > 0)
+				memcpy(out.data(), FileContent + ref.Offset, static_cast<size_t>(byteSize));
+
+			// NOTE: Every BeatSortedList relies on its items being sorted by beat for all of its binary searches
+			for (size_t i = 0; i < out.size(); i++)
+			{
+				if (GetBeat(out[i]).Ticks < 0 || (i > 0 && GetBeat(out[i]) < GetBeat(out[i - 1])) || !IsValidItem(out[i]))
+					return false;
+			}
+			return true;
+		}
+
+		b8 TryReadLyricsArray(ChartBinaryArrayRef ref, std::vector<LyricChange>& out) const
+		{
+			std::vector<ChartBinaryLyric> binaryLyrics;
+			if (!TryReadArray(ref, binaryLyrics))
+				return false;
+			out.resize(binaryLyrics.size());
+			for (size_t i = 0; i < binaryLyrics.size(); i++)
+			{
+				out[i].BeatTime = binaryLyrics[i].BeatTime;
+				if (!TryReadString(binaryLyrics[i].Lyric, out[i].Lyric))
+					return false;
+			}
+			return true;
+		}
+	};
+
+	b8 LoadChartProjectFromBinary(const u8* fileContent, size_t fileSize, ChartProject& out)
+	{
+		if (fileContent == nullptr || fileSize < sizeof(ChartBinaryHeader))
+			return false;
+
+		ChartBinaryHeader header;
+		memcpy(&header, fileContent, sizeof(header));
+
+		if (memcmp(header.Magic, ChartBinaryMagic, sizeof(ChartBinaryMagic)) != 0 || header.ByteOrderMarker != ChartBinaryByteOrderMarker)
+			return false;
+		if (header.Version != ChartBinaryVersion || header.HeaderSize != sizeof(ChartBinaryHeader) || header.FileSize != fileSize)
+			return false;
+
+		ChartBinaryReader reader { fileContent, fileSize };
+		if (!reader.IsInBounds(header.CourseTableOffset, static_cast<u64>(header.CourseCount) * sizeof(ChartBinaryCourse)) || !reader.IsInBounds(header.StringTableOffset, header.StringTableSize))
+			return false;
+		reader.StringTable = std::string_view(reinterpret_cast<const char*>(fileContent + header.StringTableOffset), header.StringTableSize);
+
+		ChartProject loaded {};
+		loaded.ChartDuration = Time::FromSec(header.ChartDuration);
+		loaded.SongOffset = Time::FromSec(header.SongOffset);
+		loaded.SongDemoStartTime = Time::FromSec(header.SongDemoStartTime);
+		loaded.MovieOffset = Time::FromSec(header.MovieOffset);
+		loaded.SongVolume = header.SongVolume;
+		loaded.SoundEffectVolume = header.SoundEffectVolume;
+
+		b8 allValid = true;
+		for (Language language = {}; language < Language::Count; IncrementEnum(language))
+		{
+			allValid &= reader.TryReadString(header.ChartTitle[EnumToIndex(language)], loaded.ChartTitle[language]);
+			allValid &= reader.TryReadString(header.ChartSubtitle[EnumToIndex(language)], loaded.ChartSubtitle[language]);
+		}
+		allValid &= reader.TryReadString(header.ChartCreator, loaded.ChartCreator);
+		allValid &= reader.TryReadString(header.ChartGenre, loaded.ChartGenre);
+		allValid &= reader.TryReadString(header.ChartLyricsFileName, loaded.ChartLyricsFileName);
+		allValid &= reader.TryReadString(header.SongFileName, loaded.SongFileName);
+		allValid &= reader.TryReadString(header.BackgroundImageFileName, loaded.BackgroundImageFileName);
+		allValid &= reader.TryReadString(header.BackgroundMovieFileName, loaded.BackgroundMovieFileName);
+		if (!allValid)
+			return false;
+
+		loaded.Courses.reserve(header.CourseCount);
+		for (u32 courseIndex = 0; courseIndex < header.CourseCount; courseIndex++)
+		{
+			ChartBinaryCourse inCourse;
+			memcpy(&inCourse, fileContent + header.CourseTableOffset + (courseIndex * sizeof(ChartBinaryCourse)), sizeof(inCourse));
+			if (inCourse.Type >= EnumToIndex(DifficultyType::Count))
+				return false;
+
+			ChartCourse& outCourse = *loaded.Courses.emplace_back(std::make_unique<ChartCourse>());
+			outCourse.Type = static_cast<DifficultyType>(inCourse.Type);
+			outCourse.Level = Clamp(static_cast<DifficultyLevel>(inCourse.Level), DifficultyLevel::Min, DifficultyLevel::Max);
+			outCourse.ScoreInit = inCourse.ScoreInit;
+			outCourse.ScoreDiff = inCourse.ScoreDiff;
+
+			allValid &= reader.TryReadString(inCourse.CourseCreator, outCourse.CourseCreator);
+			allValid &= reader.TryReadArray(inCourse.TempoChanges, outCourse.TempoMap.Tempo.Sorted);
+			allValid &= reader.TryReadArray(inCourse.SignatureChanges, outCourse.TempoMap.Signature.Sorted);
+			for (BranchType branch = {}; branch < BranchType::Count; IncrementEnum(branch))
+				allValid &= reader.TryReadArray(inCourse.Notes[EnumToIndex(branch)], outCourse.GetNotes(branch).Sorted);
+			allValid &= reader.TryReadArray(inCourse.ScrollChanges, outCourse.ScrollChanges.Sorted);
+			allValid &= reader.TryReadArray(inCourse.BarLineChanges, outCourse.BarLineChanges.Sorted);
+			allValid &= reader.TryReadArray(inCourse.GoGoRanges, outCourse.GoGoRanges.Sorted);
+			allValid &= reader.TryReadLyricsArray(inCourse.Lyrics, outCourse.Lyrics.Sorted);
+			if (!allValid)
+				return false;
+
+			outCourse.TempoMap.RebuildAccelerationStructure();
+		}
+
+		out = std::move(loaded);
+		return true;
+	}
+
+	b8 LoadChartProjectFromBinaryFile(std::string_view filePath, ChartProject& out)
+	{
+		File::MemoryMappedFile mappedFile;
+		if (!mappedFile.Open(filePath))
+			return false;
+
+		return LoadChartProjectFromBinary(mappedFile.Content, mappedFile.Size, out);
+	}
+}
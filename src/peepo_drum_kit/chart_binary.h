@@ -0,0 +1,23 @@
+#pragma once
+#include "core_types.h"
+#include "chart.h"
+
+namespace PeepoDrumKit
+{
+	// NOTE: Native versioned little-endian binary chart project format. Every BeatSortedList is stored as a raw array of its fixed size items
+	//		 and all strings (metadata and lyrics) are stored inside a single string table, so that loading a file only has to validate
+	//		 the header, array bounds and item values before copying each array over as a whole, instead of having to tokenize and parse any text
+	constexpr std::string_view ChartBinaryExtension = ".pdkchart";
+	constexpr std::string_view ChartBinaryFilterName = "Peepo Drum Kit Chart";
+	constexpr std::string_view ChartBinaryFilterSpec = "*.pdkchart";
+
+	// NOTE: Must be incremented whenever the layout of any of the stored structs changes, older versions are rejected instead of being upgraded
+	constexpr u32 ChartBinaryVersion = 1;
+
+	void SaveChartProjectToBinary(const ChartProject& in, std::vector<u8>& outFileContent);
+	b8 SaveChartProjectToBinaryFile(const ChartProject& in, std::string_view filePath);
+
+	// NOTE: Returns false (without modifying the output chart) for truncated, corrupted or incompatible files
+	b8 LoadChartProjectFromBinary(const u8* fileContent, size_t fileSize, ChartProject& out);
+	b8 LoadChartProjectFromBinaryFile(std::string_view filePath, ChartProject& out);
+}
@@ -3,6 +3,9 @@
 #include "chart_editor_undo.h"
 #include "audio/audio_file_formats.h"
 #include "chart_editor_i18n.h"
+#include "core_thread_pool.h"
+#include "chart_binary.h"
+#include "file_format_fumen.h"
 
 namespace PeepoDrumKit
 {
@@ -27,14 +30,31 @@ namespace PeepoDrumKit
 
 	static b8 CanOpenChartDirectoryInFileExplorer(const ChartContext& context)
 	{
+#if PEEPO_WIN32
 		return !context.ChartFilePath.empty();
+#else
+		return false;
+#endif
 	}
 
 	static void OpenChartDirectoryInFileExplorer(const ChartContext& context)
 	{
+#if PEEPO_WIN32
 		const std::string_view chartDirectory = Path::GetDirectoryName(context.ChartFilePath);
 		if (!chartDirectory.empty() && Directory::Exists(chartDirectory))
 			Shell::OpenInExplorer(chartDirectory);
+#else
+		assert(!"Unreachable");
+#endif
+	}
+
+	static void ShowChartFileErrorMessageBox(std::string_view description, std::string_view filePath)
+	{
+		std::string message;
+		message.append(description).append(":\n\"").append(filePath).append("\"");
+		printf("%.*s\n", FmtStrViewArgs(message));
+
+		Shell::ShowMessageBox(message, "Peepo Drum Kit - File Error", Shell::MessageBoxButtons::OK, Shell::MessageBoxIcon::Error, ApplicationHost::GlobalState.NativeWindowHandle);
 	}
 
 	static void SetChartDefaultSettingsAndCourses(ChartProject& outChart)
@@ -82,6 +102,7 @@ namespace PeepoDrumKit
 
 	ChartEditor::~ChartEditor()
 	{
+		CancelAsyncSongDecoding();
 		context.SfxVoicePool.UnloadAllSourcesAndVoices();
 	}
 
@@ -132,8 +153,8 @@ namespace PeepoDrumKit
 				Gui::EndMenu();
 			}
 
-			size_t selectedItemCount = 0, selectedNoteCount = 0;
-			ForEachSelectedChartItem(*context.ChartSelectedCourse, [&](const ForEachChartItemData& it) { selectedItemCount++; selectedNoteCount += IsNotesList(it.List); });
+			const size_t selectedItemCount = CountSelectedChartItems(*context.ChartSelectedCourse);
+			const size_t selectedNoteCount = context.ChartSelectedCourse->Notes_Normal.GetSelectedCount() + context.ChartSelectedCourse->Notes_Expert.GetSelectedCount() + context.ChartSelectedCourse->Notes_Master.GetSelectedCount();
 			const b8 isAnyItemSelected = (selectedItemCount > 0);
 			const b8 isAnyNoteSelected = (selectedNoteCount > 0);
 
@@ -568,6 +589,7 @@ namespace PeepoDrumKit
 	void ChartEditor::DrawGui()
 	{
 		InternalUpdateAsyncLoading();
+		Audio::Engine.FreeRetiredSourceBuffers();
 
 		if (tryToCloseApplicationOnNextFrame)
 		{
@@ -612,10 +634,13 @@ namespace PeepoDrumKit
 			context.SfxVoicePool.BaseVolumeSfx = context.Chart.SoundEffectVolume;
 		}
 
+		// NOTE: Apply playback speed pitch setting
+		context.SongVoice.SetPreservePitch(*Settings.Audio.PreservePitchAtVariablePlaybackSpeed);
+
 		// NOTE: Drag and drop handling
 		for (const std::string& droppedFilePath : ApplicationHost::GlobalState.FilePathsDroppedThisFrame)
 		{
-			if (Path::HasAnyExtension(droppedFilePath, TJA::Extension)) { CheckOpenSaveConfirmationPopupThenCall([this, pathCopy = droppedFilePath] { StartAsyncImportingChartFile(pathCopy); }); break; }
+			if (Path::HasExtension(droppedFilePath, TJA::Extension) || Path::HasExtension(droppedFilePath, ChartBinaryExtension) || Path::HasExtension(droppedFilePath, Fumen::Extension)) { CheckOpenSaveConfirmationPopupThenCall([this, pathCopy = droppedFilePath] { StartAsyncImportingChartFile(pathCopy); }); break; }
 			if (Path::HasAnyExtension(droppedFilePath, Audio::SupportedFileFormatExtensionsPacked)) { SetAndStartLoadingChartSongFileName(droppedFilePath, context.Undo); break; }
 		}
 
@@ -834,7 +859,7 @@ namespace PeepoDrumKit
 						// DEBUG: TJA bug hunting
 						if (exportDebugViewData.RoundTripCheck)
 						{
-							std::vector<TJA::Token> tempTokens = TJA::TokenizeLines(TJA::SplitLines(exportDebugViewData.Text));
+							std::vector<TJA::Token> tempTokens = TJA::TokenizeFileContent(exportDebugViewData.Text);
 							TJA::ErrorList tempErrors;
 							TJA::ParsedTJA tempTJA = TJA::ParseTokens(tempTokens, tempErrors);
 							exportDebugViewData.DebugChart = {}; CreateChartProjectFromTJA(tempTJA, exportDebugViewData.DebugChart); exportDebugViewData.DebugLog.clear();
@@ -1048,13 +1073,27 @@ namespace PeepoDrumKit
 		timeline.Camera.ZoomTarget = vec2(1.0f);
 	}
 
-	void ChartEditor::SaveChart(ChartContext& context, std::string_view filePath)
+	b8 ChartEditor::SaveChart(ChartContext& context, std::string_view filePath)
 	{
 		if (filePath.empty())
 			filePath = context.ChartFilePath;
 
 		assert(!filePath.empty());
-		if (!filePath.empty())
+		if (!filePath.empty() && Path::HasExtension(filePath, ChartBinaryExtension))
+		{
+			// NOTE: Keep the pending changes flag (and the previous file path) on failure so that nothing is ever silently lost
+			if (!SaveChartProjectToBinaryFile(context.Chart, filePath))
+			{
+				ShowChartFileErrorMessageBox("Failed to save binary chart file", filePath);
+				return false;
+			}
+
+			context.ChartFilePath = filePath;
+			context.Undo.ClearChangesWereMade();
+
+			PersistentApp.RecentFiles.Add(std::string { filePath });
+		}
+		else if (!filePath.empty())
 		{
 			TJA::ParsedTJA tja;
 			ConvertChartProjectToTJA(context.Chart, tja);
@@ -1071,13 +1110,18 @@ namespace PeepoDrumKit
 				createBackupOfOriginalTJABeforeOverwriteSave = false;
 			}
 
-			File::WriteAllBytes(filePath, tjaText);
+			if (!File::WriteAllBytes(filePath, tjaText))
+			{
+				ShowChartFileErrorMessageBox("Failed to save TJA chart file", filePath);
+				return false;
+			}
 
 			context.ChartFilePath = filePath;
 			context.Undo.ClearChangesWereMade();
 
 			PersistentApp.RecentFiles.Add(std::string { filePath });
 		}
+		return !filePath.empty();
 	}
 
 	b8 ChartEditor::OpenChartSaveAsDialog(ChartContext& context)
@@ -1093,14 +1137,13 @@ namespace PeepoDrumKit
 		fileDialog.InTitle = "Save Chart As";
 		fileDialog.InFileName = getChartFileNameWithoutExtensionOrDefault(context);
 		fileDialog.InDefaultExtension = TJA::Extension;
-		fileDialog.InFilters = { { TJA::FilterName, TJA::FilterSpec }, { Shell::AllFilesFilterName, Shell::AllFilesFilterSpec }, };
+		fileDialog.InFilters = { { TJA::FilterName, TJA::FilterSpec }, { ChartBinaryFilterName, ChartBinaryFilterSpec }, { Shell::AllFilesFilterName, Shell::AllFilesFilterSpec }, };
 		fileDialog.InParentWindowHandle = ApplicationHost::GlobalState.NativeWindowHandle;
 
 		if (fileDialog.OpenSave() != Shell::FileDialogResult::OK)
 			return false;
 
-		SaveChart(context, fileDialog.OutFilePath);
-		return true;
+		return SaveChart(context, fileDialog.OutFilePath);
 	}
 
 	b8 ChartEditor::TrySaveChartOrOpenSaveAsDialog(ChartContext& context)
@@ -1108,8 +1151,7 @@ namespace PeepoDrumKit
 		if (context.ChartFilePath.empty())
 			return OpenChartSaveAsDialog(context);
 		else
-			SaveChart(context);
-		return true;
+			return SaveChart(context);
 	}
 
 	void ChartEditor::StartAsyncImportingChartFile(std::string_view absoluteChartFilePath)
@@ -1123,10 +1165,28 @@ namespace PeepoDrumKit
 			AsyncImportChartResult result {};
 			result.ChartFilePath = std::move(tempPathCopy);
 
+			// NOTE: Binary charts are always written by PeepoDrumKit itself, so there is no TJA data to keep around and no need to create a backup either
+			if (Path::HasExtension(result.ChartFilePath, ChartBinaryExtension))
+			{
+				result.IsBinaryChart = true;
+				if (!LoadChartProjectFromBinaryFile(result.ChartFilePath, result.Chart))
+					result.ErrorDescription = "Failed to load binary chart file";
+				return result;
+			}
+
 			auto[fileContent, fileSize] = File::ReadAllBytes(result.ChartFilePath);
 			if (fileContent == nullptr || fileSize == 0)
 			{
-				printf("Failed to read file '%.*s'\n", FmtStrViewArgs(result.ChartFilePath));
+				result.ErrorDescription = "Failed to read chart file";
+				return result;
+			}
+
+			// NOTE: Fumen files only contain a single course without any metadata, so they are imported as a new chart instead of being opened for editing in place
+			if (Path::HasExtension(result.ChartFilePath, Fumen::Extension))
+			{
+				result.IsFumenCourse = true;
+				if (!CreateChartProjectFromFumen(fileContent.get(), fileSize, result.Chart))
+					result.ErrorDescription = "Failed to import fumen chart file";
 				return result;
 			}
 
@@ -1138,13 +1198,14 @@ namespace PeepoDrumKit
 			else
 				result.TJA.FileContentUTF8 = UTF8::FromShiftJIS(fileContentView);
 
-			result.TJA.Lines = TJA::SplitLines(result.TJA.FileContentUTF8);
-			result.TJA.Tokens = TJA::TokenizeLines(result.TJA.Lines);
+			result.TJA.Tokens = TJA::TokenizeFileContent(result.TJA.FileContentUTF8);
 			result.TJA.Parsed = ParseTokens(result.TJA.Tokens, result.TJA.ParseErrors);
 
-			if (!CreateChartProjectFromTJA(result.TJA.Parsed, result.Chart))
+			// NOTE: The importing thread itself helps out while waiting, so one less worker thread than there are courses is needed
+			ThreadPool courseThreadPool { ClampBot(static_cast<i32>(result.TJA.Parsed.Courses.size()) - 1, 1) };
+			if (!CreateChartProjectFromTJA(result.TJA.Parsed, result.Chart, &courseThreadPool))
 			{
-				printf("Failed to create chart from TJA file '%.*s'\n", FmtStrViewArgs(result.ChartFilePath));
+				result.ErrorDescription = "Failed to create chart from TJA file";
 				return result;
 			}
 
@@ -1157,6 +1218,9 @@ namespace PeepoDrumKit
 		if (loadSongFuture.valid())
 			loadSongFuture.get();
 
+		// NOTE: The previous song source is about to be unloaded, so its decoder must no longer be writing into the sample buffer by then
+		CancelAsyncSongDecoding();
+
 		context.SongWaveformFadeAnimationTarget = 0.0f;
 		loadSongStopwatch.Restart();
 		loadSongFuture = std::async(std::launch::async, [tempPathCopy = std::string(absoluteAudioFilePath)]()->AsyncLoadSongResult
@@ -1168,32 +1232,38 @@ namespace PeepoDrumKit
 			if (result.SongFilePath.empty())
 				return result;
 
-			auto[fileContent, fileSize] = File::ReadAllBytes(result.SongFilePath);
-			if (fileContent == nullptr || fileSize == 0)
+			result.FileContent = File::ReadAllBytes(result.SongFilePath);
+			if (result.FileContent.Content == nullptr || result.FileContent.Size == 0)
 			{
 				printf("Failed to read file '%.*s'\n", FmtStrViewArgs(result.SongFilePath));
 				return result;
 			}
 
-			if (Audio::DecodeEntireFile(result.SongFilePath, fileContent.get(), fileSize, result.SampleBuffer) != Audio::DecodeFileResult::FeelsGoodMan)
+			// NOTE: Resample on the fly (one chunk at a time) instead of having to resample the entire buffer after the fact
+			result.Decoder = std::make_unique<Audio::StreamingDecoder>();
+			if (result.Decoder->Open(result.SongFilePath, result.FileContent.Content.get(), result.FileContent.Size, result.SampleBuffer, Audio::Engine.OutputSampleRate) != Audio::DecodeFileResult::FeelsGoodMan)
 			{
 				printf("Failed to decode audio file '%.*s'\n", FmtStrViewArgs(result.SongFilePath));
+				result.Decoder = nullptr;
+				result.SampleBuffer = {};
 				return result;
 			}
 
-			// HACK: ...
-			if (result.SampleBuffer.SampleRate != Audio::Engine.OutputSampleRate)
-				Audio::LinearlyResampleBuffer<i16>(result.SampleBuffer.InterleavedSamples, result.SampleBuffer.FrameCount, result.SampleBuffer.SampleRate, result.SampleBuffer.ChannelCount, Audio::Engine.OutputSampleRate);
-
-			if (result.SampleBuffer.ChannelCount > 0) result.WaveformL.GenerateEntireMipChainFromSampleBuffer(result.SampleBuffer, 0);
-#if !PEEPO_DEBUG // NOTE: Always ignore the second channel in debug builds for performance reasons!
-			if (result.SampleBuffer.ChannelCount > 1) result.WaveformR.GenerateEntireMipChainFromSampleBuffer(result.SampleBuffer, 1);
-#endif
-
+			result.Decoder->DecodeNextChunk();
 			return result;
 		});
 	}
 
+	void ChartEditor::CancelAsyncSongDecoding()
+	{
+		if (songDecoder != nullptr)
+			songDecoder->RequestCancel();
+		if (songDecodeFuture.valid())
+			songDecodeFuture.get();
+		songDecoder = nullptr;
+		isSongWaveformGenerating = false;
+	}
+
 	void ChartEditor::SetAndStartLoadingChartSongFileName(std::string_view relativeOrAbsoluteAudioFilePath, Undo::UndoHistory& undo)
 	{
 		if (!relativeOrAbsoluteAudioFilePath.empty() && !Path::IsRelative(relativeOrAbsoluteAudioFilePath))
@@ -1219,7 +1289,7 @@ namespace PeepoDrumKit
 	{
 		Shell::FileDialog fileDialog {};
 		fileDialog.InTitle = "Open Chart File";
-		fileDialog.InFilters = { { TJA::FilterName, TJA::FilterSpec }, { Shell::AllFilesFilterName, Shell::AllFilesFilterSpec }, };
+		fileDialog.InFilters = { { TJA::FilterName, TJA::FilterSpec }, { ChartBinaryFilterName, ChartBinaryFilterSpec }, { Fumen::FilterName, Fumen::FilterSpec }, { Shell::AllFilesFilterName, Shell::AllFilesFilterSpec }, };
 		fileDialog.InParentWindowHandle = ApplicationHost::GlobalState.NativeWindowHandle;
 
 		if (fileDialog.OpenRead() != Shell::FileDialogResult::OK)
@@ -1266,20 +1336,28 @@ namespace PeepoDrumKit
 			const Time previousChartSongOffset = context.Chart.SongOffset;
 
 			AsyncImportChartResult loadResult = importChartFuture.get();
+			if (loadResult.ErrorDescription != nullptr)
+			{
+				// NOTE: Keep editing the current chart instead of replacing it with an empty one
+				ShowChartFileErrorMessageBox(loadResult.ErrorDescription, loadResult.ChartFilePath);
+			}
+			else
+			{
+				// TODO: Maybe also do date version check (?)
+				createBackupOfOriginalTJABeforeOverwriteSave = !loadResult.IsBinaryChart && !loadResult.IsFumenCourse && !loadResult.TJA.Parsed.HasPeepoDrumKitComment;
 
-			// TODO: Maybe also do date version check (?)
-			createBackupOfOriginalTJABeforeOverwriteSave = !loadResult.TJA.Parsed.HasPeepoDrumKitComment;
-
-			context.Chart = std::move(loadResult.Chart);
-			context.ChartFilePath = std::move(loadResult.ChartFilePath);
-			context.ChartSelectedCourse = context.Chart.Courses.empty() ? context.Chart.Courses.emplace_back(std::make_unique<ChartCourse>()).get() : context.Chart.Courses.front().get();
-			StartAsyncLoadingSongAudioFile(Path::TryMakeAbsolute(context.Chart.SongFileName, context.ChartFilePath));
+				context.Chart = std::move(loadResult.Chart);
+				// NOTE: Saving an imported fumen course always has to go through the save as dialog, instead of overwriting the original file with TJA text
+				context.ChartFilePath = loadResult.IsFumenCourse ? std::string {} : std::move(loadResult.ChartFilePath);
+				context.ChartSelectedCourse = context.Chart.Courses.empty() ? context.Chart.Courses.emplace_back(std::make_unique<ChartCourse>()).get() : context.Chart.Courses.front().get();
+				StartAsyncLoadingSongAudioFile(Path::TryMakeAbsolute(context.Chart.SongFileName, context.ChartFilePath));
 
-			// NOTE: Prevent the cursor from changing screen position. Not needed if paused because a stable beat time is used instead
-			if (context.GetIsPlayback())
-				context.SetCursorTime(context.GetCursorTime() + (previousChartSongOffset - context.Chart.SongOffset));
+				// NOTE: Prevent the cursor from changing screen position. Not needed if paused because a stable beat time is used instead
+				if (context.GetIsPlayback())
+					context.SetCursorTime(context.GetCursorTime() + (previousChartSongOffset - context.Chart.SongOffset));
 
-			context.Undo.ClearAll();
+				context.Undo.ClearAll();
+			}
 		}
 
 		// NOTE: Just in case there is something wrong with the animation, that could otherwise prevent the song from finishing to load
@@ -1291,9 +1369,16 @@ namespace PeepoDrumKit
 			loadSongStopwatch.Stop();
 			AsyncLoadSongResult loadResult = loadSongFuture.get();
 			context.SongSourceFilePath = std::move(loadResult.SongFilePath);
-			context.SongWaveformL = std::move(loadResult.WaveformL);
-			context.SongWaveformR = std::move(loadResult.WaveformR);
+
+			// NOTE: Only allocate the (zeroed) mips here, these are then filled in every frame as more and more of the song is being decoded
+			context.SongWaveformL.Clear();
+			context.SongWaveformR.Clear();
+			if (loadResult.SampleBuffer.ChannelCount > 0) context.SongWaveformL.BeginMipChainForSampleBuffer(loadResult.SampleBuffer);
+#if !PEEPO_DEBUG // NOTE: Always ignore the second channel in debug builds for performance reasons!
+			if (loadResult.SampleBuffer.ChannelCount > 1) context.SongWaveformR.BeginMipChainForSampleBuffer(loadResult.SampleBuffer);
+#endif
 			context.SongWaveformFadeAnimationTarget = context.SongWaveformL.IsEmpty() ? 0.0f : 1.0f;
+			isSongWaveformGenerating = !context.SongWaveformL.IsEmpty();
 
 			// TODO: Maybe handle this differently...
 			if (context.Chart.ChartTitle.Base().empty() && !context.SongSourceFilePath.empty())
@@ -1308,7 +1393,50 @@ namespace PeepoDrumKit
 			context.SongSource = Audio::Engine.LoadSourceFromBufferMove(Path::GetFileName(context.SongSourceFilePath), std::move(loadResult.SampleBuffer));
 			context.SongVoice.SetSource(context.SongSource);
 
+			// NOTE: Moving the sample buffer into the audio engine doesn't reallocate its sample array, so the decoder can keep writing into it from here on out
+			if (loadResult.Decoder != nullptr && !loadResult.Decoder->IsFinished())
+			{
+				songDecoder = std::move(loadResult.Decoder);
+				songDecodeFuture = std::async(std::launch::async, [decoder = songDecoder, fileContent = std::move(loadResult.FileContent)]() -> b8
+				{
+					return decoder->DecodeAllRemainingChunks();
+				});
+			}
+
 			Audio::Engine.EnsureStreamRunning();
 		}
+
+		if (isSongWaveformGenerating)
+		{
+			const Audio::PCMSampleBuffer* songBuffer = Audio::Engine.GetSourceSampleBufferView(context.SongSource);
+			if (songBuffer != nullptr && songBuffer->InterleavedSamples != nullptr)
+			{
+				const i64 availableFrameCount = songBuffer->GetAvailableFrameCount();
+#if !PEEPO_DEBUG // NOTE: Always ignore the second channel in debug builds for performance reasons!
+				if (songBuffer->ChannelCount == 2)
+				{
+					Audio::WaveformMipChain::UpdateStereoMipChainsFromSampleBuffer(*songBuffer, context.SongWaveformL, context.SongWaveformR, availableFrameCount);
+				}
+				else
+				{
+					if (songBuffer->ChannelCount > 0) context.SongWaveformL.UpdateMipChainFromSampleBuffer(*songBuffer, 0, availableFrameCount);
+					if (songBuffer->ChannelCount > 1) context.SongWaveformR.UpdateMipChainFromSampleBuffer(*songBuffer, 1, availableFrameCount);
+				}
+#else
+				if (songBuffer->ChannelCount > 0) context.SongWaveformL.UpdateMipChainFromSampleBuffer(*songBuffer, 0, availableFrameCount);
+#endif
+				isSongWaveformGenerating = (availableFrameCount < songBuffer->FrameCount);
+			}
+			else
+			{
+				isSongWaveformGenerating = false;
+			}
+		}
+
+		if (songDecodeFuture.valid() && songDecodeFuture._Is_ready())
+		{
+			songDecodeFuture.get();
+			songDecoder = nullptr;
+		}
 	}
 }
@@ -8,6 +8,7 @@
 #include "chart_editor_timeline.h"
 #include "imgui/imgui_include.h"
 #include "audio/audio_engine.h"
+#include "audio/audio_file_formats.h"
 
 #include "test_gui_audio.h"
 #include "test_gui_tja.h"
@@ -18,6 +19,10 @@ namespace PeepoDrumKit
 	{
 		std::string ChartFilePath;
 		ChartProject Chart;
+		// NOTE: Set instead of the chart when the file couldn't be loaded, in which case the current chart is kept as is
+		cstr ErrorDescription = nullptr;
+		b8 IsBinaryChart = false;
+		b8 IsFumenCourse = false;
 
 		struct TJATempData
 		{
@@ -33,7 +38,9 @@ namespace PeepoDrumKit
 	{
 		std::string SongFilePath;
 		Audio::PCMSampleBuffer SampleBuffer;
-		Audio::WaveformMipChain WaveformL, WaveformR;
+		// NOTE: Only the first chunk has been decoded by the time the result is ready, the rest is then decoded in the background after the buffer has been handed over to the audio engine
+		std::unique_ptr<Audio::StreamingDecoder> Decoder;
+		File::UniqueFileContent FileContent;
 	};
 
 	struct ChartEditor
@@ -52,12 +59,13 @@ namespace PeepoDrumKit
 		void UpdateApplicationWindowTitle(const ChartContext& context);
 
 		void CreateNewChart(ChartContext& context);
-		void SaveChart(ChartContext& context, std::string_view filePath = "");
+		b8 SaveChart(ChartContext& context, std::string_view filePath = "");
 		b8 OpenChartSaveAsDialog(ChartContext& context);
 		b8 TrySaveChartOrOpenSaveAsDialog(ChartContext& context);
 
 		void StartAsyncImportingChartFile(std::string_view absoluteChartFilePath);
 		void StartAsyncLoadingSongAudioFile(std::string_view absoluteAudioFilePath);
+		void CancelAsyncSongDecoding();
 		void SetAndStartLoadingChartSongFileName(std::string_view relativeOrAbsoluteAudioFilePath, Undo::UndoHistory& undo);
 
 		b8 OpenLoadChartFileDialog(ChartContext& context);
@@ -74,6 +82,9 @@ namespace PeepoDrumKit
 		std::future<AsyncImportChartResult> importChartFuture {};
 		std::future<AsyncLoadSongResult> loadSongFuture {};
 		CPUStopwatch loadSongStopwatch = {};
+		std::shared_ptr<Audio::StreamingDecoder> songDecoder = nullptr;
+		std::future<b8> songDecodeFuture {};
+		b8 isSongWaveformGenerating = false;
 		b8 createBackupOfOriginalTJABeforeOverwriteSave = false;
 		b8 wasAudioEngineRunningIdleOnFocusLost = false;
 		b8 tryToCloseApplicationOnNextFrame = false;
@@ -1,11 +1,14 @@
 #include "chart_editor_graphics.h"
 #include "core_io.h"
+#include "core_thread_pool.h"
 #include <thorvg/thorvg.h>
 #include <thread>
 #include <future>
 
-// TODO: Use for packing texture atlases (?)
-// #include "imgui/3rdparty/imstb_rectpack.h"
+// NOTE: Dear ImGui only includes its own implementation as static so a separate one is needed here
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/3rdparty/imstb_rectpack.h"
 
 namespace PeepoDrumKit
 {
@@ -21,7 +24,9 @@ namespace PeepoDrumKit
 	static constexpr i32 PerSideRasterizedTexPadding = 2;
 	static constexpr i32 CombinedRasterizedTexPadding = (PerSideRasterizedTexPadding * 2);
 
-	struct RasterizedBitmap { std::unique_ptr<u32[]> BGRA; ivec2 Resolution; };
+	// NOTE: Largest size either side of an atlas is allowed to grow to, with any sprites that still don't fit then simply not being drawn at all
+	static constexpr i32 MaxSprAtlasResolution = 8192;
+
 	struct SvgRasterizer
 	{
 		std::unique_ptr<tvg::SwCanvas> Canvas = nullptr;
@@ -38,33 +43,40 @@ namespace PeepoDrumKit
 			BaseScale = baseScale;
 			PictureView = picture.get();
 
+			// NOTE: Each sprite gets its own memory pool so that different sprites can be rasterized on different threads at the same time
 			assert(Canvas == nullptr);
 			Canvas = tvg::SwCanvas::gen();
+			Canvas->mempool(tvg::SwCanvas::MempoolPolicy::Individual);
 			Canvas->push(std::move(picture));
 		}
 
-		// TODO: Rasterize directly into final atlas using stride
-		RasterizedBitmap Rasterize(f32 scale)
+		ivec2 GetPaddedResolution(f32 scale) const
 		{
 			const vec2 scaledPictureSize = (PictureSize * scale);
-			const ivec2 resolutionWithoutPadding = { static_cast<i32>(Ceil(scaledPictureSize.x)), static_cast<i32>(Ceil(scaledPictureSize.y)) };
-			const ivec2 resolution = resolutionWithoutPadding + ivec2(CombinedRasterizedTexPadding);
-			RasterizedBitmap out { std::make_unique<u32[]>(resolution.x * resolution.y), resolution };
+			return ivec2(static_cast<i32>(Ceil(scaledPictureSize.x)), static_cast<i32>(Ceil(scaledPictureSize.y))) + ivec2(CombinedRasterizedTexPadding);
+		}
+
+		// NOTE: Renders into the (padded resolution) sub-rect starting at (offset) of a larger pixel buffer with a width of (stride), leaving all pixels outside of it untouched
+		void RasterizeInto(u32* outBGRA, i32 stride, ivec2 offset, f32 scale)
+		{
+			const ivec2 resolution = GetPaddedResolution(scale);
+			const ivec2 resolutionWithoutPadding = resolution - ivec2(CombinedRasterizedTexPadding);
 			if (resolutionWithoutPadding.x <= 0 || resolutionWithoutPadding.y <= 0)
-				return out;
+				return;
 
+			u32* subRectBGRA = &outBGRA[(offset.y * stride) + offset.x];
 			const vec2 position = vec2(PerSideRasterizedTexPadding, PerSideRasterizedTexPadding);
 			PictureView->scale(scale * BaseScale);
 			PictureView->translate(position.x, position.y);
 
-			Canvas->target(out.BGRA.get(), resolution.x, resolution.x, resolution.y, tvg::SwCanvas::ARGB8888/*_STRAIGHT*/);
+			Canvas->target(subRectBGRA, stride, resolution.x, resolution.y, tvg::SwCanvas::ARGB8888/*_STRAIGHT*/);
 			Canvas->update(PictureView);
 			Canvas->draw();
 			Canvas->sync();
 
 			if constexpr (PerSideRasterizedTexPadding > 0)
 			{
-				auto pixelAt = [&](i32 x, i32 y) -> u32& { return out.BGRA[(y * resolution.x) + x]; };
+				auto pixelAt = [&](i32 x, i32 y) -> u32& { return subRectBGRA[(y * stride) + x]; };
 				auto pixelAtWithoutPadding = [&](i32 x, i32 y) -> u32& { return pixelAt(x + PerSideRasterizedTexPadding, y + PerSideRasterizedTexPadding); };
 
 				for (i32 x = 0; x < PerSideRasterizedTexPadding; x++)
@@ -91,21 +103,100 @@ namespace PeepoDrumKit
 						pixelAt(resolutionWithoutPadding.x + x + PerSideRasterizedTexPadding, PerSideRasterizedTexPadding + y) = pixelAtWithoutPadding(resolutionWithoutPadding.x - 1, y);
 					}
 			}
-
-			return out;
 		}
 	};
 
-	struct ChartGraphicsResources::OpaqueData
+	// NOTE: Padded sub-rect of a sprite within the atlas of its group
+	struct SprAtlasRect { ivec2 Offset, Size; b8 IsPacked; };
+	struct SprAtlasPixels { f32 RasterScale; ivec2 Size; i32 PackedSprCount; SprAtlasRect PerSprRect[EnumCount<SprID>]; std::unique_ptr<u32[]> BGRA; };
+	struct SprAtlas { f32 RasterScale; ivec2 Size; i32 PackedSprCount; SprAtlasRect PerSprRect[EnumCount<SprID>]; CustomDraw::GPUTexture Texture; u64 LastUsedTick; };
+
+	// NOTE: Atlases of the most recently used raster scales, so that zooming back and forth can switch between them without having to rasterize again.
+	//		 Rasterizing a new scale happens in the background with the current atlas still being used until the new one is ready to be swapped in
+	static constexpr i32 SprAtlasCacheCapacity = 4;
+	struct SprGroupAtlasCache
+	{
+		SprAtlas Entries[SprAtlasCacheCapacity];
+		i32 CurrentIndex = -1;
+		u64 UseTick = 0;
+		std::future<SprAtlasPixels> PendingRasterization;
+
+		inline const SprAtlas* GetCurrent() const { return (CurrentIndex >= 0 && CurrentIndex < SprAtlasCacheCapacity) ? &Entries[CurrentIndex] : nullptr; }
+	};
+
+	// NOTE: Tries the smallest power of two sizes first, alternately doubling the height and width until everything fits
+	static ivec2 PackSprAtlasRects(std::vector<stbrp_rect>& inOutRects)
+	{
+		i32 totalArea = 0;
+		ivec2 largestRect = ivec2(1, 1);
+		for (const stbrp_rect& it : inOutRects) { totalArea += (it.w * it.h); largestRect = Max(largestRect, ivec2(it.w, it.h)); }
+
+		const i32 minSideLength = Max(largestRect.x, static_cast<i32>(Ceil(::sqrtf(static_cast<f32>(totalArea)))));
+		ivec2 atlasSize = Min(ivec2(static_cast<i32>(RoundUpToPowerOfTwo(static_cast<u32>(minSideLength))), static_cast<i32>(RoundUpToPowerOfTwo(static_cast<u32>(largestRect.y)))), ivec2(MaxSprAtlasResolution));
+
+		std::vector<stbrp_node> nodes;
+		while (true)
+		{
+			nodes.resize(atlasSize.x);
+			stbrp_context context;
+			stbrp_init_target(&context, atlasSize.x, atlasSize.y, nodes.data(), static_cast<i32>(nodes.size()));
+			if (stbrp_pack_rects(&context, inOutRects.data(), static_cast<i32>(inOutRects.size())) || (atlasSize.x >= MaxSprAtlasResolution && atlasSize.y >= MaxSprAtlasResolution))
+				return atlasSize;
+
+			if (atlasSize.y < atlasSize.x || atlasSize.x >= MaxSprAtlasResolution)
+				atlasSize.y = Min(atlasSize.y * 2, MaxSprAtlasResolution);
+			else
+				atlasSize.x = Min(atlasSize.x * 2, MaxSprAtlasResolution);
+		}
+	}
+
+	// NOTE: Runs on a background thread, with each sprite then being a separate thread pool task. Each sprite only ever belongs to a single group
+	//		 and there's only ever one rasterization per group in flight so no two threads can ever access the same SvgRasterizer
+	static SprAtlasPixels RasterizeSprAtlasPixels(SvgRasterizer (&perSprSvg)[EnumCount<SprID>], ThreadPool& threadPool, SprGroup group, f32 scale)
 	{
-		f32 PerGroupRasterScale[EnumCount<SprGroup>];
+		std::vector<stbrp_rect> rects;
+		rects.reserve(EnumCount<SprID>);
+		for (i32 sprIndex = 0; sprIndex < EnumCountI32<SprID>; sprIndex++)
+		{
+			if (GetSprGroup(static_cast<SprID>(sprIndex)) != group)
+				continue;
+
+			const ivec2 resolution = perSprSvg[sprIndex].GetPaddedResolution(scale);
+			rects.push_back(stbrp_rect { sprIndex, resolution.x, resolution.y });
+		}
+
+		SprAtlasPixels out {};
+		out.RasterScale = scale;
+		out.Size = PackSprAtlasRects(rects);
+		out.BGRA = std::make_unique<u32[]>(static_cast<size_t>(out.Size.x) * static_cast<size_t>(out.Size.y));
+
+		erase_remove_if(rects, [](const stbrp_rect& it) { return !it.was_packed; });
+		for (const stbrp_rect& it : rects)
+			out.PerSprRect[it.id] = SprAtlasRect { ivec2(it.x, it.y), ivec2(it.w, it.h), true };
+		out.PackedSprCount = static_cast<i32>(rects.size());
+
+		threadPool.ParallelFor(rects.size(), [&](size_t i)
+		{
+			perSprSvg[rects[i].id].RasterizeInto(out.BGRA.get(), out.Size.x, ivec2(rects[i].x, rects[i].y), scale);
+		});
+
+		return out;
+	}
 
+	struct ChartGraphicsResources::OpaqueData
+	{
 		b8 FinishedLoading;
 		std::future<void> LoadFuture;
 
-		// TODO: Combine multiple spirites into texture atlases (?)
 		SvgRasterizer PerSprSvg[EnumCount<SprID>];
-		CustomDraw::GPUTexture PerSprTexture[EnumCount<SprID>];
+		ThreadPool RasterThreadPool { ClampBot(static_cast<i32>(std::thread::hardware_concurrency()) - 1, 1) };
+		// NOTE: All sprites of a group share the same texture so that consecutive draws of them can be merged into a single draw command
+		SprGroupAtlasCache PerGroupAtlasCache[EnumCount<SprGroup>];
+
+		ImDrawList* PerGroupCountingDrawList[EnumCount<SprGroup>];
+		i32 PerGroupCountingStartCmdIndex[EnumCount<SprGroup>];
+		u32 PerGroupCountingStartElemCount[EnumCount<SprGroup>];
+		i32 PerGroupLastDrawCommandCount[EnumCount<SprGroup>];
 
 		// TODO: Global alpha to handle async load fade-ins (?)
 		// f32 PerGroupGlobalAlpha[EnumCount<SprGroup>];
@@ -113,15 +204,20 @@ namespace PeepoDrumKit
 
 	ChartGraphicsResources::ChartGraphicsResources()
 	{
-		const u32 threadCount = static_cast<u32>(ClampBot(static_cast<i32>(std::thread::hardware_concurrency()) - 1, 0));
-		tvg::Initializer::init(tvg::CanvasEngine::Sw, threadCount);
+		// NOTE: No worker threads of its own as each sprite is already rasterized on a separate thread pool task
+		tvg::Initializer::init(tvg::CanvasEngine::Sw, 0);
 
 		Data = std::make_unique<OpaqueData>();
 	}
 
 	ChartGraphicsResources::~ChartGraphicsResources()
 	{
-		for (auto& it : Data->PerSprTexture) { it.Unload(); }
+		for (auto& cache : Data->PerGroupAtlasCache)
+		{
+			if (cache.PendingRasterization.valid())
+				cache.PendingRasterization.wait();
+			for (auto& it : cache.Entries) { it.Texture.Unload(); }
+		}
 	}
 
 	void ChartGraphicsResources::StartAsyncLoading()
@@ -165,22 +261,83 @@ namespace PeepoDrumKit
 	void ChartGraphicsResources::Rasterize(SprGroup group, f32 scale)
 	{
 		assert(Data->FinishedLoading && group < SprGroup::Count);
-
-		f32& currentRasterScale = Data->PerGroupRasterScale[EnumToIndex(group)];
-		if (ApproxmiatelySame(currentRasterScale, scale))
+		if (!(scale > 0.0f))
 			return;
-		currentRasterScale = scale;
 
-		for (i32 sprIndex = 0; sprIndex < EnumCountI32<SprID>; sprIndex++)
+		SprGroupAtlasCache& cache = Data->PerGroupAtlasCache[EnumToIndex(group)];
+		if (cache.PendingRasterization.valid() && cache.PendingRasterization._Is_ready())
 		{
-			if (GetSprGroup(static_cast<SprID>(sprIndex)) != group)
-				continue;
+			// NOTE: Swapped in even if the requested scale has changed again since, as it'll still be closer than the one that's currently in use
+			const SprAtlasPixels pixels = cache.PendingRasterization.get();
+			i32 leastRecentlyUsedIndex = -1;
+			for (i32 i = 0; i < SprAtlasCacheCapacity; i++)
+			{
+				if (i != cache.CurrentIndex && (leastRecentlyUsedIndex < 0 || cache.Entries[i].LastUsedTick < cache.Entries[leastRecentlyUsedIndex].LastUsedTick))
+					leastRecentlyUsedIndex = i;
+			}
+
+			SprAtlas& atlas = cache.Entries[leastRecentlyUsedIndex];
+			atlas.Texture.Unload();
+			atlas.RasterScale = pixels.RasterScale;
+			atlas.Size = pixels.Size;
+			atlas.PackedSprCount = pixels.PackedSprCount;
+			std::copy(std::begin(pixels.PerSprRect), std::end(pixels.PerSprRect), std::begin(atlas.PerSprRect));
+			if (atlas.PackedSprCount > 0)
+				atlas.Texture.Load(CustomDraw::GPUTextureDesc { CustomDraw::GPUPixelFormat::BGRA, CustomDraw::GPUAccessType::Static, atlas.Size, pixels.BGRA.get() });
+			atlas.LastUsedTick = ++cache.UseTick;
+			cache.CurrentIndex = leastRecentlyUsedIndex;
+		}
 
-			auto bitmap = Data->PerSprSvg[sprIndex].Rasterize(currentRasterScale);
-			Data->PerSprTexture[sprIndex].Unload();
-			if (bitmap.Resolution.x > 0 && bitmap.Resolution.y > 0)
-				Data->PerSprTexture[sprIndex].Load(CustomDraw::GPUTextureDesc { CustomDraw::GPUPixelFormat::BGRA, CustomDraw::GPUAccessType::Static, bitmap.Resolution, bitmap.BGRA.get() });
+		for (i32 i = 0; i < SprAtlasCacheCapacity; i++)
+		{
+			if (cache.Entries[i].RasterScale > 0.0f && ApproxmiatelySame(cache.Entries[i].RasterScale, scale))
+			{
+				cache.Entries[i].LastUsedTick = ++cache.UseTick;
+				cache.CurrentIndex = i;
+				return;
+			}
 		}
+
+		if (!cache.PendingRasterization.valid())
+			cache.PendingRasterization = std::async(std::launch::async, [this, group, scale]() { return RasterizeSprAtlasPixels(Data->PerSprSvg, Data->RasterThreadPool, group, scale); });
+	}
+
+	SprGroupStats ChartGraphicsResources::GetGroupStats(SprGroup group) const
+	{
+		assert(group < SprGroup::Count);
+		const SprGroupAtlasCache& cache = Data->PerGroupAtlasCache[EnumToIndex(group)];
+		const SprAtlas* atlas = cache.GetCurrent();
+
+		SprGroupStats stats {};
+		stats.AtlasSize = (atlas != nullptr) ? atlas->Size : ivec2(0, 0);
+		stats.PackedSprCount = (atlas != nullptr) ? atlas->PackedSprCount : 0;
+		stats.LastDrawCommandCount = Data->PerGroupLastDrawCommandCount[EnumToIndex(group)];
+		stats.CachedAtlasCount = static_cast<i32>(std::count_if(std::begin(cache.Entries), std::end(cache.Entries), [](const SprAtlas& it) { return (it.RasterScale > 0.0f); }));
+		stats.IsRasterizing = cache.PendingRasterization.valid();
+		return stats;
+	}
+
+	void ChartGraphicsResources::BeginCountingDrawCommands(SprGroup group, ImDrawList* drawList)
+	{
+		assert(group < SprGroup::Count && drawList != nullptr);
+		Data->PerGroupCountingDrawList[EnumToIndex(group)] = drawList;
+		Data->PerGroupCountingStartCmdIndex[EnumToIndex(group)] = drawList->CmdBuffer.Size - 1;
+		Data->PerGroupCountingStartElemCount[EnumToIndex(group)] = (drawList->CmdBuffer.Size > 0) ? drawList->CmdBuffer.back().ElemCount : 0;
+	}
+
+	void ChartGraphicsResources::EndCountingDrawCommands(SprGroup group)
+	{
+		assert(group < SprGroup::Count && Data->PerGroupCountingDrawList[EnumToIndex(group)] != nullptr);
+		const ImDrawList* drawList = Data->PerGroupCountingDrawList[EnumToIndex(group)];
+		const i32 startCmdIndex = Data->PerGroupCountingStartCmdIndex[EnumToIndex(group)];
+
+		// NOTE: The command that was current when starting only counts if anything has been appended to it since
+		i32 drawCommandCount = 0;
+		for (i32 i = ClampBot(startCmdIndex, 0); i < drawList->CmdBuffer.Size; i++)
+			drawCommandCount += (drawList->CmdBuffer[i].ElemCount > ((i == startCmdIndex) ? Data->PerGroupCountingStartElemCount[EnumToIndex(group)] : 0)) ? 1 : 0;
+
+		Data->PerGroupLastDrawCommandCount[EnumToIndex(group)] = drawCommandCount;
+		Data->PerGroupCountingDrawList[EnumToIndex(group)] = nullptr;
 	}
 
 	SprInfo ChartGraphicsResources::GetInfo(SprID spr) const
@@ -188,9 +345,11 @@ namespace PeepoDrumKit
 		if (!Data->FinishedLoading || spr >= SprID::Count)
 			return {};
 
+		const SprAtlas* atlas = Data->PerGroupAtlasCache[EnumToIndex(GetSprGroup(spr))].GetCurrent();
+
 		SprInfo info;
 		info.SourceSize = Data->PerSprSvg[EnumToIndex(spr)].PictureSize;
-		info.RasterScale = Data->PerGroupRasterScale[EnumToIndex(GetSprGroup(spr))];
+		info.RasterScale = (atlas != nullptr) ? atlas->RasterScale : 0.0f;
 		return info;
 	}
 
@@ -199,12 +358,18 @@ namespace PeepoDrumKit
 		if (!Data->FinishedLoading || spr >= SprID::Count)
 			return false;
 
-		const f32 rasterScale = Data->PerGroupRasterScale[EnumToIndex(GetSprGroup(spr))];;
+		// NOTE: The current atlas might not (yet) match the most recently requested scale, so everything has to be relative to the scale it was rasterized at
+		const SprAtlas* atlas = Data->PerGroupAtlasCache[EnumToIndex(GetSprGroup(spr))].GetCurrent();
+		if (atlas == nullptr || !atlas->PerSprRect[EnumToIndex(spr)].IsPacked)
+			return false;
+
+		const SprAtlasRect& atlasRect = atlas->PerSprRect[EnumToIndex(spr)];
+		const f32 rasterScale = atlas->RasterScale;
 		transform.Scale /= rasterScale;
 		const vec2 scaledPictureSize = Data->PerSprSvg[EnumToIndex(spr)].PictureSize * rasterScale;
 
-		const auto& tex = Data->PerSprTexture[EnumToIndex(spr)];
-		const vec2 texSizePadded = tex.GetSizeF32();
+		const vec2 atlasSize = vec2(static_cast<f32>(atlas->Size.x), static_cast<f32>(atlas->Size.y));
+		const vec2 atlasRectOffset = vec2(static_cast<f32>(atlasRect.Offset.x), static_cast<f32>(atlasRect.Offset.y));
 		const vec2 size = (transform.Scale * scaledPictureSize);
 		const vec2 pivot = (-transform.Pivot * transform.Scale * scaledPictureSize);
 
@@ -242,11 +407,11 @@ namespace PeepoDrumKit
 		for (vec2& it : quadUV)
 		{
 			it *= scaledPictureSize;
-			it += vec2(PerSideRasterizedTexPadding, PerSideRasterizedTexPadding);
-			it /= texSizePadded;
+			it += atlasRectOffset + vec2(PerSideRasterizedTexPadding, PerSideRasterizedTexPadding);
+			it /= atlasSize;
 		}
 
-		out.TexID = tex.GetTexID();
+		out.TexID = atlas->Texture.GetTexID();
 		out.Pos[0] = tl; out.Pos[1] = tr;
 		out.Pos[2] = br; out.Pos[3] = bl;
 		out.UV[0] = quadUV[0]; out.UV[1] = quadUV[1];
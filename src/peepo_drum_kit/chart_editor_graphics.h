@@ -96,6 +96,9 @@ namespace PeepoDrumKit
 
 	struct SprInfo { vec2 SourceSize; f32 RasterScale; };
 
+	// NOTE: Draw command count of the last Begin/EndCountingDrawCommands() section, to verify that sprites drawn back to back actually end up being batched together
+	struct SprGroupStats { ivec2 AtlasSize; i32 PackedSprCount; i32 LastDrawCommandCount; i32 CachedAtlasCount; b8 IsRasterizing; };
+
 	struct SprTransform
 	{
 		vec2 Position;	// NOTE: In absolute screen space
@@ -145,8 +148,14 @@ namespace PeepoDrumKit
 		b8 IsAsyncLoading() const;
 
 		// TODO: Only actually rebulid textures after *completeing* a resize (?)
+		// NOTE: Rasterizes all sprites of the group into a single packed texture atlas. Scales that aren't cached yet are rasterized asynchronously,
+		//		 with the previous atlas continuing to be used until the new one has finished (so has to be called every frame for it to eventually be swapped in)
 		void Rasterize(SprGroup group, f32 scale);
 
+		SprGroupStats GetGroupStats(SprGroup group) const;
+		void BeginCountingDrawCommands(SprGroup group, ImDrawList* drawList);
+		void EndCountingDrawCommands(SprGroup group);
+
 		SprInfo GetInfo(SprID spr) const;
 		b8 GetImageQuad(ImImageQuad& out, SprID spr, SprTransform transform, u32 colorTint, const SprUV* uv);
 
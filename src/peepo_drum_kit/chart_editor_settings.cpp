@@ -477,6 +477,7 @@ namespace PeepoDrumKit
 			X(Audio.OpenDeviceOnStartup, "open_device_on_startup");
 			X(Audio.CloseDeviceOnIdleFocusLoss, "close_device_on_idle_focus_loss");
 			X(Audio.RequestExclusiveDeviceAccess, "request_exclusive_device_access");
+			X(Audio.PreservePitchAtVariablePlaybackSpeed, "preserve_pitch_at_variable_playback_speed");
 
 			SECTION("animation");
 			X(Animation.EnableGuiScaleAnimation, "enable_gui_scale_animation");
@@ -143,6 +143,7 @@ namespace PeepoDrumKit
 			WithDefault<b8> OpenDeviceOnStartup = true;
 			WithDefault<b8> CloseDeviceOnIdleFocusLoss = false;
 			WithDefault<b8> RequestExclusiveDeviceAccess = false;
+			WithDefault<b8> PreservePitchAtVariablePlaybackSpeed = true;
 		} Audio;
 
 		struct AnimationData
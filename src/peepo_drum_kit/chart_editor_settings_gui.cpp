@@ -852,6 +852,12 @@ namespace PeepoDrumKit
 							"Reduce audio latency by requesting exlusive device access.\n"
 							"This will prevent all *other* applications from playing back or recording audio.",
 							SettingsGui::WidgetType::B8_ExclusiveAudioComboBox),
+
+						SettingsGui::SettingsEntry(
+							settings.Audio.PreservePitchAtVariablePlaybackSpeed,
+							"Preserve Pitch at Variable Playback Speed",
+							"Time stretch the song instead of resampling it when changing the playback speed,\n"
+							"so that slowed down playback keeps its original pitch."),
 					};
 
 					changesWereMade |= SettingsGui::DrawEntriesListTableGui(settingsEntriesAudio, ArrayCount(settingsEntriesAudio), nullptr, lastActiveGroup);
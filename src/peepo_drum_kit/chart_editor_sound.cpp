@@ -22,15 +22,11 @@ namespace PeepoDrumKit
 					continue;
 				}
 
-				if (Audio::DecodeEntireFile(inFilePath, fileContent.get(), fileSize, resultBuffer) != Audio::DecodeFileResult::FeelsGoodMan)
+				if (Audio::DecodeEntireFile(inFilePath, fileContent.get(), fileSize, resultBuffer, Audio::Engine.OutputSampleRate) != Audio::DecodeFileResult::FeelsGoodMan)
 				{
 					printf("Failed to decode audio file '%.*s'\n", FmtStrViewArgs(inFilePath));
 					continue;
 				}
-
-				// HACK: ...
-				if (resultBuffer.SampleRate != Audio::Engine.OutputSampleRate)
-					Audio::LinearlyResampleBuffer<i16>(resultBuffer.InterleavedSamples, resultBuffer.FrameCount, resultBuffer.SampleRate, resultBuffer.ChannelCount, Audio::Engine.OutputSampleRate);
 			}
 			return result;
 		});
@@ -74,14 +70,13 @@ namespace PeepoDrumKit
 		}
 	}
 
-	void SoundEffectsVoicePool::PlaySound(SoundEffectType type, Time startTime, std::optional<Time> externalClock)
+	void SoundEffectsVoicePool::PlaySound(SoundEffectType type, Time startTime)
 	{
 		Audio::Engine.EnsureStreamRunning();
 
 		// TODO: Maybe handle metronome in a different way entirely (separate voice pool?)
 		const b8 isMetronome = (type == SoundEffectType::MetronomeBar || type == SoundEffectType::MetronomeBeat);
 
-		// TODO: Handle external clock differently so that there isn't any problem with preview sounds / the metronome clashing with manual inputs
 		f32 voiceVolume = 1.0f;
 
 		const Time timeSinceLastVoice = LastPlayedVoiceStopwatch.GetElapsed();
@@ -109,15 +104,41 @@ namespace PeepoDrumKit
 			if (!isMetronome)
 				LastPlayedVoiceStopwatch.Restart();
 
-			Audio::Voice voice = VoicePool[VoicePoolRingIndex];
+			Audio::Voice voice = AdvanceVoicePoolRing();
 			voice.SetSource(TryGetSourceForType(type));
 			voice.SetPosition(startTime);
 			voice.SetVolume(voiceVolume);
 			voice.SetIsPlaying(true);
+		}
+	}
+
+	void SoundEffectsVoicePool::PlaySoundAtStreamFrame(SoundEffectType type, i64 streamFrame)
+	{
+		Audio::Engine.EnsureStreamRunning();
+		const b8 isMetronome = (type == SoundEffectType::MetronomeBar || type == SoundEffectType::MetronomeBeat);
+
+		if (!isMetronome)
+		{
+			// NOTE: Same threshold as for immediately played sounds but measured between the scheduled output frames themselves,
+			//		 instead of between calls which would otherwise make it depend on how many sounds happen to fall within the same GUI frame
+			static constexpr Time silenceThreshold = Time::FromFrames(2.0, 60.0);
+			static const i64 silenceThresholdFrames = Audio::TimeToFrames(silenceThreshold, Audio::AudioEngine::OutputSampleRate);
 
-			VoicePoolRingIndex++;
-			if (VoicePoolRingIndex >= VoicePoolSize)
-				VoicePoolRingIndex = 0;
+			if (LastScheduledVoiceStreamFrame.has_value() && Absolute(streamFrame - *LastScheduledVoiceStreamFrame) < silenceThresholdFrames)
+				return;
+
+			LastScheduledVoiceStreamFrame = streamFrame;
+			LastPlayedVoiceStopwatch.Restart();
+		}
+
+		const f32 voiceVolume = (isMetronome ? BaseVolumeMetronome : BaseVolumeSfx) * BaseVolumeMaster;
+		if (voiceVolume > 0.0f)
+		{
+			Audio::Voice voice = AdvanceVoicePoolRing();
+			voice.SetIsPlaying(false);
+			voice.SetSource(TryGetSourceForType(type));
+			voice.SetVolume(voiceVolume);
+			Audio::Engine.ScheduleVoiceStart(voice, streamFrame);
 		}
 	}
 
@@ -125,9 +146,23 @@ namespace PeepoDrumKit
 	{
 		for (auto& voice : VoicePool)
 		{
+			Audio::Engine.CancelScheduledVoiceStarts(voice);
 			if (voice.GetIsPlaying() && voice.GetPosition() < Time::Zero())
 				voice.SetIsPlaying(false);
 		}
+		LastScheduledVoiceStreamFrame.reset();
+	}
+
+	Audio::Voice SoundEffectsVoicePool::AdvanceVoicePoolRing()
+	{
+		// NOTE: The voice about to be reused might still have an earlier start pending, which would otherwise end up playing this sound twice
+		Audio::Voice voice = VoicePool[VoicePoolRingIndex];
+		Audio::Engine.CancelScheduledVoiceStarts(voice);
+
+		VoicePoolRingIndex++;
+		if (VoicePoolRingIndex >= VoicePoolSize)
+			VoicePoolRingIndex = 0;
+		return voice;
 	}
 
 	Audio::SourceHandle SoundEffectsVoicePool::TryGetSourceForType(SoundEffectType type) const
@@ -1,5 +1,6 @@
 #pragma once
 #include "core_types.h"
+#include "chart.h"
 #include "audio/audio_engine.h"
 #include <optional>
 
@@ -24,6 +25,44 @@ namespace PeepoDrumKit
 
 	static_assert(ArrayCount(SoundEffectTypeFilePaths) == EnumCount<SoundEffectType>);
 
+	constexpr SoundEffectType SoundEffectTypeForNoteType(NoteType noteType)
+	{
+		return IsKaNote(noteType) ? SoundEffectType::TaikoKa : SoundEffectType::TaikoDon;
+	}
+
+	// NOTE: Every (chart space) point in time at which a playback hit sound should be heard, including the individual balloon pops and drumroll hits
+	template <typename Func>
+	void ForEachNoteHitSound(const SortedNotesList& notes, const SortedTempoMap& tempoMap, Beat drumrollHitInterval, Func perHitSoundFunc)
+	{
+		for (const Note& note : notes)
+		{
+			if (note.BeatDuration > Beat::Zero())
+			{
+				if (IsBalloonNote(note.Type))
+				{
+					perHitSoundFunc(tempoMap.BeatToTime(note.BeatTime) + note.TimeOffset, note.Type);
+
+					const Beat balloonBeatInterval = (note.BalloonPopCount > 0) ? (note.BeatDuration / note.BalloonPopCount) : Beat::Zero();
+					if (balloonBeatInterval > Beat::Zero())
+					{
+						i32 remainingPops = note.BalloonPopCount;
+						for (Beat subBeat = balloonBeatInterval; (subBeat < note.BeatDuration) && (--remainingPops > 0); subBeat += balloonBeatInterval)
+							perHitSoundFunc(tempoMap.BeatToTime(note.BeatTime + subBeat) + note.TimeOffset, note.Type);
+					}
+				}
+				else if (drumrollHitInterval > Beat::Zero())
+				{
+					for (Beat subBeat = Beat::Zero(); subBeat <= note.BeatDuration; subBeat += drumrollHitInterval)
+						perHitSoundFunc(tempoMap.BeatToTime(note.BeatTime + subBeat) + note.TimeOffset, note.Type);
+				}
+			}
+			else
+			{
+				perHitSoundFunc(tempoMap.BeatToTime(note.BeatTime) + note.TimeOffset, note.Type);
+			}
+		}
+	}
+
 	struct AsyncLoadSoundEffectsResult
 	{
 		Audio::PCMSampleBuffer SampleBuffers[EnumCount<SoundEffectType>];
@@ -36,9 +75,12 @@ namespace PeepoDrumKit
 		void UpdateAsyncLoading();
 		void UnloadAllSourcesAndVoices();
 
-		void PlaySound(SoundEffectType type, Time startTime = Time::Zero(), std::optional<Time> externalClock = {});
+		void PlaySound(SoundEffectType type, Time startTime = Time::Zero());
+		// NOTE: Sample accurate start at an absolute output stream frame (see Audio::AudioEngine::ScheduleVoiceStart()), for sounds known about ahead of time
+		void PlaySoundAtStreamFrame(SoundEffectType type, i64 streamFrame);
 		void PauseAllFutureVoices();
 		Audio::SourceHandle TryGetSourceForType(SoundEffectType type) const;
+		Audio::Voice AdvanceVoicePoolRing();
 
 		f32 BaseVolumeMaster = 1.0f;
 		f32 BaseVolumeSfx = 1.0f;
@@ -47,7 +89,7 @@ namespace PeepoDrumKit
 		static constexpr size_t VoicePoolSize = 32;
 		Audio::Voice VoicePool[VoicePoolSize] = {};
 		CPUStopwatch LastPlayedVoiceStopwatch = {};
-		Time LastPlayedVoiceExternalClockTime = {};
+		std::optional<i64> LastScheduledVoiceStreamFrame = {};
 
 		Audio::SourceHandle LoadedSources[EnumCount<SoundEffectType>] = {};
 		std::future<AsyncLoadSoundEffectsResult> LoadSoundEffectFuture = {};
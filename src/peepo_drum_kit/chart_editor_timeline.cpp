@@ -37,6 +37,26 @@ namespace PeepoDrumKit
 			}
 		}
 
+		if (Gui::CollapsingHeader("Sprite Atlases", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			if (Gui::Property::BeginTable(tableFlags))
+			{
+				static constexpr cstr groupNames[] = { "Timeline", "Game" };
+				static_assert(ArrayCount(groupNames) == EnumCount<SprGroup>);
+
+				for (SprGroup group = {}; group < SprGroup::Count; IncrementEnum(group))
+				{
+					const SprGroupStats stats = context.Gfx.GetGroupStats(group);
+					Gui::Property::PropertyTextValueFunc(groupNames[EnumToIndex(group)], [&]
+					{
+						Gui::Text("%dx%d atlas, %d sprites, %d draw commands, %d cached%s", stats.AtlasSize.x, stats.AtlasSize.y, stats.PackedSprCount, stats.LastDrawCommandCount,
+							stats.CachedAtlasCount, stats.IsRasterizing ? " (rasterizing...)" : "");
+					});
+				}
+				Gui::Property::EndTable();
+			}
+		}
+
 		if (Gui::CollapsingHeader("Colors", ImGuiTreeNodeFlags_DefaultOpen))
 		{
 			struct NamedColorU32Pointer { cstr Label; u32* ColorPtr; u32 Default; };
@@ -291,7 +311,7 @@ namespace PeepoDrumKit
 		const Time chartDuration = context.Chart.GetDurationOrDefault();
 		context.ChartSelectedCourse->TempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
 		{
-			const Time timeIt = context.ChartSelectedCourse->TempoMap.BeatToTime(it.Beat);
+			const Time timeIt = context.ChartSelectedCourse->TempoMap.BeatToTime(it.BeatTime);
 
 			if ((gridLineIndex++ % gridLineModToSkip) == 0)
 			{
@@ -314,11 +334,6 @@ namespace PeepoDrumKit
 	static constexpr f32 NoteHitAnimationScaleStart = 1.35f, NoteHitAnimationScaleEnd = 1.0f;
 	static constexpr f32 NoteDeleteAnimationDuration = 0.04f;
 
-	static constexpr SoundEffectType SoundEffectTypeForNoteType(NoteType noteType)
-	{
-		return IsKaNote(noteType) ? SoundEffectType::TaikoKa : SoundEffectType::TaikoDon;
-	}
-
 	static b8 IsTimelineCursorVisibleOnScreen(const TimelineCamera& camera, const TimelineRegions& regions, const Time cursorTime, const f32 edgePixelThreshold = 0.0f)
 	{
 		assert(edgePixelThreshold >= 0.0f);
@@ -357,7 +372,7 @@ namespace PeepoDrumKit
 
 		for (auto& item : noteItemsToAnimate)
 			if (IsNotesList(item.List))
-				item.Value.POD.Note.ClickAnimationTimeDuration = item.Value.POD.Note.ClickAnimationTimeRemaining = GetNotesWaveAnimationTimeAtIndex(noteIndex++, notesCount, direction);
+				item.Value.POD.NoteItem.ClickAnimationTimeDuration = item.Value.POD.NoteItem.ClickAnimationTimeRemaining = GetNotesWaveAnimationTimeAtIndex(noteIndex++, notesCount, direction);
 	}
 
 	static f32 GetTimelineNoteScaleFactor(b8 isPlayback, Time cursorTime, Beat cursorBeatOnPlaybackStart, const Note& note, Time noteTime)
@@ -501,19 +516,20 @@ namespace PeepoDrumKit
 			if (waveform.IsEmpty())
 				continue;
 
-			const auto& waveformMip = waveform.FindClosestMip(waveformTimePerPixel);
-			for (i32 visiblePixel = 0; visiblePixel < contentRect.GetWidth(); /*visiblePixel++*/)
+			for (i32 visiblePixel = 0; visiblePixel < contentRect.GetWidth(); visiblePixel += CustomDraw::WaveformPixelsPerChunk)
 			{
 				CustomDraw::WaveformChunk chunk;
 				const Rect chunkRect = Rect::FromTLSize(timeline.LocalToScreenSpace(vec2(static_cast<f32>(visiblePixel), 0.5f)), vec2(static_cast<f32>(CustomDraw::WaveformPixelsPerChunk), rowsHeight));
 
+				const Time chunkStartTime = timeline.Camera.LocalSpaceXToTime(static_cast<f32>(visiblePixel)) - chartSongOffset;
+				waveform.GetAmplitudesForPixels(chunkStartTime, waveformTimePerPixel, chunk.PerPixelAmplitude, CustomDraw::WaveformPixelsPerChunk);
+
 				for (i32 chunkPixel = 0; chunkPixel < CustomDraw::WaveformPixelsPerChunk; chunkPixel++)
 				{
-					const Time timeAtPixel = timeline.Camera.LocalSpaceXToTime(static_cast<f32>(visiblePixel)) - chartSongOffset;
+					const Time timeAtPixel = chunkStartTime + (waveformTimePerPixel * static_cast<f64>(chunkPixel));
 					const b8 outOfBounds = (timeAtPixel < Time::Zero() || (timeAtPixel > waveformDuration));
 
-					chunk.PerPixelAmplitude[chunkPixel] = outOfBounds ? 0.0f : (waveformAnimationScale * ClampBot(waveform.GetAmplitudeAt(waveformMip, timeAtPixel, waveformTimePerPixel), minAmplitude));
-					visiblePixel++;
+					chunk.PerPixelAmplitude[chunkPixel] = outOfBounds ? 0.0f : (waveformAnimationScale * ClampBot(chunk.PerPixelAmplitude[chunkPixel], minAmplitude));
 				}
 
 				CustomDraw::DrawWaveformChunk(drawList, chunkRect, waveformColor, chunk);
@@ -540,8 +556,8 @@ namespace PeepoDrumKit
 		ImDrawList* drawListContent = param.DrawListContent;
 		const TimelineCamera& camera = timeline.Camera;
 		const ChartTimeline::MinMaxTime visibleTime = param.VisibleTime;
+		const BeatSortedIndexRange visibleRange = FindIndexRangeOverlappingTimes(context.ChartSelectedCourse->TempoMap, list, visibleTime.Min, visibleTime.Max);
 
-		// TODO: Do culling by first determining min/max visible beat times then use those to continue / break inside loop (although problematic with TimeOffset?)
 		if constexpr (std::is_same_v<T, Note>)
 		{
 			// TODO: Draw unselected branch notes grayed and at a slightly smaller scale (also nicely animate between selecting different branched!)
@@ -549,10 +565,15 @@ namespace PeepoDrumKit
 			// TODO: It looks like there'll also have to be one scroll speed lane per branch type
 			//		 which means the scroll speed change line should probably extend all to the way down to its corresponding note lane (?)
 
-			for (const Note& it : list)
+			static constexpr BranchType branchForThisRow = TimelineRowToBranchType(RowType);
+			const ChartCourseTimingCache::NoteTimings& timings = context.GetUpdatedTimingCache().Notes[EnumToIndex(branchForThisRow)];
+			assert(timings.HeadTimes.size() == list.size());
+
+			for (size_t i = visibleRange.First; i < visibleRange.End; i++)
 			{
-				const Time startTime = context.BeatToTime(it.GetStart()) + it.TimeOffset;
-				const Time endTime = (it.BeatDuration > Beat::Zero()) ? context.BeatToTime(it.GetEnd()) + it.TimeOffset : startTime;
+				const Note& it = list[i];
+				const Time startTime = timings.HeadTimes[i];
+				const Time endTime = timings.TailTimes[i];
 				if (endTime < visibleTime.Min || startTime > visibleTime.Max)
 					continue;
 
@@ -582,7 +603,6 @@ namespace PeepoDrumKit
 				}
 			}
 
-			static constexpr BranchType branchForThisRow = TimelineRowToBranchType(RowType);
 			if (!timeline.TempDeletedNoteAnimationsBuffer.empty())
 			{
 				for (const auto& data : timeline.TempDeletedNoteAnimationsBuffer)
@@ -631,8 +651,9 @@ namespace PeepoDrumKit
 		}
 		else if constexpr (std::is_same_v<T, GoGoRange>)
 		{
-			for (const GoGoRange& it : list)
+			for (size_t i = visibleRange.First; i < visibleRange.End; i++)
 			{
+				const GoGoRange& it = list[i];
 				const Time startTime = context.BeatToTime(it.GetStart());
 				const Time endTime = context.BeatToTime(it.GetEnd());
 				if (endTime < visibleTime.Min || startTime > visibleTime.Max)
@@ -648,8 +669,9 @@ namespace PeepoDrumKit
 		{
 			const Beat chartBeatDuration = context.TimeToBeat(context.Chart.GetDurationOrDefault());
 
+			// NOTE: Each lyric extends all the way up to the next one, so the last one before the visible range might still be reaching into it
 			Gui::PushFont(FontMain_JP);
-			for (size_t i = 0; i < list.size(); i++)
+			for (size_t i = (visibleRange.First > 0) ? (visibleRange.First - 1) : 0; i < visibleRange.End; i++)
 			{
 				const LyricChange* prevLyric = IndexOrNull(static_cast<i32>(i) - 1, list);
 				const LyricChange& thisLyric = list[i];
@@ -699,8 +721,9 @@ namespace PeepoDrumKit
 			const b8 useCompactFormat = (camera.ZoomTarget.x < compactFormatStringZoomLevelThreshold);
 			const f32 textHeight = Gui::GetFontSize();
 
-			for (const auto& it : list)
+			for (size_t i = visibleRange.First; i < visibleRange.End; i++)
 			{
+				const auto& it = list[i];
 				const Time startTime = context.BeatToTime(GetBeat(it));
 				if (startTime < visibleTime.Min || startTime > visibleTime.Max)
 					continue;
@@ -713,7 +736,7 @@ namespace PeepoDrumKit
 				Gui::DisableFontPixelSnap(true);
 				{
 					[[maybe_unused]] char b[32]; std::string_view text; u32 lineColor; u32 textColor = TimelineItemTextColor;
-					if constexpr (std::is_same_v<T, TempoChange>) { text = std::string_view(b, sprintf_s(b, useCompactFormat ? "%.0f BPM" : "%g BPM", it.Tempo.BPM)); lineColor = TimelineTempoChangeLineColor; }
+					if constexpr (std::is_same_v<T, TempoChange>) { text = std::string_view(b, sprintf_s(b, useCompactFormat ? "%.0f BPM" : "%g BPM", it.TempoValue.BPM)); lineColor = TimelineTempoChangeLineColor; }
 					if constexpr (std::is_same_v<T, TimeSignatureChange>) { text = std::string_view(b, sprintf_s(b, "%d/%d", it.Signature.Numerator, it.Signature.Denominator)); lineColor = TimelineSignatureChangeLineColor; textColor = IsTimeSignatureSupported(it.Signature) ? TimelineItemTextColor : TimelineItemTextColorWarning; }
 					if constexpr (std::is_same_v<T, ScrollChange>) { text = std::string_view(b, sprintf_s(b, "%gx", it.ScrollSpeed)); lineColor = TimelineScrollChangeLineColor; }
 					if constexpr (std::is_same_v<T, BarLineChange>) { text = it.IsVisible ? "On" : "Off"; lineColor = TimelineBarLineChangeLineColor; }
@@ -765,19 +788,20 @@ namespace PeepoDrumKit
 			if (waveform.IsEmpty())
 				continue;
 
-			const auto& waveformMip = waveform.FindClosestMip(waveformTimePerPixel);
-			for (i32 visiblePixel = 0; visiblePixel < scrollbarRect.GetWidth(); /*visiblePixel++*/)
+			for (i32 visiblePixel = 0; visiblePixel < scrollbarRect.GetWidth(); visiblePixel += CustomDraw::WaveformPixelsPerChunk)
 			{
 				CustomDraw::WaveformChunk chunk;
 				const Rect chunkRect = Rect::FromTLSize(timeline.LocalToScreenSpace_ScrollbarX(vec2(static_cast<f32>(visiblePixel), 0.5f)), vec2(static_cast<f32>(CustomDraw::WaveformPixelsPerChunk), scrollbarHeight));
 
+				const Time chunkStartTime = (waveformTimePerPixel * static_cast<f64>(visiblePixel)) - chartSongOffset;
+				waveform.GetAmplitudesForPixels(chunkStartTime, waveformTimePerPixel, chunk.PerPixelAmplitude, CustomDraw::WaveformPixelsPerChunk);
+
 				for (i32 chunkPixel = 0; chunkPixel < CustomDraw::WaveformPixelsPerChunk; chunkPixel++)
 				{
-					const Time timeAtPixel = (waveformTimePerPixel * static_cast<f64>(visiblePixel)) - chartSongOffset;
+					const Time timeAtPixel = chunkStartTime + (waveformTimePerPixel * static_cast<f64>(chunkPixel));
 					const b8 outOfBounds = (timeAtPixel < Time::Zero() || (timeAtPixel > waveformDuration));
 
-					chunk.PerPixelAmplitude[chunkPixel] = outOfBounds ? 0.0f : (waveformAnimationScale * ClampBot(waveform.GetAmplitudeAt(waveformMip, timeAtPixel, waveformTimePerPixel), minAmplitude));
-					visiblePixel++;
+					chunk.PerPixelAmplitude[chunkPixel] = outOfBounds ? 0.0f : (waveformAnimationScale * ClampBot(chunk.PerPixelAmplitude[chunkPixel], minAmplitude));
 				}
 
 				CustomDraw::DrawWaveformChunk(drawList, chunkRect, waveformColor, chunk);
@@ -785,20 +809,25 @@ namespace PeepoDrumKit
 		}
 	}
 
-	static void DrawTimelineScrollbarXMinimap(const ChartTimeline& timeline, ImDrawList* drawList, const ChartCourse& course, BranchType branch, Time chartDuration)
+	static void DrawTimelineScrollbarXMinimap(const ChartTimeline& timeline, ImDrawList* drawList, const ChartCourse& course, const ChartCourseTimingCache& timingCache, BranchType branch, Time chartDuration)
 	{
 		const vec2 localNoteRectSize = GuiScale(vec2(2.0f, 4.0f)); // timeline.Regions.ContentScrollbarX.GetHeight() * 0.25f;
 		const f32 localNoteCenterY = timeline.Regions.ContentScrollbarX.GetHeight() * /*0.5f*//*0.75f*/0.25f;
 
+		const SortedNotesList& notes = course.GetNotes(branch);
+		const ChartCourseTimingCache::NoteTimings& timings = timingCache.Notes[EnumToIndex(branch)];
+		assert(timings.HeadTimes.size() == notes.size());
+
 		// TODO: Also draw other timeline items... tempo / signature changes, gogo-time etc. (?)
-		for (const Note& note : course.GetNotes(branch))
+		for (size_t i = 0; i < notes.size(); i++)
 		{
-			const f32 localHeadX = TimeToScrollbarLocalSpaceX(course.TempoMap.BeatToTime(note.GetStart()) + note.TimeOffset, timeline.Regions, chartDuration);
+			const Note& note = notes[i];
+			const f32 localHeadX = TimeToScrollbarLocalSpaceX(timings.HeadTimes[i], timeline.Regions, chartDuration);
 			Rect screenNoteRect = Rect::FromCenterSize(timeline.LocalToScreenSpace_ScrollbarX(vec2(localHeadX, localNoteCenterY)), localNoteRectSize);
 
 			if (note.BeatDuration > Beat::Zero())
 			{
-				const f32 localTailX = TimeToScrollbarLocalSpaceX(course.TempoMap.BeatToTime(note.GetEnd()) + note.TimeOffset, timeline.Regions, chartDuration);
+				const f32 localTailX = TimeToScrollbarLocalSpaceX(timings.TailTimes[i], timeline.Regions, chartDuration);
 				screenNoteRect.BR.x += (localTailX - localHeadX);
 			}
 
@@ -815,14 +844,25 @@ namespace PeepoDrumKit
 		Time& nonSmoothCursorThisFrame = context.CursorNonSmoothTimeThisFrame;
 		Time& nonSmoothCursorLastFrame = context.CursorNonSmoothTimeLastFrame;
 
+		i64 cursorStreamFrame = 0;
 		nonSmoothCursorLastFrame = nonSmoothCursorThisFrame;
-		nonSmoothCursorThisFrame = (context.SongVoice.GetPosition() + context.Chart.SongOffset);
+		nonSmoothCursorThisFrame = (context.SongVoice.GetPositionAtStreamFrame(cursorStreamFrame) + context.Chart.SongOffset);
 
 		const Time elapsedCursorTimeSinceLastUpdate = (nonSmoothCursorLastFrame - nonSmoothCursorThisFrame);
 		if (elapsedCursorTimeSinceLastUpdate >= frameTimeThresholdAtWhichPlayingSoundsMakesNoSense)
 			return;
 
-		const Time futureOffset = (playbackSoundFutureOffset * Min(context.SongVoice.GetPlaybackSpeed(), 1.0f));
+		// NOTE: Sounds are scheduled at the exact output stream frame their chart time corresponds to, relative to the (sample accurate) song voice position.
+		//		 The additional buffer of lookahead ensures the render thread is never handed a start for a buffer it has already begun rendering
+		const f32 playbackSpeed = context.SongVoice.GetPlaybackSpeed();
+		const Time bufferLookahead = Audio::FramesToTime(Audio::Engine.GetBufferFrameSize(), Audio::AudioEngine::OutputSampleRate) * playbackSpeed;
+		const Time futureOffset = (playbackSoundFutureOffset * Min(playbackSpeed, 1.0f)) + bufferLookahead;
+
+		auto chartTimeToStreamFrame = [&](Time chartTime) -> i64
+		{
+			const Time outputTimeUntilChartTime = Time::FromSec((chartTime - nonSmoothCursorThisFrame).ToSec() / static_cast<f64>(playbackSpeed));
+			return cursorStreamFrame + Audio::TimeToFrames(outputTimeUntilChartTime, Audio::AudioEngine::OutputSampleRate);
+		};
 
 		if (playbackSoundsEnabled)
 		{
@@ -831,43 +871,14 @@ namespace PeepoDrumKit
 				const Time offsetNoteTime = noteTime - futureOffset;
 				if (offsetNoteTime >= nonSmoothCursorLastFrame && offsetNoteTime < nonSmoothCursorThisFrame)
 				{
-					// NOTE: Don't wanna cause any audio cutoffs. If this happens the future threshold is either set too low for the current frame time
-					//		 or playback was started on top of an existing note
-					const Time startTime = Min((nonSmoothCursorThisFrame - noteTime), Time::Zero());
-					const Time externalClock = noteTime;
-
-					context.SfxVoicePool.PlaySound(SoundEffectTypeForNoteType(noteType), startTime, externalClock);
+					// NOTE: Don't wanna cause any audio cutoffs. A stream frame in the past (if the future threshold is set too low for the current frame time
+					//		 or playback was started on top of an existing note) gets started right away, skipped ahead to stay in sync
+					context.SfxVoicePool.PlaySoundAtStreamFrame(SoundEffectTypeForNoteType(noteType), chartTimeToStreamFrame(noteTime));
 				}
 			};
 
-			for (const Note& note : context.ChartSelectedCourse->GetNotes(context.ChartSelectedBranch))
-			{
-				if (note.BeatDuration > Beat::Zero())
-				{
-					if (IsBalloonNote(note.Type))
-					{
-						checkAndPlayNoteSound(context.BeatToTime(note.BeatTime) + note.TimeOffset, note.Type);
-
-						const Beat balloonBeatInterval = (note.BalloonPopCount > 0) ? (note.BeatDuration / note.BalloonPopCount) : Beat::Zero();
-						if (balloonBeatInterval > Beat::Zero())
-						{
-							i32 remainingPops = note.BalloonPopCount;
-							for (Beat subBeat = balloonBeatInterval; (subBeat < note.BeatDuration) && (--remainingPops > 0); subBeat += balloonBeatInterval)
-								checkAndPlayNoteSound(context.BeatToTime(note.BeatTime + subBeat) + note.TimeOffset, note.Type);
-						}
-					}
-					else
-					{
-						const Beat drummrollBeatInterval = GetGridBeatSnap(*Settings.General.DrumrollAutoHitBarDivision);
-						for (Beat subBeat = Beat::Zero(); subBeat <= note.BeatDuration; subBeat += drummrollBeatInterval)
-							checkAndPlayNoteSound(context.BeatToTime(note.BeatTime + subBeat) + note.TimeOffset, note.Type);
-					}
-				}
-				else
-				{
-					checkAndPlayNoteSound(context.BeatToTime(note.BeatTime) + note.TimeOffset, note.Type);
-				}
-			}
+			const Beat drumrollHitInterval = GetGridBeatSnap(*Settings.General.DrumrollAutoHitBarDivision);
+			ForEachNoteHitSound(context.ChartSelectedCourse->GetNotes(context.ChartSelectedBranch), context.ChartSelectedCourse->TempoMap, drumrollHitInterval, checkAndPlayNoteSound);
 		}
 
 		if (metronome.IsEnabled)
@@ -885,10 +896,10 @@ namespace PeepoDrumKit
 
 			context.ChartSelectedCourse->TempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
 			{
-				if (it.Beat >= cursorBeatEnd)
+				if (it.BeatTime >= cursorBeatEnd)
 					return ControlFlow::Break;
 
-				const Time beatTime = context.BeatToTime(it.Beat);
+				const Time beatTime = context.BeatToTime(it.BeatTime);
 				const Time offsetBeatTime = (beatTime - futureOffset);
 
 				// BUG: This is definitely too lenient and easily falsely triggers 1/16th after a bar start
@@ -906,8 +917,7 @@ namespace PeepoDrumKit
 					if (metronome.LastPlayedBeatTime != beatTime)
 					{
 						metronome.LastPlayedBeatTime = beatTime;
-						const Time startTime = Min((nonSmoothCursorThisFrame - beatTime), Time::Zero());
-						context.SfxVoicePool.PlaySound(it.IsBar ? SoundEffectType::MetronomeBar : SoundEffectType::MetronomeBeat, startTime);
+						context.SfxVoicePool.PlaySoundAtStreamFrame(it.IsBar ? SoundEffectType::MetronomeBar : SoundEffectType::MetronomeBeat, chartTimeToStreamFrame(beatTime));
 					}
 					return ControlFlow::Break;
 				}
@@ -1045,7 +1055,7 @@ namespace PeepoDrumKit
 					if (!context.SongWaveformL.IsEmpty())
 						DrawTimelineScrollbarXWaveform(*this, Gui::GetWindowDrawList(), context.Chart.SongOffset, chartDuration, context.SongWaveformL, context.SongWaveformR, context.SongWaveformFadeAnimationCurrent);
 
-					DrawTimelineScrollbarXMinimap(*this, Gui::GetWindowDrawList(), *context.ChartSelectedCourse, context.ChartSelectedBranch, chartDuration);
+					DrawTimelineScrollbarXMinimap(*this, Gui::GetWindowDrawList(), *context.ChartSelectedCourse, context.GetUpdatedTimingCache(), context.ChartSelectedBranch, chartDuration);
 
 					const f32 animatedCursorLocalSpaceX = TimeToScrollbarLocalSpaceXClamped(Camera.WorldSpaceXToTime(WorldSpaceCursorXAnimationCurrent), Regions, chartDuration);
 					const f32 currentCursorLocalSpaceX = TimeToScrollbarLocalSpaceXClamped(cursorTime, Regions, chartDuration);
@@ -1135,18 +1145,18 @@ namespace PeepoDrumKit
 				case GenericList::TempoChanges:
 				{
 					const auto& in = item.Value.POD.Tempo;
-					bufferLength = sprintf_s(buffer, "Tempo { %d, %g };\n", (in.Beat - baseBeat).Ticks, in.Tempo.BPM);
+					bufferLength = sprintf_s(buffer, "Tempo { %d, %g };\n", (in.BeatTime - baseBeat).Ticks, in.TempoValue.BPM);
 				} break;
 				case GenericList::SignatureChanges:
 				{
 					const auto& in = item.Value.POD.Signature;
-					bufferLength = sprintf_s(buffer, "TimeSignature { %d, %d, %d };\n", (in.Beat - baseBeat).Ticks, in.Signature.Numerator, in.Signature.Denominator);
+					bufferLength = sprintf_s(buffer, "TimeSignature { %d, %d, %d };\n", (in.BeatTime - baseBeat).Ticks, in.Signature.Numerator, in.Signature.Denominator);
 				} break;
 				case GenericList::Notes_Normal:
 				case GenericList::Notes_Expert:
 				case GenericList::Notes_Master:
 				{
-					const auto& in = item.Value.POD.Note;
+					const auto& in = item.Value.POD.NoteItem;
 					bufferLength = sprintf_s(buffer, "Note { %d, %d, %d, %d, %g };\n", (in.BeatTime - baseBeat).Ticks, in.BeatDuration.Ticks, static_cast<i32>(in.Type), in.BalloonPopCount, in.TimeOffset.ToMS());
 				} break;
 				case GenericList::ScrollChanges:
@@ -1242,22 +1252,22 @@ namespace PeepoDrumKit
 						auto& newItem = out.emplace_back(); newItem.List = GenericList::TempoChanges;
 						auto& newItemValue = newItem.Value.POD.Tempo;
 						newItemValue = TempoChange {};
-						newItemValue.Beat.Ticks = parsedParams[0].I32;
-						newItemValue.Tempo.BPM = parsedParams[1].F32;
+						newItemValue.BeatTime.Ticks = parsedParams[0].I32;
+						newItemValue.TempoValue.BPM = parsedParams[1].F32;
 					}
 					else if (itemType == "TimeSignature")
 					{
 						auto& newItem = out.emplace_back(); newItem.List = GenericList::SignatureChanges;
 						auto& newItemValue = newItem.Value.POD.Signature;
 						newItemValue = TimeSignatureChange {};
-						newItemValue.Beat.Ticks = parsedParams[0].I32;
+						newItemValue.BeatTime.Ticks = parsedParams[0].I32;
 						newItemValue.Signature.Numerator = parsedParams[1].I32;
 						newItemValue.Signature.Denominator = parsedParams[2].I32;
 					}
 					else if (itemType == "Note")
 					{
 						auto& newItem = out.emplace_back(); newItem.List = GenericList::Notes_Normal;
-						auto& newItemValue = newItem.Value.POD.Note;
+						auto& newItemValue = newItem.Value.POD.NoteItem;
 						newItemValue = Note {};
 						newItemValue.BeatTime.Ticks = parsedParams[0].I32;
 						newItemValue.BeatDuration.Ticks = parsedParams[1].I32;
@@ -1299,7 +1309,7 @@ namespace PeepoDrumKit
 		static constexpr auto copyAllSelectedItems = [](const ChartCourse& course) -> std::vector<GenericListStructWithType>
 		{
 			std::vector<GenericListStructWithType> out;
-			size_t selectionCount = 0; ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { selectionCount++; });
+			const size_t selectionCount = CountSelectedChartItems(course);
 			if (selectionCount > 0)
 			{
 				out.reserve(selectionCount);
@@ -1333,7 +1343,7 @@ namespace PeepoDrumKit
 					if (IsNotesList(item.List))
 					{
 						TempDeletedNoteAnimationsBuffer.push_back(
-							DeletedNoteAnimation { item.Value.POD.Note, context.ChartSelectedBranch, ConvertRange(0.0f, static_cast<f32>(selectedItems.size()), 0.0f, -0.08f, static_cast<f32>(selectedNoteIndex)) });
+							DeletedNoteAnimation { item.Value.POD.NoteItem, context.ChartSelectedBranch, ConvertRange(0.0f, static_cast<f32>(selectedItems.size()), 0.0f, -0.08f, static_cast<f32>(selectedNoteIndex)) });
 						selectedNoteIndex++;
 					}
 				}
@@ -1366,9 +1376,9 @@ namespace PeepoDrumKit
 					{
 					case GenericList::TempoChanges: return check(course.TempoMap.Tempo, item.Value.POD.Tempo);
 					case GenericList::SignatureChanges: return check(course.TempoMap.Signature, item.Value.POD.Signature);
-					case GenericList::Notes_Normal: return check(course.Notes_Normal, item.Value.POD.Note);
-					case GenericList::Notes_Expert: return check(course.Notes_Expert, item.Value.POD.Note);
-					case GenericList::Notes_Master: return check(course.Notes_Master, item.Value.POD.Note);
+					case GenericList::Notes_Normal: return check(course.Notes_Normal, item.Value.POD.NoteItem);
+					case GenericList::Notes_Expert: return check(course.Notes_Expert, item.Value.POD.NoteItem);
+					case GenericList::Notes_Master: return check(course.Notes_Master, item.Value.POD.NoteItem);
 					case GenericList::ScrollChanges: return check(course.ScrollChanges, item.Value.POD.Scroll);
 					case GenericList::BarLineChanges: return check(course.BarLineChanges, item.Value.POD.BarLine);
 					case GenericList::GoGoRanges: return check(course.GoGoRanges, item.Value.POD.GoGo);
@@ -1384,7 +1394,7 @@ namespace PeepoDrumKit
 
 					b8 isFirstNote = true;
 					for (const auto& item : clipboardItems)
-						if (isFirstNote && IsNotesList(item.List)) { context.SfxVoicePool.PlaySound(SoundEffectTypeForNoteType(item.Value.POD.Note.Type)); isFirstNote = false; }
+						if (isFirstNote && IsNotesList(item.List)) { context.SfxVoicePool.PlaySound(SoundEffectTypeForNoteType(item.Value.POD.NoteItem.Type)); isFirstNote = false; }
 
 					context.Undo.Execute<Commands::AddMultipleGenericItems_Paste>(&course, std::move(clipboardItems));
 				}
@@ -1397,7 +1407,7 @@ namespace PeepoDrumKit
 				for (const auto& item : selectedItems)
 				{
 					if (IsNotesList(item.List))
-						TempDeletedNoteAnimationsBuffer.push_back(DeletedNoteAnimation { item.Value.POD.Note, context.ChartSelectedBranch, 0.0f });
+						TempDeletedNoteAnimationsBuffer.push_back(DeletedNoteAnimation { item.Value.POD.NoteItem, context.ChartSelectedBranch, 0.0f });
 				}
 
 				context.Undo.Execute<Commands::RemoveMultipleGenericItems>(&course, std::move(selectedItems));
@@ -1414,7 +1424,7 @@ namespace PeepoDrumKit
 		{
 		default: { assert(false); } break;
 		case SelectionAction::SelectAll: { ForEachChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, true); }); } break;
-		case SelectionAction::UnselectAll: { ForEachChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, false); }); } break;
+		case SelectionAction::UnselectAll: { ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, false); }); } break;
 		case SelectionAction::InvertAll: { ForEachChartItem(course, [&](const ForEachChartItemData& it) { it.SetIsSelected(course, !it.GetIsSelected(course)); }); } break;
 		case SelectionAction::SelectAllWithinRangeSelection:
 		{
@@ -1433,39 +1443,20 @@ namespace PeepoDrumKit
 		} break;
 		case SelectionAction::PerRowShiftSelected:
 		{
-			struct ItemProxy
-			{
-				ChartCourse& Course; GenericList List; i32 Index;
-				inline b8 Exists() const { return (Index >= 0); }
-				inline b8 IsSelected() const { GenericMemberUnion v {}; TryGetGeneric(Course, List, Index, GenericMember::B8_IsSelected, v); return v.B8; }
-				inline void IsSelected(b8 isSelected) { GenericMemberUnion v {}; v.B8 = isSelected; TrySetGeneric(Course, List, Index, GenericMember::B8_IsSelected, v); }
-				inline static ItemProxy At(ChartCourse& course, GenericList list, i32 listCount, i32 i) { return ItemProxy { course, list, (i >= 0) && (i < listCount) ? i : -1 }; }
-			};
-
+			// NOTE: Every selected item passes its selection on to its neighbor (if there is one), which only has to look at the selected items themselves
+			std::vector<size_t> selectedIndices;
 			for (GenericList list = {}; list < GenericList::Count; IncrementEnum(list))
 			{
 				const i32 listCount = static_cast<i32>(GetGenericListCount(course, list));
-				if (param.ShiftDelta > 0)
-				{
-					for (i32 i = listCount - 1; i >= 0; i--)
-					{
-						ItemProxy thisIt = ItemProxy::At(course, list, listCount, i);
-						ItemProxy nextIt = ItemProxy::At(course, list, listCount, i + 1);
-						if (nextIt.Exists() && thisIt.IsSelected())
-							nextIt.IsSelected(true);
-						thisIt.IsSelected(false);
-					}
-				}
-				else if (param.ShiftDelta < 0)
+				selectedIndices = GetGenericListSelectedIndices(course, list);
+
+				for (const size_t i : selectedIndices)
+					ForEachChartItemData { list, i }.SetIsSelected(course, false);
+
+				for (const size_t i : selectedIndices)
 				{
-					for (i32 i = 0; i < listCount; i++)
-					{
-						ItemProxy thisIt = ItemProxy::At(course, list, listCount, i);
-						ItemProxy prevIt = ItemProxy::At(course, list, listCount, i - 1);
-						if (prevIt.Exists() && thisIt.IsSelected())
-							prevIt.IsSelected(true);
-						thisIt.IsSelected(false);
-					}
+					if (const i32 shiftedIndex = static_cast<i32>(i) + param.ShiftDelta; shiftedIndex >= 0 && shiftedIndex < listCount)
+						ForEachChartItemData { list, static_cast<size_t>(shiftedIndex) }.SetIsSelected(course, true);
 				}
 			}
 		} break;
@@ -1477,15 +1468,13 @@ namespace PeepoDrumKit
 			const std::string_view pattern = param.Pattern;
 			for (GenericList list = {}; list < GenericList::Count; IncrementEnum(list))
 			{
-				for (size_t i = 0, patternIndex = 0; i < GetGenericListCount(course, list); i++)
+				const std::vector<size_t>& selectedIndices = GetGenericListSelectedIndices(course, list);
+				for (size_t i = 0, patternIndex = 0; i < selectedIndices.size(); i++)
 				{
-					if (const ForEachChartItemData it = { list, i }; it.GetIsSelected(course))
-					{
-						if (pattern[patternIndex] != 'x')
-							it.SetIsSelected(course, false);
-						if (++patternIndex >= pattern.size())
-							patternIndex = 0;
-					}
+					if (pattern[patternIndex] != 'x')
+						ForEachChartItemData { list, selectedIndices[i] }.SetIsSelected(course, false);
+					if (++patternIndex >= pattern.size())
+						patternIndex = 0;
 				}
 			}
 		} break;
@@ -1502,21 +1491,23 @@ namespace PeepoDrumKit
 		{
 			for (BranchType branch = {}; branch < BranchType::Count; IncrementEnum(branch))
 			{
-				size_t selectedNoteCount = 0;
 				SortedNotesList& notes = context.ChartSelectedCourse->GetNotes(branch);
-				for (const Note& note : notes) { if (note.IsSelected && IsNoteFlippable(note.Type)) selectedNoteCount++; }
+				const std::vector<size_t>& selectedIndices = notes.GetSelectedIndices();
+
+				size_t selectedNoteCount = 0;
+				for (const size_t i : selectedIndices) { if (IsNoteFlippable(notes[i].Type)) selectedNoteCount++; }
 				if (selectedNoteCount <= 0)
 					continue;
 
 				std::vector<Commands::ChangeMultipleNoteTypes::Data> noteTypesToChange;
 				noteTypesToChange.reserve(selectedNoteCount);
 
-				for (Note& note : notes)
+				for (const size_t i : selectedIndices)
 				{
-					if (note.IsSelected && IsNoteFlippable(note.Type))
+					if (Note& note = notes[i]; IsNoteFlippable(note.Type))
 					{
 						auto& data = noteTypesToChange.emplace_back();
-						data.Index = ArrayItToIndex(&note, &notes[0]);
+						data.Index = i;
 						data.NewType = FlipNote(note.Type);
 						note.ClickAnimationTimeRemaining = note.ClickAnimationTimeDuration = NoteHitAnimationDuration;
 					}
@@ -1531,24 +1522,21 @@ namespace PeepoDrumKit
 		{
 			for (BranchType branch = {}; branch < BranchType::Count; IncrementEnum(branch))
 			{
-				size_t selectedNoteCount = 0;
 				SortedNotesList& notes = context.ChartSelectedCourse->GetNotes(branch);
-				for (const Note& note : notes) { if (note.IsSelected) selectedNoteCount++; }
-				if (selectedNoteCount <= 0)
+				const std::vector<size_t>& selectedIndices = notes.GetSelectedIndices();
+				if (selectedIndices.empty())
 					continue;
 
 				std::vector<Commands::ChangeMultipleNoteTypes::Data> noteTypesToChange;
-				noteTypesToChange.reserve(selectedNoteCount);
+				noteTypesToChange.reserve(selectedIndices.size());
 
-				for (Note& note : notes)
+				for (const size_t i : selectedIndices)
 				{
-					if (note.IsSelected)
-					{
-						auto& data = noteTypesToChange.emplace_back();
-						data.Index = ArrayItToIndex(&note, &notes[0]);
-						data.NewType = ToggleNoteSize(note.Type);
-						note.ClickAnimationTimeRemaining = note.ClickAnimationTimeDuration = NoteHitAnimationDuration;
-					}
+					Note& note = notes[i];
+					auto& data = noteTypesToChange.emplace_back();
+					data.Index = i;
+					data.NewType = ToggleNoteSize(note.Type);
+					note.ClickAnimationTimeRemaining = note.ClickAnimationTimeDuration = NoteHitAnimationDuration;
 				}
 
 				context.SfxVoicePool.PlaySound(SoundEffectTypeForNoteType(noteTypesToChange[0].NewType));
@@ -1559,7 +1547,7 @@ namespace PeepoDrumKit
 		case TransformAction::ScaleItemTime:
 		{
 			assert(param.TimeRatio[0] > 0 && param.TimeRatio[1] > 0 && param.TimeRatio[0] != param.TimeRatio[1]);
-			size_t selectedItemCount = 0; ForEachSelectedChartItem(course, [&](const ForEachChartItemData& it) { selectedItemCount++; });
+			const size_t selectedItemCount = CountSelectedChartItems(course);
 			if (selectedItemCount <= 0)
 				return;
 
@@ -1578,14 +1566,14 @@ namespace PeepoDrumKit
 				itemToAdd.SetBeat((((itemToAdd.GetBeat() - firstBeat) / param.TimeRatio[1]) * param.TimeRatio[0]) + firstBeat);
 
 				if (IsNotesList(itemToAdd.List))
-					itemToAdd.Value.POD.Note.ClickAnimationTimeRemaining = itemToAdd.Value.POD.Note.ClickAnimationTimeDuration = NoteHitAnimationDuration;
+					itemToAdd.Value.POD.NoteItem.ClickAnimationTimeRemaining = itemToAdd.Value.POD.NoteItem.ClickAnimationTimeDuration = NoteHitAnimationDuration;
 			});
 
 			// BUG: Resolve item duration intersections (only *add* notes if they don't interect another non-selected long item (?))
 			// BUG: Overwritten items not correctly restored on undo (?)
 			if (!itemsToRemove.empty() || !itemsToAdd.empty())
 			{
-				for (auto& it : itemsToAdd) if (IsNotesList(it.List)) { context.SfxVoicePool.PlaySound(SoundEffectTypeForNoteType(it.Value.POD.Note.Type)); break; }
+				for (auto& it : itemsToAdd) if (IsNotesList(it.List)) { context.SfxVoicePool.PlaySound(SoundEffectTypeForNoteType(it.Value.POD.NoteItem.Type)); break; }
 
 				if (param.TimeRatio[0] < param.TimeRatio[1])
 					context.Undo.Execute<Commands::RemoveThenAddMultipleGenericItems_CompressItems>(&course, std::move(itemsToRemove), std::move(itemsToAdd));
@@ -1627,7 +1615,7 @@ namespace PeepoDrumKit
 
 			if (*Settings.General.ConvertSelectionToScrollChanges_SelectNew)
 			{
-				for (auto* it : scrollChangesThatAlreadyExist) { it->IsSelected = true; }
+				for (auto* it : scrollChangesThatAlreadyExist) { it->IsSelected = true; course.ScrollChanges.SyncCachedSelectionAt(ArrayItToIndex(it, &course.ScrollChanges[0])); }
 				for (auto& it : scrollChangesToAdd) { it.IsSelected = true; }
 			}
 
@@ -1738,39 +1726,36 @@ namespace PeepoDrumKit
 						const Rect screenRowRect = Rect(LocalToScreenSpace(vec2(0.0f, rowIt.LocalY)), LocalToScreenSpace(vec2(Regions.Content.GetWidth(), rowIt.LocalY + rowIt.LocalHeight)));
 						const vec2 screenRectCenter = screenRowRect.GetCenter();
 
-						for (size_t i = 0; i < GetGenericListCount(selectedCourse, list); i++)
+						for (const size_t i : GetGenericListSelectedIndices(selectedCourse, list))
 						{
-							GenericMemberUnion beatStart, beatDuration, isSelected, noteType;
-							if (TryGetGeneric(selectedCourse, list, i, GenericMember::B8_IsSelected, isSelected) && isSelected.B8)
-							{
-								const b8 hasBeatStart = TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Start, beatStart);
-								const b8 hasBeatDuration = TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Duration, beatDuration);
+							GenericMemberUnion beatStart, beatDuration, noteType;
+							const b8 hasBeatStart = TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Start, beatStart);
+							const b8 hasBeatDuration = TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Duration, beatDuration);
 
-								Rect screenHitbox = {};
-								if (isNotesRow)
-								{
-									TryGetGeneric(selectedCourse, list, i, GenericMember::NoteType_V, noteType);
+							Rect screenHitbox = {};
+							if (isNotesRow)
+							{
+								TryGetGeneric(selectedCourse, list, i, GenericMember::NoteType_V, noteType);
 
-									const vec2 center = vec2(LocalToScreenSpace(vec2(Camera.TimeToLocalSpaceX(context.BeatToTime(beatStart.Beat)), 0.0f)).x, screenRectCenter.y);
-									screenHitbox = Rect::FromCenterSize(center, vec2(GuiScale(IsBigNote(noteType.NoteType) ? TimelineSelectedNoteHitBoxSizeBig : TimelineSelectedNoteHitBoxSizeSmall)));
-								}
-								else
-								{
-									// TODO: Proper hitboxses (at least for gogo range and lyrics?)
-									const vec2 center = vec2(LocalToScreenSpace(vec2(Camera.TimeToLocalSpaceX(context.BeatToTime(beatStart.Beat)), 0.0f)).x, screenRectCenter.y);
-									screenHitbox = Rect::FromCenterSize(center, vec2(GuiScale(TimelineSelectedNoteHitBoxSizeSmall)));
-								}
+								const vec2 center = vec2(LocalToScreenSpace(vec2(Camera.TimeToLocalSpaceX(context.BeatToTime(beatStart.BeatV)), 0.0f)).x, screenRectCenter.y);
+								screenHitbox = Rect::FromCenterSize(center, vec2(GuiScale(IsBigNote(noteType.NoteTypeV) ? TimelineSelectedNoteHitBoxSizeBig : TimelineSelectedNoteHitBoxSizeSmall)));
+							}
+							else
+							{
+								// TODO: Proper hitboxses (at least for gogo range and lyrics?)
+								const vec2 center = vec2(LocalToScreenSpace(vec2(Camera.TimeToLocalSpaceX(context.BeatToTime(beatStart.BeatV)), 0.0f)).x, screenRectCenter.y);
+								screenHitbox = Rect::FromCenterSize(center, vec2(GuiScale(TimelineSelectedNoteHitBoxSizeSmall)));
+							}
 
-								if (screenHitbox.Contains(MousePosThisFrame))
+							if (screenHitbox.Contains(MousePosThisFrame))
+							{
+								SelectedItemDrag.IsHovering = true;
+								if (Gui::IsMouseClicked(ImGuiMouseButton_Left))
 								{
-									SelectedItemDrag.IsHovering = true;
-									if (Gui::IsMouseClicked(ImGuiMouseButton_Left))
-									{
-										SelectedItemDrag.IsActive = true;
-										SelectedItemDrag.BeatOnMouseDown = SelectedItemDrag.MouseBeatThisFrame;
-										SelectedItemDrag.BeatDistanceMovedSoFar = Beat::Zero();
-										context.Undo.DisallowMergeForLastCommand();
-									}
+									SelectedItemDrag.IsActive = true;
+									SelectedItemDrag.BeatOnMouseDown = SelectedItemDrag.MouseBeatThisFrame;
+									SelectedItemDrag.BeatDistanceMovedSoFar = Beat::Zero();
+									context.Undo.DisallowMergeForLastCommand();
 								}
 							}
 						}
@@ -1791,8 +1776,8 @@ namespace PeepoDrumKit
 				if (SelectedItemDrag.IsActive)
 				{
 					auto itemSelected = [&](GenericList list, size_t i) { GenericMemberUnion out; TryGetGeneric(selectedCourse, list, i, GenericMember::B8_IsSelected, out); return out.B8; };
-					auto itemStart = [&](GenericList list, size_t i) { GenericMemberUnion out; TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Start, out); return out.Beat; };
-					auto itemDuration = [&](GenericList list, size_t i) { GenericMemberUnion out; TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Duration, out); return out.Beat; };
+					auto itemStart = [&](GenericList list, size_t i) { GenericMemberUnion out; TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Start, out); return out.BeatV; };
+					auto itemDuration = [&](GenericList list, size_t i) { GenericMemberUnion out; TryGetGeneric(selectedCourse, list, i, GenericMember::Beat_Duration, out); return out.BeatV; };
 					auto checkCanSelectedItemsBeMoved = [&](GenericList list, Beat beatIncrement) -> b8
 					{
 						const i32 listCount = static_cast<i32>(GetGenericListCount(selectedCourse, list));
@@ -1803,13 +1788,17 @@ namespace PeepoDrumKit
 						//		but definitely annoying and a bit confusing
 						// TODO: Rework LyricChange to be Beat+Duration based to avoid the problem all together and also simplify the rest of the code
 						const b8 inclusiveBeatCheck = ListUsesInclusiveBeatCheck(list);
+
+						// NOTE: Only the selected items themselves (and their unselected neighbors) can ever block the move
+						const std::vector<size_t>& selectedIndices = GetGenericListSelectedIndices(selectedCourse, list);
 						if (beatIncrement > Beat::Zero())
 						{
-							for (i32 thisIndex = 0; thisIndex < listCount; thisIndex++)
+							for (const size_t selectedIndex : selectedIndices)
 							{
+								const i32 thisIndex = static_cast<i32>(selectedIndex);
 								const i32 nextIndex = thisIndex + 1;
 								const b8 hasNext = (nextIndex < listCount);
-								if (itemSelected(list, thisIndex) && hasNext && !itemSelected(list, nextIndex))
+								if (hasNext && !itemSelected(list, nextIndex))
 								{
 									const Beat thisEnd = itemStart(list, thisIndex) + itemDuration(list, thisIndex);
 									const Beat nextStart = itemStart(list, nextIndex);
@@ -1828,29 +1817,27 @@ namespace PeepoDrumKit
 						}
 						else
 						{
-							for (i32 thisIndex = (listCount - 1); thisIndex >= 0; thisIndex--)
+							for (const size_t selectedIndex : selectedIndices)
 							{
+								const i32 thisIndex = static_cast<i32>(selectedIndex);
 								const i32 prevIndex = thisIndex - 1;
 								const b8 hasPrev = (prevIndex >= 0);
-								if (itemSelected(list, thisIndex))
-								{
-									const Beat thisStart = itemStart(list, thisIndex);
-									if (thisStart + beatIncrement < Beat::Zero())
-										return false;
+								const Beat thisStart = itemStart(list, thisIndex);
+								if (thisStart + beatIncrement < Beat::Zero())
+									return false;
 
-									if (hasPrev && !itemSelected(list, prevIndex))
+								if (hasPrev && !itemSelected(list, prevIndex))
+								{
+									const Beat prevEnd = itemStart(list, prevIndex) + itemDuration(list, prevIndex);
+									if (inclusiveBeatCheck)
 									{
-										const Beat prevEnd = itemStart(list, prevIndex) + itemDuration(list, prevIndex);
-										if (inclusiveBeatCheck)
-										{
-											if (thisStart + beatIncrement <= prevEnd)
-												return false;
-										}
-										else
-										{
-											if (thisStart + beatIncrement < prevEnd)
-												return false;
-										}
+										if (thisStart + beatIncrement <= prevEnd)
+											return false;
+									}
+									else
+									{
+										if (thisStart + beatIncrement < prevEnd)
+											return false;
 									}
 								}
 							}
@@ -1879,8 +1866,8 @@ namespace PeepoDrumKit
 							{
 								std::vector<Commands::ChangeMultipleNoteBeats::Data> noteBeatsToChange;
 								noteBeatsToChange.reserve(selectedItemCount);
-								for (const Note& note : notes)
-									if (note.IsSelected) { auto& data = noteBeatsToChange.emplace_back(); data.Index = ArrayItToIndex(&note, &notes[0]); data.NewBeat = (note.BeatTime + dragBeatIncrement); }
+								for (const size_t i : notes.GetSelectedIndices())
+									{ auto& data = noteBeatsToChange.emplace_back(); data.Index = i; data.NewBeat = (notes[i].BeatTime + dragBeatIncrement); }
 
 								context.Undo.Execute<Commands::ChangeMultipleNoteBeats_MoveNotes>(&notes, std::move(noteBeatsToChange));
 							}
@@ -1895,14 +1882,14 @@ namespace PeepoDrumKit
 									data.Index = it.Index;
 									data.List = it.List;
 									data.Member = GenericMember::Beat_Start;
-									data.NewValue.Beat = it.GetBeat(selectedCourse) + dragBeatIncrement;
+									data.NewValue.BeatV = it.GetBeat(selectedCourse) + dragBeatIncrement;
 								});
 
 								context.Undo.Execute<Commands::ChangeMultipleGenericProperties_MoveItems>(&selectedCourse, std::move(itemsToChange));
 							}
 
-							for (const Note& note : notes)
-								if (note.IsSelected) { if (note.BeatTime == cursorBeat) PlayNoteSoundAndHitAnimationsAtBeat(context, note.BeatTime); }
+							for (const size_t i : notes.GetSelectedIndices())
+								if (notes[i].BeatTime == cursorBeat) { PlayNoteSoundAndHitAnimationsAtBeat(context, notes[i].BeatTime); }
 
 							// NOTE: Set again to account for a changes in cursor time
 							if (atLeastOneSelectedItemIsTempoChange)
@@ -2362,8 +2349,8 @@ namespace PeepoDrumKit
 								const b8 hasIsSelected = TryGetGeneric(*context.ChartSelectedCourse, list, i, GenericMember::B8_IsSelected, isSelected);
 								assert(hasBeatStart && hasIsSelected);
 
-								const Beat beatMin = beatStart.Beat;
-								const Beat beatMax = (hasBeatDuration && !isNotesRow) ? (beatStart.Beat + beatDuration.Beat) : beatStart.Beat;
+								const Beat beatMin = beatStart.BeatV;
+								const Beat beatMax = (hasBeatDuration && !isNotesRow) ? (beatStart.BeatV + beatDuration.BeatV) : beatStart.BeatV;
 								const b8 isInsideSelectionBox = (beatMin <= selectionBeatMax) && (beatMax >= selectionBeatMin) && (screenMinY <= screenSelectionMax.y) && (screenMaxY >= screenSelectionMin.y);
 
 								switch (BoxSelection.Action)
@@ -2605,6 +2592,8 @@ namespace PeepoDrumKit
 		{
 			const Time visibleTimeOverdraw = Camera.TimePerScreenPixel() * (Gui::GetFrameHeight() * 4.0f);
 			const DrawTimelineContentItemRowParam rowParam = { *this, context, DrawListContent, GetMinMaxVisibleTime(visibleTimeOverdraw), isPlayback, cursorTime, cursorBeatOnPlaybackStart };
+			context.Gfx.BeginCountingDrawCommands(SprGroup::Timeline, DrawListContent);
+			defer { context.Gfx.EndCountingDrawCommands(SprGroup::Timeline); };
 			Gui::PushFont(FontMedium_EN);
 			ForEachTimelineRow(*this, [&](const ForEachRowData& rowIt)
 			{
@@ -85,7 +85,7 @@ namespace PeepoDrumKit
 		{
 			AddTempoChange(SortedTempoMap* tempoMap, TempoChange newValue) : TempoMap(tempoMap), NewValue(newValue) {}
 
-			void Undo() override { TempoMap->Tempo.RemoveAtBeat(NewValue.Beat); TempoMap->RebuildAccelerationStructure(); }
+			void Undo() override { TempoMap->Tempo.RemoveAtBeat(NewValue.BeatTime); TempoMap->RebuildAccelerationStructure(); }
 			void Redo() override { TempoMap->Tempo.InsertOrUpdate(NewValue); TempoMap->RebuildAccelerationStructure(); }
 
 			Undo::MergeResult TryMerge(Command& commandToMerge) override { return Undo::MergeResult::Failed; }
@@ -97,10 +97,10 @@ namespace PeepoDrumKit
 
 		struct RemoveTempoChange : Undo::Command
 		{
-			RemoveTempoChange(SortedTempoMap* tempoMap, Beat beat) : TempoMap(tempoMap), OldValue(*TempoMap->Tempo.TryFindLastAtBeat(beat)) { assert(OldValue.Beat == beat); }
+			RemoveTempoChange(SortedTempoMap* tempoMap, Beat beat) : TempoMap(tempoMap), OldValue(*TempoMap->Tempo.TryFindLastAtBeat(beat)) { assert(OldValue.BeatTime == beat); }
 
 			void Undo() override { TempoMap->Tempo.InsertOrUpdate(OldValue); TempoMap->RebuildAccelerationStructure(); }
-			void Redo() override { TempoMap->Tempo.RemoveAtBeat(OldValue.Beat); TempoMap->RebuildAccelerationStructure(); }
+			void Redo() override { TempoMap->Tempo.RemoveAtBeat(OldValue.BeatTime); TempoMap->RebuildAccelerationStructure(); }
 
 			Undo::MergeResult TryMerge(Command& commandToMerge) override { return Undo::MergeResult::Failed; }
 			Undo::CommandInfo GetInfo() const override { return { "Remove Tempo Change" }; }
@@ -111,7 +111,7 @@ namespace PeepoDrumKit
 
 		struct UpdateTempoChange : Undo::Command
 		{
-			UpdateTempoChange(SortedTempoMap* tempoMap, TempoChange newValue) : TempoMap(tempoMap), NewValue(newValue), OldValue(*TempoMap->Tempo.TryFindLastAtBeat(newValue.Beat)) { assert(newValue.Beat == OldValue.Beat); }
+			UpdateTempoChange(SortedTempoMap* tempoMap, TempoChange newValue) : TempoMap(tempoMap), NewValue(newValue), OldValue(*TempoMap->Tempo.TryFindLastAtBeat(newValue.BeatTime)) { assert(newValue.BeatTime == OldValue.BeatTime); }
 
 			void Undo() override { TempoMap->Tempo.InsertOrUpdate(OldValue); TempoMap->RebuildAccelerationStructure(); }
 			void Redo() override { TempoMap->Tempo.InsertOrUpdate(NewValue); TempoMap->RebuildAccelerationStructure(); }
@@ -119,7 +119,7 @@ namespace PeepoDrumKit
 			Undo::MergeResult TryMerge(Command& commandToMerge) override
 			{
 				auto* other = static_cast<decltype(this)>(&commandToMerge);
-				if (other->TempoMap != TempoMap || other->NewValue.Beat != NewValue.Beat)
+				if (other->TempoMap != TempoMap || other->NewValue.BeatTime != NewValue.BeatTime)
 					return Undo::MergeResult::Failed;
 
 				NewValue = other->NewValue;
@@ -136,7 +136,7 @@ namespace PeepoDrumKit
 		{
 			AddTimeSignatureChange(SortedTempoMap* tempoMap, TimeSignatureChange newValue) : TempoMap(tempoMap), NewValue(newValue) {}
 
-			void Undo() override { TempoMap->Signature.RemoveAtBeat(NewValue.Beat); }
+			void Undo() override { TempoMap->Signature.RemoveAtBeat(NewValue.BeatTime); }
 			void Redo() override { TempoMap->Signature.InsertOrUpdate(NewValue); }
 
 			Undo::MergeResult TryMerge(Command& commandToMerge) override { return Undo::MergeResult::Failed; }
@@ -148,10 +148,10 @@ namespace PeepoDrumKit
 
 		struct RemoveTimeSignatureChange : Undo::Command
 		{
-			RemoveTimeSignatureChange(SortedTempoMap* tempoMap, Beat beat) : TempoMap(tempoMap), OldValue(*TempoMap->Signature.TryFindLastAtBeat(beat)) { assert(OldValue.Beat == beat); }
+			RemoveTimeSignatureChange(SortedTempoMap* tempoMap, Beat beat) : TempoMap(tempoMap), OldValue(*TempoMap->Signature.TryFindLastAtBeat(beat)) { assert(OldValue.BeatTime == beat); }
 
 			void Undo() override { TempoMap->Signature.InsertOrUpdate(OldValue); }
-			void Redo() override { TempoMap->Signature.RemoveAtBeat(OldValue.Beat); }
+			void Redo() override { TempoMap->Signature.RemoveAtBeat(OldValue.BeatTime); }
 
 			Undo::MergeResult TryMerge(Command& commandToMerge) override { return Undo::MergeResult::Failed; }
 			Undo::CommandInfo GetInfo() const override { return { "Remove Time Signature Change" }; }
@@ -162,7 +162,7 @@ namespace PeepoDrumKit
 
 		struct UpdateTimeSignatureChange : Undo::Command
 		{
-			UpdateTimeSignatureChange(SortedTempoMap* tempoMap, TimeSignatureChange newValue) : TempoMap(tempoMap), NewValue(newValue), OldValue(*TempoMap->Signature.TryFindLastAtBeat(newValue.Beat)) { assert(newValue.Beat == OldValue.Beat); }
+			UpdateTimeSignatureChange(SortedTempoMap* tempoMap, TimeSignatureChange newValue) : TempoMap(tempoMap), NewValue(newValue), OldValue(*TempoMap->Signature.TryFindLastAtBeat(newValue.BeatTime)) { assert(newValue.BeatTime == OldValue.BeatTime); }
 
 			void Undo() override { TempoMap->Signature.InsertOrUpdate(OldValue); }
 			void Redo() override { TempoMap->Signature.InsertOrUpdate(NewValue); }
@@ -170,7 +170,7 @@ namespace PeepoDrumKit
 			Undo::MergeResult TryMerge(Command& commandToMerge) override
 			{
 				auto* other = static_cast<decltype(this)>(&commandToMerge);
-				if (other->TempoMap != TempoMap || other->NewValue.Beat != NewValue.Beat)
+				if (other->TempoMap != TempoMap || other->NewValue.BeatTime != NewValue.BeatTime)
 					return Undo::MergeResult::Failed;
 
 				NewValue = other->NewValue;
@@ -432,8 +432,8 @@ namespace PeepoDrumKit
 		{
 			AddMultipleNotes(SortedNotesList* notes, std::vector<Note> newNotes) : Notes(notes), NewNotes(std::move(newNotes)) {}
 
-			void Undo() override { for (const Note& note : NewNotes) Notes->RemoveAtBeat(note.BeatTime); }
-			void Redo() override { for (const Note& note : NewNotes) Notes->InsertOrUpdate(note); }
+			void Undo() override { Notes->RemoveMultiple(NewNotes); }
+			void Redo() override { Notes->InsertOrUpdateMultiple(NewNotes); }
 
 			Undo::MergeResult TryMerge(Undo::Command& commandToMerge) override { return Undo::MergeResult::Failed; }
 			Undo::CommandInfo GetInfo() const override { return { "Add Notes" }; }
@@ -460,8 +460,8 @@ namespace PeepoDrumKit
 		{
 			RemoveMultipleNotes(SortedNotesList* notes, std::vector<Note> oldNotes) : Notes(notes), OldNotes(std::move(oldNotes)) {}
 
-			void Undo() override { for (Note& note : OldNotes) Notes->InsertOrUpdate(note); }
-			void Redo() override { for (const Note& note : OldNotes) Notes->RemoveAtBeat(note.BeatTime); }
+			void Undo() override { Notes->InsertOrUpdateMultiple(OldNotes); }
+			void Redo() override { Notes->RemoveMultiple(OldNotes); }
 
 			Undo::MergeResult TryMerge(Undo::Command& commandToMerge) override { return Undo::MergeResult::Failed; }
 			Undo::CommandInfo GetInfo() const override { return { "Remove Notes" }; }
@@ -601,14 +601,22 @@ namespace PeepoDrumKit
 			void Undo() override
 			{
 				for (const auto& newData : NewData)
-					(*Notes)[newData.Index].BeatTime = newData.OldBeat;
+				{
+					Note& note = (*Notes)[newData.Index];
+					note.BeatTime = newData.OldBeat;
+					Notes->SyncCachedBeatRangesAt(newData.Index, newData.NewBeat, note.TimeOffset);
+				}
 				// TODO: Assert sorted (?)
 			}
 
 			void Redo() override
 			{
 				for (const auto& newData : NewData)
-					(*Notes)[newData.Index].BeatTime = newData.NewBeat;
+				{
+					Note& note = (*Notes)[newData.Index];
+					note.BeatTime = newData.NewBeat;
+					Notes->SyncCachedBeatRangesAt(newData.Index, newData.OldBeat, note.TimeOffset);
+				}
 				// TODO: Assert sorted (?)
 			}
 
@@ -662,16 +670,14 @@ namespace PeepoDrumKit
 
 			void Undo() override
 			{
-				for (const auto& data : NewData)
-					TryRemoveGenericStruct(*Course, data.List, data.Value);
+				RemoveMultipleGenericStructs(*Course, NewData);
 				if (UpdateTempoMap)
 					Course->TempoMap.RebuildAccelerationStructure();
 			}
 
 			void Redo() override
 			{
-				for (const auto& data : NewData)
-					TryAddGenericStruct(*Course, data.List, data.Value);
+				AddMultipleGenericStructs(*Course, NewData);
 				if (UpdateTempoMap)
 					Course->TempoMap.RebuildAccelerationStructure();
 			}
@@ -697,16 +703,14 @@ namespace PeepoDrumKit
 
 			void Undo() override
 			{
-				for (const auto& data : OldData)
-					TryAddGenericStruct(*Course, data.List, data.Value);
+				AddMultipleGenericStructs(*Course, OldData);
 				if (UpdateTempoMap)
 					Course->TempoMap.RebuildAccelerationStructure();
 			}
 
 			void Redo() override
 			{
-				for (const auto& data : OldData)
-					TryRemoveGenericStruct(*Course, data.List, data.Value);
+				RemoveMultipleGenericStructs(*Course, OldData);
 				if (UpdateTempoMap)
 					Course->TempoMap.RebuildAccelerationStructure();
 			}
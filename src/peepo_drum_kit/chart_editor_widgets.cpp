@@ -781,21 +781,21 @@ namespace PeepoDrumKit
 						case GenericMember::B8_BarLineVisible: { /* ... */ } break;
 						case GenericMember::I16_BalloonPopCount: { min.I16 = Min(min.I16, v.I16); max.I16 = Max(max.I16, v.I16); } break;
 						case GenericMember::F32_ScrollSpeed: { min.F32 = Min(min.F32, v.F32); max.F32 = Max(max.F32, v.F32); } break;
-						case GenericMember::Beat_Start: { min.Beat = Min(min.Beat, v.Beat); max.Beat = Max(max.Beat, v.Beat); } break;
-						case GenericMember::Beat_Duration: { min.Beat = Min(min.Beat, v.Beat); max.Beat = Max(max.Beat, v.Beat); } break;
-						case GenericMember::Time_Offset: { min.Time = Min(min.Time, v.Time); max.Time = Max(max.Time, v.Time); } break;
+						case GenericMember::Beat_Start: { min.BeatV = Min(min.BeatV, v.BeatV); max.BeatV = Max(max.BeatV, v.BeatV); } break;
+						case GenericMember::Beat_Duration: { min.BeatV = Min(min.BeatV, v.BeatV); max.BeatV = Max(max.BeatV, v.BeatV); } break;
+						case GenericMember::Time_Offset: { min.TimeV = Min(min.TimeV, v.TimeV); max.TimeV = Max(max.TimeV, v.TimeV); } break;
 						case GenericMember::NoteType_V:
 						{
-							min.NoteType = static_cast<NoteType>(Min(EnumToIndex(min.NoteType), EnumToIndex(v.NoteType)));
-							max.NoteType = static_cast<NoteType>(Max(EnumToIndex(max.NoteType), EnumToIndex(v.NoteType)));
+							min.NoteTypeV = static_cast<NoteType>(Min(EnumToIndex(min.NoteTypeV), EnumToIndex(v.NoteTypeV)));
+							max.NoteTypeV = static_cast<NoteType>(Max(EnumToIndex(max.NoteTypeV), EnumToIndex(v.NoteTypeV)));
 						} break;
-						case GenericMember::Tempo_V: { min.Tempo.BPM = Min(min.Tempo.BPM, v.Tempo.BPM); max.Tempo.BPM = Max(max.Tempo.BPM, v.Tempo.BPM); } break;
+						case GenericMember::Tempo_V: { min.TempoV.BPM = Min(min.TempoV.BPM, v.TempoV.BPM); max.TempoV.BPM = Max(max.TempoV.BPM, v.TempoV.BPM); } break;
 						case GenericMember::TimeSignature_V:
 						{
-							min.TimeSignature.Numerator = Min(min.TimeSignature.Numerator, v.TimeSignature.Numerator);
-							max.TimeSignature.Numerator = Max(max.TimeSignature.Numerator, v.TimeSignature.Numerator);
-							min.TimeSignature.Denominator = Min(min.TimeSignature.Denominator, v.TimeSignature.Denominator);
-							max.TimeSignature.Denominator = Max(max.TimeSignature.Denominator, v.TimeSignature.Denominator);
+							min.TimeSignatureV.Numerator = Min(min.TimeSignatureV.Numerator, v.TimeSignatureV.Numerator);
+							max.TimeSignatureV.Numerator = Max(max.TimeSignatureV.Numerator, v.TimeSignatureV.Numerator);
+							min.TimeSignatureV.Denominator = Min(min.TimeSignatureV.Denominator, v.TimeSignatureV.Denominator);
+							max.TimeSignatureV.Denominator = Max(max.TimeSignatureV.Denominator, v.TimeSignatureV.Denominator);
 						} break;
 						case GenericMember::CStr_Lyric: { /* ... */ } break;
 						default: assert(false); break;
@@ -1552,10 +1552,10 @@ namespace PeepoDrumKit
 				Gui::BeginDisabled(disableWidgetsBeacuseOfSelection || cursorBeat.Ticks < 0);
 
 				const TempoChange* tempoChangeAtCursor = course.TempoMap.Tempo.TryFindLastAtBeat(cursorBeat);
-				const Tempo tempoAtCursor = (tempoChangeAtCursor != nullptr) ? tempoChangeAtCursor->Tempo : FallbackTempo;
+				const Tempo tempoAtCursor = (tempoChangeAtCursor != nullptr) ? tempoChangeAtCursor->TempoValue : FallbackTempo;
 				auto insertOrUpdateCursorTempoChange = [&](Tempo newTempo)
 				{
-					if (tempoChangeAtCursor == nullptr || tempoChangeAtCursor->Beat != cursorBeat)
+					if (tempoChangeAtCursor == nullptr || tempoChangeAtCursor->BeatTime != cursorBeat)
 						context.Undo.Execute<Commands::AddTempoChange>(&course.TempoMap, TempoChange(cursorBeat, newTempo));
 					else
 						context.Undo.Execute<Commands::UpdateTempoChange>(&course.TempoMap, TempoChange(cursorBeat, newTempo));
@@ -1574,7 +1574,7 @@ namespace PeepoDrumKit
 						insertOrUpdateCursorTempoChange(Tempo(Clamp(v, MinBPM, MaxBPM)));
 
 					Gui::PushID(&course.TempoMap.Tempo);
-					if (!disallowRemoveButton && tempoChangeAtCursor != nullptr && tempoChangeAtCursor->Beat == cursorBeat)
+					if (!disallowRemoveButton && tempoChangeAtCursor != nullptr && tempoChangeAtCursor->BeatTime == cursorBeat)
 					{
 						if (Gui::Button(UI_Str("Remove"), vec2(-1.0f, 0.0f)))
 							context.Undo.Execute<Commands::RemoveTempoChange>(&course.TempoMap, cursorBeat);
@@ -1594,7 +1594,7 @@ namespace PeepoDrumKit
 					auto insertOrUpdateCursorSignatureChange = [&](TimeSignature newSignature)
 					{
 						// TODO: Also floor cursor beat to next whole bar (?)
-						if (signatureChangeAtCursor == nullptr || signatureChangeAtCursor->Beat != cursorBeat)
+						if (signatureChangeAtCursor == nullptr || signatureChangeAtCursor->BeatTime != cursorBeat)
 							context.Undo.Execute<Commands::AddTimeSignatureChange>(&course.TempoMap, TimeSignatureChange(cursorBeat, newSignature));
 						else
 							context.Undo.Execute<Commands::UpdateTimeSignatureChange>(&course.TempoMap, TimeSignatureChange(cursorBeat, newSignature));
@@ -1606,7 +1606,7 @@ namespace PeepoDrumKit
 						insertOrUpdateCursorSignatureChange(TimeSignature(v[0], v[1]));
 
 					Gui::PushID(&course.TempoMap.Signature);
-					if (!disallowRemoveButton && signatureChangeAtCursor != nullptr && signatureChangeAtCursor->Beat == cursorBeat)
+					if (!disallowRemoveButton && signatureChangeAtCursor != nullptr && signatureChangeAtCursor->BeatTime == cursorBeat)
 					{
 						if (Gui::Button(UI_Str("Remove"), vec2(-1.0f, 0.0f)))
 							context.Undo.Execute<Commands::RemoveTimeSignatureChange>(&course.TempoMap, cursorBeat);
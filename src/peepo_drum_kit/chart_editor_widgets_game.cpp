@@ -230,31 +230,13 @@ namespace PeepoDrumKit
 		i32 BarIndex;
 	};
 
+	// NOTE: Bar lines don't (yet) differ between branches, so the branch is only passed for consistency
 	template <typename Func>
-	static void ForEachBarOnNoteLane(ChartCourse& course, BranchType branch, Beat maxBeatDuration, Func perBarFunc)
+	static void ForEachBarOnNoteLane(const ChartCourseTimingCache& timingCache, BranchType branch, Func perBarFunc)
 	{
-		BeatSortedForwardIterator<TempoChange> tempoChangeIt {};
-		BeatSortedForwardIterator<ScrollChange> scrollChangeIt {};
-		BeatSortedForwardIterator<BarLineChange> barLineChangeIt {};
-
-		course.TempoMap.ForEachBeatBar([&](const SortedTempoMap::ForEachBeatBarData& it)
-		{
-			if (it.Beat > maxBeatDuration)
-				return ControlFlow::Break;
-
-			if (!it.IsBar)
-				return ControlFlow::Continue;
-
-			if (!VisibleOrDefault(barLineChangeIt.Next(course.BarLineChanges.Sorted, it.Beat)))
-				return ControlFlow::Continue;
-
-			const Time time = course.TempoMap.BeatToTime(it.Beat);
-			perBarFunc(ForEachBarLaneData { time,
-				TempoOrDefault(tempoChangeIt.Next(course.TempoMap.Tempo.Sorted, it.Beat)),
-				ScrollOrDefault(scrollChangeIt.Next(course.ScrollChanges.Sorted, it.Beat)), it.BarIndex });
-
-			return ControlFlow::Continue;
-		});
+		const ChartCourseTimingCache::BarTimings& bars = timingCache.Bars;
+		for (size_t i = 0; i < bars.Times.size(); i++)
+			perBarFunc(ForEachBarLaneData { bars.Times[i], bars.Tempos[i], bars.ScrollSpeeds[i], bars.BarIndices[i] });
 	}
 
 	struct ForEachNoteLaneData
@@ -267,21 +249,14 @@ namespace PeepoDrumKit
 	};
 
 	template <typename Func>
-	static void ForEachNoteOnNoteLane(ChartCourse& course, BranchType branch, Func perNoteFunc)
+	static void ForEachNoteOnNoteLane(const ChartCourse& course, const ChartCourseTimingCache& timingCache, BranchType branch, Func perNoteFunc)
 	{
-		BeatSortedForwardIterator<TempoChange> tempoChangeIt {};
-		BeatSortedForwardIterator<ScrollChange> scrollChangeIt {};
+		const SortedNotesList& notes = course.GetNotes(branch);
+		const ChartCourseTimingCache::NoteTimings& timings = timingCache.Notes[EnumToIndex(branch)];
+		assert(timings.HeadTimes.size() == notes.size());
 
-		for (const Note& note : course.GetNotes(branch))
-		{
-			const Beat beat = note.BeatTime;
-			const Time head = (course.TempoMap.BeatToTime(beat) + note.TimeOffset);
-			const Time tail = (note.BeatDuration > Beat::Zero()) ? (course.TempoMap.BeatToTime(beat + note.BeatDuration) + note.TimeOffset) : head;
-			perNoteFunc(ForEachNoteLaneData { &note, head, tail,
-				TempoOrDefault(tempoChangeIt.Next(course.TempoMap.Tempo.Sorted, beat)),
-				ScrollOrDefault(scrollChangeIt.Next(course.ScrollChanges.Sorted, beat))
-				});
-		}
+		for (size_t i = 0; i < notes.size(); i++)
+			perNoteFunc(ForEachNoteLaneData { &notes[i], timings.HeadTimes[i], timings.TailTimes[i], timings.Tempos[i], timings.ScrollSpeeds[i] });
 	}
 
 	void ChartGamePreview::DrawGui(ChartContext& context, Time animatedCursorTime)
@@ -378,7 +353,7 @@ namespace PeepoDrumKit
 			const BeatAndTime exactCursorBeatAndTime = context.GetCursorBeatAndTime();
 			const Time cursorTimeOrAnimated = isPlayback ? exactCursorBeatAndTime.Time : animatedCursorTime;
 			const Beat cursorBeatOrAnimated = isPlayback ? exactCursorBeatAndTime.Beat : context.TimeToBeat(animatedCursorTime);
-			const Beat chartBeatDuration = context.TimeToBeat(context.Chart.GetDurationOrDefault());
+			const ChartCourseTimingCache& timingCache = context.GetUpdatedTimingCache();
 
 			// NOTE: Lane background and borders
 			{
@@ -408,7 +383,7 @@ namespace PeepoDrumKit
 			drawList->AddCircle(Camera.WorldToScreenSpace(Camera.LaneXToWorldSpace(0.0f)), Camera.WorldToScreenScale(GameHitCircle.InnerOutlineRadius), GameLaneHitCircleInnerOutlineColor, 0, Camera.WorldToScreenScale(GameHitCircle.InnerOutlineThickness));
 			drawList->AddCircle(Camera.WorldToScreenSpace(Camera.LaneXToWorldSpace(0.0f)), Camera.WorldToScreenScale(GameHitCircle.OuterOutlineRadius), GameLaneHitCircleOuterOutlineColor, 0, Camera.WorldToScreenScale(GameHitCircle.OuterOutlineThickness));
 
-			ForEachBarOnNoteLane(*context.ChartSelectedCourse, context.ChartSelectedBranch, chartBeatDuration, [&](const ForEachBarLaneData& it)
+			ForEachBarOnNoteLane(timingCache, context.ChartSelectedBranch, [&](const ForEachBarLaneData& it)
 			{
 				const f32 laneX = Camera.TimeToLaneSpaceX(cursorTimeOrAnimated, it.Time, it.Tempo, it.ScrollSpeed);
 				if (Camera.IsPointVisibleOnLane(laneX))
@@ -443,7 +418,7 @@ namespace PeepoDrumKit
 			Gui::End();
 #endif
 
-			ForEachNoteOnNoteLane(*context.ChartSelectedCourse, context.ChartSelectedBranch, [&](const ForEachNoteLaneData& it)
+			ForEachNoteOnNoteLane(*context.ChartSelectedCourse, timingCache, context.ChartSelectedBranch, [&](const ForEachNoteLaneData& it)
 			{
 				const f32 laneHeadX = Camera.TimeToLaneSpaceX(cursorTimeOrAnimated, it.TimeHead, it.Tempo, it.ScrollSpeed);
 				const f32 laneTailX = Camera.TimeToLaneSpaceX(cursorTimeOrAnimated, it.TimeTail, it.Tempo, it.ScrollSpeed);
@@ -462,6 +437,8 @@ namespace PeepoDrumKit
 			});
 
 			const Beat drummrollHitInterval = GetGridBeatSnap(*Settings.General.DrumrollAutoHitBarDivision);
+			context.Gfx.BeginCountingDrawCommands(SprGroup::Game, drawList);
+			defer { context.Gfx.EndCountingDrawCommands(SprGroup::Game); };
 			for (auto it = ReverseNoteDrawBuffer.rbegin(); it != ReverseNoteDrawBuffer.rend(); it++)
 			{
 				const Time timeSinceHit = TimeSinceNoteHit(it->NoteStartTime, cursorTimeOrAnimated);
@@ -140,6 +140,67 @@ namespace PeepoDrumKit
 					Gui::PopStyleColor(2);
 				});
 			});
+
+			Gui::Property::PropertyTreeNodeValueFunc("Render Telemetry", ImGuiTreeNodeFlags_None, [&]
+			{
+				const Audio::RenderTelemetrySnapshot telemetry = Audio::Engine.GetRenderTelemetrySnapshot();
+
+				Gui::Property::PropertyTextValueFunc("Callbacks", [&]
+				{
+					Gui::Text("%lld (%lld Frames)", static_cast<long long>(telemetry.CallbackCount), static_cast<long long>(telemetry.RenderedFrameCount));
+				});
+
+				Gui::Property::PropertyTextValueFunc("Over Budget / Underruns", [&]
+				{
+					Gui::TextColored((telemetry.OverBudgetCount > 0 || telemetry.UnderrunCount > 0) ? redColor : greenColor, "%lld / %lld",
+						static_cast<long long>(telemetry.OverBudgetCount), static_cast<long long>(telemetry.UnderrunCount));
+				});
+
+				Gui::Property::PropertyTextValueFunc("Duration Percentiles", [&]
+				{
+					Gui::Text("p50 %.3f ms, p99 %.3f ms, p99.9 %.3f ms (max %.3f ms)",
+						telemetry.EstimateDurationPercentile(50.0).ToMS(), telemetry.EstimateDurationPercentile(99.0).ToMS(), telemetry.EstimateDurationPercentile(99.9).ToMS(), telemetry.MaxDuration.ToMS());
+				});
+
+				Gui::Property::PropertyTextValueFunc("Duration Histogram", [&]
+				{
+					f32 binCounts[Audio::RenderTelemetryHistogramBinCount];
+					for (size_t bin = 0; bin < ArrayCount(binCounts); bin++)
+						binCounts[bin] = static_cast<f32>(telemetry.DurationHistogram[bin]);
+
+					Gui::PlotHistogram("##DurationHistogram", binCounts, ArrayCountI32(binCounts), 0, "Log2 Microseconds", 0.0f, FLT_MAX, vec2(Gui::GetContentRegionAvail().x, 48.0f));
+					if (Gui::IsItemHovered())
+					{
+						Gui::BeginTooltip();
+						for (size_t bin = 0; bin < ArrayCount(binCounts); bin++)
+						{
+							if (telemetry.DurationHistogram[bin] > 0)
+								Gui::Text("[%g, %g) us: %lld", Audio::GetRenderTelemetryHistogramBinStart(bin).ToMS() * 1000.0, Audio::GetRenderTelemetryHistogramBinEnd(bin).ToMS() * 1000.0, static_cast<long long>(telemetry.DurationHistogram[bin]));
+						}
+						Gui::EndTooltip();
+					}
+				});
+
+				Gui::Property::PropertyTextValueFunc("Voice Costs", [&]
+				{
+					if (auto v = Audio::Engine.GetTrackVoiceRenderCosts(); Gui::Checkbox("Track##TrackVoiceRenderCosts", &v))
+						Audio::Engine.SetTrackVoiceRenderCosts(v);
+
+					for (const Audio::RenderTelemetryVoiceCost& voice : telemetry.VoiceCosts)
+					{
+						const f64 averageUS = (voice.CallbackCount > 0) ? ((voice.TotalDuration.ToMS() * 1000.0) / static_cast<f64>(voice.CallbackCount)) : 0.0;
+						Gui::Text("%s: %.2f us avg, %.2f us max", voice.Name.c_str(), averageUS, voice.MaxDuration.ToMS() * 1000.0);
+					}
+				});
+
+				Gui::Property::PropertyTextValueFunc("Telemetry Control", [&]
+				{
+					if (Gui::Button("Reset", vec2(Gui::GetContentRegionAvail().x, 0.0f)))
+						Audio::Engine.ResetRenderTelemetry();
+					if (Gui::Button("Copy JSON", vec2(Gui::GetContentRegionAvail().x, 0.0f)))
+						Gui::SetClipboardText(Audio::RenderTelemetrySnapshotToJSON(telemetry).c_str());
+				});
+			});
 		});
 	}
 
@@ -153,10 +214,9 @@ namespace PeepoDrumKit
 				Gui::TableSetupColumn(name, ImGuiTableColumnFlags_None);
 			Gui::TableHeadersRow();
 
-			const Audio::AudioEngine::DebugVoicesArray allActiveVoices = Audio::Engine.DebugGetAllActiveVoices();
-			for (size_t i = 0; i < allActiveVoices.Count; i++)
+			const std::vector<Audio::Voice> allActiveVoices = Audio::Engine.DebugGetAllActiveVoices();
+			for (const Audio::Voice voiceIt : allActiveVoices)
 			{
-				const Audio::Voice voiceIt = allActiveVoices.Slots[i];
 				const b8 voiceIsPlaying = voiceIt.GetIsPlaying();
 				if (!voiceIsPlaying) Gui::PushStyleColor(ImGuiCol_Text, Gui::GetStyleColorVec4(ImGuiCol_TextDisabled));
 
@@ -167,9 +227,9 @@ namespace PeepoDrumKit
 				Gui::TableNextColumn(); Gui::TextUnformatted(voiceIt.GetSourceDuration().ToString().Data);
 				Gui::TableNextColumn(); Gui::Text("%.0f%%", ToPercent(voiceIt.GetVolume()));
 				Gui::TableNextColumn(); Gui::Text("%.0f%%", ToPercent(voiceIt.GetPlaybackSpeed()));
-				Gui::TableNextColumn(); Gui::Text("0x%04X", static_cast<Audio::HandleBaseType>(voiceIt.Handle));
-				Gui::TableNextColumn(); Gui::Text("0x%04X", static_cast<Audio::HandleBaseType>(voiceIt.GetSource()));
-				static_assert(sizeof(Audio::HandleBaseType) == 2, "TODO: Update format strings");
+				Gui::TableNextColumn(); Gui::Text("0x%08X", static_cast<Audio::HandleBaseType>(voiceIt.Handle));
+				Gui::TableNextColumn(); Gui::Text("0x%08X", static_cast<Audio::HandleBaseType>(voiceIt.GetSource()));
+				static_assert(sizeof(Audio::HandleBaseType) == 4, "TODO: Update format strings");
 
 				Gui::TableNextColumn();
 				if (voiceIt.GetIsLooping()) voiceFlagsBuffer += "Loop | ";
@@ -198,10 +258,10 @@ namespace PeepoDrumKit
 				Gui::TableSetupColumn(name, ImGuiTableColumnFlags_None);
 			Gui::TableHeadersRow();
 
-			const Audio::AudioEngine::DebugSourcesArray allLoadedSources = Audio::Engine.DebugGetAllLoadedSources();
-			for (size_t i = 0; i < allLoadedSources.Count; i++)
+			const std::vector<Audio::SourceHandle> allLoadedSources = Audio::Engine.DebugGetAllLoadedSources();
+			for (size_t i = 0; i < allLoadedSources.size(); i++)
 			{
-				const Audio::SourceHandle sourceIt = allLoadedSources.Slots[i];
+				const Audio::SourceHandle sourceIt = allLoadedSources[i];
 				const Audio::PCMSampleBuffer* sourceItSampleBuffer = Audio::Engine.GetSourceSampleBufferView(sourceIt);
 				const std::string_view sourceItName = Audio::Engine.GetSourceName(sourceIt);
 				const f32 sourceItBaseVolume = Audio::Engine.GetSourceBaseVolume(sourceIt);
@@ -210,7 +270,7 @@ namespace PeepoDrumKit
 				if (sourcePreviewVoice.GetSource() == sourceIt)
 					sourceItInstanceCount--;
 
-				Gui::PushID(allLoadedSources.Slots + i);
+				Gui::PushID(&allLoadedSources[i]);
 				b8 sourceIsPreviewing = (sourcePreviewVoice.GetIsPlaying() && sourcePreviewVoice.GetSource() == sourceIt);
 				const b8 pushTextColor = !sourceIsPreviewing;
 				if (pushTextColor) Gui::PushStyleColor(ImGuiCol_Text, Gui::GetStyleColorVec4(ImGuiCol_TextDisabled));
@@ -244,8 +304,8 @@ namespace PeepoDrumKit
 					}
 					Gui::SameLine(0.0f, 0.0f); Gui::TextUnformatted(sourceItName);
 				}
-				static_assert(sizeof(Audio::HandleBaseType) == 2, "TODO: Update format strings");
-				Gui::TableNextColumn(); Gui::Text("0x%04X", static_cast<Audio::HandleBaseType>(sourceIt));
+				static_assert(sizeof(Audio::HandleBaseType) == 4, "TODO: Update format strings");
+				Gui::TableNextColumn(); Gui::Text("0x%08X", static_cast<Audio::HandleBaseType>(sourceIt));
 				Gui::TableNextColumn(); Gui::Text("%.2f%%", ToPercent(sourceItBaseVolume));
 				Gui::TableNextColumn(); Gui::Text("%d", sourceItInstanceCount);
 				Gui::TableNextColumn(); (sourceItSampleBuffer != nullptr) ? Gui::Text("%d", sourceItSampleBuffer->ChannelCount) : Gui::TextDisabled("n/a");
@@ -204,9 +204,9 @@ namespace PeepoDrumKit
 
 				Gui::TableNextColumn();
 				{
-					if (token.Key >= TJA::Key::KeyColonValue_First && token.Key <= TJA::Key::KeyColonValue_Last)
+					if (token.KeyID >= TJA::Key::KeyColonValue_First && token.KeyID <= TJA::Key::KeyColonValue_Last)
 						Gui::PushStyleColor(ImGuiCol_Text, NiceImImGuiColorTextEditColorPalette[EnumToIndex(::TextEditor::PaletteIndex::Identifier)]);
-					else if (token.Key >= TJA::Key::HashCommand_First && token.Key <= TJA::Key::HashCommand_Last)
+					else if (token.KeyID >= TJA::Key::HashCommand_First && token.KeyID <= TJA::Key::HashCommand_Last)
 						Gui::PushStyleColor(ImGuiCol_Text, NiceImImGuiColorTextEditColorPalette[EnumToIndex(::TextEditor::PaletteIndex::Preprocessor)]);
 					else
 						Gui::PushStyleColor(ImGuiCol_Text, NiceImImGuiColorTextEditColorPalette[EnumToIndex(::TextEditor::PaletteIndex::Default)]);
@@ -381,10 +381,11 @@ namespace PeepoDrumKit
 							case TJA::ParsedChartCommandType::MeasureNotes:
 							{
 								static std::string strBuffer; strBuffer.clear();
-								for (const TJA::NoteType& note : param.MeasureNotes.Notes)
+								const TJA::ParsedNoteTypeView notes = course.GetNotes(param.MeasureNotes.Notes);
+								for (size_t i = 0; i < notes.size(); i++)
 								{
-									strBuffer += TJANoteTypeNames[EnumToIndex(note)];
-									if (&note != &param.MeasureNotes.Notes.back())
+									strBuffer += TJANoteTypeNames[EnumToIndex(notes.Data[i])];
+									if (i + 1 < notes.size())
 										strBuffer += " ";
 								}
 								if (!strBuffer.empty())
@@ -19,7 +19,6 @@ namespace PeepoDrumKit
 		File::UniqueFileContent FileContentBytes;
 		std::string FileContentUTF8;
 
-		std::vector<std::string_view> Lines;
 		std::vector<TJA::Token> Tokens;
 		TJA::ErrorList ParseErrors;
 		TJA::ParsedTJA Parsed;
@@ -43,8 +42,7 @@ namespace PeepoDrumKit
 
 		inline b8 DebugReloadFromModifiedFileContentUTF8()
 		{
-			Lines = TJA::SplitLines(FileContentUTF8);
-			Tokens = TJA::TokenizeLines(Lines);
+			Tokens = TJA::TokenizeFileContent(FileContentUTF8);
 			ParseErrors.Clear();
 			Parsed = ParseTokens(Tokens, ParseErrors);
 